@@ -1,6 +1,6 @@
 /*
     Let's code a 2-3 tree: 20, 30, 40, 50, 60, 11, 15, 70, 80
-    Each node has [ key[2] | *left_child | *middle_child | *right_child | is_root ]
+    Each node has [ key[2] | value[2] | *left_child | *middle_child | *right_child | is_root ]
 
     Output:
                         [30| ]
@@ -0,0 +1,88 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+    Helpers shared by the benchmarks in this directory. Each benchmark is one file with its
+    build line at the top, to be run from Recursion/; none of them is part of the library.
+*/
+
+#include <time.h>
+
+#include "u_util.h"
+
+/* Keys the benchmarks draw from: positive, so never the blank key (-1) */
+#define BENCH_KEY_MASK  (0x3FFFFFFF)
+
+/* Monotonic clock, in seconds */
+static inline double bench_now(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + ((double)now.tv_nsec * 1e-9);
+}
+
+/* xorshift64*: the same seed gives every variant the same keys */
+static inline uint64_t bench_random(uint64_t *const p_state)
+{
+    uint64_t x = *p_state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *p_state = x;
+
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static inline int32_t bench_key(uint64_t *const p_state)
+{
+    return (int32_t)(bench_random(p_state) & BENCH_KEY_MASK);
+}
+
+/*
+    count ascending keys, up to 8 values apart with random gaps, so that trees can be bulk
+    built and lookups of absent keys land between present ones. NULL when out of memory.
+*/
+static inline int32_t *bench_sorted_keys(const int32_t count, uint64_t *const p_state)
+{
+    int32_t *p_keys = (int32_t *)malloc((size_t)count * sizeof(int32_t));
+    int64_t step = (BENCH_KEY_MASK / ((int64_t)count + 1));
+    int32_t i;
+
+    step = (8 < step) ? 8 : step;
+
+    for (i = 0; (NULL != p_keys) && (i < count); i++)
+    {
+        p_keys[i] = (int32_t)(((int64_t)i * step) + (int64_t)(bench_random(p_state) % (uint64_t)step));
+    }
+
+    return p_keys;
+}
+
+/* lookup_count keys to look up: every other one is present, the rest are mostly not */
+static inline int32_t *bench_lookups(const int32_t *const p_keys, const int32_t count, const int32_t lookup_count, uint64_t *const p_state)
+{
+    int32_t *p_lookups = (int32_t *)malloc((size_t)lookup_count * sizeof(int32_t));
+    int32_t i;
+
+    for (i = 0; (NULL != p_lookups) && (i < lookup_count); i++)
+    {
+        p_lookups[i] = p_keys[bench_random(p_state) % (uint64_t)count];
+        if (0 != (i & 1))
+        {
+            p_lookups[i] += 1;
+        }
+    }
+
+    return p_lookups;
+}
+
+/* Count argument N from argv, or the default */
+static inline int32_t bench_arg(const int argc, char **const argv, const int index, const int32_t fallback)
+{
+    return (index < argc) ? (int32_t)strtol(argv[index], NULL, 10) : fallback;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,175 @@
+/*
+    Random lookups in a large tree with the nodes from malloc() or from a node arena on
+    transparent huge pages, each searched from the root and through replicated top levels:
+    nanoseconds per lookup and, where the kernel lets perf_event_open() count them, dTLB
+    load misses per lookup ("n/a" otherwise; check kernel.perf_event_paranoid). Every
+    configuration must find the same keys. Without libnuma there is one replica, so the
+    replicated runs show the cost of the copied levels, not remote memory.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -pthread -Iinclude bench/bench_arena.c u_replicated_tree.c u_node_arena.c u_util.c -o bench_arena
+        ./bench_arena [keys] [lookups] [replicated levels]
+    With libnuma: add -DHAVE_LIBNUMA ... -lnuma
+*/
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "u_replicated_tree.h"
+#include "bench.h"
+
+static int open_dtlb_counter(void);
+static bool_t bench_config(const char *const p_name, const bool_t use_arena, const bool_t replicate, const int32_t levels,
+    const int32_t *const p_keys, const int32_t key_count, const int32_t *const p_lookups, const int32_t lookup_count, int64_t *const p_found);
+
+/* dTLB load misses of this thread in user space, -1 when perf events are not available */
+static int open_dtlb_counter(void)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HW_CACHE;
+    attr.size           = sizeof(attr);
+    attr.config         = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static bool_t bench_config(const char *const p_name, const bool_t use_arena, const bool_t replicate, const int32_t levels,
+    const int32_t *const p_keys, const int32_t key_count, const int32_t *const p_lookups, const int32_t lookup_count, int64_t *const p_found)
+{
+    st_replicated_tree_t        tree;
+    st_node_arena_t             arena;
+    st_node_allocator_t         allocator;
+    const st_node_allocator_t   *p_previous = NULL;
+    uint64_t                    misses = 0;
+    int64_t                     found = 0;
+    int32_t                     i;
+    double                      start;
+    double                      elapsed;
+    bool_t                      ok;
+    int                         counter;
+
+    if (RET_ERRCODE_OK != replicated_tree_init(&tree, levels, (true == use_arena) ? NODE_ARENA_HUGE_TRANSPARENT : 0))
+    {
+        return false;
+    }
+
+    /* The shared nodes come from the arena while it is bound, and must go back to it */
+    if (true == use_arena)
+    {
+        if (RET_ERRCODE_OK != node_arena_init(&arena, NODE_ARENA_ANY_NODE, NODE_ARENA_HUGE_TRANSPARENT))
+        {
+            replicated_tree_destroy(&tree);
+            return false;
+        }
+
+        node_arena_allocator(&arena, &allocator);
+        p_previous = tree_bind_node_allocator(&allocator);
+    }
+
+    ok = (RET_ERRCODE_OK == tree_build_from_sorted(&tree.p_root, p_keys, NULL, key_count))
+      && ((false == replicate) || (RET_ERRCODE_OK == replicated_tree_refresh(&tree)));
+
+    counter = open_dtlb_counter();
+    if (0 <= counter)
+    {
+        (void)ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        (void)ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    start = bench_now();
+    for (i = 0; (true == ok) && (i < lookup_count); i++)
+    {
+        found += (NULL != replicated_tree_search(&tree, p_lookups[i]));
+    }
+    elapsed = bench_now() - start;
+
+    if (0 <= counter)
+    {
+        (void)ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if ((ssize_t)sizeof(misses) != read(counter, &misses, sizeof(misses)))
+        {
+            close(counter);
+            counter = (-1);
+        }
+    }
+
+    if (true == ok)
+    {
+        if (0 <= counter)
+        {
+            printf("%-22s %10.1f %12.3f\n", p_name, (elapsed * 1e9) / lookup_count, (double)misses / lookup_count);
+            close(counter);
+        }
+        else
+        {
+            printf("%-22s %10.1f %12s\n", p_name, (elapsed * 1e9) / lookup_count, "n/a");
+        }
+    }
+
+    replicated_tree_destroy(&tree);
+
+    if (true == use_arena)
+    {
+        (void)tree_bind_node_allocator(p_previous);
+        node_arena_destroy(&arena);
+    }
+
+    *p_found = found;
+
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int32_t     *p_keys;
+    int32_t     *p_lookups;
+    uint64_t    seed = 1;
+    int64_t     found[4];
+    int32_t     key_count;
+    int32_t     lookup_count;
+    int32_t     levels;
+    bool_t      ok;
+
+    key_count    = bench_arg(argc, argv, 1, 10000000);
+    lookup_count = bench_arg(argc, argv, 2, 5000000);
+    levels       = bench_arg(argc, argv, 3, 8);
+    if ((0 >= key_count) || (0 >= lookup_count) || (1 > levels) || (REPLICATED_TREE_MAX_LEVELS < levels))
+    {
+        fprintf(stderr, "usage: %s [keys] [lookups] [replicated levels 1..%d]\n", argv[0], REPLICATED_TREE_MAX_LEVELS);
+        return 1;
+    }
+
+    p_keys    = bench_sorted_keys(key_count, &seed);
+    p_lookups = (NULL != p_keys) ? bench_lookups(p_keys, key_count, lookup_count, &seed) : NULL;
+    if (NULL == p_lookups)
+    {
+        fprintf(stderr, "bench_arena: out of memory\n");
+        return 1;
+    }
+
+    printf("%d keys, %d lookups, %d replicated levels, %d replica(s)\n", key_count, lookup_count, levels, node_arena_node_count());
+    printf("%-22s %10s %12s\n", "nodes", "ns/lookup", "dTLB/lookup");
+
+    ok = (true == bench_config("malloc", false, false, levels, p_keys, key_count, p_lookups, lookup_count, &found[0]))
+      && (true == bench_config("malloc, replicated", false, true, levels, p_keys, key_count, p_lookups, lookup_count, &found[1]))
+      && (true == bench_config("arena", true, false, levels, p_keys, key_count, p_lookups, lookup_count, &found[2]))
+      && (true == bench_config("arena, replicated", true, true, levels, p_keys, key_count, p_lookups, lookup_count, &found[3]));
+
+    free(p_lookups);
+    free(p_keys);
+
+    if ((false == ok) || (found[0] != found[1]) || (found[0] != found[2]) || (found[0] != found[3]))
+    {
+        fprintf(stderr, "bench_arena: out of memory, or the configurations found different keys\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
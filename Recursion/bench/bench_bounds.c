@@ -0,0 +1,87 @@
+/*
+    Nearest-key queries next to search() on the same tree and the same lookups, half of
+    them keys present and half between two keys: nanoseconds per call of each.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_bounds.c u_util.c -o bench_bounds
+        ./bench_bounds [keys] [lookups]
+*/
+
+#include "bench.h"
+
+typedef bool_t (*pf_bound_t)(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key);
+
+static void time_bound(const char *const p_name, pf_bound_t pf_bound, const st_tree_node_t *const p_root, const int32_t *const p_lookups, const int32_t lookup_count);
+
+/* Keeps the timed loops from being optimized away */
+static volatile int64_t g_sink = 0;
+
+static void time_bound(const char *const p_name, pf_bound_t pf_bound, const st_tree_node_t *const p_root, const int32_t *const p_lookups, const int32_t lookup_count)
+{
+    int64_t sum = 0;
+    int32_t found_key;
+    int32_t i;
+    double  start;
+
+    start = bench_now();
+    for (i = 0; i < lookup_count; i++)
+    {
+        if (true == pf_bound(p_root, p_lookups[i], &found_key))
+        {
+            sum += found_key;
+        }
+    }
+
+    printf("%-18s %9.1f\n", p_name, ((bench_now() - start) * 1e9) / lookup_count);
+    g_sink += sum;
+}
+
+int main(int argc, char **argv)
+{
+    st_tree_node_t  *p_root = NULL;
+    int32_t         *p_keys;
+    int32_t         *p_lookups;
+    uint64_t        seed = 1;
+    int64_t         sum = 0;
+    int32_t         key_count;
+    int32_t         lookup_count;
+    int32_t         i;
+    double          start;
+
+    key_count    = bench_arg(argc, argv, 1, 1000000);
+    lookup_count = bench_arg(argc, argv, 2, 5000000);
+    if ((0 >= key_count) || (0 >= lookup_count))
+    {
+        fprintf(stderr, "usage: %s [keys] [lookups]\n", argv[0]);
+        return 1;
+    }
+
+    p_keys    = bench_sorted_keys(key_count, &seed);
+    p_lookups = (NULL != p_keys) ? bench_lookups(p_keys, key_count, lookup_count, &seed) : NULL;
+    if ((NULL == p_lookups) || (RET_ERRCODE_OK != tree_build_from_sorted(&p_root, p_keys, NULL, key_count)))
+    {
+        fprintf(stderr, "bench_bounds: out of memory\n");
+        return 1;
+    }
+
+    printf("%d keys, %d lookups\n%-18s %9s\n", key_count, lookup_count, "query", "ns/call");
+
+    start = bench_now();
+    for (i = 0; i < lookup_count; i++)
+    {
+        sum += (NULL != search(p_root, p_lookups[i]));
+    }
+    printf("%-18s %9.1f\n", "search", ((bench_now() - start) * 1e9) / lookup_count);
+    g_sink += sum;
+
+    time_bound("tree_lower_bound", tree_lower_bound, p_root, p_lookups, lookup_count);
+    time_bound("tree_upper_bound", tree_upper_bound, p_root, p_lookups, lookup_count);
+    time_bound("tree_predecessor", tree_predecessor, p_root, p_lookups, lookup_count);
+    time_bound("tree_successor", tree_successor, p_root, p_lookups, lookup_count);
+
+    tree_destroy(&p_root);
+    free(p_lookups);
+    free(p_keys);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+/*
+    Ingest rate of distinct keys in random order through the insert buffer, at several
+    buffer capacities, against the plain insert() loop: millions of keys per second, final
+    flush included. Every run must end with all the keys in the tree.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_buffered.c u_buffered_tree.c u_util.c -o bench_buffered
+        ./bench_buffered [keys]
+*/
+
+#include "u_buffered_tree.h"
+#include "bench.h"
+
+static const int32_t buffer_capacities[] = { 16, 64, 256, 1024, 4096 };
+
+static bool_t bench_buffer(const int32_t *const p_keys, const int32_t key_count, const int32_t capacity);
+
+static bool_t bench_buffer(const int32_t *const p_keys, const int32_t key_count, const int32_t capacity)
+{
+    st_buffered_tree_t  tree;
+    int32_t             in_tree;
+    int32_t             i;
+    double              start;
+    double              elapsed;
+
+    if (RET_ERRCODE_OK != buffered_tree_init(&tree, capacity))
+    {
+        return false;
+    }
+
+    start = bench_now();
+    for (i = 0; i < key_count; i++)
+    {
+        if (RET_ERRCODE_OK != buffered_tree_insert(&tree, p_keys[i]))
+        {
+            buffered_tree_destroy(&tree);
+            return false;
+        }
+    }
+
+    if (RET_ERRCODE_OK != buffered_tree_flush(&tree, NULL))
+    {
+        buffered_tree_destroy(&tree);
+        return false;
+    }
+    elapsed = bench_now() - start;
+
+    in_tree = tree_key_count(tree.p_root);
+    printf("buffer of %-10d %9.2f%s\n", capacity, (key_count / elapsed) / 1e6, (key_count != in_tree) ? "  (keys lost)" : "");
+
+    buffered_tree_destroy(&tree);
+
+    return (key_count == in_tree);
+}
+
+int main(int argc, char **argv)
+{
+    st_tree_node_t  *p_root = NULL;
+    int32_t         *p_keys;
+    uint64_t        seed = 1;
+    int32_t         key_count;
+    int32_t         capacity;
+    int32_t         swap;
+    int32_t         other;
+    int32_t         i;
+    bool_t          ok = true;
+    double          start;
+
+    key_count = bench_arg(argc, argv, 1, 2000000);
+    if (0 >= key_count)
+    {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return 1;
+    }
+
+    /* Distinct keys, so that insert() never reports a duplicate */
+    p_keys = bench_sorted_keys(key_count, &seed);
+    if (NULL == p_keys)
+    {
+        fprintf(stderr, "bench_buffered: out of memory\n");
+        return 1;
+    }
+
+    for (i = key_count - 1; 0 < i; i--)
+    {
+        other         = (int32_t)(bench_random(&seed) % (uint64_t)(i + 1));
+        swap          = p_keys[i];
+        p_keys[i]     = p_keys[other];
+        p_keys[other] = swap;
+    }
+
+    printf("%d keys in random order\n%-20s %9s\n", key_count, "ingest", "Mkeys/s");
+
+    start = bench_now();
+    for (i = 0; i < key_count; i++)
+    {
+        if (RET_ERRCODE_OK != insert(&p_root, p_keys[i]))
+        {
+            fprintf(stderr, "bench_buffered: insert() failed\n");
+            return 1;
+        }
+    }
+    printf("%-20s %9.2f\n", "insert()", (key_count / (bench_now() - start)) / 1e6);
+    tree_destroy(&p_root);
+
+    for (capacity = 0; (true == ok) && (capacity < ARRAY_SIZE(buffer_capacities)); capacity++)
+    {
+        ok = bench_buffer(p_keys, key_count, buffer_capacities[capacity]);
+    }
+
+    free(p_keys);
+
+    return (true == ok) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+    Compact level-order layout against the pointer tree it was built from: bytes per key
+    and time per lookup for the same keys and lookups. For misses per lookup, run each
+    side under perf stat -e cache-misses with the other one disabled by its argument.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_compact.c u_compact_tree.c u_tree_stats.c u_util.c -o bench_compact
+        ./bench_compact [keys] [lookups] [pointer: 0 to skip] [compact: 0 to skip]
+*/
+
+#include "u_compact_tree.h"
+#include "u_tree_stats.h"
+#include "bench.h"
+
+int main(int argc, char **argv)
+{
+    st_tree_memory_stats_t  stats;
+    st_compact_tree_t       compact;
+    st_tree_node_t          *p_root = NULL;
+    int32_t                 *p_keys;
+    int32_t                 *p_lookups;
+    uint64_t                seed = 1;
+    int32_t                 key_count;
+    int32_t                 lookup_count;
+    int32_t                 found = 0;
+    int32_t                 i;
+    double                  start;
+
+    key_count    = bench_arg(argc, argv, 1, 1000000);
+    lookup_count = bench_arg(argc, argv, 2, 5000000);
+    if ((0 >= key_count) || (0 >= lookup_count))
+    {
+        fprintf(stderr, "usage: %s [keys] [lookups] [pointer] [compact]\n", argv[0]);
+        return 1;
+    }
+
+    p_keys    = bench_sorted_keys(key_count, &seed);
+    p_lookups = (NULL != p_keys) ? bench_lookups(p_keys, key_count, lookup_count, &seed) : NULL;
+    if ((NULL == p_lookups)
+     || (RET_ERRCODE_OK != tree_build_from_sorted(&p_root, p_keys, NULL, key_count))
+     || (RET_ERRCODE_OK != compact_tree_build(p_root, &compact))
+     || (RET_ERRCODE_OK != tree_memory_stats(p_root, &stats)))
+    {
+        fprintf(stderr, "bench_compact: out of memory\n");
+        return 1;
+    }
+
+    printf("%d keys, %d lookups\n", key_count, lookup_count);
+    printf("%-10s %12s %12s\n", "layout", "bytes/key", "ns/lookup");
+
+    if (0 != bench_arg(argc, argv, 3, 1))
+    {
+        start = bench_now();
+        for (i = 0; i < lookup_count; i++)
+        {
+            found += (NULL != search(p_root, p_lookups[i]));
+        }
+
+        printf("%-10s %12.2f %12.1f\n", "pointer", stats.bytes_per_key, ((bench_now() - start) * 1e9) / lookup_count);
+    }
+
+    if (0 != bench_arg(argc, argv, 4, 1))
+    {
+        start = bench_now();
+        for (i = 0; i < lookup_count; i++)
+        {
+            found -= (true == compact_tree_search(&compact, p_lookups[i]));
+        }
+
+        printf("%-10s %12.2f %12.1f\n", "compact", (double)compact_tree_bytes(&compact) / key_count, ((bench_now() - start) * 1e9) / lookup_count);
+    }
+
+    /* Both sides found the same keys, or one of them is wrong */
+    if ((0 != bench_arg(argc, argv, 3, 1)) && (0 != bench_arg(argc, argv, 4, 1)) && (0 != found))
+    {
+        fprintf(stderr, "bench_compact: the layouts disagree\n");
+        return 1;
+    }
+
+    compact_tree_destroy(&compact);
+    tree_destroy(&p_root);
+    free(p_lookups);
+    free(p_keys);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+/*
+    Counted multiset on streams with fewer and fewer distinct keys: nanoseconds per insert,
+    rank, select and count_range, next to ranks from a binary search over the sorted stream,
+    which must add up to the same. The stream length stays the same, so higher duplication
+    means a smaller tree.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_counted.c u_counted_tree.c u_util.c -o bench_counted
+        ./bench_counted [stream length]
+*/
+
+#include "u_counted_tree.h"
+#include "bench.h"
+
+#define BENCH_QUERIES   (1000000)
+
+static int compare_keys(const void *p_left, const void *p_right);
+static uint64_t sorted_rank(const int32_t *const p_sorted, const int32_t count, const int32_t key);
+static bool_t bench_stream(int32_t *const p_stream, int32_t *const p_sorted, const int32_t count, const int32_t distinct);
+
+/* Keeps the select and range loops from being optimized away */
+static volatile uint64_t g_sink = 0;
+
+static int compare_keys(const void *p_left, const void *p_right)
+{
+    const int32_t left  = *(const int32_t *)p_left;
+    const int32_t right = *(const int32_t *)p_right;
+
+    return (left > right) - (left < right);
+}
+
+/* Occurrences below key */
+static uint64_t sorted_rank(const int32_t *const p_sorted, const int32_t count, const int32_t key)
+{
+    int32_t low = 0;
+    int32_t high = count;
+    int32_t middle;
+
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        if (p_sorted[middle] < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return (uint64_t)low;
+}
+
+static bool_t bench_stream(int32_t *const p_stream, int32_t *const p_sorted, const int32_t count, const int32_t distinct)
+{
+    st_counted_tree_t   tree;
+    uint64_t            seed = 1;
+    uint64_t            rank_sum = 0;
+    uint64_t            sorted_sum = 0;
+    uint64_t            sum = 0;
+    int32_t             key;
+    int32_t             i;
+    double              start;
+    double              insert;
+    double              rank;
+    double              sorted;
+    double              select;
+    double              range;
+
+    for (i = 0; i < count; i++)
+    {
+        p_stream[i] = (int32_t)(bench_random(&seed) % (uint64_t)distinct) * 16;
+    }
+
+    memcpy(p_sorted, p_stream, (size_t)count * sizeof(int32_t));
+    qsort(p_sorted, (size_t)count, sizeof(int32_t), compare_keys);
+
+    if (RET_ERRCODE_OK != counted_tree_init(&tree))
+    {
+        return false;
+    }
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        if (RET_ERRCODE_OK != counted_tree_insert(&tree, p_stream[i]))
+        {
+            counted_tree_destroy(&tree);
+            return false;
+        }
+    }
+    insert = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_QUERIES; i++)
+    {
+        rank_sum += counted_tree_rank(&tree, p_stream[i % count] + (i & 8));
+    }
+    rank = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_QUERIES; i++)
+    {
+        sorted_sum += sorted_rank(p_sorted, count, p_stream[i % count] + (i & 8));
+    }
+    sorted = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_QUERIES; i++)
+    {
+        (void)counted_tree_select(&tree, bench_random(&seed) % tree.total, &key);
+        sum += (uint64_t)key;
+    }
+    select = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_QUERIES; i++)
+    {
+        key  = p_stream[i % count];
+        sum += counted_tree_count_range(&tree, key, key + (16 * 64));
+    }
+    range = bench_now() - start;
+
+    printf("%10d %10d %9.1f %9.1f %9.1f %9.1f %9.1f%s\n", distinct, tree.key_count, (insert * 1e9) / count,
+        (rank * 1e9) / BENCH_QUERIES, (sorted * 1e9) / BENCH_QUERIES, (select * 1e9) / BENCH_QUERIES, (range * 1e9) / BENCH_QUERIES,
+        (rank_sum != sorted_sum) ? "  (ranks differ)" : "");
+    g_sink += sum;
+
+    counted_tree_destroy(&tree);
+
+    return (rank_sum == sorted_sum);
+}
+
+int main(int argc, char **argv)
+{
+    int32_t *p_stream;
+    int32_t *p_sorted;
+    int32_t count;
+    int32_t distinct;
+    bool_t  ok = true;
+
+    count = bench_arg(argc, argv, 1, 10000000);
+    if (0 >= count)
+    {
+        fprintf(stderr, "usage: %s [stream length]\n", argv[0]);
+        return 1;
+    }
+
+    p_stream = (int32_t *)malloc((size_t)count * sizeof(int32_t));
+    p_sorted = (int32_t *)malloc((size_t)count * sizeof(int32_t));
+    if ((NULL == p_stream) || (NULL == p_sorted))
+    {
+        return 1;
+    }
+
+    printf("%d occurrences, ns per operation\n", count);
+    printf("%10s %10s %9s %9s %9s %9s %9s\n", "distinct", "in tree", "insert", "rank", "sorted", "select", "range");
+
+    for (distinct = count; (true == ok) && (0 < distinct); distinct /= 10)
+    {
+        ok = bench_stream(p_stream, p_sorted, count, distinct);
+    }
+
+    free(p_stream);
+    free(p_sorted);
+
+    return (true == ok) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+/*
+    External build of a tree image larger than memory: writes a file of ascending keys,
+    4 bytes each (the default 512M keys make 2 GiB), builds its image with
+    disk_tree_build() under a fixed memory budget, and reports the build time, the
+    key file rate and the peak resident set against the budget. The image is then checked
+    with lookups of present and absent keys read straight from the file. Both files go
+    next to the path prefix and are removed at the end; the disk needs about 2.5 times
+    the key file.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_disk_build.c u_disk_tree.c u_util.c -o bench_disk_build
+        ./bench_disk_build [keys] [budget MiB] [path prefix]
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "u_disk_tree.h"
+#include "bench.h"
+
+#define BENCH_CHUNK     (1 << 18)
+#define BENCH_CHECKS    (10000)
+
+static int64_t peak_kib(void);
+static bool_t write_keys(const char *const p_path, const int64_t count);
+static bool_t image_contains(const int fd, const st_disk_header_t *const p_header, const int32_t key, bool_t *const p_found);
+
+/* Peak resident set of the process so far */
+static int64_t peak_kib(void)
+{
+    struct rusage usage;
+
+    (void)getrusage(RUSAGE_SELF, &usage);
+
+    return (int64_t)usage.ru_maxrss;
+}
+
+/* Key i is 2 * i, so key k is present exactly when k is even */
+static bool_t write_keys(const char *const p_path, const int64_t count)
+{
+    int32_t *p_chunk;
+    int64_t written = 0;
+    int32_t chunk;
+    int32_t i;
+    bool_t  ok;
+    int     fd;
+
+    p_chunk = (int32_t *)malloc(BENCH_CHUNK * sizeof(int32_t));
+    fd      = open(p_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ok      = ((NULL != p_chunk) && (0 <= fd));
+
+    while ((true == ok) && (written < count))
+    {
+        chunk = ((count - written) < BENCH_CHUNK) ? (int32_t)(count - written) : BENCH_CHUNK;
+        for (i = 0; i < chunk; i++)
+        {
+            p_chunk[i] = (int32_t)((written + i) * 2);
+        }
+
+        ok       = ((ssize_t)((size_t)chunk * sizeof(int32_t)) == write(fd, p_chunk, (size_t)chunk * sizeof(int32_t)));
+        written += chunk;
+    }
+
+    if (0 <= fd)
+    {
+        ok = ((0 == close(fd)) && (true == ok));
+    }
+    free(p_chunk);
+
+    return ok;
+}
+
+/* 2-3 descent from the root, one pread per node; false when the image cannot be read */
+static bool_t image_contains(const int fd, const st_disk_header_t *const p_header, const int32_t key, bool_t *const p_found)
+{
+    st_disk_node_t  node;
+    uint32_t        id = p_header->root;
+    uint32_t        child;
+
+    *p_found = false;
+
+    while (DISK_NODE_NONE != id)
+    {
+        if ((ssize_t)sizeof(node) != pread(fd, &node, sizeof(node), (off_t)disk_tree_node_offset(id)))
+        {
+            return false;
+        }
+
+        if ((key == node.keys[FIRST_KEY]) || (((-1) != node.keys[SECOND_KEY]) && (key == node.keys[SECOND_KEY])))
+        {
+            *p_found = true;
+            break;
+        }
+
+        if (key < node.keys[FIRST_KEY])
+        {
+            child = 0;
+        }
+        else if (((-1) == node.keys[SECOND_KEY]) || (key < node.keys[SECOND_KEY]))
+        {
+            child = 1;
+        }
+        else
+        {
+            child = 2;
+        }
+
+        id = node.children[child];
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    st_disk_header_t    header;
+    const char          *p_prefix;
+    char                key_path[1024];
+    char                image_path[1024];
+    uint64_t            seed = 1;
+    int64_t             key_count;
+    int64_t             before;
+    int64_t             budget_mib;
+    int32_t             key;
+    int32_t             wrong = 0;
+    int32_t             i;
+    bool_t              found;
+    double              start;
+    double              elapsed;
+    e_retcode_t         ret;
+    int                 fd;
+
+    key_count  = bench_arg(argc, argv, 1, 512 * 1024 * 1024);
+    budget_mib = bench_arg(argc, argv, 2, 64);
+    p_prefix   = (4 > argc) ? "bench_disk_build" : argv[3];
+    if ((0 >= key_count) || (((int64_t)BENCH_KEY_MASK + 1) < key_count) || ((int64_t)(DISK_TREE_MIN_BUDGET >> 20) >= budget_mib))
+    {
+        fprintf(stderr, "usage: %s [keys 1..%d] [budget MiB above %u] [path prefix]\n", argv[0], BENCH_KEY_MASK + 1, DISK_TREE_MIN_BUDGET >> 20);
+        return 1;
+    }
+
+    (void)snprintf(key_path, sizeof(key_path), "%s.keys", p_prefix);
+    (void)snprintf(image_path, sizeof(image_path), "%s.image", p_prefix);
+
+    start = bench_now();
+    if (false == write_keys(key_path, key_count))
+    {
+        fprintf(stderr, "bench_disk_build: cannot write %s\n", key_path);
+        (void)unlink(key_path);
+        return 1;
+    }
+    printf("%lld keys, %.2f GiB key file written in %.2f s\n", (long long)key_count, (key_count * 4.0) / (1 << 30), bench_now() - start);
+
+    before  = peak_kib();
+    start   = bench_now();
+    ret     = disk_tree_build(key_path, image_path, (size_t)budget_mib << 20);
+    elapsed = bench_now() - start;
+    (void)unlink(key_path);
+
+    if (RET_ERRCODE_OK != ret)
+    {
+        fprintf(stderr, "bench_disk_build: disk_tree_build() failed with %d\n", (int)ret);
+        (void)unlink(image_path);
+        return 1;
+    }
+
+    printf("built in %.2f s, %.1f MiB of keys/s\n", elapsed, ((key_count * 4.0) / (1 << 20)) / elapsed);
+    printf("peak resident %lld KiB before, %lld KiB after, budget %lld KiB\n", (long long)before, (long long)peak_kib(), (long long)(budget_mib << 10));
+
+    fd = open(image_path, O_RDONLY);
+    if ((0 > fd) || ((ssize_t)sizeof(header) != pread(fd, &header, sizeof(header), 0)) || ((uint64_t)key_count != header.key_count))
+    {
+        fprintf(stderr, "bench_disk_build: bad image header\n");
+        wrong = 1;
+    }
+
+    for (i = 0; (0 == wrong) && (i < BENCH_CHECKS); i++)
+    {
+        key = (int32_t)(bench_random(&seed) % (uint64_t)(key_count * 2));
+        if ((false == image_contains(fd, &header, key, &found)) || (found != (0 == (key & 1))))
+        {
+            fprintf(stderr, "bench_disk_build: lookup of %d in the image is wrong\n", key);
+            wrong = 1;
+        }
+    }
+
+    if (0 == wrong)
+    {
+        printf("image: height %u, %llu nodes, %d lookups checked\n", header.height, (unsigned long long)header.node_count, BENCH_CHECKS);
+    }
+
+    if (0 <= fd)
+    {
+        close(fd);
+    }
+    (void)unlink(image_path);
+
+    return wrong;
+}
\ No newline at end of file
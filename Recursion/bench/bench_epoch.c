@@ -0,0 +1,169 @@
+/*
+    Reader-side cost of epoch reclamation: the same random lookups on one tree, bare and
+    each wrapped in epoch_enter() / epoch_exit(), from 1 up to the given number of threads.
+    The tree is built on the epoch allocator, as a reader would find it in production.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -pthread -Iinclude bench/bench_epoch.c u_epoch.c u_node_pool.c u_util.c -o bench_epoch
+        ./bench_epoch [keys] [lookups per thread] [max threads]
+*/
+
+#include <pthread.h>
+
+#include "u_epoch.h"
+#include "bench.h"
+
+typedef struct
+{
+    pthread_t               thread;
+    const st_tree_node_t    *p_root;
+    const int32_t           *p_keys;
+    int32_t                 key_count;
+    int32_t                 lookups;
+    bool_t                  use_epoch;
+    uint64_t                seed;
+    int32_t                 found;
+} st_bench_reader_t;
+
+static void *reader_main(void *p_arg);
+static double run_readers(st_bench_reader_t *const p_readers, const int32_t thread_count, const bool_t use_epoch);
+
+static st_epoch_domain_t domain;
+
+static void *reader_main(void *p_arg)
+{
+    st_bench_reader_t   *p_reader = (st_bench_reader_t *)p_arg;
+    int32_t             slot = (-1);
+    int32_t             key;
+    int32_t             i;
+
+    if (true == p_reader->use_epoch)
+    {
+        slot = epoch_register(&domain);
+    }
+
+    for (i = 0; i < p_reader->lookups; i++)
+    {
+        key = p_reader->p_keys[bench_random(&p_reader->seed) % (uint64_t)p_reader->key_count];
+
+        if (0 <= slot)
+        {
+            epoch_enter(&domain, slot);
+            p_reader->found += (NULL != search(p_reader->p_root, key));
+            epoch_exit(&domain, slot);
+        }
+        else
+        {
+            p_reader->found += (NULL != search(p_reader->p_root, key));
+        }
+    }
+
+    if (0 <= slot)
+    {
+        epoch_unregister(&domain, slot);
+    }
+
+    return NULL;
+}
+
+/* Nanoseconds per lookup of one thread: the threads run side by side */
+static double run_readers(st_bench_reader_t *const p_readers, const int32_t thread_count, const bool_t use_epoch)
+{
+    double  start;
+    double  elapsed;
+    int32_t i;
+
+    start = bench_now();
+
+    for (i = 0; i < thread_count; i++)
+    {
+        p_readers[i].use_epoch = use_epoch;
+        p_readers[i].seed      = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+        p_readers[i].found     = 0;
+        (void)pthread_create(&p_readers[i].thread, NULL, reader_main, &p_readers[i]);
+    }
+
+    for (i = 0; i < thread_count; i++)
+    {
+        (void)pthread_join(p_readers[i].thread, NULL);
+        if (p_readers[i].found != p_readers[i].lookups)
+        {
+            fprintf(stderr, "bench_epoch: a key went missing\n");
+            exit(1);
+        }
+    }
+
+    elapsed = bench_now() - start;
+
+    return (elapsed * 1e9) / (double)p_readers[0].lookups;
+}
+
+int main(int argc, char **argv)
+{
+    static st_bench_reader_t    readers[EPOCH_MAX_THREADS];
+    st_node_allocator_t         allocator;
+    st_node_pool_t              pool;
+    st_tree_node_t              *p_root = NULL;
+    st_tree_path_t              path;
+    int32_t                     *p_keys;
+    uint64_t                    seed = 1;
+    double                      bare;
+    double                      guarded;
+    int32_t                     key_count;
+    int32_t                     lookups;
+    int32_t                     max_threads;
+    int32_t                     threads;
+    int32_t                     i;
+
+    key_count   = bench_arg(argc, argv, 1, 1000000);
+    lookups     = bench_arg(argc, argv, 2, 2000000);
+    max_threads = bench_arg(argc, argv, 3, 4);
+    if ((0 >= key_count) || (0 >= lookups) || (0 >= max_threads) || (EPOCH_MAX_THREADS < max_threads))
+    {
+        fprintf(stderr, "usage: %s [keys] [lookups per thread] [max threads 1..%d]\n", argv[0], EPOCH_MAX_THREADS);
+        return 1;
+    }
+
+    p_keys = (int32_t *)malloc((size_t)key_count * sizeof(int32_t));
+    if ((NULL == p_keys) || (RET_ERRCODE_OK != node_pool_init(&pool)) || (RET_ERRCODE_OK != epoch_domain_init(&domain, &pool)))
+    {
+        return 1;
+    }
+
+    epoch_node_allocator(&domain, &allocator);
+    (void)tree_bind_node_allocator(&allocator);
+
+    path.depth = 0;
+
+    for (i = 0; i < key_count; i++)
+    {
+        p_keys[i] = bench_key(&seed);
+        (void)tree_path_insert(&p_root, &path, p_keys[i]);
+    }
+
+    printf("%8s %14s %14s %10s\n", "threads", "bare ns/op", "epoch ns/op", "overhead");
+
+    for (threads = 1; threads <= max_threads; threads *= 2)
+    {
+        for (i = 0; i < threads; i++)
+        {
+            readers[i].p_root    = p_root;
+            readers[i].p_keys    = p_keys;
+            readers[i].key_count = key_count;
+            readers[i].lookups   = lookups;
+        }
+
+        bare    = run_readers(readers, threads, false);
+        guarded = run_readers(readers, threads, true);
+
+        printf("%8d %14.1f %14.1f %9.1f%%\n", threads, bare, guarded, 100.0 * (guarded - bare) / bare);
+    }
+
+    tree_destroy(&p_root);
+    epoch_domain_destroy(&domain);
+    (void)tree_bind_node_allocator(NULL);
+    node_pool_destroy(&pool);
+    free(p_keys);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+/*
+    Bloom-filtered tree against plain search() of the same tree with 0%, 50% and 90% of
+    the lookups for absent keys: the filter's false positive rate over the misses and
+    nanoseconds per lookup of each. Present keys are even and absent ones odd, so both
+    sides must find the same number of keys.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_filtered.c u_filtered_tree.c u_bloom_filter.c u_util.c -o bench_filtered
+        ./bench_filtered [keys] [lookups]
+*/
+
+#include "u_filtered_tree.h"
+#include "bench.h"
+
+static const int32_t miss_percents[] = { 0, 50, 90 };
+
+int main(int argc, char **argv)
+{
+    st_filtered_tree_t  filtered;
+    int32_t             *p_keys;
+    int32_t             *p_lookups;
+    uint64_t            seed = 1;
+    uint64_t            lookups;
+    uint64_t            false_positives;
+    int64_t             plain_found;
+    int64_t             filtered_found;
+    int32_t             key_count;
+    int32_t             lookup_count;
+    int32_t             misses;
+    int32_t             ratio;
+    int32_t             i;
+    double              start;
+    double              plain;
+    double              filter;
+
+    key_count    = bench_arg(argc, argv, 1, 1000000);
+    lookup_count = bench_arg(argc, argv, 2, 5000000);
+    if ((0 >= key_count) || ((BENCH_KEY_MASK / 16) < key_count) || (0 >= lookup_count))
+    {
+        fprintf(stderr, "usage: %s [keys 1..%d] [lookups]\n", argv[0], BENCH_KEY_MASK / 16);
+        return 1;
+    }
+
+    p_keys    = bench_sorted_keys(key_count, &seed);
+    p_lookups = (int32_t *)malloc((size_t)lookup_count * sizeof(int32_t));
+    if ((NULL == p_keys) || (NULL == p_lookups) || (RET_ERRCODE_OK != filtered_tree_init(&filtered, (uint32_t)key_count)))
+    {
+        fprintf(stderr, "bench_filtered: out of memory\n");
+        return 1;
+    }
+
+    for (i = 0; i < key_count; i++)
+    {
+        p_keys[i] *= 2;
+        if (RET_ERRCODE_OK != filtered_tree_insert(&filtered, p_keys[i]))
+        {
+            fprintf(stderr, "bench_filtered: out of memory\n");
+            return 1;
+        }
+    }
+
+    printf("%d keys, %d lookups, filter of %u KiB\n", key_count, lookup_count, (filtered.filter.block_count * BLOOM_BLOCK_WORDS * 4) >> 10);
+    printf("%8s %10s %12s %12s\n", "misses", "FP rate", "search ns", "filtered ns");
+
+    for (ratio = 0; ratio < ARRAY_SIZE(miss_percents); ratio++)
+    {
+        misses = 0;
+        for (i = 0; i < lookup_count; i++)
+        {
+            p_lookups[i] = p_keys[bench_random(&seed) % (uint64_t)key_count];
+            if ((bench_random(&seed) % 100) < (uint64_t)miss_percents[ratio])
+            {
+                p_lookups[i] += 1;
+                misses++;
+            }
+        }
+
+        plain_found = 0;
+        start       = bench_now();
+        for (i = 0; i < lookup_count; i++)
+        {
+            plain_found += (NULL != search(filtered.p_root, p_lookups[i]));
+        }
+        plain = bench_now() - start;
+
+        lookups         = filtered.lookups;
+        false_positives = filtered.false_positives;
+        filtered_found  = 0;
+        start           = bench_now();
+        for (i = 0; i < lookup_count; i++)
+        {
+            filtered_found += (NULL != filtered_tree_search(&filtered, p_lookups[i]));
+        }
+        filter          = bench_now() - start;
+        false_positives = filtered.false_positives - false_positives;
+
+        printf("%7d%% %9.2f%% %12.1f %12.1f\n", miss_percents[ratio], (0 < misses) ? ((100.0 * false_positives) / misses) : 0.0,
+            (plain * 1e9) / lookup_count, (filter * 1e9) / lookup_count);
+
+        if ((plain_found != filtered_found) || ((uint64_t)lookup_count != (filtered.lookups - lookups)) || ((int64_t)(lookup_count - misses) != plain_found))
+        {
+            fprintf(stderr, "bench_filtered: the filtered tree and search() found different keys\n");
+            return 1;
+        }
+    }
+
+    filtered_tree_destroy(&filtered);
+    free(p_lookups);
+    free(p_keys);
+
+    return 0;
+}
\ No newline at end of file
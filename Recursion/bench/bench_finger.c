@@ -0,0 +1,153 @@
+/*
+    Finger tree against insert() and search() from the root, on the same distinct keys in
+    ascending order, in sorted runs of BENCH_RUN keys at random places, and in random
+    order: nanoseconds per insert and per search of every key in the same order, and the
+    share of finger operations whose key fell outside the remembered leaf.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_finger.c u_finger_tree.c u_util.c -o bench_finger
+        ./bench_finger [keys]
+*/
+
+#include "u_finger_tree.h"
+#include "bench.h"
+
+#define BENCH_RUN   (64)
+
+static void shuffle_runs(int32_t *const p_keys, const int32_t count, const int32_t run, uint64_t *const p_state);
+static bool_t bench_order(const char *const p_name, const int32_t *const p_keys, const int32_t count);
+
+/* Keeps the search loops from being optimized away */
+static volatile uintptr_t g_sink = 0;
+
+/* Random order of the runs of run keys, each run left ascending */
+static void shuffle_runs(int32_t *const p_keys, const int32_t count, const int32_t run, uint64_t *const p_state)
+{
+    int32_t swap;
+    int32_t other;
+    int32_t i;
+    int32_t j;
+
+    for (i = (count / run) - 1; 0 < i; i--)
+    {
+        other = (int32_t)(bench_random(p_state) % (uint64_t)(i + 1));
+        for (j = 0; j < run; j++)
+        {
+            swap                      = p_keys[(i * run) + j];
+            p_keys[(i * run) + j]     = p_keys[(other * run) + j];
+            p_keys[(other * run) + j] = swap;
+        }
+    }
+}
+
+static bool_t bench_order(const char *const p_name, const int32_t *const p_keys, const int32_t count)
+{
+    st_finger_tree_t    finger;
+    st_tree_node_t      *p_root = NULL;
+    uintptr_t           plain_sum = 0;
+    uintptr_t           finger_sum = 0;
+    int32_t             i;
+    double              start;
+    double              plain_insert;
+    double              plain_search;
+    double              finger_insert;
+    double              finger_search;
+
+    finger_tree_init(&finger);
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        if (RET_ERRCODE_OK != insert(&p_root, p_keys[i]))
+        {
+            tree_destroy(&p_root);
+            return false;
+        }
+    }
+    plain_insert = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        plain_sum += (uintptr_t)(NULL != search(p_root, p_keys[i]));
+    }
+    plain_search = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        if (RET_ERRCODE_OK != finger_tree_insert(&finger, p_keys[i]))
+        {
+            tree_destroy(&p_root);
+            finger_tree_destroy(&finger);
+            return false;
+        }
+    }
+    finger_insert = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        finger_sum += (uintptr_t)(NULL != finger_tree_search(&finger, p_keys[i]));
+    }
+    finger_search = bench_now() - start;
+
+    printf("%-10s %9.1f %9.1f %9.1f %9.1f %9.1f%%\n", p_name, (plain_insert * 1e9) / count, (finger_insert * 1e9) / count,
+        (plain_search * 1e9) / count, (finger_search * 1e9) / count, (100.0 * finger.finger_misses) / finger.operations);
+    g_sink += plain_sum;
+
+    tree_destroy(&p_root);
+    finger_tree_destroy(&finger);
+
+    /* Every key was inserted, so both sides must find all of them */
+    return ((uintptr_t)count == plain_sum) && (plain_sum == finger_sum);
+}
+
+int main(int argc, char **argv)
+{
+    int32_t     *p_keys;
+    uint64_t    seed = 1;
+    int32_t     key_count;
+    bool_t      ok;
+
+    key_count = bench_arg(argc, argv, 1, 2000000);
+    if (0 >= key_count)
+    {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return 1;
+    }
+
+    p_keys = bench_sorted_keys(key_count, &seed);
+    if (NULL == p_keys)
+    {
+        fprintf(stderr, "bench_finger: out of memory\n");
+        return 1;
+    }
+
+    printf("%d keys, ns per operation\n", key_count);
+    printf("%-10s %9s %9s %9s %9s %10s\n", "order", "insert", "finger", "search", "finger", "misses");
+
+    ok = bench_order("ascending", p_keys, key_count);
+
+    if (true == ok)
+    {
+        shuffle_runs(p_keys, key_count, BENCH_RUN, &seed);
+        ok = bench_order("clustered", p_keys, key_count);
+    }
+
+    if (true == ok)
+    {
+        shuffle_runs(p_keys, key_count, 1, &seed);
+        ok = bench_order("random", p_keys, key_count);
+    }
+
+    free(p_keys);
+
+    if (true != ok)
+    {
+        fprintf(stderr, "bench_finger: a tree lost keys\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
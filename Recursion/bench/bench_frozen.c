@@ -0,0 +1,94 @@
+/*
+    Eytzinger snapshot against the pointer tree it was frozen from, at each tree size given:
+    time to freeze, then time per lookup on both for the same lookups. 100M keys need about
+    4 GB for the pointer tree.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_frozen.c u_frozen_tree.c u_util.c -o bench_frozen
+        ./bench_frozen [keys...]        (default: 1000000 10000000)
+*/
+
+#include "u_frozen_tree.h"
+#include "bench.h"
+
+#define BENCH_LOOKUPS   (2000000)
+
+static bool_t bench_size(const int32_t key_count);
+
+static bool_t bench_size(const int32_t key_count)
+{
+    st_frozen_tree_t    frozen;
+    st_tree_node_t      *p_root = NULL;
+    int32_t             *p_keys;
+    int32_t             *p_lookups;
+    uint64_t            seed = 1;
+    int32_t             found = 0;
+    int32_t             i;
+    double              start;
+    double              build;
+    double              pointer;
+    double              eytzinger;
+
+    p_keys    = bench_sorted_keys(key_count, &seed);
+    p_lookups = (NULL != p_keys) ? bench_lookups(p_keys, key_count, BENCH_LOOKUPS, &seed) : NULL;
+    if ((NULL == p_lookups) || (RET_ERRCODE_OK != tree_build_from_sorted(&p_root, p_keys, NULL, key_count)))
+    {
+        free(p_keys);
+        free(p_lookups);
+        return false;
+    }
+
+    start = bench_now();
+    if (RET_ERRCODE_OK != frozen_tree_build(p_root, &frozen))
+    {
+        tree_destroy(&p_root);
+        free(p_keys);
+        free(p_lookups);
+        return false;
+    }
+    build = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        found += (NULL != search(p_root, p_lookups[i]));
+    }
+    pointer = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        found -= (true == frozen_tree_search(&frozen, p_lookups[i]));
+    }
+    eytzinger = bench_now() - start;
+
+    printf("%12d %10.3f %14.1f %14.1f%s\n", key_count, build, (pointer * 1e9) / BENCH_LOOKUPS, (eytzinger * 1e9) / BENCH_LOOKUPS,
+        (0 != found) ? "  (results differ)" : "");
+
+    frozen_tree_destroy(&frozen);
+    tree_destroy(&p_root);
+    free(p_lookups);
+    free(p_keys);
+
+    return (0 == found);
+}
+
+int main(int argc, char **argv)
+{
+    bool_t  ok = true;
+    int     i;
+
+    printf("%12s %10s %14s %14s\n", "keys", "freeze s", "pointer ns", "frozen ns");
+
+    if (1 == argc)
+    {
+        ok = (true == bench_size(1000000)) && (true == bench_size(10000000));
+    }
+
+    for (i = 1; (true == ok) && (i < argc); i++)
+    {
+        ok = bench_size(bench_arg(argc, argv, i, 0));
+    }
+
+    return (true == ok) ? 0 : 1;
+}
\ No newline at end of file
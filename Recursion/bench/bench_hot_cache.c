@@ -0,0 +1,171 @@
+/*
+    Hot-key cache in front of search() on lookups whose keys follow a Zipfian distribution,
+    at several skews, the hottest keys scattered over the tree: hit rate from
+    hot_cache_stats() and nanoseconds per lookup against plain search(). Both must return
+    the same nodes. Nothing is freed while the lookups run, so the cache is never flushed.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_hot_cache.c u_hot_cache.c u_util.c -lm -o bench_hot_cache
+        ./bench_hot_cache [keys] [lookups] [cache entries]
+*/
+
+#include <math.h>
+
+#include "u_hot_cache.h"
+#include "bench.h"
+
+/* Zipf exponents, x100 */
+static const int32_t skews[] = { 0, 60, 80, 99, 120 };
+
+static void zipf_lookups(int32_t *const p_lookups, const int32_t lookup_count, const int32_t *const p_ranked, double *const p_cdf, const int32_t key_count, const double skew, uint64_t *const p_state);
+
+/* Keeps the timed loops from being optimized away */
+static volatile uintptr_t g_sink = 0;
+
+/* Lookup of the key of rank r with probability proportional to 1 / (r + 1)^skew */
+static void zipf_lookups(int32_t *const p_lookups, const int32_t lookup_count, const int32_t *const p_ranked, double *const p_cdf, const int32_t key_count, const double skew, uint64_t *const p_state)
+{
+    double  total = 0.0;
+    double  point;
+    int32_t low;
+    int32_t high;
+    int32_t middle;
+    int32_t i;
+
+    for (i = 0; i < key_count; i++)
+    {
+        total    += 1.0 / pow((double)(i + 1), skew);
+        p_cdf[i]  = total;
+    }
+
+    for (i = 0; i < lookup_count; i++)
+    {
+        point = ((double)(bench_random(p_state) >> 11) / (double)(1ULL << 53)) * total;
+        low   = 0;
+        high  = key_count - 1;
+        while (low < high)
+        {
+            middle = low + ((high - low) / 2);
+            if (p_cdf[middle] < point)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        p_lookups[i] = p_ranked[low];
+    }
+}
+
+int main(int argc, char **argv)
+{
+    st_hot_cache_stats_t    stats;
+    st_hot_cache_t          cache;
+    st_tree_node_t          *p_root = NULL;
+    uint64_t                *p_previous;
+    int32_t                 *p_keys;
+    int32_t                 *p_lookups;
+    double                  *p_cdf;
+    uint64_t                generation = 0;
+    uint64_t                seed = 1;
+    uintptr_t               plain_sum;
+    uintptr_t               cached_sum;
+    int32_t                 key_count;
+    int32_t                 lookup_count;
+    int32_t                 entry_count;
+    int32_t                 other;
+    int32_t                 swap;
+    int32_t                 skew;
+    int32_t                 i;
+    double                  start;
+    double                  plain;
+    double                  cached;
+
+    key_count    = bench_arg(argc, argv, 1, 1000000);
+    lookup_count = bench_arg(argc, argv, 2, 5000000);
+    entry_count  = bench_arg(argc, argv, 3, 4096);
+    if ((0 >= key_count) || (0 >= lookup_count) || (0 >= entry_count))
+    {
+        fprintf(stderr, "usage: %s [keys] [lookups] [cache entries]\n", argv[0]);
+        return 1;
+    }
+
+    p_keys    = bench_sorted_keys(key_count, &seed);
+    p_lookups = (int32_t *)malloc((size_t)lookup_count * sizeof(int32_t));
+    p_cdf     = (double *)malloc((size_t)key_count * sizeof(double));
+    if ((NULL == p_keys) || (NULL == p_lookups) || (NULL == p_cdf))
+    {
+        fprintf(stderr, "bench_hot_cache: out of memory\n");
+        return 1;
+    }
+
+    /* The tree's own free counter, so that frees elsewhere could not flush the cache */
+    p_previous = tree_bind_free_generation(&generation);
+    if (RET_ERRCODE_OK != tree_build_from_sorted(&p_root, p_keys, NULL, key_count))
+    {
+        fprintf(stderr, "bench_hot_cache: out of memory\n");
+        return 1;
+    }
+    (void)tree_bind_free_generation(p_previous);
+
+    /* Rank order: hot keys are not neighbours in the tree */
+    for (i = key_count - 1; 0 < i; i--)
+    {
+        other         = (int32_t)(bench_random(&seed) % (uint64_t)(i + 1));
+        swap          = p_keys[i];
+        p_keys[i]     = p_keys[other];
+        p_keys[other] = swap;
+    }
+
+    printf("%d keys, %d lookups, %d cache entries\n", key_count, lookup_count, entry_count);
+    printf("%8s %10s %12s %12s\n", "skew", "hit rate", "search ns", "cached ns");
+
+    for (skew = 0; skew < ARRAY_SIZE(skews); skew++)
+    {
+        zipf_lookups(p_lookups, lookup_count, p_keys, p_cdf, key_count, skews[skew] / 100.0, &seed);
+
+        if (RET_ERRCODE_OK != hot_cache_init(&cache, (uint32_t)entry_count, &generation))
+        {
+            fprintf(stderr, "bench_hot_cache: out of memory\n");
+            return 1;
+        }
+
+        plain_sum = 0;
+        start     = bench_now();
+        for (i = 0; i < lookup_count; i++)
+        {
+            plain_sum += (uintptr_t)search(p_root, p_lookups[i]);
+        }
+        plain = bench_now() - start;
+
+        cached_sum = 0;
+        start      = bench_now();
+        for (i = 0; i < lookup_count; i++)
+        {
+            cached_sum += (uintptr_t)hot_cache_search(&cache, p_root, p_lookups[i]);
+        }
+        cached = bench_now() - start;
+
+        hot_cache_stats(&cache, &stats);
+        hot_cache_destroy(&cache);
+
+        printf("%8.2f %9.1f%% %12.1f %12.1f\n", skews[skew] / 100.0, stats.hit_rate * 100.0, (plain * 1e9) / lookup_count, (cached * 1e9) / lookup_count);
+        g_sink += plain_sum;
+
+        if (plain_sum != cached_sum)
+        {
+            fprintf(stderr, "bench_hot_cache: the cache returned other nodes than search()\n");
+            return 1;
+        }
+    }
+
+    tree_destroy(&p_root);
+    free(p_cdf);
+    free(p_lookups);
+    free(p_keys);
+
+    return 0;
+}
\ No newline at end of file
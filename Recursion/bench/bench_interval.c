@@ -0,0 +1,161 @@
+/*
+    Interval tree against a scan of the intervals sorted by low end, which stops at the
+    first low end past the query: microseconds per overlap query for a short window and
+    per stabbing query. Both sides must count the same intervals. The scan is linear, so it
+    only runs the first BENCH_SCAN_QUERIES queries.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_interval.c u_interval_tree.c u_util.c -o bench_interval
+        ./bench_interval [intervals] [longest interval]
+*/
+
+#include "u_interval_tree.h"
+#include "bench.h"
+
+#define BENCH_QUERIES       (200000)
+#define BENCH_SCAN_QUERIES  (200)
+#define BENCH_WINDOW        (1024)
+
+typedef struct
+{
+    int32_t     low;
+    int32_t     high;
+} st_bench_interval_t;
+
+static int compare_intervals(const void *p_left, const void *p_right);
+static void count_interval(const int32_t low, const int32_t high, void *p_ctx);
+static int64_t scan_overlaps(const st_bench_interval_t *const p_sorted, const int32_t count, const int32_t low, const int32_t high);
+
+static int compare_intervals(const void *p_left, const void *p_right)
+{
+    const int32_t left  = ((const st_bench_interval_t *)p_left)->low;
+    const int32_t right = ((const st_bench_interval_t *)p_right)->low;
+
+    return (left > right) - (left < right);
+}
+
+static void count_interval(const int32_t low, const int32_t high, void *p_ctx)
+{
+    (void)low;
+    (void)high;
+
+    (*(int64_t *)p_ctx)++;
+}
+
+/* Intervals overlapping [low, high] among those sorted by low end */
+static int64_t scan_overlaps(const st_bench_interval_t *const p_sorted, const int32_t count, const int32_t low, const int32_t high)
+{
+    int64_t found = 0;
+    int32_t i;
+
+    for (i = 0; (i < count) && (p_sorted[i].low <= high); i++)
+    {
+        found += (p_sorted[i].high >= low);
+    }
+
+    return found;
+}
+
+int main(int argc, char **argv)
+{
+    st_interval_tree_t  tree;
+    st_bench_interval_t *p_sorted;
+    int32_t             *p_points;
+    uint64_t            seed = 1;
+    int64_t             tree_found[2] = { 0, 0 };
+    int64_t             scan_found[2] = { 0, 0 };
+    int64_t             found = 0;
+    int32_t             count;
+    int32_t             longest;
+    int32_t             low;
+    int32_t             i;
+    double              start;
+    double              window;
+    double              stab;
+    double              scan_window;
+    double              scan_stab;
+
+    count   = bench_arg(argc, argv, 1, 2000000);
+    longest = bench_arg(argc, argv, 2, 100000);
+    if ((0 >= count) || (0 >= longest))
+    {
+        fprintf(stderr, "usage: %s [intervals] [longest interval]\n", argv[0]);
+        return 1;
+    }
+
+    p_sorted = (st_bench_interval_t *)malloc((size_t)count * sizeof(st_bench_interval_t));
+    p_points = (int32_t *)malloc(BENCH_QUERIES * sizeof(int32_t));
+    if ((NULL == p_sorted) || (NULL == p_points) || (RET_ERRCODE_OK != interval_tree_init(&tree)))
+    {
+        return 1;
+    }
+
+    start = bench_now();
+    for (i = 0; i < count; i++)
+    {
+        low              = bench_key(&seed);
+        p_sorted[i].low  = low;
+        p_sorted[i].high = low + (int32_t)(bench_random(&seed) % (uint64_t)longest);
+        if (RET_ERRCODE_OK != interval_tree_insert(&tree, p_sorted[i].low, p_sorted[i].high))
+        {
+            fprintf(stderr, "bench_interval: interval_tree_insert() failed\n");
+            return 1;
+        }
+    }
+    printf("%d intervals up to %d long, inserted in %.3f s\n", count, longest, bench_now() - start);
+
+    qsort(p_sorted, (size_t)count, sizeof(st_bench_interval_t), compare_intervals);
+
+    for (i = 0; i < BENCH_QUERIES; i++)
+    {
+        p_points[i] = bench_key(&seed);
+    }
+
+    start = bench_now();
+    for (i = 0; i < BENCH_QUERIES; i++)
+    {
+        found = 0;
+        (void)interval_tree_overlaps(&tree, p_points[i], p_points[i] + BENCH_WINDOW, count_interval, &found);
+        tree_found[0] += (i < BENCH_SCAN_QUERIES) ? found : 0;
+    }
+    window = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_QUERIES; i++)
+    {
+        found = 0;
+        (void)interval_tree_stab(&tree, p_points[i], count_interval, &found);
+        tree_found[1] += (i < BENCH_SCAN_QUERIES) ? found : 0;
+    }
+    stab = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_SCAN_QUERIES; i++)
+    {
+        scan_found[0] += scan_overlaps(p_sorted, count, p_points[i], p_points[i] + BENCH_WINDOW);
+    }
+    scan_window = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_SCAN_QUERIES; i++)
+    {
+        scan_found[1] += scan_overlaps(p_sorted, count, p_points[i], p_points[i]);
+    }
+    scan_stab = bench_now() - start;
+
+    printf("%-14s %12s %12s\n", "us per query", "tree", "sorted scan");
+    printf("%-14s %12.3f %12.3f\n", "overlap", (window * 1e6) / BENCH_QUERIES, (scan_window * 1e6) / BENCH_SCAN_QUERIES);
+    printf("%-14s %12.3f %12.3f\n", "stab", (stab * 1e6) / BENCH_QUERIES, (scan_stab * 1e6) / BENCH_SCAN_QUERIES);
+
+    interval_tree_destroy(&tree);
+    free(p_points);
+    free(p_sorted);
+
+    if ((tree_found[0] != scan_found[0]) || (tree_found[1] != scan_found[1]))
+    {
+        fprintf(stderr, "bench_interval: the tree and the scan found different intervals\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
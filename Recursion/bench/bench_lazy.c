@@ -0,0 +1,137 @@
+/*
+    Eager delete against lazy deletion with incremental compaction, deleting half of the
+    keys in random order from the same tree. Each lazy delete is timed together with the
+    lazy_tree_compact_step() it triggers once compaction is due, so the cleanup cost
+    shows up in the tail. Nanoseconds per delete: mean, p50, p99 and max. Both sides
+    must be left with the same keys.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_lazy.c u_lazy_tree.c u_key_set.c u_util.c -o bench_lazy
+        ./bench_lazy [keys] [compaction threshold] [compaction budget per delete]
+*/
+
+#include "u_lazy_tree.h"
+#include "bench.h"
+
+static int compare_latencies(const void *p_left, const void *p_right);
+static void print_latencies(const char *const p_name, double *const p_latencies, const int32_t count);
+
+static int compare_latencies(const void *p_left, const void *p_right)
+{
+    const double left  = *(const double *)p_left;
+    const double right = *(const double *)p_right;
+
+    return (left > right) - (left < right);
+}
+
+/* Sorts the latencies in place */
+static void print_latencies(const char *const p_name, double *const p_latencies, const int32_t count)
+{
+    double  total = 0;
+    int32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        total += p_latencies[i];
+    }
+
+    qsort(p_latencies, (size_t)count, sizeof(double), compare_latencies);
+
+    printf("%-8s %9.1f %9.1f %9.1f %11.1f\n", p_name, (total * 1e9) / count, p_latencies[count / 2] * 1e9,
+        p_latencies[(int32_t)(((int64_t)count * 99) / 100)] * 1e9, p_latencies[count - 1] * 1e9);
+}
+
+int main(int argc, char **argv)
+{
+    st_lazy_tree_t  lazy;
+    st_tree_node_t  *p_root = NULL;
+    int32_t         *p_keys;
+    int32_t         *p_deletes;
+    double          *p_latencies;
+    uint64_t        seed = 1;
+    int32_t         key_count;
+    int32_t         delete_count;
+    int32_t         threshold;
+    int32_t         budget;
+    int32_t         other;
+    int32_t         swap;
+    int32_t         lazy_live;
+    int32_t         i;
+    double          start;
+
+    key_count = bench_arg(argc, argv, 1, 1000000);
+    threshold = bench_arg(argc, argv, 2, 4096);
+    budget    = bench_arg(argc, argv, 3, 4);
+    if ((1 >= key_count) || (0 >= threshold) || (0 >= budget))
+    {
+        fprintf(stderr, "usage: %s [keys] [compaction threshold] [compaction budget per delete]\n", argv[0]);
+        return 1;
+    }
+
+    delete_count = key_count / 2;
+    p_keys       = bench_sorted_keys(key_count, &seed);
+    p_deletes    = (int32_t *)malloc((size_t)key_count * sizeof(int32_t));
+    p_latencies  = (double *)malloc((size_t)delete_count * sizeof(double));
+    if ((NULL == p_keys) || (NULL == p_deletes) || (NULL == p_latencies)
+     || (RET_ERRCODE_OK != lazy_tree_init(&lazy, (uint32_t)threshold))
+     || (RET_ERRCODE_OK != tree_build_from_sorted(&p_root, p_keys, NULL, key_count))
+     || (RET_ERRCODE_OK != tree_build_from_sorted(&lazy.p_root, p_keys, NULL, key_count)))
+    {
+        fprintf(stderr, "bench_lazy: out of memory\n");
+        return 1;
+    }
+
+    memcpy(p_deletes, p_keys, (size_t)key_count * sizeof(int32_t));
+    for (i = key_count - 1; 0 < i; i--)
+    {
+        other            = (int32_t)(bench_random(&seed) % (uint64_t)(i + 1));
+        swap             = p_deletes[i];
+        p_deletes[i]     = p_deletes[other];
+        p_deletes[other] = swap;
+    }
+
+    printf("%d keys, %d deletes, compaction at %d tombstones, %d keys per step\n", key_count, delete_count, threshold, budget);
+    printf("%-8s %9s %9s %9s %11s\n", "ns", "mean", "p50", "p99", "max");
+
+    for (i = 0; i < delete_count; i++)
+    {
+        start = bench_now();
+        (void)tree_remove(&p_root, p_deletes[i]);
+        p_latencies[i] = bench_now() - start;
+    }
+    print_latencies("eager", p_latencies, delete_count);
+
+    for (i = 0; i < delete_count; i++)
+    {
+        start = bench_now();
+        if (RET_ERRCODE_OK != lazy_tree_delete(&lazy, p_deletes[i]))
+        {
+            fprintf(stderr, "bench_lazy: out of memory\n");
+            return 1;
+        }
+
+        if (true == lazy_tree_compaction_due(&lazy))
+        {
+            (void)lazy_tree_compact_step(&lazy, budget);
+        }
+        p_latencies[i] = bench_now() - start;
+    }
+    print_latencies("lazy", p_latencies, delete_count);
+
+    lazy_live = tree_key_count(lazy.p_root) - (int32_t)lazy.tombstones.count;
+    printf("%d tombstones left for the next compaction\n", (int32_t)lazy.tombstones.count);
+
+    if (tree_key_count(p_root) != lazy_live)
+    {
+        fprintf(stderr, "bench_lazy: eager and lazy trees hold different keys\n");
+        return 1;
+    }
+
+    lazy_tree_destroy(&lazy);
+    tree_destroy(&p_root);
+    free(p_latencies);
+    free(p_deletes);
+    free(p_keys);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+/*
+    Packed leaves, plain against frame of reference, on dense keys (up to 8 apart) and on
+    keys spread over the whole key range: bytes per key, millions of keys per second for a
+    full scan and for scans of BENCH_WINDOW keys, and nanoseconds per point lookup (half
+    of the keys present). Both encodings must visit and find the same keys.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_packed.c u_packed_tree.c u_util.c -o bench_packed
+        ./bench_packed [keys] [lookups]
+*/
+
+#include "u_packed_tree.h"
+#include "bench.h"
+
+#define BENCH_WINDOW    (1024)
+#define BENCH_SCANS     (20000)
+
+static void sum_key(const int32_t key, void *p_ctx);
+static bool_t bench_encoding(const char *const p_name, const int32_t *const p_keys, const int32_t key_count, const int32_t *const p_lookups,
+    const int32_t lookup_count, const e_leaf_encoding_t encoding, int64_t *const p_checksum);
+
+static void sum_key(const int32_t key, void *p_ctx)
+{
+    *(int64_t *)p_ctx += key;
+}
+
+/* p_checksum gets the keys visited and found, the same for every encoding of the same keys */
+static bool_t bench_encoding(const char *const p_name, const int32_t *const p_keys, const int32_t key_count, const int32_t *const p_lookups,
+    const int32_t lookup_count, const e_leaf_encoding_t encoding, int64_t *const p_checksum)
+{
+    st_packed_tree_t    tree;
+    int64_t             sum = 0;
+    int64_t             scanned = 0;
+    int32_t             first;
+    int32_t             i;
+    double              start;
+    double              full;
+    double              window;
+    double              lookup;
+
+    if (RET_ERRCODE_OK != packed_tree_build_sorted(p_keys, key_count, encoding, &tree))
+    {
+        return false;
+    }
+
+    start = bench_now();
+    (void)packed_tree_range_scan(&tree, INT32_MIN, INT32_MAX, sum_key, &sum);
+    full = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < BENCH_SCANS; i++)
+    {
+        first    = (int32_t)(((int64_t)i * 7919) % key_count);
+        scanned += packed_tree_range_scan(&tree, p_keys[first], p_keys[(key_count - first <= BENCH_WINDOW) ? (key_count - 1) : (first + BENCH_WINDOW - 1)], sum_key, &sum);
+    }
+    window = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < lookup_count; i++)
+    {
+        sum += (true == packed_tree_search(&tree, p_lookups[i]));
+    }
+    lookup = bench_now() - start;
+
+    printf("%-14s %9.2f %12.1f %12.1f %11.1f\n", p_name, (double)packed_tree_bytes(&tree) / key_count,
+        (key_count / full) / 1e6, (scanned / window) / 1e6, (lookup * 1e9) / lookup_count);
+
+    *p_checksum = sum + scanned;
+    packed_tree_destroy(&tree);
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int32_t     *p_keys;
+    int32_t     *p_lookups;
+    uint64_t    seed = 1;
+    int64_t     plain_sum;
+    int64_t     for_sum;
+    int64_t     step;
+    int32_t     key_count;
+    int32_t     lookup_count;
+    int32_t     i;
+    bool_t      ok;
+
+    key_count    = bench_arg(argc, argv, 1, 10000000);
+    lookup_count = bench_arg(argc, argv, 2, 5000000);
+    if ((0 >= key_count) || ((BENCH_KEY_MASK / 16) < key_count) || (0 >= lookup_count))
+    {
+        fprintf(stderr, "usage: %s [keys 1..%d] [lookups]\n", argv[0], BENCH_KEY_MASK / 16);
+        return 1;
+    }
+
+    p_keys    = bench_sorted_keys(key_count, &seed);
+    p_lookups = (NULL != p_keys) ? bench_lookups(p_keys, key_count, lookup_count, &seed) : NULL;
+    if (NULL == p_lookups)
+    {
+        fprintf(stderr, "bench_packed: out of memory\n");
+        return 1;
+    }
+
+    printf("%d keys, scans of %d keys, %d lookups\n", key_count, BENCH_WINDOW, lookup_count);
+    printf("%-14s %9s %12s %12s %11s\n", "encoding", "bytes/key", "full Mkeys/s", "scan Mkeys/s", "ns/lookup");
+
+    ok = (true == bench_encoding("dense plain", p_keys, key_count, p_lookups, lookup_count, LEAF_ENCODING_PLAIN, &plain_sum))
+      && (true == bench_encoding("dense FOR", p_keys, key_count, p_lookups, lookup_count, LEAF_ENCODING_FOR, &for_sum))
+      && (plain_sum == for_sum);
+
+    /* The same keys spread evenly over the key range, with the same random offsets */
+    step = BENCH_KEY_MASK / ((int64_t)key_count + 1);
+    for (i = 0; (true == ok) && (i < key_count); i++)
+    {
+        p_keys[i] = (int32_t)(((int64_t)i * step) + (p_keys[i] % 8));
+    }
+
+    for (i = 0; (true == ok) && (i < lookup_count); i++)
+    {
+        p_lookups[i] = p_keys[bench_random(&seed) % (uint64_t)key_count] + (i & 1);
+    }
+
+    ok = (true == ok)
+      && (true == bench_encoding("sparse plain", p_keys, key_count, p_lookups, lookup_count, LEAF_ENCODING_PLAIN, &plain_sum))
+      && (true == bench_encoding("sparse FOR", p_keys, key_count, p_lookups, lookup_count, LEAF_ENCODING_FOR, &for_sum))
+      && (plain_sum == for_sum);
+
+    free(p_lookups);
+    free(p_keys);
+
+    if (false == ok)
+    {
+        fprintf(stderr, "bench_packed: out of memory, or the encodings disagree\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
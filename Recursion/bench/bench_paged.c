@@ -0,0 +1,175 @@
+/*
+    Paged tree with a buffer pool of 100%, 25% and 5% of the image pages: pool hit rate and
+    microseconds per random lookup (half of the keys present) and per insert of a new key.
+    Each ratio starts from a freshly built image, and the lookups must find exactly the
+    keys that are there. Misses are served by pread(), so from the OS page cache when the
+    image fits in it: drop the page cache between runs to measure the disk.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_paged.c u_paged_tree.c u_buffer_pool.c u_disk_tree.c u_util.c -o bench_paged
+        ./bench_paged [keys] [ops] [path prefix]
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "u_paged_tree.h"
+#include "bench.h"
+
+#define BENCH_CHUNK     (1 << 18)
+
+static const uint32_t frame_percents[] = { 100, 25, 5 };
+
+static bool_t write_keys(const char *const p_path, const int32_t count);
+static bool_t bench_ratio(const char *const p_key_path, const char *const p_image_path, const uint32_t percent, const int32_t key_count, const int32_t op_count);
+
+/* Key i is 2 * i, so key k is present exactly when k is even */
+static bool_t write_keys(const char *const p_path, const int32_t count)
+{
+    int32_t *p_chunk;
+    int32_t written = 0;
+    int32_t chunk;
+    int32_t i;
+    bool_t  ok;
+    int     fd;
+
+    p_chunk = (int32_t *)malloc(BENCH_CHUNK * sizeof(int32_t));
+    fd      = open(p_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ok      = ((NULL != p_chunk) && (0 <= fd));
+
+    while ((true == ok) && (written < count))
+    {
+        chunk = ((count - written) < BENCH_CHUNK) ? (count - written) : BENCH_CHUNK;
+        for (i = 0; i < chunk; i++)
+        {
+            p_chunk[i] = (written + i) * 2;
+        }
+
+        ok       = ((ssize_t)((size_t)chunk * sizeof(int32_t)) == write(fd, p_chunk, (size_t)chunk * sizeof(int32_t)));
+        written += chunk;
+    }
+
+    if (0 <= fd)
+    {
+        ok = ((0 == close(fd)) && (true == ok));
+    }
+    free(p_chunk);
+
+    return ok;
+}
+
+static bool_t bench_ratio(const char *const p_key_path, const char *const p_image_path, const uint32_t percent, const int32_t key_count, const int32_t op_count)
+{
+    st_paged_tree_t tree;
+    struct stat     image_stat;
+    uint64_t        seed = 1;
+    uint64_t        hits;
+    uint64_t        misses;
+    uint32_t        pages;
+    uint32_t        frames;
+    int32_t         key;
+    int32_t         wrong = 0;
+    int32_t         i;
+    bool_t          found;
+    double          start;
+    double          lookup;
+    double          lookup_hits;
+    double          insert;
+
+    if ((RET_ERRCODE_OK != disk_tree_build(p_key_path, p_image_path, DISK_TREE_MIN_BUDGET * 16)) || (0 != stat(p_image_path, &image_stat)))
+    {
+        return false;
+    }
+
+    pages  = (uint32_t)(image_stat.st_size / DISK_TREE_PAGE_SIZE);
+    frames = (uint32_t)(((uint64_t)pages * percent) / 100);
+    frames = (BUFFER_POOL_MIN_FRAMES > frames) ? BUFFER_POOL_MIN_FRAMES : frames;
+
+    if (RET_ERRCODE_OK != paged_tree_open(&tree, p_image_path, frames))
+    {
+        return false;
+    }
+
+    /* One pass over the lookups to warm the pool, then the timed one */
+    for (i = 0; (0 == wrong) && (i < op_count); i++)
+    {
+        wrong = (RET_ERRCODE_OK != paged_tree_search(&tree, (int32_t)(bench_random(&seed) % ((uint64_t)key_count * 2)), &found));
+    }
+
+    seed   = 2;
+    hits   = tree.pool.hits;
+    misses = tree.pool.misses;
+    start  = bench_now();
+    for (i = 0; (0 == wrong) && (i < op_count); i++)
+    {
+        key   = (int32_t)(bench_random(&seed) % ((uint64_t)key_count * 2));
+        wrong = (RET_ERRCODE_OK != paged_tree_search(&tree, key, &found)) || (found != (0 == (key & 1)));
+    }
+    lookup      = bench_now() - start;
+    hits        = tree.pool.hits - hits;
+    misses      = tree.pool.misses - misses;
+    lookup_hits = (0 < (hits + misses)) ? ((100.0 * hits) / (hits + misses)) : 0.0;
+
+    /* New odd keys, each drawn once */
+    start = bench_now();
+    for (i = 0; (0 == wrong) && (i < op_count); i++)
+    {
+        key   = (int32_t)((((uint64_t)i * 2654435761u) % (uint64_t)key_count) * 2) + 1;
+        wrong = (RET_ERRCODE_OK != paged_tree_insert(&tree, key));
+    }
+    insert = bench_now() - start;
+
+    if ((RET_ERRCODE_OK != paged_tree_close(&tree)) || (0 != wrong))
+    {
+        return false;
+    }
+
+    printf("%5u%% %9u %9.1f%% %11.2f %11.2f\n", percent, frames, lookup_hits, (lookup * 1e6) / op_count, (insert * 1e6) / op_count);
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char  *p_prefix;
+    char        key_path[1024];
+    char        image_path[1024];
+    int32_t     key_count;
+    int32_t     op_count;
+    int32_t     ratio;
+    bool_t      ok;
+
+    key_count = bench_arg(argc, argv, 1, 20000000);
+    op_count  = bench_arg(argc, argv, 2, 1000000);
+    p_prefix  = (4 > argc) ? "bench_paged" : argv[3];
+    if ((0 >= key_count) || ((BENCH_KEY_MASK + 1) < key_count) || (0 >= op_count) || (key_count < op_count))
+    {
+        fprintf(stderr, "usage: %s [keys 1..%d] [ops up to keys] [path prefix]\n", argv[0], BENCH_KEY_MASK + 1);
+        return 1;
+    }
+
+    (void)snprintf(key_path, sizeof(key_path), "%s.keys", p_prefix);
+    (void)snprintf(image_path, sizeof(image_path), "%s.image", p_prefix);
+
+    ok = write_keys(key_path, key_count);
+
+    printf("%d keys, %d lookups then %d inserts per ratio\n", key_count, op_count, op_count);
+    printf("%6s %9s %10s %11s %11s\n", "frames", "count", "hit rate", "lookup us", "insert us");
+
+    for (ratio = 0; (true == ok) && (ratio < ARRAY_SIZE(frame_percents)); ratio++)
+    {
+        ok = bench_ratio(key_path, image_path, frame_percents[ratio], key_count, op_count);
+    }
+
+    (void)unlink(key_path);
+    (void)unlink(image_path);
+
+    if (false == ok)
+    {
+        fprintf(stderr, "bench_paged: a run failed or found the wrong keys\n");
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+/*
+    Scaling of the parallel bulk load: the same unsorted keys loaded one insert at a time on
+    one thread, then with parallel_build() and parallel_insert_bulk() (a tenth more keys
+    into the built tree) from 1 to max threads, doubling. Speedups are against 1 thread.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -pthread -Iinclude bench/bench_parallel_build.c u_parallel_build.c u_util.c -o bench_parallel_build
+        ./bench_parallel_build [keys] [max threads]
+*/
+
+#include "u_parallel_build.h"
+#include "bench.h"
+
+int main(int argc, char **argv)
+{
+    st_tree_node_t  *p_root = NULL;
+    st_tree_path_t  path;
+    int32_t         *p_keys;
+    uint64_t        seed = 1;
+    int32_t         key_count;
+    int32_t         added;
+    int32_t         max_threads;
+    int32_t         threads;
+    int32_t         i;
+    double          start;
+    double          build;
+    double          bulk;
+    double          build_one = 0.0;
+    double          bulk_one = 0.0;
+
+    key_count   = bench_arg(argc, argv, 1, 10000000);
+    max_threads = bench_arg(argc, argv, 2, 8);
+    if ((0 >= key_count) || (0 >= max_threads) || (PARALLEL_MAX_THREADS < max_threads))
+    {
+        fprintf(stderr, "usage: %s [keys] [max threads 1..%d]\n", argv[0], PARALLEL_MAX_THREADS);
+        return 1;
+    }
+
+    added  = key_count / 10;
+    p_keys = (int32_t *)malloc(((size_t)key_count + (size_t)added) * sizeof(int32_t));
+    if (NULL == p_keys)
+    {
+        return 1;
+    }
+
+    for (i = 0; i < (key_count + added); i++)
+    {
+        p_keys[i] = bench_key(&seed);
+    }
+
+    path.depth = 0;
+    start      = bench_now();
+    for (i = 0; i < key_count; i++)
+    {
+        (void)tree_path_insert(&p_root, &path, p_keys[i]);
+    }
+    printf("%d keys, one insert at a time: %.3f s\n", key_count, bench_now() - start);
+    tree_destroy(&p_root);
+
+    printf("%8s %10s %9s %10s %9s\n", "threads", "build s", "speedup", "bulk s", "speedup");
+
+    for (threads = 1; threads <= max_threads; threads *= 2)
+    {
+        start = bench_now();
+        if (RET_ERRCODE_OK != parallel_build(&p_root, p_keys, key_count, threads))
+        {
+            fprintf(stderr, "bench_parallel_build: parallel_build() failed\n");
+            return 1;
+        }
+        build = bench_now() - start;
+
+        start = bench_now();
+        if (RET_ERRCODE_OK != parallel_insert_bulk(&p_root, &p_keys[key_count], added, threads))
+        {
+            fprintf(stderr, "bench_parallel_build: parallel_insert_bulk() failed\n");
+            return 1;
+        }
+        bulk = bench_now() - start;
+
+        if (1 == threads)
+        {
+            build_one = build;
+            bulk_one  = bulk;
+        }
+
+        printf("%8d %10.3f %8.2fx %10.3f %8.2fx\n", threads, build, build_one / build, bulk, bulk_one / bulk);
+        tree_destroy(&p_root);
+    }
+
+    free(p_keys);
+
+    return 0;
+}
\ No newline at end of file
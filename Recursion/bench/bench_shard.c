@@ -0,0 +1,255 @@
+/*
+    Throughput of the sharded index on a mixed workload (half searches, a quarter inserts,
+    a quarter deletes) from 1 to max threads, doubling, with the keys spread uniformly over
+    the shards and with the shards drawn from a Zipfian distribution, so that a few hot
+    shards hold back the workers that have nothing left to steal. Millions of ops per
+    second; every thread count must find the same keys.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -pthread -Iinclude bench/bench_shard.c u_shard_index.c u_thread_pool.c u_util.c -lm -o bench_shard
+        ./bench_shard [keys] [ops] [shards] [max threads] [Zipf exponent x100]
+*/
+
+#include <math.h>
+
+#include "u_shard_index.h"
+#include "bench.h"
+
+#define BENCH_BATCH     (65536)
+
+static bool_t fill_index(st_shard_index_t *const p_index, const int32_t *const p_bounds, const int32_t shard_count, const int32_t *const p_keys, const int32_t key_count, st_thread_pool_t *const p_pool);
+static void make_ops(st_index_op_t *const p_ops, const int32_t op_count, const int32_t *const p_bounds, const int32_t shard_count, const double *const p_cdf, uint64_t *const p_state);
+static double run_ops(st_index_op_t *const p_ops, const st_index_op_t *const p_workload, const int32_t op_count, const int32_t *const p_bounds, const int32_t shard_count,
+    const int32_t *const p_keys, const int32_t key_count, const int32_t threads, int64_t *const p_found);
+
+/* Index of shard_count shards over the key range, loaded with the keys; not timed */
+static bool_t fill_index(st_shard_index_t *const p_index, const int32_t *const p_bounds, const int32_t shard_count, const int32_t *const p_keys, const int32_t key_count, st_thread_pool_t *const p_pool)
+{
+    st_index_op_t   *p_ops;
+    e_retcode_t     ret;
+    int32_t         i;
+
+    if (RET_ERRCODE_OK != shard_index_init(p_index, p_bounds, shard_count))
+    {
+        return false;
+    }
+
+    p_ops = (st_index_op_t *)malloc((size_t)key_count * sizeof(st_index_op_t));
+    if (NULL == p_ops)
+    {
+        shard_index_destroy(p_index);
+        return false;
+    }
+
+    for (i = 0; i < key_count; i++)
+    {
+        p_ops[i].type = INDEX_OP_INSERT;
+        p_ops[i].key  = p_keys[i];
+    }
+
+    ret = shard_index_execute(p_index, p_ops, key_count, p_pool);
+    free(p_ops);
+
+    if (RET_ERRCODE_OK != ret)
+    {
+        shard_index_destroy(p_index);
+        return false;
+    }
+
+    return true;
+}
+
+/* Shard drawn from the cumulative distribution p_cdf, key uniform within the shard */
+static void make_ops(st_index_op_t *const p_ops, const int32_t op_count, const int32_t *const p_bounds, const int32_t shard_count, const double *const p_cdf, uint64_t *const p_state)
+{
+    uint64_t    draw;
+    double      point;
+    int32_t     shard;
+    int32_t     low;
+    int32_t     high;
+    int32_t     i;
+
+    for (i = 0; i < op_count; i++)
+    {
+        point = (double)(bench_random(p_state) >> 11) / (double)(1ULL << 53);
+        low   = 0;
+        high  = shard_count - 1;
+        while (low < high)
+        {
+            shard = low + ((high - low) / 2);
+            if (p_cdf[shard] < point)
+            {
+                low = shard + 1;
+            }
+            else
+            {
+                high = shard;
+            }
+        }
+
+        high          = ((low + 1) < shard_count) ? p_bounds[low + 1] : (BENCH_KEY_MASK + 1);
+        draw          = bench_random(p_state);
+        p_ops[i].key  = p_bounds[low] + (int32_t)((draw >> 2) % (uint64_t)(high - p_bounds[low]));
+        p_ops[i].type = (0 == (draw & 1)) ? INDEX_OP_SEARCH : ((0 == (draw & 2)) ? INDEX_OP_INSERT : INDEX_OP_DELETE);
+    }
+}
+
+/* Seconds to run the workload in batches of BENCH_BATCH on threads workers, from a freshly loaded index */
+static double run_ops(st_index_op_t *const p_ops, const st_index_op_t *const p_workload, const int32_t op_count, const int32_t *const p_bounds, const int32_t shard_count,
+    const int32_t *const p_keys, const int32_t key_count, const int32_t threads, int64_t *const p_found)
+{
+    st_thread_pool_t    pool;
+    st_shard_index_t    index;
+    int32_t             done;
+    int32_t             batch;
+    int32_t             i;
+    double              start;
+    double              elapsed = -1.0;
+
+    if (RET_ERRCODE_OK != thread_pool_init(&pool, threads))
+    {
+        return elapsed;
+    }
+
+    if (true == fill_index(&index, p_bounds, shard_count, p_keys, key_count, &pool))
+    {
+        memcpy(p_ops, p_workload, (size_t)op_count * sizeof(st_index_op_t));
+
+        start = bench_now();
+        for (done = 0; done < op_count; done += batch)
+        {
+            batch = ((op_count - done) < BENCH_BATCH) ? (op_count - done) : BENCH_BATCH;
+            if (RET_ERRCODE_OK != shard_index_execute(&index, &p_ops[done], batch, &pool))
+            {
+                break;
+            }
+        }
+        elapsed = (done >= op_count) ? (bench_now() - start) : -1.0;
+
+        *p_found = 0;
+        for (i = 0; i < op_count; i++)
+        {
+            *p_found += (true == p_ops[i].found);
+        }
+
+        shard_index_destroy(&index);
+    }
+
+    thread_pool_destroy(&pool);
+
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *const p_names[] = { "uniform", "zipfian" };
+
+    st_index_op_t   *p_workloads[2];
+    st_index_op_t   *p_ops;
+    int32_t         *p_keys;
+    int32_t         *p_bounds;
+    double          *p_cdfs[2];
+    uint64_t        seed = 1;
+    int64_t         found;
+    int64_t         first_found[2] = { 0, 0 };
+    int32_t         key_count;
+    int32_t         op_count;
+    int32_t         shard_count;
+    int32_t         max_threads;
+    int32_t         skew;
+    int32_t         threads;
+    int32_t         load;
+    int32_t         i;
+    double          total;
+    double          seconds[2];
+
+    key_count   = bench_arg(argc, argv, 1, 1000000);
+    op_count    = bench_arg(argc, argv, 2, 4000000);
+    shard_count = bench_arg(argc, argv, 3, 64);
+    max_threads = bench_arg(argc, argv, 4, 8);
+    skew        = bench_arg(argc, argv, 5, 99);
+    if ((0 >= key_count) || (0 >= op_count) || (0 >= shard_count) || (BENCH_KEY_MASK < shard_count)
+     || (0 >= max_threads) || (THREAD_POOL_MAX_WORKERS < max_threads) || (0 > skew))
+    {
+        fprintf(stderr, "usage: %s [keys] [ops] [shards] [max threads 1..%d] [Zipf exponent x100]\n", argv[0], THREAD_POOL_MAX_WORKERS);
+        return 1;
+    }
+
+    p_keys         = (int32_t *)malloc((size_t)key_count * sizeof(int32_t));
+    p_bounds       = (int32_t *)malloc((size_t)shard_count * sizeof(int32_t));
+    p_cdfs[0]      = (double *)malloc((size_t)shard_count * sizeof(double));
+    p_cdfs[1]      = (double *)malloc((size_t)shard_count * sizeof(double));
+    p_workloads[0] = (st_index_op_t *)malloc((size_t)op_count * sizeof(st_index_op_t));
+    p_workloads[1] = (st_index_op_t *)malloc((size_t)op_count * sizeof(st_index_op_t));
+    p_ops          = (st_index_op_t *)malloc((size_t)op_count * sizeof(st_index_op_t));
+    if ((NULL == p_keys) || (NULL == p_bounds) || (NULL == p_cdfs[0]) || (NULL == p_cdfs[1])
+     || (NULL == p_workloads[0]) || (NULL == p_workloads[1]) || (NULL == p_ops))
+    {
+        fprintf(stderr, "bench_shard: out of memory\n");
+        return 1;
+    }
+
+    for (i = 0; i < key_count; i++)
+    {
+        p_keys[i] = bench_key(&seed);
+    }
+
+    /* Equal key ranges; Zipfian shard i has weight 1 / (i + 1)^s */
+    total = 0.0;
+    for (i = 0; i < shard_count; i++)
+    {
+        p_bounds[i]  = (int32_t)(((int64_t)(BENCH_KEY_MASK + 1) * i) / shard_count);
+        p_cdfs[0][i] = (double)(i + 1) / shard_count;
+        total       += 1.0 / pow((double)(i + 1), skew / 100.0);
+        p_cdfs[1][i] = total;
+    }
+
+    for (i = 0; i < shard_count; i++)
+    {
+        p_cdfs[1][i] /= total;
+    }
+    p_cdfs[0][shard_count - 1] = 1.0;
+    p_cdfs[1][shard_count - 1] = 1.0;
+
+    make_ops(p_workloads[0], op_count, p_bounds, shard_count, p_cdfs[0], &seed);
+    make_ops(p_workloads[1], op_count, p_bounds, shard_count, p_cdfs[1], &seed);
+
+    printf("%d keys, %d ops in batches of %d, %d shards, hottest Zipfian shard gets %.1f%%\n",
+        key_count, op_count, BENCH_BATCH, shard_count, p_cdfs[1][0] * 100.0);
+    printf("%8s %12s %12s\n", "threads", "uniform", "zipfian");
+
+    for (threads = 1; threads <= max_threads; threads *= 2)
+    {
+        for (load = 0; load < 2; load++)
+        {
+            seconds[load] = run_ops(p_ops, p_workloads[load], op_count, p_bounds, shard_count, p_keys, key_count, threads, &found);
+            if (0.0 > seconds[load])
+            {
+                fprintf(stderr, "bench_shard: %s run on %d threads failed\n", p_names[load], threads);
+                return 1;
+            }
+
+            if (1 == threads)
+            {
+                first_found[load] = found;
+            }
+            else if (first_found[load] != found)
+            {
+                fprintf(stderr, "bench_shard: %s run on %d threads found different keys\n", p_names[load], threads);
+                return 1;
+            }
+        }
+
+        printf("%8d %12.2f %12.2f\n", threads, (op_count / seconds[0]) / 1e6, (op_count / seconds[1]) / 1e6);
+    }
+
+    free(p_ops);
+    free(p_workloads[0]);
+    free(p_workloads[1]);
+    free(p_cdfs[0]);
+    free(p_cdfs[1]);
+    free(p_bounds);
+    free(p_keys);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+/*
+    RadixSpline index against the pointer descent, on sequential, uniform and clustered keys:
+    index bytes per key beyond the keys themselves, build time and time per lookup for the
+    same lookups. The pointer tree costs about 34 bytes per key; with the last argument 0 the
+    index is built from the sorted keys and the tree is skipped, which is how 1B keys fit.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude bench/bench_spline.c u_spline_index.c u_util.c -o bench_spline
+        ./bench_spline [keys] [pointer tree: 0 to skip]
+*/
+
+#include "u_spline_index.h"
+#include "bench.h"
+
+#define BENCH_LOOKUPS       (4000000)
+#define BENCH_CLUSTERS      (1000)
+#define BENCH_CLUSTER_SPAN  (1 << 16)
+
+enum e_bench_spread
+{
+    BENCH_SEQUENTIAL = 0,
+    BENCH_UNIFORM,
+    BENCH_CLUSTERED,
+    BENCH_SPREAD_COUNT
+};
+
+static int compare_keys(const void *p_left, const void *p_right);
+static int32_t make_keys(int32_t *const p_keys, const int32_t count, const int32_t spread, uint64_t *const p_state);
+static bool_t bench_spread(int32_t *const p_keys, const int32_t count, const int32_t spread, const bool_t with_tree);
+
+static const char *const spread_names[BENCH_SPREAD_COUNT] = { "sequential", "uniform", "clustered" };
+
+static int compare_keys(const void *p_left, const void *p_right)
+{
+    const int32_t left  = *(const int32_t *)p_left;
+    const int32_t right = *(const int32_t *)p_right;
+
+    return (left > right) - (left < right);
+}
+
+/* Sorted, without duplicates: returns how many keys are left */
+static int32_t make_keys(int32_t *const p_keys, const int32_t count, const int32_t spread, uint64_t *const p_state)
+{
+    int32_t centres[BENCH_CLUSTERS];
+    int32_t unique = 0;
+    int32_t i;
+
+    if (BENCH_SEQUENTIAL == spread)
+    {
+        for (i = 0; i < count; i++)
+        {
+            p_keys[i] = i;
+        }
+
+        return count;
+    }
+
+    for (i = 0; i < BENCH_CLUSTERS; i++)
+    {
+        centres[i] = bench_key(p_state);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (BENCH_UNIFORM == spread)
+        {
+            p_keys[i] = bench_key(p_state);
+        }
+        else
+        {
+            p_keys[i] = (centres[bench_random(p_state) % BENCH_CLUSTERS] + (int32_t)(bench_random(p_state) % BENCH_CLUSTER_SPAN)) & BENCH_KEY_MASK;
+        }
+    }
+
+    qsort(p_keys, (size_t)count, sizeof(int32_t), compare_keys);
+
+    for (i = 0; i < count; i++)
+    {
+        if ((0 == unique) || (p_keys[unique - 1] != p_keys[i]))
+        {
+            p_keys[unique] = p_keys[i];
+            unique++;
+        }
+    }
+
+    return unique;
+}
+
+static bool_t bench_spread(int32_t *const p_keys, const int32_t count, const int32_t spread, const bool_t with_tree)
+{
+    st_spline_index_t   index;
+    st_tree_node_t      *p_root = NULL;
+    int32_t             *p_lookups;
+    uint64_t            seed = 1;
+    int32_t             unique;
+    int32_t             found = 0;
+    int32_t             i;
+    e_retcode_t         ret;
+    double              start;
+    double              build;
+    double              spline;
+    double              pointer = 0.0;
+
+    unique    = make_keys(p_keys, count, spread, &seed);
+    p_lookups = bench_lookups(p_keys, unique, BENCH_LOOKUPS, &seed);
+    if (NULL == p_lookups)
+    {
+        return false;
+    }
+
+    if ((true == with_tree) && (RET_ERRCODE_OK != tree_build_from_sorted(&p_root, p_keys, NULL, unique)))
+    {
+        free(p_lookups);
+        return false;
+    }
+
+    start = bench_now();
+    ret   = (true == with_tree) ? spline_index_build(p_root, SPLINE_DEFAULT_ERROR, &index)
+                                : spline_index_build_sorted(p_keys, unique, SPLINE_DEFAULT_ERROR, &index);
+    build = bench_now() - start;
+    if (RET_ERRCODE_OK != ret)
+    {
+        tree_destroy(&p_root);
+        free(p_lookups);
+        return false;
+    }
+
+    start = bench_now();
+    for (i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        found += (true == spline_index_search(&index, p_lookups[i]));
+    }
+    spline = bench_now() - start;
+
+    if (true == with_tree)
+    {
+        start = bench_now();
+        for (i = 0; i < BENCH_LOOKUPS; i++)
+        {
+            found -= (NULL != search(p_root, p_lookups[i]));
+        }
+        pointer = bench_now() - start;
+    }
+
+    printf("%-11s %12d %8d %10.3f %9.3f %11.1f", spread_names[spread], unique, index.point_count,
+        (double)(spline_index_bytes(&index) - ((size_t)unique * sizeof(int32_t))) / unique, build, (spline * 1e9) / BENCH_LOOKUPS);
+    if (true == with_tree)
+    {
+        printf(" %11.1f%s", (pointer * 1e9) / BENCH_LOOKUPS, (0 != found) ? "  (results differ)" : "");
+    }
+    printf("\n");
+
+    spline_index_destroy(&index);
+    tree_destroy(&p_root);
+    free(p_lookups);
+
+    return ((false == with_tree) || (0 == found));
+}
+
+int main(int argc, char **argv)
+{
+    int32_t *p_keys;
+    int32_t key_count;
+    int32_t spread;
+    bool_t  with_tree;
+    bool_t  ok = true;
+
+    key_count = bench_arg(argc, argv, 1, 10000000);
+    with_tree = (0 != bench_arg(argc, argv, 2, 1));
+    if (0 >= key_count)
+    {
+        fprintf(stderr, "usage: %s [keys] [pointer tree]\n", argv[0]);
+        return 1;
+    }
+
+    p_keys = (int32_t *)malloc((size_t)key_count * sizeof(int32_t));
+    if (NULL == p_keys)
+    {
+        return 1;
+    }
+
+    printf("%-11s %12s %8s %10s %9s %11s%s\n", "keys", "count", "points", "index B/k", "build s", "spline ns",
+        (true == with_tree) ? "  pointer ns" : "");
+
+    for (spread = 0; (true == ok) && (spread < BENCH_SPREAD_COUNT); spread++)
+    {
+        ok = bench_spread(p_keys, key_count, spread, with_tree);
+    }
+
+    free(p_keys);
+
+    return (true == ok) ? 0 : 1;
+}
\ No newline at end of file
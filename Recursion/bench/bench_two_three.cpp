@@ -0,0 +1,205 @@
+/*
+    two_three_set / two_three_map against std::set / std::map, with the default allocator
+    and with std::pmr monotonic and pool resources: nanoseconds per insert, find (half of
+    the keys present), step of a full iteration, and erase of every other key.
+
+    From Recursion/:
+        gcc -std=gnu11 -O2 -Iinclude -c u_util.c -o u_util.o
+        g++ -std=c++17 -O2 -Iinclude bench/bench_two_three.cpp u_util.o -o bench_two_three
+        ./bench_two_three [keys]
+*/
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <vector>
+
+#include "u_two_three.hpp"
+#include "bench.h"
+
+namespace
+{
+
+struct bench_input
+{
+    std::vector<int32_t>    keys;       /**< Distinct, in random order */
+    std::vector<int32_t>    lookups;
+};
+
+/* Keeps the timed loops from being optimized away */
+volatile long g_sink = 0;
+
+void print_row(const char *const p_name, const double insert, const double find, const double step, const double erase)
+{
+    std::printf("%-30s %9.1f %9.1f %9.1f %9.1f\n", p_name, insert, find, step, erase);
+}
+
+template <class Set>
+void run_set(const char *const p_name, Set &set, const bench_input &input)
+{
+    const double    count = static_cast<double>(input.keys.size());
+    double          start;
+    double          insert;
+    double          find;
+    double          step;
+
+    start = bench_now();
+    for (const int32_t key : input.keys)
+    {
+        set.insert(key);
+    }
+    insert = bench_now() - start;
+
+    start = bench_now();
+    for (const int32_t key : input.lookups)
+    {
+        g_sink += static_cast<long>(set.count(key));
+    }
+    find = bench_now() - start;
+
+    start = bench_now();
+    for (const int32_t key : set)
+    {
+        g_sink += key;
+    }
+    step = bench_now() - start;
+
+    start = bench_now();
+    for (size_t i = 0; i < input.keys.size(); i += 2)
+    {
+        set.erase(input.keys[i]);
+    }
+
+    print_row(p_name, (insert * 1e9) / count, (find * 1e9) / input.lookups.size(), (step * 1e9) / count, ((bench_now() - start) * 1e9) / (count / 2));
+}
+
+/* Mapped values that own memory, so that moving and destroying them is part of the cost */
+template <class Map>
+void run_map(const char *const p_name, Map &map, const bench_input &input)
+{
+    const double    count = static_cast<double>(input.keys.size());
+    double          start;
+    double          insert;
+    double          find;
+    double          step;
+
+    start = bench_now();
+    for (const int32_t key : input.keys)
+    {
+        map.try_emplace(key, std::make_unique<int32_t>(key));
+    }
+    insert = bench_now() - start;
+
+    start = bench_now();
+    for (const int32_t key : input.lookups)
+    {
+        const auto found = map.find(key);
+
+        g_sink += (map.end() != found) ? *found->second : 0;
+    }
+    find = bench_now() - start;
+
+    start = bench_now();
+    for (const auto &entry : map)
+    {
+        g_sink += *entry.second;
+    }
+    step = bench_now() - start;
+
+    start = bench_now();
+    for (size_t i = 0; i < input.keys.size(); i += 2)
+    {
+        map.erase(input.keys[i]);
+    }
+
+    print_row(p_name, (insert * 1e9) / count, (find * 1e9) / input.lookups.size(), (step * 1e9) / count, ((bench_now() - start) * 1e9) / (count / 2));
+}
+
+} /* namespace */
+
+int main(int argc, char **argv)
+{
+    using unique_value = std::unique_ptr<int32_t>;
+
+    bench_input         input;
+    std::set<int32_t>   seen;
+    uint64_t            seed = 1;
+    int32_t             key_count;
+    int32_t             key;
+
+    key_count = bench_arg(argc, argv, 1, 1000000);
+    if (0 >= key_count)
+    {
+        std::fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return 1;
+    }
+
+    while (static_cast<int32_t>(input.keys.size()) < key_count)
+    {
+        key = bench_key(&seed);
+        if (seen.insert(key).second)
+        {
+            input.keys.push_back(key);
+        }
+    }
+
+    for (int32_t i = 0; i < key_count; i++)
+    {
+        key = input.keys[bench_random(&seed) % input.keys.size()];
+        input.lookups.push_back((0 != (i & 1)) ? key : bench_key(&seed));
+    }
+
+    std::printf("%d keys, ns per operation\n", key_count);
+    std::printf("%-30s %9s %9s %9s %9s\n", "container", "insert", "find", "iterate", "erase");
+
+    {
+        std::set<int32_t> set;
+        run_set("std::set", set, input);
+    }
+    {
+        dsa::two_three_set<int32_t> set;
+        run_set("two_three_set", set, input);
+    }
+    {
+        std::pmr::monotonic_buffer_resource resource;
+        std::pmr::set<int32_t> set(&resource);
+        run_set("std::pmr::set monotonic", set, input);
+    }
+    {
+        std::pmr::monotonic_buffer_resource resource;
+        dsa::pmr::two_three_set<int32_t> set(&resource);
+        run_set("pmr::two_three_set monotonic", set, input);
+    }
+    {
+        std::pmr::unsynchronized_pool_resource resource;
+        std::pmr::set<int32_t> set(&resource);
+        run_set("std::pmr::set pool", set, input);
+    }
+    {
+        std::pmr::unsynchronized_pool_resource resource;
+        dsa::pmr::two_three_set<int32_t> set(&resource);
+        run_set("pmr::two_three_set pool", set, input);
+    }
+    {
+        std::map<int32_t, unique_value> map;
+        run_map("std::map", map, input);
+    }
+    {
+        dsa::two_three_map<int32_t, unique_value> map;
+        run_map("two_three_map", map, input);
+    }
+    {
+        std::pmr::unsynchronized_pool_resource resource;
+        std::pmr::map<int32_t, unique_value> map(&resource);
+        run_map("std::pmr::map pool", map, input);
+    }
+    {
+        std::pmr::unsynchronized_pool_resource resource;
+        dsa::pmr::two_three_map<int32_t, unique_value> map(&resource);
+        run_map("pmr::two_three_map pool", map, input);
+    }
+
+    return 0;
+}
\ No newline at end of file
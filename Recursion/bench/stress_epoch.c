@@ -0,0 +1,185 @@
+/*
+    Stress test for epoch reclamation. Reader threads search the published tree inside
+    epoch_enter() / epoch_exit() while one writer keeps building a new tree, publishing it
+    and destroying the old one, whose nodes are retired to the epoch domain. Tree r holds
+    the STRESS_KEYS keys from STRESS_KEYS * r, and the pool hands reclaimed nodes to the
+    next trees, so a reader still walking a node given back too early finds keys of
+    another round and the test fails. At the end every node must be back in the pool.
+
+    From Recursion/:
+        gcc -std=gnu11 -g -O2 -pthread -Iinclude bench/stress_epoch.c u_epoch.c u_node_pool.c u_util.c -o stress_epoch
+        ./stress_epoch [readers] [rounds]
+*/
+
+#include <pthread.h>
+
+#include "u_epoch.h"
+#include "bench.h"
+
+#define STRESS_KEYS         (4096)
+#define STRESS_MAX_READERS  (EPOCH_MAX_THREADS - 1)
+
+typedef struct
+{
+    pthread_t   thread;
+    uint64_t    seed;
+    uint64_t    reads;
+    uint64_t    failures;
+} st_stress_reader_t;
+
+static void *reader_main(void *p_arg);
+static bool_t check_tree(const st_tree_node_t *const p_root, uint64_t *const p_seed);
+
+static st_epoch_domain_t    domain;
+static st_tree_node_t       *p_published = NULL;
+static uint32_t             stop = 0;
+
+/* A whole round, seen through one root */
+static bool_t check_tree(const st_tree_node_t *const p_root, uint64_t *const p_seed)
+{
+    int32_t base;
+    int32_t key;
+    int32_t i;
+
+    if (false == tree_lower_bound(p_root, 0, &base))
+    {
+        return false;
+    }
+
+    if ((0 != (base % STRESS_KEYS)) || (NULL != search(p_root, base + STRESS_KEYS)))
+    {
+        return false;
+    }
+
+    for (i = 0; i < 16; i++)
+    {
+        key = base + (int32_t)(bench_random(p_seed) % STRESS_KEYS);
+        if (NULL == search(p_root, key))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void *reader_main(void *p_arg)
+{
+    st_stress_reader_t  *p_reader = (st_stress_reader_t *)p_arg;
+    st_tree_node_t      *p_root;
+    int32_t             slot;
+
+    slot = epoch_register(&domain);
+    if (0 > slot)
+    {
+        p_reader->failures++;
+        return NULL;
+    }
+
+    while (0 == __atomic_load_n(&stop, __ATOMIC_ACQUIRE))
+    {
+        epoch_enter(&domain, slot);
+
+        p_root = __atomic_load_n(&p_published, __ATOMIC_ACQUIRE);
+        if ((NULL != p_root) && (false == check_tree(p_root, &p_reader->seed)))
+        {
+            p_reader->failures++;
+        }
+
+        epoch_exit(&domain, slot);
+        p_reader->reads++;
+    }
+
+    epoch_unregister(&domain, slot);
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    static st_stress_reader_t   readers[STRESS_MAX_READERS];
+    static int32_t              keys[STRESS_KEYS];
+    st_node_allocator_t         allocator;
+    st_node_pool_t              pool;
+    st_tree_node_t              *p_new_root;
+    st_tree_node_t              *p_old_root;
+    uint64_t                    reads = 0;
+    uint64_t                    failures = 0;
+    int32_t                     reader_count;
+    int32_t                     rounds;
+    int32_t                     round;
+    int32_t                     i;
+
+    reader_count = bench_arg(argc, argv, 1, 4);
+    rounds       = bench_arg(argc, argv, 2, 2000);
+    if ((0 >= reader_count) || (STRESS_MAX_READERS < reader_count) || (0 >= rounds) || ((INT32_MAX / STRESS_KEYS) <= rounds))
+    {
+        fprintf(stderr, "usage: %s [readers 1..%d] [rounds]\n", argv[0], STRESS_MAX_READERS);
+        return 1;
+    }
+
+    if ((RET_ERRCODE_OK != node_pool_init(&pool)) || (RET_ERRCODE_OK != epoch_domain_init(&domain, &pool)))
+    {
+        return 1;
+    }
+
+    /* Only the writer allocates and frees nodes */
+    epoch_node_allocator(&domain, &allocator);
+    (void)tree_bind_node_allocator(&allocator);
+
+    for (i = 0; i < reader_count; i++)
+    {
+        readers[i].seed = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+        (void)pthread_create(&readers[i].thread, NULL, reader_main, &readers[i]);
+    }
+
+    for (round = 0; round < rounds; round++)
+    {
+        for (i = 0; i < STRESS_KEYS; i++)
+        {
+            keys[i] = (round * STRESS_KEYS) + i;
+        }
+
+        p_new_root = NULL;
+        if (RET_ERRCODE_OK != tree_build_from_sorted(&p_new_root, keys, NULL, STRESS_KEYS))
+        {
+            failures++;
+            break;
+        }
+
+        p_old_root = __atomic_exchange_n(&p_published, p_new_root, __ATOMIC_ACQ_REL);
+        tree_destroy(&p_old_root);
+        (void)epoch_try_advance(&domain);
+    }
+
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+
+    for (i = 0; i < reader_count; i++)
+    {
+        (void)pthread_join(readers[i].thread, NULL);
+        reads    += readers[i].reads;
+        failures += readers[i].failures;
+    }
+
+    tree_destroy(&p_published);
+    epoch_domain_destroy(&domain);
+    (void)tree_bind_node_allocator(NULL);
+
+    printf("stress_epoch: %d readers, %d rounds, %llu reads, %llu nodes reclaimed, %zu in %zu chunks still out\n",
+        reader_count, rounds, (unsigned long long)reads, (unsigned long long)domain.reclaimed, pool.allocated, pool.chunk_count);
+
+    if (0 != pool.allocated)
+    {
+        failures++;
+    }
+
+    node_pool_destroy(&pool);
+
+    if (0 != failures)
+    {
+        printf("stress_epoch: %llu failures\n", (unsigned long long)failures);
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
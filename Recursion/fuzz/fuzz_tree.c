@@ -0,0 +1,355 @@
+/*
+    Differential fuzzer for the 2-3 tree: every input is a list of operations run both on a
+    tree and on a flat reference model, and after each one tree_validate_keys() checks the
+    shape and the key order, and the values are compared with the model. Nearest-key
+    queries are checked against the model too, around the blank key (-1) as well.
+
+    libFuzzer (from Recursion/):
+        clang -std=gnu11 -g -O1 -fsanitize=fuzzer,address,undefined -Iinclude fuzz/fuzz_tree.c u_util.c u_tree_check.c -o fuzz_tree
+        ./fuzz_tree -max_len=4096 corpus/
+
+    Without clang, a random driver replaces libFuzzer: ./fuzz_tree [seed] [runs], or
+    ./fuzz_tree FILE... to replay inputs (a crash file left by libFuzzer, say):
+        gcc -std=gnu11 -g -O1 -fsanitize=address,undefined -DFUZZ_TREE_MAIN -Iinclude fuzz/fuzz_tree.c u_util.c u_tree_check.c -o fuzz_tree
+*/
+
+#include "u_util.h"
+#include "u_tree_check.h"
+
+#define FUZZ_KEY_RANGE  (1024)  /**< Small enough for keys to collide and for deletes to hit */
+#define FUZZ_BATCH_MAX  (16)
+#define FUZZ_OP_BYTES   (4)     /**< Op, two key bytes, one value or length byte */
+
+enum e_fuzz_op
+{
+    FUZZ_OP_PATH_INSERT = 0,
+    FUZZ_OP_REMOVE,
+    FUZZ_OP_UPSERT,
+    FUZZ_OP_INSERT_OR_GET,
+    FUZZ_OP_INSERT_BATCH,
+    FUZZ_OP_REMOVE_BATCH,
+    FUZZ_OP_REMOVE_IF,
+    FUZZ_OP_REBUILD,
+    FUZZ_OP_NEIGHBOURS,
+    FUZZ_OP_COUNT
+};
+
+typedef struct
+{
+    bool_t      present[FUZZ_KEY_RANGE];
+    uintptr_t   values[FUZZ_KEY_RANGE];
+    int32_t     sorted_keys[FUZZ_KEY_RANGE];
+    uintptr_t   sorted_values[FUZZ_KEY_RANGE];
+    int32_t     count;
+} st_fuzz_model_t;
+
+int LLVMFuzzerTestOneInput(const uint8_t *p_data, size_t size);
+
+static void fuzz_fail(const char *const p_what, const int32_t key);
+static void model_sort(st_fuzz_model_t *const p_model);
+static void check_tree(const st_tree_node_t *const p_root, st_fuzz_model_t *const p_model, const int32_t key);
+static bool_t remove_if_odd(const int32_t key, const uintptr_t value, void *p_ctx);
+static void check_neighbour(const bool_t found, const int32_t found_key, const int32_t expected, const char *const p_what, const int32_t key);
+static void check_neighbours(const st_tree_node_t *const p_root, const st_fuzz_model_t *const p_model, const int32_t key);
+
+static st_fuzz_model_t model;
+
+static void fuzz_fail(const char *const p_what, const int32_t key)
+{
+    fprintf(stderr, "fuzz_tree: %s (key %d)\n", p_what, key);
+    abort();
+}
+
+/* Keys of the model in ascending order, with their values */
+static void model_sort(st_fuzz_model_t *const p_model)
+{
+    int32_t key;
+
+    p_model->count = 0;
+
+    for (key = 0; key < FUZZ_KEY_RANGE; key++)
+    {
+        if (true == p_model->present[key])
+        {
+            p_model->sorted_keys[p_model->count]   = key;
+            p_model->sorted_values[p_model->count] = p_model->values[key];
+            p_model->count++;
+        }
+    }
+}
+
+/* Whole shape and key order, then the value of the key just touched */
+static void check_tree(const st_tree_node_t *const p_root, st_fuzz_model_t *const p_model, const int32_t key)
+{
+    st_tree_report_t    report;
+    uintptr_t           value;
+
+    model_sort(p_model);
+
+    if (false == tree_validate_keys(p_root, p_model->sorted_keys, p_model->count, &report))
+    {
+        fuzz_fail(tree_violation_name(report.violation), key);
+    }
+
+    if (tree_get_value(p_root, key, &value) != p_model->present[key])
+    {
+        fuzz_fail("membership differs from the model", key);
+    }
+
+    if ((true == p_model->present[key]) && (value != p_model->values[key]))
+    {
+        fuzz_fail("value differs from the model", key);
+    }
+}
+
+static bool_t remove_if_odd(const int32_t key, const uintptr_t value, void *p_ctx)
+{
+    (void)key;
+    (void)p_ctx;
+
+    return (0 != (value & 1));
+}
+
+/* expected is (-1) when there is no such key */
+static void check_neighbour(const bool_t found, const int32_t found_key, const int32_t expected, const char *const p_what, const int32_t key)
+{
+    if ((found != ((-1) != expected)) || ((true == found) && (found_key != expected)))
+    {
+        fuzz_fail(p_what, key);
+    }
+}
+
+/*
+    Nearest-key queries around key against a scan of the model. key can be (-1), the blank
+    key, which must never be reported as found.
+*/
+static void check_neighbours(const st_tree_node_t *const p_root, const st_fuzz_model_t *const p_model, const int32_t key)
+{
+    int32_t below = (-1);
+    int32_t above = (-1);
+    int32_t found_key = (-1);
+    bool_t  found;
+    int32_t i;
+
+    for (i = 0; i < FUZZ_KEY_RANGE; i++)
+    {
+        if (true == p_model->present[i])
+        {
+            if (i < key)
+            {
+                below = i;
+            }
+            else if ((i > key) && ((-1) == above))
+            {
+                above = i;
+            }
+        }
+    }
+
+    found = tree_upper_bound(p_root, key, &found_key);
+    check_neighbour(found, found_key, above, "tree_upper_bound() differs from the model", key);
+
+    found = tree_predecessor(p_root, key, &found_key);
+    check_neighbour(found, found_key, below, "tree_predecessor() differs from the model", key);
+
+    found = tree_lower_bound(p_root, key, &found_key);
+    check_neighbour(found, found_key, ((0 <= key) && (true == p_model->present[key])) ? key : above, "tree_lower_bound() differs from the model", key);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *p_data, size_t size)
+{
+    st_tree_node_t  *p_root = NULL;
+    st_tree_path_t  path;
+    int32_t         batch[FUZZ_BATCH_MAX];
+    uintptr_t       *p_slot;
+    bool_t          inserted;
+    e_retcode_t     ret;
+    int32_t         key;
+    int32_t         length;
+    int32_t         i;
+    uint8_t         op;
+    uint8_t         arg;
+    size_t          offset;
+
+    memset(&model, 0, sizeof(model));
+    path.depth = 0;
+
+    for (offset = 0; (offset + FUZZ_OP_BYTES) <= size; offset += FUZZ_OP_BYTES)
+    {
+        op  = p_data[offset] % FUZZ_OP_COUNT;
+        key = (int32_t)((((uint32_t)p_data[offset + 1] << 8) | p_data[offset + 2]) % FUZZ_KEY_RANGE);
+        arg = p_data[offset + 3];
+
+        switch (op)
+        {
+        case FUZZ_OP_PATH_INSERT:
+            ret = tree_path_insert(&p_root, &path, key);
+            if (ret != ((true == model.present[key]) ? RET_ERRCODE_NG_DUPLICATE : RET_ERRCODE_OK))
+            {
+                fuzz_fail("tree_path_insert() result", key);
+            }
+
+            if (false == model.present[key])
+            {
+                model.present[key] = true;
+                model.values[key]  = 0;
+            }
+            break;
+
+        case FUZZ_OP_REMOVE:
+            if (tree_remove(&p_root, key) != model.present[key])
+            {
+                fuzz_fail("tree_remove() result", key);
+            }
+
+            model.present[key] = false;
+            break;
+
+        case FUZZ_OP_UPSERT:
+            if (RET_ERRCODE_OK != upsert(&p_root, key, arg))
+            {
+                fuzz_fail("upsert() failed", key);
+            }
+
+            model.present[key] = true;
+            model.values[key]  = arg;
+            break;
+
+        case FUZZ_OP_INSERT_OR_GET:
+            p_slot = insert_or_get(&p_root, key, arg, &inserted);
+            if ((NULL == p_slot) || (inserted == model.present[key]))
+            {
+                fuzz_fail("insert_or_get() result", key);
+            }
+
+            if (true == inserted)
+            {
+                model.present[key] = true;
+                model.values[key]  = arg;
+            }
+            break;
+
+        case FUZZ_OP_INSERT_BATCH:
+        case FUZZ_OP_REMOVE_BATCH:
+        case FUZZ_OP_REMOVE_IF:
+            /* An ascending run from key, steps taken from arg */
+            length = 1 + (arg % FUZZ_BATCH_MAX);
+            for (i = 0; i < length; i++)
+            {
+                batch[i] = (key + (i * (1 + (arg >> 4)))) % FUZZ_KEY_RANGE;
+                if ((0 < i) && (batch[i] <= batch[i - 1]))
+                {
+                    break;
+                }
+            }
+            length = i;
+
+            if (FUZZ_OP_INSERT_BATCH == op)
+            {
+                if (RET_ERRCODE_OK != tree_insert_batch(&p_root, batch, length, NULL, NULL))
+                {
+                    fuzz_fail("tree_insert_batch() failed", key);
+                }
+
+                for (i = 0; i < length; i++)
+                {
+                    if (false == model.present[batch[i]])
+                    {
+                        model.present[batch[i]] = true;
+                        model.values[batch[i]]  = 0;
+                    }
+                }
+            }
+            else
+            {
+                (void)tree_remove_batch(&p_root, batch, length, (FUZZ_OP_REMOVE_IF == op) ? remove_if_odd : NULL, NULL);
+                for (i = 0; i < length; i++)
+                {
+                    if ((FUZZ_OP_REMOVE_BATCH == op) || (0 != (model.values[batch[i]] & 1)))
+                    {
+                        model.present[batch[i]] = false;
+                    }
+                }
+            }
+            break;
+
+        case FUZZ_OP_NEIGHBOURS:
+            /* One below the key, so that key 0 asks about the blank key */
+            check_neighbours(p_root, &model, key - 1);
+            break;
+
+        default:
+            model_sort(&model);
+            if (RET_ERRCODE_OK != tree_build_from_sorted(&p_root, model.sorted_keys, model.sorted_values, model.count))
+            {
+                fuzz_fail("tree_build_from_sorted() failed", key);
+            }
+            break;
+        }
+
+        /* The path only follows its own inserts */
+        if (FUZZ_OP_PATH_INSERT != op)
+        {
+            tree_path_reset(&path);
+        }
+
+        check_tree(p_root, &model, key);
+    }
+
+    tree_destroy(&p_root);
+
+    return 0;
+}
+
+#ifdef FUZZ_TREE_MAIN
+int main(int argc, char **argv)
+{
+    static uint8_t  input[4096];
+    FILE            *p_file;
+    size_t          size;
+    uint32_t        seed;
+    int32_t         runs;
+    int32_t         run;
+    int32_t         i;
+
+    /* Replay files */
+    if ((1 < argc) && (NULL != (p_file = fopen(argv[1], "rb"))))
+    {
+        fclose(p_file);
+
+        for (i = 1; i < argc; i++)
+        {
+            p_file = fopen(argv[i], "rb");
+            if (NULL == p_file)
+            {
+                continue;
+            }
+
+            size = fread(input, 1, sizeof(input), p_file);
+            fclose(p_file);
+            (void)LLVMFuzzerTestOneInput(input, size);
+        }
+
+        return 0;
+    }
+
+    seed = (1 < argc) ? (uint32_t)strtoul(argv[1], NULL, 10) : 1;
+    runs = (2 < argc) ? atoi(argv[2]) : 1000;
+    srand(seed);
+
+    for (run = 0; run < runs; run++)
+    {
+        size = (size_t)(rand() % (int)sizeof(input));
+        for (i = 0; i < (int32_t)size; i++)
+        {
+            input[i] = (uint8_t)rand();
+        }
+
+        (void)LLVMFuzzerTestOneInput(input, size);
+    }
+
+    printf("fuzz_tree: %d runs from seed %u, no failure\n", runs, seed);
+
+    return 0;
+}
+#endif
\ No newline at end of file
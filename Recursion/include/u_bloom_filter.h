@@ -0,0 +1,28 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include "u_errors.h"
+
+#define BLOOM_BLOCK_WORDS       (8)     /**< 8 x 32 bits: a key never leaves half a cache line */
+#define BLOOM_BITS_PER_KEY      (12)
+
+/*
+    Split-block Bloom filter of int32 keys. A key maps to one 32-byte block and sets one
+    bit in each of its 8 words, so every query reads a single cache line.
+    No false negatives; keys cannot be removed.
+*/
+struct st_bloom_filter
+{
+    uint32_t    *p_blocks;      /**< block_count * BLOOM_BLOCK_WORDS words, 64-byte aligned */
+    uint32_t    block_count;    /**< Power of 2 */
+    uint32_t    key_count;      /**< Keys added since the last clear */
+};
+
+e_retcode_t bloom_filter_init(st_bloom_filter_t *const p_filter, const uint32_t expected_keys);
+void bloom_filter_add(st_bloom_filter_t *const p_filter, const int32_t key);
+bool_t bloom_filter_may_contain(const st_bloom_filter_t *const p_filter, const int32_t key);
+uint32_t bloom_filter_capacity(const st_bloom_filter_t *const p_filter);
+void bloom_filter_clear(st_bloom_filter_t *const p_filter);
+void bloom_filter_destroy(st_bloom_filter_t *const p_filter);
+
+#endif
\ No newline at end of file
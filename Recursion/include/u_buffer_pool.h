@@ -0,0 +1,43 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include "u_disk_tree.h"
+
+#define BUFFER_POOL_NO_PAGE     (UINT32_MAX)
+#define BUFFER_POOL_MIN_FRAMES  (4u)
+
+struct st_buffer_frame
+{
+    uint32_t    page_id;        /**< BUFFER_POOL_NO_PAGE when the frame is free */
+    uint32_t    pin_count;
+    uint32_t    next;           /**< Next frame in the same hash bucket */
+    bool_t      dirty;
+    bool_t      referenced;     /**< CLOCK bit, set on every pin */
+};
+
+/*
+    Fixed set of page frames over one file, replaced with CLOCK.
+    A pinned page stays in its frame until unpinned; dirty pages are written back when
+    they are evicted or flushed. Not thread safe.
+*/
+struct st_buffer_pool
+{
+    int                 fd;
+    uint8_t             *p_pages;       /**< frame_count pages of DISK_TREE_PAGE_SIZE */
+    st_buffer_frame_t   *p_frames;
+    uint32_t            *p_buckets;     /**< Page id hash to first frame */
+    uint32_t            bucket_mask;
+    uint32_t            frame_count;
+    uint32_t            clock_hand;
+    uint64_t            hits;
+    uint64_t            misses;
+    uint64_t            write_backs;
+};
+
+e_retcode_t buffer_pool_init(st_buffer_pool_t *const p_pool, const int fd, const uint32_t frame_count);
+e_retcode_t buffer_pool_pin(st_buffer_pool_t *const p_pool, const uint32_t page_id, const bool_t is_new, uint8_t **const pp_page);
+void buffer_pool_unpin(st_buffer_pool_t *const p_pool, const uint32_t page_id, const bool_t dirty);
+e_retcode_t buffer_pool_flush(st_buffer_pool_t *const p_pool);
+e_retcode_t buffer_pool_destroy(st_buffer_pool_t *const p_pool);
+
+#endif
\ No newline at end of file
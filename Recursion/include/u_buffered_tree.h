@@ -0,0 +1,27 @@
+#ifndef BUFFERED_TREE_H
+#define BUFFERED_TREE_H
+
+#include "u_util.h"
+
+/*
+    2-3 tree with a small sorted insert buffer in front of it.
+    Inserts land in the buffer; when it fills up the whole run is applied with
+    tree_insert_batch(), so neighbouring keys share one descent and splits are amortized.
+    A flush that runs out of memory keeps the keys it could not apply in the buffer.
+*/
+struct st_buffered_tree
+{
+    st_tree_node_t  *p_root;
+    int32_t         *p_buffer;      /**< Ascending, no duplicates */
+    int32_t         count;
+    int32_t         capacity;
+};
+
+e_retcode_t buffered_tree_init(st_buffered_tree_t *const p_tree, const int32_t capacity);
+e_retcode_t buffered_tree_insert(st_buffered_tree_t *const p_tree, const int32_t key);
+bool_t buffered_tree_search(const st_buffered_tree_t *const p_tree, const int32_t searched_key);
+e_retcode_t buffered_tree_delete(st_buffered_tree_t *const p_tree, const int32_t key);
+e_retcode_t buffered_tree_flush(st_buffered_tree_t *const p_tree, int32_t *const p_inserted);
+void buffered_tree_destroy(st_buffered_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef COMPACT_TREE_H
+#define COMPACT_TREE_H
+
+#include "u_util.h"
+
+/*
+    Read-optimized copy of a 2-3 tree.
+    Nodes are stored in level order, so the children of a node are contiguous and
+    all leaves sit at the end. Keys live in one dense array (2 keys per node), and
+    only internal nodes keep a 32-bit index of their first child.
+*/
+struct st_compact_tree
+{
+    int32_t     *p_keys;            /**< keys[2 * i + FIRST_KEY], keys[2 * i + SECOND_KEY] of node i */
+    uint32_t    *p_first_child;     /**< Only for i < internal_count */
+    uint32_t    node_count;
+    uint32_t    internal_count;
+    int32_t     key_count;
+};
+
+e_retcode_t compact_tree_build(const st_tree_node_t *const p_root, st_compact_tree_t *const p_tree);
+bool_t compact_tree_search(const st_compact_tree_t *const p_tree, const int32_t searched_key);
+size_t compact_tree_bytes(const st_compact_tree_t *const p_tree);
+void compact_tree_destroy(st_compact_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef COUNTED_TREE_H
+#define COUNTED_TREE_H
+
+#include "u_util.h"
+
+/*
+    2-3 tree used as a multiset. The value of each key is its number of occurrences and
+    the summary of each node (an st_summary_node_t) the occurrences under it, so a
+    duplicate costs one descent and no node, and ranks count every occurrence in O(log n).
+*/
+struct st_counted_tree
+{
+    st_tree_node_t      *p_root;
+    int32_t             key_count;      /**< Distinct keys */
+    uint64_t            total;          /**< Occurrences of all keys */
+};
+
+e_retcode_t counted_tree_init(st_counted_tree_t *const p_tree);
+e_retcode_t counted_tree_insert(st_counted_tree_t *const p_tree, const int32_t key);
+e_retcode_t counted_tree_delete(st_counted_tree_t *const p_tree, const int32_t key);
+uint64_t counted_tree_count(const st_counted_tree_t *const p_tree, const int32_t key);
+uint64_t counted_tree_rank(const st_counted_tree_t *const p_tree, const int32_t key);
+bool_t counted_tree_select(const st_counted_tree_t *const p_tree, const uint64_t rank, int32_t *const p_key);
+uint64_t counted_tree_count_range(const st_counted_tree_t *const p_tree, const int32_t low, const int32_t high);
+int32_t counted_tree_range_scan(const st_counted_tree_t *const p_tree, const int32_t low, const int32_t high, pf_count_visitor_t pf_visitor, void *p_ctx);
+void counted_tree_destroy(st_counted_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef DISK_TREE_H
+#define DISK_TREE_H
+
+#include "u_util.h"
+
+#define DISK_TREE_MAGIC         (0x33324454u)   /**< "TD23" */
+#define DISK_TREE_VERSION       (1u)
+#define DISK_TREE_PAGE_SIZE     (4096u)
+#define DISK_NODES_PER_PAGE     (DISK_TREE_PAGE_SIZE / sizeof(st_disk_node_t))
+#define DISK_NODE_NONE          (UINT32_MAX)    /**< Child id of a leaf */
+#define DISK_TREE_MIN_BUDGET    (3u * 64u * 1024u)
+
+/*
+    On-disk image of a 2-3 tree.
+    Page 0 holds the header, nodes fill the following pages in id order without
+    crossing page boundaries (the tail of each page is padding).
+    Ids are assigned level by level: all leaves first, the root last.
+*/
+struct st_disk_node
+{
+    int32_t     keys[MAX_KEY];          /**< (-1) for a blank second key */
+    uint32_t    children[MAX_KEY + 1];  /**< DISK_NODE_NONE on leaves and for unused children */
+};
+
+struct st_disk_header
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    page_size;
+    uint32_t    height;                 /**< 0 for an empty tree */
+    uint32_t    root;                   /**< Node id of the root */
+    uint32_t    reserved;
+    uint64_t    key_count;
+    uint64_t    node_count;
+};
+
+e_retcode_t disk_tree_build(const char *const p_key_path, const char *const p_image_path, const size_t memory_budget);
+uint64_t disk_tree_node_offset(const uint32_t node_id);
+
+#endif
\ No newline at end of file
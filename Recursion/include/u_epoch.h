@@ -0,0 +1,51 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <pthread.h>
+
+#include "u_node_pool.h"
+
+#define EPOCH_MAX_THREADS       (64)
+#define EPOCH_LIMBO_LISTS       (3)
+#define EPOCH_RETIRE_BATCH      (256)   /**< Try to advance the epoch after this many retirements */
+
+/* One per reader thread, on its own cache line */
+struct st_epoch_record
+{
+    uint64_t    epoch;      /**< Global epoch seen when the read section started */
+    uint32_t    active;     /**< 1 inside epoch_enter() / epoch_exit() */
+    uint32_t    in_use;     /**< Slot taken by epoch_register() */
+    uint8_t     padding[48];
+};
+
+/*
+    Epoch-based reclamation for tree nodes.
+    Nodes freed by the tree (merge, delete, tree_destroy) are retired instead of freed
+    and only go back to the node pool once every reader that might still hold them has
+    left its read section. This prevents use-after-free for concurrent readers; writers
+    still have to be serialized against each other.
+*/
+struct st_epoch_domain
+{
+    uint64_t            global_epoch;
+    st_epoch_record_t   records[EPOCH_MAX_THREADS];
+    pthread_mutex_t     lock;           /**< Guards the limbo lists and the epoch advance */
+    st_tree_node_t      **pp_limbo[EPOCH_LIMBO_LISTS];
+    size_t              limbo_count[EPOCH_LIMBO_LISTS];
+    size_t              limbo_capacity[EPOCH_LIMBO_LISTS];
+    size_t              retired_since_advance;
+    uint64_t            reclaimed;
+    st_node_pool_t      *p_pool;
+};
+
+e_retcode_t epoch_domain_init(st_epoch_domain_t *const p_domain, st_node_pool_t *const p_pool);
+int32_t epoch_register(st_epoch_domain_t *const p_domain);
+void epoch_unregister(st_epoch_domain_t *const p_domain, const int32_t slot);
+void epoch_enter(st_epoch_domain_t *const p_domain, const int32_t slot);
+void epoch_exit(st_epoch_domain_t *const p_domain, const int32_t slot);
+void epoch_retire(st_epoch_domain_t *const p_domain, st_tree_node_t *const p_tree_node);
+bool_t epoch_try_advance(st_epoch_domain_t *const p_domain);
+void epoch_node_allocator(st_epoch_domain_t *const p_domain, st_node_allocator_t *const p_allocator);
+void epoch_domain_destroy(st_epoch_domain_t *const p_domain);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef FILTERED_TREE_H
+#define FILTERED_TREE_H
+
+#include "u_util.h"
+#include "u_bloom_filter.h"
+
+#define FILTERED_TREE_STALE_RATIO   (4)     /**< Rebuild once deleted keys reach 1/4 of the capacity */
+
+/*
+    2-3 tree with a Bloom filter of its keys in front of it. Lookups and deletes of
+    keys the filter rules out return without descending. The filter grows with the tree;
+    deleted keys stay in it as extra false positives until it is rebuilt from the tree.
+*/
+struct st_filtered_tree
+{
+    st_tree_node_t      *p_root;
+    st_bloom_filter_t   filter;
+    int32_t             key_count;
+    int32_t             stale_count;        /**< Deleted keys still set in the filter */
+    uint64_t            lookups;
+    uint64_t            filtered;           /**< Lookups answered by the filter alone */
+    uint64_t            false_positives;    /**< Lookups the filter let through for absent keys */
+    uint64_t            rebuilds;
+};
+
+e_retcode_t filtered_tree_init(st_filtered_tree_t *const p_tree, const uint32_t expected_keys);
+e_retcode_t filtered_tree_insert(st_filtered_tree_t *const p_tree, const int32_t key);
+st_tree_node_t *filtered_tree_search(st_filtered_tree_t *const p_tree, const int32_t searched_key);
+e_retcode_t filtered_tree_delete(st_filtered_tree_t *const p_tree, const int32_t key);
+e_retcode_t filtered_tree_rebuild(st_filtered_tree_t *const p_tree);
+void filtered_tree_destroy(st_filtered_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
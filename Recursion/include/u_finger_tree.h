@@ -0,0 +1,25 @@
+#ifndef FINGER_TREE_H
+#define FINGER_TREE_H
+
+#include "u_util.h"
+
+/*
+    2-3 tree that remembers the path to the last leaf it touched, with the key range of
+    every node on it. An operation starts from the deepest remembered node whose range
+    covers its key, so sorted or clustered streams cost O(1) amortized instead of O(log n).
+*/
+struct st_finger_tree
+{
+    st_tree_node_t  *p_root;
+    st_tree_path_t  finger;
+    uint64_t        operations;
+    uint64_t        finger_misses;  /**< Operations whose key fell outside the remembered leaf */
+};
+
+void finger_tree_init(st_finger_tree_t *const p_tree);
+e_retcode_t finger_tree_insert(st_finger_tree_t *const p_tree, const int32_t key);
+st_tree_node_t *finger_tree_search(st_finger_tree_t *const p_tree, const int32_t searched_key);
+e_retcode_t finger_tree_delete(st_finger_tree_t *const p_tree, const int32_t key);
+void finger_tree_destroy(st_finger_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
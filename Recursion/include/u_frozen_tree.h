@@ -0,0 +1,24 @@
+#ifndef FROZEN_TREE_H
+#define FROZEN_TREE_H
+
+#include "u_util.h"
+
+/*
+    Read-only snapshot of a 2-3 tree in Eytzinger (BFS) order.
+    p_keys[1] is the root, the children of p_keys[k] are p_keys[2k] and p_keys[2k + 1].
+    There are no pointers, and a descent prefetches the cache line four levels ahead.
+*/
+struct st_frozen_tree
+{
+    int32_t     *p_keys;        /**< key_count + 1 slots, slot 0 is unused */
+    int32_t     key_count;
+};
+
+e_retcode_t frozen_tree_build(const st_tree_node_t *const p_root, st_frozen_tree_t *const p_frozen);
+e_retcode_t frozen_tree_build_sorted(const int32_t *const p_sorted_keys, const int32_t count, st_frozen_tree_t *const p_frozen);
+bool_t frozen_tree_search(const st_frozen_tree_t *const p_frozen, const int32_t searched_key);
+bool_t frozen_tree_lower_bound(const st_frozen_tree_t *const p_frozen, const int32_t key, int32_t *const p_found_key);
+int32_t frozen_tree_range_scan(const st_frozen_tree_t *const p_frozen, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx);
+void frozen_tree_destroy(st_frozen_tree_t *const p_frozen);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef HOT_CACHE_H
+#define HOT_CACHE_H
+
+#include "u_util.h"
+
+#define HOT_CACHE_WAYS  (4)
+
+struct st_hot_cache_entry
+{
+    st_tree_node_t  *p_node;        /**< NULL for an empty way */
+    int32_t         key;
+    uint32_t        version;        /**< p_node->version when the entry was filled */
+};
+
+/*
+    Small set-associative cache from key to the node holding it, in front of search().
+    An entry is trusted only while its node kept the same version, so splits, merges,
+    borrows and successor swaps invalidate it lazily; a node being freed empties the
+    whole cache. Given the counter the tree's writers bind with tree_bind_free_generation(),
+    only frees in that tree do; without one, frees in any tree do (tree_free_generation(),
+    which hot_cache_init() turns on with tree_track_free_generation()).
+    Values are read from the node, so upsert() and cas() need no invalidation.
+    One cache per thread, writers excluded while it is used.
+*/
+struct st_hot_cache
+{
+    st_hot_cache_entry_t    *p_entries;     /**< Sets of HOT_CACHE_WAYS entries, most recent first */
+    uint32_t                set_mask;
+    const uint64_t          *p_generation;  /**< Free counter of the tree, NULL for the process-wide one */
+    uint64_t                generation;
+    uint64_t                lookups;
+    uint64_t                hits;
+    uint64_t                stale;          /**< Entries dropped because their node changed */
+    uint64_t                flushes;        /**< Whole-cache flushes after nodes were freed */
+};
+
+struct st_hot_cache_stats
+{
+    uint64_t    lookups;
+    uint64_t    hits;
+    uint64_t    stale;
+    uint64_t    flushes;
+    double      hit_rate;
+};
+
+e_retcode_t hot_cache_init(st_hot_cache_t *const p_cache, const uint32_t entry_count, const uint64_t *const p_generation);
+st_tree_node_t *hot_cache_search(st_hot_cache_t *const p_cache, const st_tree_node_t *const p_root, const int32_t key);
+bool_t hot_cache_get_value(st_hot_cache_t *const p_cache, const st_tree_node_t *const p_root, const int32_t key, uintptr_t *const p_value);
+void hot_cache_clear(st_hot_cache_t *const p_cache);
+void hot_cache_stats(const st_hot_cache_t *const p_cache, st_hot_cache_stats_t *const p_stats);
+void hot_cache_destroy(st_hot_cache_t *const p_cache);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef INTERVAL_TREE_H
+#define INTERVAL_TREE_H
+
+#include "u_util.h"
+
+#define INTERVAL_BUCKET_MIN (4)     /**< High ends a bucket starts with */
+
+/* Intervals sharing one low end: their high ends, largest first */
+struct st_interval_bucket
+{
+    int32_t             count;
+    int32_t             capacity;
+    int32_t             highs[];
+};
+
+/*
+    Closed intervals [low, high] in a 2-3 tree keyed by low. The value of a key is its high
+    end, or a bucket once several intervals start there, and the summary of each node
+    (an st_summary_node_t) the largest high end under it. Overlap queries skip every
+    subtree that ends before the query.
+*/
+struct st_interval_tree
+{
+    st_tree_node_t      *p_root;
+    int32_t             key_count;          /**< Distinct low ends */
+    int32_t             interval_count;     /**< Duplicates included */
+};
+
+e_retcode_t interval_tree_init(st_interval_tree_t *const p_tree);
+e_retcode_t interval_tree_insert(st_interval_tree_t *const p_tree, const int32_t low, const int32_t high);
+e_retcode_t interval_tree_delete(st_interval_tree_t *const p_tree, const int32_t low, const int32_t high);
+int32_t interval_tree_overlaps(const st_interval_tree_t *const p_tree, const int32_t low, const int32_t high, pf_interval_visitor_t pf_visitor, void *p_ctx);
+int32_t interval_tree_stab(const st_interval_tree_t *const p_tree, const int32_t point, pf_interval_visitor_t pf_visitor, void *p_ctx);
+void interval_tree_destroy(st_interval_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef KEY_SET_H
+#define KEY_SET_H
+
+#include "u_errors.h"
+
+/* Open-addressing hash set of tree keys. (-1) marks an empty slot, like a blank key in a node */
+struct st_key_set
+{
+    int32_t     *p_slots;
+    uint32_t    capacity;   /**< Power of 2 */
+    uint32_t    count;
+};
+
+e_retcode_t key_set_init(st_key_set_t *const p_set, const uint32_t capacity);
+bool_t key_set_contains(const st_key_set_t *const p_set, const int32_t key);
+e_retcode_t key_set_add(st_key_set_t *const p_set, const int32_t key);
+bool_t key_set_remove(st_key_set_t *const p_set, const int32_t key);
+void key_set_clear(st_key_set_t *const p_set);
+void key_set_destroy(st_key_set_t *const p_set);
+
+#endif
\ No newline at end of file
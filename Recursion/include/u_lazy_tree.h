@@ -0,0 +1,32 @@
+#ifndef LAZY_TREE_H
+#define LAZY_TREE_H
+
+#include "u_util.h"
+#include "u_key_set.h"
+
+/*
+    2-3 tree with lazy deletion.
+    lazy_tree_delete() only records a tombstone, the tree shape is left alone.
+    Tombstoned keys are skipped by lookups and scans. Deletes never compact: once
+    lazy_tree_compaction_due(), the caller removes them a few at a time with
+    lazy_tree_compact_step(), or all of them in one rebuild with lazy_tree_compact().
+*/
+struct st_lazy_tree
+{
+    st_tree_node_t  *p_root;
+    st_key_set_t    tombstones;
+    uint32_t        compact_threshold;  /**< Compaction is due once this many tombstones pile up, 0 = never */
+    uint32_t        compact_cursor;     /**< Tombstone slot where lazy_tree_compact_step() carries on */
+};
+
+e_retcode_t lazy_tree_init(st_lazy_tree_t *const p_tree, const uint32_t compact_threshold);
+e_retcode_t lazy_tree_insert(st_lazy_tree_t *const p_tree, const int32_t key);
+st_tree_node_t *lazy_tree_search(const st_lazy_tree_t *const p_tree, const int32_t searched_key);
+e_retcode_t lazy_tree_delete(st_lazy_tree_t *const p_tree, const int32_t key);
+int32_t lazy_tree_range_scan(const st_lazy_tree_t *const p_tree, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx);
+bool_t lazy_tree_compaction_due(const st_lazy_tree_t *const p_tree);
+int32_t lazy_tree_compact_step(st_lazy_tree_t *const p_tree, const int32_t budget);
+e_retcode_t lazy_tree_compact(st_lazy_tree_t *const p_tree);
+void lazy_tree_destroy(st_lazy_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
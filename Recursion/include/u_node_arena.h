@@ -0,0 +1,54 @@
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <pthread.h>
+
+#include "u_util.h"
+
+#define NODE_ARENA_REGION_BYTES     ((size_t)2 << 20)   /**< One x86-64 huge page, and the region alignment */
+#define NODE_ARENA_MAX_NODES        (8)                 /**< NUMA nodes a replicated tree can serve */
+#define NODE_ARENA_ANY_NODE         (-1)
+
+#define NODE_ARENA_HUGE_TRANSPARENT (1u << 0)   /**< madvise(MADV_HUGEPAGE) on every region */
+#define NODE_ARENA_HUGE_EXPLICIT    (1u << 1)   /**< MAP_HUGETLB first, transparent pages if the pool is empty */
+
+/* Start of every region: a node finds its arena by masking its own address */
+struct st_node_arena_region
+{
+    st_node_arena_t         *p_arena;
+    st_node_arena_region_t  *p_next;
+};
+
+/*
+    Tree nodes carved from 2 MB aligned regions, so a large tree needs one TLB entry per
+    region instead of one per 4 KB page when huge pages are on.
+    With HAVE_LIBNUMA defined (link with -lnuma) the regions are bound to numa_node;
+    without it they follow the kernel's first-touch policy, so build each partition's tree
+    from a thread running on that partition's socket.
+    Freed nodes go back to the arena that made them, from any thread. Memory is returned
+    to the system by node_arena_destroy() only.
+*/
+struct st_node_arena
+{
+    pthread_mutex_t         lock;
+    st_node_arena_region_t  *p_regions;
+    uint8_t                 *p_next;        /**< Bump pointer in the newest region */
+    uint8_t                 *p_end;
+    st_tree_node_t          *p_free;        /**< Freed nodes, linked through their first bytes */
+    uint32_t                flags;
+    int32_t                 numa_node;
+    size_t                  region_count;
+    size_t                  huge_region_count;  /**< Regions backed by MAP_HUGETLB */
+    size_t                  allocated;          /**< Nodes currently handed out */
+};
+
+e_retcode_t node_arena_init(st_node_arena_t *const p_arena, const int32_t numa_node, const uint32_t flags);
+st_tree_node_t *node_arena_alloc(st_node_arena_t *const p_arena);
+void node_arena_free(st_tree_node_t *const p_tree_node);
+void node_arena_bind(st_node_arena_t *const p_arena);
+void node_arena_allocator(st_node_arena_t *const p_arena, st_node_allocator_t *const p_allocator);
+int32_t node_arena_node_count(void);
+int32_t node_arena_current_node(void);
+void node_arena_destroy(st_node_arena_t *const p_arena);
+
+#endif
\ No newline at end of file
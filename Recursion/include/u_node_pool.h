@@ -0,0 +1,27 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <pthread.h>
+
+#include "u_util.h"
+
+#define NODE_POOL_CHUNK_NODES   (1024)
+
+/* Free list of tree nodes carved from large chunks. Nodes are recycled, never handed back to the heap */
+struct st_node_pool
+{
+    pthread_mutex_t lock;
+    void            **pp_free;      /**< Stack of free nodes */
+    size_t          free_count;
+    size_t          free_capacity;
+    void            **pp_chunks;
+    size_t          chunk_count;
+    size_t          allocated;      /**< Nodes currently handed out */
+};
+
+e_retcode_t node_pool_init(st_node_pool_t *const p_pool);
+st_tree_node_t *node_pool_alloc(st_node_pool_t *const p_pool);
+void node_pool_free(st_node_pool_t *const p_pool, st_tree_node_t *const p_tree_node);
+void node_pool_destroy(st_node_pool_t *const p_pool);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef PACKED_TREE_H
+#define PACKED_TREE_H
+
+#include "u_util.h"
+
+#define PACKED_LANES        (4)                         /**< One SSE register of 32-bit deltas */
+#define PACKED_BLOCK_KEYS   (32 * PACKED_LANES)         /**< 32 deltas per lane */
+
+enum e_leaf_encoding
+{
+    LEAF_ENCODING_PLAIN = 0,    /**< Every delta on 32 bits: the uncompressed layout */
+    LEAF_ENCODING_FOR           /**< Frame of reference: deltas on the fewest bits the block needs */
+};
+
+/*
+    Read-only copy of a tree with its keys in blocks of PACKED_BLOCK_KEYS sorted keys.
+    A block keeps its first key (the base) in p_blocks and the other keys as key - base,
+    bit-packed with one width per block. Delta i sits in lane i % 4 at position i / 4,
+    and the 4 lanes are interleaved word by word, so one decode step yields 4 keys
+    with the same shifts: plain C the compiler turns into SSE/NEON code.
+    A block of width w takes 4 * w words; the width is not stored.
+*/
+struct st_packed_block
+{
+    int32_t     base;           /**< Smallest key of the block */
+    uint32_t    word_offset;    /**< First word of the block in p_words */
+};
+
+struct st_packed_tree
+{
+    st_packed_block_t       *p_blocks;      /**< block_count + 1 entries, the last one ends p_words */
+    uint32_t                *p_words;
+    uint32_t                block_count;
+    int32_t                 key_count;
+    e_leaf_encoding_t       encoding;
+};
+
+e_retcode_t packed_tree_build(const st_tree_node_t *const p_root, const e_leaf_encoding_t encoding, st_packed_tree_t *const p_tree);
+e_retcode_t packed_tree_build_sorted(const int32_t *const p_sorted_keys, const int32_t count, const e_leaf_encoding_t encoding, st_packed_tree_t *const p_tree);
+bool_t packed_tree_search(const st_packed_tree_t *const p_tree, const int32_t searched_key);
+int32_t packed_tree_range_scan(const st_packed_tree_t *const p_tree, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx);
+size_t packed_tree_bytes(const st_packed_tree_t *const p_tree);
+void packed_tree_destroy(st_packed_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef PAGED_TREE_H
+#define PAGED_TREE_H
+
+#include "u_buffer_pool.h"
+
+/*
+    2-3 tree stored in a disk_tree image and reached through a buffer pool.
+    Nodes are referenced by id instead of pointer, so the tree can be much larger than
+    the pool. The header is kept in memory and written by paged_tree_sync().
+    Nodes emptied by paged_tree_delete() are left unused in the image, not recycled.
+*/
+struct st_paged_tree
+{
+    int                 fd;
+    st_disk_header_t    header;
+    st_buffer_pool_t    pool;
+};
+
+e_retcode_t paged_tree_open(st_paged_tree_t *const p_tree, const char *const p_image_path, const uint32_t frame_count);
+e_retcode_t paged_tree_search(st_paged_tree_t *const p_tree, const int32_t key, bool_t *const p_found);
+e_retcode_t paged_tree_insert(st_paged_tree_t *const p_tree, const int32_t key);
+e_retcode_t paged_tree_delete(st_paged_tree_t *const p_tree, const int32_t key, bool_t *const p_removed);
+e_retcode_t paged_tree_sync(st_paged_tree_t *const p_tree);
+e_retcode_t paged_tree_close(st_paged_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef PARALLEL_BUILD_H
+#define PARALLEL_BUILD_H
+
+#include "u_util.h"
+
+#define PARALLEL_MAX_THREADS    (256)
+
+/*
+    Multi-threaded bulk loading.
+    The keys are sorted in per-thread chunks and merged pairwise in parallel. The top
+    levels of the tree are then laid out on one thread with tree_split_plan(), and the
+    subtrees under them are built concurrently with tree_build_subtree(), so every leaf
+    ends up at the same depth.
+*/
+e_retcode_t parallel_build(st_tree_node_t **const pp_root, const int32_t *const p_keys, const int32_t count, const int32_t thread_count);
+e_retcode_t parallel_insert_bulk(st_tree_node_t **const pp_root, const int32_t *const p_keys, const int32_t count, const int32_t thread_count);
+
+#endif
\ No newline at end of file
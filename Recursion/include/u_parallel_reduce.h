@@ -0,0 +1,33 @@
+#ifndef PARALLEL_REDUCE_H
+#define PARALLEL_REDUCE_H
+
+#include "u_util.h"
+#include "u_thread_pool.h"
+
+/*
+    User-supplied reduction. Every subtree task gets its own accumulator of acc_size bytes,
+    fills it with pf_init() and pf_accumulate() (keys in ascending order), and the partial
+    results are folded left to right with pf_combine(), so order-sensitive reductions work.
+*/
+struct st_reduce_ops
+{
+    size_t  acc_size;
+    void    (*pf_init)(void *p_acc, void *p_ctx);
+    void    (*pf_accumulate)(void *p_acc, const int32_t key, void *p_ctx);
+    void    (*pf_combine)(void *p_acc, const void *p_right_acc, void *p_ctx);  /**< p_right_acc covers larger keys */
+    void    *p_ctx;
+};
+
+struct st_key_summary
+{
+    int64_t     count;
+    int64_t     sum;
+    int32_t     min;
+    int32_t     max;
+};
+
+e_retcode_t parallel_reduce(const st_tree_node_t *const p_root, const int32_t low, const int32_t high, const st_reduce_ops_t *const p_ops, st_thread_pool_t *const p_pool, void *const p_result);
+e_retcode_t parallel_for_each(const st_tree_node_t *const p_root, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx, st_thread_pool_t *const p_pool);
+e_retcode_t parallel_summarize(const st_tree_node_t *const p_root, const int32_t low, const int32_t high, st_thread_pool_t *const p_pool, st_key_summary_t *const p_summary);
+
+#endif
\ No newline at end of file
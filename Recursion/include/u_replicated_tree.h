@@ -0,0 +1,36 @@
+#ifndef REPLICATED_TREE_H
+#define REPLICATED_TREE_H
+
+#include "u_node_arena.h"
+
+#define REPLICATED_TREE_MAX_LEVELS  (16)
+
+/*
+    Read-mostly tree whose top levels are copied into one arena per NUMA node, so the
+    hottest part of every descent stays in local memory. The bottom copied level points
+    at the shared nodes below it.
+    A copied node keeps the address of the node it copies in values[FIRST_KEY], and that
+    node's version in its own version field: searches always return shared nodes.
+    Writes through replicated_tree_insert() and replicated_tree_delete() recopy the top
+    levels only when they changed; after writing to p_root directly, call
+    replicated_tree_refresh(). Writers must not run concurrently with searches.
+*/
+struct st_replicated_tree
+{
+    st_tree_node_t      *p_root;
+    st_tree_node_t      *p_replicated_root;                     /**< p_root when the copies were made */
+    st_tree_node_t      *p_replicas[NODE_ARENA_MAX_NODES];
+    st_node_arena_t     arenas[NODE_ARENA_MAX_NODES];
+    int32_t             replica_count;                          /**< One per NUMA node, 1 without libnuma */
+    int32_t             levels;
+    uint64_t            refreshes;
+};
+
+e_retcode_t replicated_tree_init(st_replicated_tree_t *const p_tree, const int32_t levels, const uint32_t arena_flags);
+e_retcode_t replicated_tree_refresh(st_replicated_tree_t *const p_tree);
+st_tree_node_t *replicated_tree_search(const st_replicated_tree_t *const p_tree, const int32_t searched_key);
+e_retcode_t replicated_tree_insert(st_replicated_tree_t *const p_tree, const int32_t key);
+e_retcode_t replicated_tree_delete(st_replicated_tree_t *const p_tree, const int32_t key);
+void replicated_tree_destroy(st_replicated_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef SHARD_INDEX_H
+#define SHARD_INDEX_H
+
+#include "u_util.h"
+#include "u_thread_pool.h"
+
+enum e_index_op
+{
+    INDEX_OP_INSERT = 0,
+    INDEX_OP_SEARCH,
+    INDEX_OP_DELETE
+};
+
+struct st_index_op
+{
+    e_index_op_t    type;
+    int32_t         key;
+    e_retcode_t     ret;        /**< Filled in by shard_index_execute(), NG_DUPLICATE for a key inserted twice */
+    bool_t          found;      /**< Key was there before the op: found, removed, or not inserted again */
+};
+
+/*
+    Range-partitioned index: shard i holds the keys in [p_lower_bounds[i], p_lower_bounds[i + 1]).
+    A batch is grouped by shard and each shard's operations run as one task on a
+    work-stealing pool, in batch order and on one thread, so the trees need no locks.
+*/
+struct st_shard_index
+{
+    st_tree_node_t  **pp_roots;
+    int32_t         *p_lower_bounds;    /**< Ascending, p_lower_bounds[0] is ignored (INT32_MIN) */
+    int32_t         shard_count;
+};
+
+e_retcode_t shard_index_init(st_shard_index_t *const p_index, const int32_t *const p_lower_bounds, const int32_t shard_count);
+int32_t shard_index_route(const st_shard_index_t *const p_index, const int32_t key);
+e_retcode_t shard_index_execute(st_shard_index_t *const p_index, st_index_op_t *const p_ops, const int32_t op_count, st_thread_pool_t *const p_pool);
+void shard_index_destroy(st_shard_index_t *const p_index);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef SPLINE_INDEX_H
+#define SPLINE_INDEX_H
+
+#include "u_util.h"
+
+#define SPLINE_DEFAULT_ERROR    (32)    /**< Positions; the last search spans 2 * error + 3 keys */
+#define SPLINE_MAX_RADIX_BITS   (18)
+
+struct st_spline_point
+{
+    int32_t     key;
+    int32_t     position;   /**< Rank of key in p_keys */
+};
+
+/*
+    Learned index over a sorted copy of a tree's keys, in the style of RadixSpline.
+    A linear spline through (key, rank) points predicts the rank of any key within
+    max_error. A radix table on the top bits of key - min_key narrows the search for the
+    spline segment to a few points. A lookup is one table read, a short search among the
+    spline points, an interpolation and a binary search of 2 * max_error + 3 keys.
+    Read-only: rebuild after the tree changes.
+*/
+struct st_spline_index
+{
+    int32_t                 *p_keys;        /**< key_count sorted keys */
+    st_spline_point_t       *p_points;      /**< point_count points, first and last key included */
+    uint32_t                *p_radix;       /**< (1 << radix_bits) + 1 entries: first point of each key prefix */
+    int32_t                 key_count;
+    int32_t                 point_count;
+    int32_t                 max_error;
+    int32_t                 min_key;
+    uint32_t                radix_bits;
+    uint32_t                radix_shift;    /**< prefix = (key - min_key) >> radix_shift */
+};
+
+e_retcode_t spline_index_build(const st_tree_node_t *const p_root, const int32_t max_error, st_spline_index_t *const p_index);
+e_retcode_t spline_index_build_sorted(const int32_t *const p_sorted_keys, const int32_t count, const int32_t max_error, st_spline_index_t *const p_index);
+bool_t spline_index_search(const st_spline_index_t *const p_index, const int32_t searched_key);
+bool_t spline_index_lower_bound(const st_spline_index_t *const p_index, const int32_t key, int32_t *const p_found_key);
+size_t spline_index_bytes(const st_spline_index_t *const p_index);
+void spline_index_destroy(st_spline_index_t *const p_index);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+
+#include "u_errors.h"
+
+#define THREAD_POOL_MAX_WORKERS (64)
+
+struct st_task
+{
+    pf_task_t   pf_task;
+    void        *p_arg;
+};
+
+/* The owner pushes and pops at the tail, thieves take from the head */
+struct st_work_deque
+{
+    pthread_mutex_t lock;
+    st_task_t       *p_tasks;
+    int32_t         head;
+    int32_t         tail;
+    int32_t         capacity;   /**< Power of 2, head and tail wrap around it */
+};
+
+/* Fixed set of workers, one deque each. An idle worker steals from the others */
+struct st_thread_pool
+{
+    pthread_t       threads[THREAD_POOL_MAX_WORKERS];
+    st_work_deque_t deques[THREAD_POOL_MAX_WORKERS];
+    int32_t         worker_count;
+    int32_t         started;        /**< Hands out worker ids at thread start */
+    pthread_mutex_t lock;
+    pthread_cond_t  work_ready;
+    pthread_cond_t  all_done;
+    int32_t         queued;         /**< Submitted, not yet taken by a worker */
+    int32_t         pending;        /**< Submitted, not yet finished */
+    uint32_t        next_deque;     /**< Round robin for tasks submitted from outside the pool */
+    uint64_t        steals;
+    bool_t          stopping;
+};
+
+e_retcode_t thread_pool_init(st_thread_pool_t *const p_pool, const int32_t worker_count);
+e_retcode_t thread_pool_submit(st_thread_pool_t *const p_pool, pf_task_t pf_task, void *p_arg);
+void thread_pool_wait(st_thread_pool_t *const p_pool);
+void thread_pool_destroy(st_thread_pool_t *const p_pool);
+
+#endif
\ No newline at end of file
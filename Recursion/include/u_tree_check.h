@@ -0,0 +1,31 @@
+#ifndef TREE_CHECK_H
+#define TREE_CHECK_H
+
+#include "u_util.h"
+
+enum e_tree_violation
+{
+    TREE_VIOLATION_NONE = 0,
+    TREE_VIOLATION_OCCUPANCY,   /**< Node without a first key, or a second key without a first one */
+    TREE_VIOLATION_ORDER,       /**< Keys unsorted in the node, or outside the range given by the ancestors */
+    TREE_VIOLATION_CHILDREN,    /**< Child count does not match key count (k keys need 0 or k + 1 children) */
+    TREE_VIOLATION_DEPTH,       /**< Leaves at different depths */
+    TREE_VIOLATION_ROOT_FLAG,   /**< is_root set on an inner node or missing on the root */
+    TREE_VIOLATION_KEYS         /**< In-order keys differ from the expected ones */
+};
+
+/* Where the first violation was found */
+struct st_tree_report
+{
+    e_tree_violation_t      violation;
+    const st_tree_node_t    *p_node;        /**< NULL for TREE_VIOLATION_KEYS */
+    int32_t                 depth;          /**< Depth of p_node, the root is 0 */
+    int32_t                 key_count;      /**< Keys seen before stopping */
+    int32_t                 height;         /**< Depth of the first leaf + 1 */
+};
+
+bool_t tree_validate(const st_tree_node_t *const p_root, st_tree_report_t *const p_report);
+bool_t tree_validate_keys(const st_tree_node_t *const p_root, const int32_t *const p_sorted_keys, const int32_t count, st_tree_report_t *const p_report);
+const char *tree_violation_name(const e_tree_violation_t violation);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef TREE_STATS_H
+#define TREE_STATS_H
+
+#include "u_util.h"
+
+/* Memory footprint of a pointer tree. Heap headers and padding between allocations are not counted */
+struct st_tree_memory_stats
+{
+    int32_t     height;
+    int32_t     key_count;
+    int32_t     node_count;
+    int32_t     fill_histogram[MAX_KEY + 1];    /**< Number of nodes holding 0, 1 or 2 keys */
+    size_t      node_bytes;                     /**< node_count * sizeof(st_tree_node_t) */
+    double      bytes_per_key;
+    double      fill_factor;                    /**< key_count / (MAX_KEY * node_count) */
+};
+
+e_retcode_t tree_memory_stats(const st_tree_node_t *const p_root, st_tree_memory_stats_t *const p_stats);
+e_retcode_t tree_compact(st_tree_node_t **const pp_root);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef TTL_TREE_H
+#define TTL_TREE_H
+
+#include "u_util.h"
+
+#define TTL_SWEEP_BATCH     (256)   /**< Due entries taken off the heap and removed together */
+#define TTL_HEAP_MIN        (64)    /**< Heap entries allocated at first */
+
+/* Pending expiry in the deadline heap */
+struct st_ttl_entry
+{
+    uint64_t            deadline;
+    int32_t             key;
+};
+
+/*
+    2-3 tree whose keys expire. The value of each key is its deadline, in whatever clock
+    the caller passes as now, and a min-heap orders the deadlines. The heap is lazy: a
+    later deadline keeps the old entry, which is queued again when it comes due, and a
+    deleted key leaves its entry until then. Every key has an entry no later than its
+    deadline. Once stale entries outnumber the keys the heap is rebuilt from the tree, so
+    it stays within 2 * key_count + TTL_HEAP_MIN entries after every insert and delete
+    that has the memory for the rebuild.
+    Expired keys read as absent until ttl_tree_expire_until() removes them.
+*/
+struct st_ttl_tree
+{
+    st_tree_node_t      *p_root;
+    st_ttl_entry_t      *p_heap;
+    int32_t             heap_count;
+    int32_t             heap_capacity;
+    int32_t             key_count;      /**< Expired keys not swept yet included */
+    uint64_t            expired;        /**< Keys removed by sweeps */
+};
+
+e_retcode_t ttl_tree_init(st_ttl_tree_t *const p_tree);
+e_retcode_t ttl_tree_insert(st_ttl_tree_t *const p_tree, const int32_t key, const uint64_t deadline);
+bool_t ttl_tree_search(const st_ttl_tree_t *const p_tree, const int32_t searched_key, const uint64_t now);
+e_retcode_t ttl_tree_delete(st_ttl_tree_t *const p_tree, const int32_t key);
+int32_t ttl_tree_expire_until(st_ttl_tree_t *const p_tree, const uint64_t now, const int32_t budget);
+bool_t ttl_tree_next_deadline(const st_ttl_tree_t *const p_tree, uint64_t *const p_deadline);
+void ttl_tree_destroy(st_ttl_tree_t *const p_tree);
+
+#endif
\ No newline at end of file
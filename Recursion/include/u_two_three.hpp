@@ -0,0 +1,1593 @@
+#ifndef TWO_THREE_HPP
+#define TWO_THREE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+extern "C"
+{
+#include "u_util.h"
+}
+
+/*
+    Header-only C++17 containers over the C 2-3 tree, with the std::set / std::map interface.
+    The core stores int32_t keys in ascending order, so Key is int32_t, Compare is
+    std::less<int32_t> or the transparent std::less<>, and -1 (the core's blank key) cannot
+    be stored. Nodes come from the container's allocator, rebound to st_tree_node_t, through
+    tree_bind_node_allocator() for the duration of each call; std::pmr resources plug in with
+    dsa::pmr::two_three_set / two_three_map.
+    Unlike std::set, insert and erase move keys between nodes and invalidate iterators.
+    Iterators follow a header (root and size) the container keeps in memory from its
+    allocator, which a move or swap hands over with the nodes, so both leave them valid.
+*/
+namespace dsa
+{
+namespace detail
+{
+
+/* The tree of a container, where its iterators find the root: it stays put when the container moves */
+struct tree_header
+{
+    st_tree_node_t  *p_root;
+    std::size_t     size;
+};
+
+/* Where a key lives: p_node == nullptr is end() */
+struct tree_position
+{
+    const st_tree_node_t    *p_node;
+    int32_t                 slot;
+};
+
+inline int32_t node_key_count(const st_tree_node_t *const p_tree_node)
+{
+    return ((-1) == p_tree_node->keys[SECOND_KEY]) ? 1 : 2;
+}
+
+inline const st_tree_node_t *node_child(const st_tree_node_t *const p_tree_node, const int32_t index)
+{
+    return (0 == index) ? p_tree_node->p_left_child : ((1 == index) ? p_tree_node->p_middle_child : p_tree_node->p_right_child);
+}
+
+inline tree_position leftmost(const st_tree_node_t *p_tree_node)
+{
+    while (nullptr != p_tree_node->p_left_child)
+    {
+        p_tree_node = p_tree_node->p_left_child;
+    }
+
+    return tree_position{p_tree_node, 0};
+}
+
+inline tree_position rightmost(const st_tree_node_t *p_tree_node)
+{
+    while (nullptr != p_tree_node->p_left_child)
+    {
+        p_tree_node = node_child(p_tree_node, node_key_count(p_tree_node));
+    }
+
+    return tree_position{p_tree_node, node_key_count(p_tree_node) - 1};
+}
+
+/* First key >= key (> key when strict) */
+inline tree_position ceiling(const st_tree_node_t *p_tree_node, const int32_t key, const bool strict)
+{
+    tree_position   found{nullptr, 0};
+    int32_t         index;
+    int32_t         count;
+
+    while (nullptr != p_tree_node)
+    {
+        count = node_key_count(p_tree_node);
+
+        for (index = 0; index < count; index++)
+        {
+            if ((false == strict) && (key == p_tree_node->keys[index]))
+            {
+                return tree_position{p_tree_node, index};
+            }
+
+            if (key < p_tree_node->keys[index])
+            {
+                found = tree_position{p_tree_node, index};
+                break;
+            }
+        }
+
+        p_tree_node = node_child(p_tree_node, index);
+    }
+
+    return found;
+}
+
+/* Last key < key */
+inline tree_position floor_strict(const st_tree_node_t *p_tree_node, const int32_t key)
+{
+    tree_position   found{nullptr, 0};
+    int32_t         index;
+
+    while (nullptr != p_tree_node)
+    {
+        for (index = node_key_count(p_tree_node); index > 0; index--)
+        {
+            if (p_tree_node->keys[index - 1] < key)
+            {
+                found = tree_position{p_tree_node, index - 1};
+                break;
+            }
+        }
+
+        p_tree_node = node_child(p_tree_node, index);
+    }
+
+    return found;
+}
+
+inline tree_position find_position(const st_tree_node_t *const p_root, const int32_t key)
+{
+    tree_position position = ceiling(p_root, key, false);
+
+    if ((nullptr != position.p_node) && (key != position.p_node->keys[position.slot]))
+    {
+        position = tree_position{nullptr, 0};
+    }
+
+    return position;
+}
+
+/* In a leaf the next key is in the same node or above it: descend again from the root */
+inline tree_position next_position(const st_tree_node_t *const p_root, const tree_position position)
+{
+    if (nullptr != position.p_node->p_left_child)
+    {
+        return leftmost(node_child(position.p_node, position.slot + 1));
+    }
+
+    if ((0 == position.slot) && ((-1) != position.p_node->keys[SECOND_KEY]))
+    {
+        return tree_position{position.p_node, 1};
+    }
+
+    return ceiling(p_root, position.p_node->keys[position.slot], true);
+}
+
+inline tree_position prev_position(const st_tree_node_t *const p_root, const tree_position position)
+{
+    if (nullptr == position.p_node)
+    {
+        return (nullptr == p_root) ? position : rightmost(p_root);
+    }
+
+    if (nullptr != position.p_node->p_left_child)
+    {
+        return rightmost(node_child(position.p_node, position.slot));
+    }
+
+    if (1 == position.slot)
+    {
+        return tree_position{position.p_node, 0};
+    }
+
+    return floor_strict(p_root, position.p_node->keys[position.slot]);
+}
+
+/* Where an integral key of another type falls against the int32_t range: -1 below, 1 above */
+template <class K>
+inline int32_t key_range_side(const K &key, int32_t *const p_key)
+{
+    static_assert(std::is_integral<K>::value, "heterogeneous lookup takes integral keys");
+
+    if constexpr (std::is_signed<K>::value)
+    {
+        if (static_cast<int64_t>(key) < std::numeric_limits<int32_t>::min())
+        {
+            return -1;
+        }
+
+        if (static_cast<int64_t>(key) > std::numeric_limits<int32_t>::max())
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        if (static_cast<uint64_t>(key) > static_cast<uint64_t>(std::numeric_limits<int32_t>::max()))
+        {
+            return 1;
+        }
+    }
+
+    *p_key = static_cast<int32_t>(key);
+
+    return 0;
+}
+
+/* Header of every container without one of its own yet: empty, and never written */
+inline tree_header *empty_header() noexcept
+{
+    static tree_header empty{nullptr, 0};
+
+    return &empty;
+}
+
+/* p_header itself, or a fresh empty header from the node allocator in place of empty_header() */
+template <class NodeAllocator>
+tree_header *own_header(tree_header *const p_header, const NodeAllocator &node_allocator)
+{
+    using header_allocator_type = typename std::allocator_traits<NodeAllocator>::template rebind_alloc<tree_header>;
+
+    header_allocator_type   allocator(node_allocator);
+    tree_header             *p_own;
+
+    if (empty_header() != p_header)
+    {
+        return p_header;
+    }
+
+    p_own = std::allocator_traits<header_allocator_type>::allocate(allocator, 1);
+    ::new (static_cast<void *>(p_own)) tree_header{nullptr, 0};
+
+    return p_own;
+}
+
+/* Frees a header from own_header(), whose tree is already destroyed */
+template <class NodeAllocator>
+void release_header(tree_header *const p_header, const NodeAllocator &node_allocator) noexcept
+{
+    using header_allocator_type = typename std::allocator_traits<NodeAllocator>::template rebind_alloc<tree_header>;
+
+    header_allocator_type allocator(node_allocator);
+
+    if (empty_header() != p_header)
+    {
+        std::allocator_traits<header_allocator_type>::deallocate(allocator, p_header, 1);
+    }
+}
+
+/* Binds the container's node allocator to this thread for the life of the scope */
+template <class NodeAllocator>
+class allocator_scope
+{
+public:
+    explicit allocator_scope(NodeAllocator &node_allocator) noexcept
+        : m_hooks{allocate_node, free_node, &node_allocator},
+          m_p_previous(tree_bind_node_allocator(&m_hooks))
+    {
+    }
+
+    ~allocator_scope()
+    {
+        (void)tree_bind_node_allocator(m_p_previous);
+    }
+
+    allocator_scope(const allocator_scope &) = delete;
+    allocator_scope &operator=(const allocator_scope &) = delete;
+
+private:
+    using traits = std::allocator_traits<NodeAllocator>;
+
+    static_assert(std::is_pointer<typename traits::pointer>::value, "the C tree links nodes with plain pointers");
+
+    /* Exceptions must not cross the C frames: a failed allocation is a NULL node there */
+    static st_tree_node_t *allocate_node(void *p_ctx) noexcept
+    {
+        try
+        {
+            return traits::allocate(*static_cast<NodeAllocator *>(p_ctx), 1);
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    static void free_node(void *p_ctx, st_tree_node_t *p_tree_node) noexcept
+    {
+        traits::deallocate(*static_cast<NodeAllocator *>(p_ctx), p_tree_node, 1);
+    }
+
+    st_node_allocator_t         m_hooks;
+    const st_node_allocator_t   *m_p_previous;
+};
+
+/* Bidirectional iterator over the keys in order; Deref turns a position into a reference */
+template <class Value, class Reference, class Deref>
+class tree_iterator
+{
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = Value;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = Reference;
+    using pointer           = std::add_pointer_t<Reference>;
+
+    tree_iterator() noexcept = default;
+
+    tree_iterator(const tree_header *const p_header, const tree_position position) noexcept
+        : m_p_header(p_header), m_position(position)
+    {
+    }
+
+    /* iterator -> const_iterator */
+    template <class OtherReference, class = std::enable_if_t<std::is_convertible<OtherReference, Reference>::value>>
+    tree_iterator(const tree_iterator<Value, OtherReference, Deref> &other) noexcept
+        : m_p_header(other.m_p_header), m_position(other.m_position)
+    {
+    }
+
+    reference operator*() const
+    {
+        return Deref::get(m_position);
+    }
+
+    pointer operator->() const
+    {
+        return std::addressof(Deref::get(m_position));
+    }
+
+    tree_iterator &operator++()
+    {
+        m_position = next_position(m_p_header->p_root, m_position);
+        return *this;
+    }
+
+    tree_iterator operator++(int)
+    {
+        tree_iterator previous = *this;
+
+        ++*this;
+        return previous;
+    }
+
+    tree_iterator &operator--()
+    {
+        m_position = prev_position(m_p_header->p_root, m_position);
+        return *this;
+    }
+
+    tree_iterator operator--(int)
+    {
+        tree_iterator previous = *this;
+
+        --*this;
+        return previous;
+    }
+
+    friend bool operator==(const tree_iterator &left, const tree_iterator &right) noexcept
+    {
+        return (left.m_position.p_node == right.m_position.p_node) && (left.m_position.slot == right.m_position.slot);
+    }
+
+    friend bool operator!=(const tree_iterator &left, const tree_iterator &right) noexcept
+    {
+        return !(left == right);
+    }
+
+    tree_position position() const noexcept
+    {
+        return m_position;
+    }
+
+private:
+    template <class, class, class>
+    friend class tree_iterator;
+
+    const tree_header   *m_p_header = nullptr;  /**< Follows the root as it changes, wherever the container moves */
+    tree_position       m_position{nullptr, 0};
+};
+
+} /* namespace detail */
+
+template <class Key = int32_t, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
+class two_three_set
+{
+    static_assert(std::is_same<Key, int32_t>::value, "the core tree stores int32_t keys");
+    static_assert(std::is_same<Compare, std::less<Key>>::value || std::is_same<Compare, std::less<>>::value,
+                  "the core tree orders keys with <");
+
+    struct deref_key
+    {
+        static const Key &get(const detail::tree_position position)
+        {
+            return position.p_node->keys[position.slot];
+        }
+    };
+
+    using node_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<st_tree_node_t>;
+    using scope               = detail::allocator_scope<node_allocator_type>;
+
+public:
+    using key_type               = Key;
+    using value_type             = Key;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using key_compare            = Compare;
+    using value_compare          = Compare;
+    using allocator_type         = Allocator;
+    using reference              = const Key &;
+    using const_reference        = const Key &;
+    using iterator               = detail::tree_iterator<Key, const Key &, deref_key>;
+    using const_iterator         = iterator;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = reverse_iterator;
+
+    two_three_set() : two_three_set(Allocator())
+    {
+    }
+
+    explicit two_three_set(const Allocator &allocator) : m_node_allocator(allocator)
+    {
+    }
+
+    template <class InputIt>
+    two_three_set(InputIt first, InputIt last, const Allocator &allocator = Allocator()) : m_node_allocator(allocator)
+    {
+        insert(first, last);
+    }
+
+    two_three_set(std::initializer_list<Key> keys, const Allocator &allocator = Allocator()) : m_node_allocator(allocator)
+    {
+        insert(keys);
+    }
+
+    two_three_set(const two_three_set &other)
+        : m_node_allocator(std::allocator_traits<node_allocator_type>::select_on_container_copy_construction(other.m_node_allocator))
+    {
+        copy_from(other);
+    }
+
+    two_three_set(const two_three_set &other, const Allocator &allocator) : m_node_allocator(allocator)
+    {
+        copy_from(other);
+    }
+
+    two_three_set(two_three_set &&other) noexcept
+        : m_node_allocator(std::move(other.m_node_allocator)), m_p_header(other.m_p_header)
+    {
+        other.m_p_header = detail::empty_header();
+    }
+
+    /* Nodes cannot change allocator: with a different one the keys are copied */
+    two_three_set(two_three_set &&other, const Allocator &allocator) : m_node_allocator(allocator)
+    {
+        if (m_node_allocator == other.m_node_allocator)
+        {
+            std::swap(m_p_header, other.m_p_header);
+        }
+        else
+        {
+            copy_from(other);
+        }
+    }
+
+    ~two_three_set()
+    {
+        clear();
+        detail::release_header(m_p_header, m_node_allocator);
+    }
+
+    two_three_set &operator=(const two_three_set &other)
+    {
+        if (this != &other)
+        {
+            clear();
+
+            if constexpr (std::allocator_traits<node_allocator_type>::propagate_on_container_copy_assignment::value)
+            {
+                m_node_allocator = other.m_node_allocator;
+            }
+
+            copy_from(other);
+        }
+
+        return *this;
+    }
+
+    two_three_set &operator=(two_three_set &&other) noexcept(std::allocator_traits<node_allocator_type>::is_always_equal::value
+                                                             || std::allocator_traits<node_allocator_type>::propagate_on_container_move_assignment::value)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+
+        /* The header goes back to the allocator it came from before that is replaced */
+        if constexpr (std::allocator_traits<node_allocator_type>::propagate_on_container_move_assignment::value)
+        {
+            detail::release_header(m_p_header, m_node_allocator);
+            m_p_header       = detail::empty_header();
+            m_node_allocator = std::move(other.m_node_allocator);
+        }
+
+        if (m_node_allocator == other.m_node_allocator)
+        {
+            std::swap(m_p_header, other.m_p_header);
+        }
+        else
+        {
+            copy_from(other);
+        }
+
+        return *this;
+    }
+
+    two_three_set &operator=(std::initializer_list<Key> keys)
+    {
+        clear();
+        insert(keys);
+
+        return *this;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(m_node_allocator);
+    }
+
+    iterator begin() const noexcept
+    {
+        return iterator(m_p_header, (nullptr == m_p_header->p_root) ? detail::tree_position{nullptr, 0} : detail::leftmost(m_p_header->p_root));
+    }
+
+    iterator end() const noexcept
+    {
+        return iterator(m_p_header, detail::tree_position{nullptr, 0});
+    }
+
+    iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    reverse_iterator rbegin() const noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    bool empty() const noexcept
+    {
+        return (0 == m_p_header->size);
+    }
+
+    size_type size() const noexcept
+    {
+        return m_p_header->size;
+    }
+
+    size_type max_size() const noexcept
+    {
+        return static_cast<size_type>(std::numeric_limits<int32_t>::max());
+    }
+
+    void clear() noexcept
+    {
+        scope bound(m_node_allocator);
+
+        if (detail::empty_header() != m_p_header)
+        {
+            tree_destroy(&m_p_header->p_root);
+            m_p_header->size = 0;
+        }
+    }
+
+    std::pair<iterator, bool> insert(const Key key)
+    {
+        st_tree_path_t  path;
+        e_retcode_t     ret;
+
+        check_key(key);
+
+        {
+            scope bound(m_node_allocator);
+
+            path.depth = 0;
+            ret        = tree_path_insert(root_link(), &path, key);
+        }
+
+        if ((RET_ERRCODE_OK != ret) && (RET_ERRCODE_NG_DUPLICATE != ret))
+        {
+            throw std::bad_alloc();
+        }
+
+        m_p_header->size += (RET_ERRCODE_OK == ret) ? 1 : 0;
+
+        return std::pair<iterator, bool>(find(key), (RET_ERRCODE_OK == ret));
+    }
+
+    iterator insert(const_iterator, const Key key)
+    {
+        return insert(key).first;
+    }
+
+    template <class InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+        {
+            (void)insert(static_cast<Key>(*first));
+        }
+    }
+
+    void insert(std::initializer_list<Key> keys)
+    {
+        insert(keys.begin(), keys.end());
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args &&...args)
+    {
+        return insert(Key(std::forward<Args>(args)...));
+    }
+
+    template <class... Args>
+    iterator emplace_hint(const_iterator, Args &&...args)
+    {
+        return emplace(std::forward<Args>(args)...).first;
+    }
+
+    size_type erase(const Key key)
+    {
+        bool removed;
+
+        {
+            scope bound(m_node_allocator);
+
+            removed = (false == empty()) && tree_remove(&m_p_header->p_root, key);
+        }
+
+        m_p_header->size -= removed ? 1 : 0;
+
+        return removed ? 1 : 0;
+    }
+
+    /* Keys move on erase: the next position is looked up again */
+    iterator erase(const_iterator position)
+    {
+        const Key key = *position;
+
+        (void)erase(key);
+
+        return lower_bound(key);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        Key     low;
+        bool    bounded = (last != end());
+        Key     high    = bounded ? *last : 0;
+
+        while ((first != end()) && ((false == bounded) || (*first < high)))
+        {
+            low   = *first;
+            (void)erase(low);
+            first = lower_bound(low);
+        }
+
+        return first;
+    }
+
+    void swap(two_three_set &other) noexcept
+    {
+        if constexpr (std::allocator_traits<node_allocator_type>::propagate_on_container_swap::value)
+        {
+            std::swap(m_node_allocator, other.m_node_allocator);
+        }
+
+        std::swap(m_p_header, other.m_p_header);
+    }
+
+    iterator find(const Key key) const
+    {
+        return iterator(m_p_header, detail::find_position(m_p_header->p_root, key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator find(const K &key) const
+    {
+        int32_t narrow;
+
+        return (0 == detail::key_range_side(key, &narrow)) ? find(narrow) : end();
+    }
+
+    size_type count(const Key key) const
+    {
+        return (end() != find(key)) ? 1 : 0;
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    size_type count(const K &key) const
+    {
+        return (end() != find(key)) ? 1 : 0;
+    }
+
+    bool contains(const Key key) const
+    {
+        return (end() != find(key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    bool contains(const K &key) const
+    {
+        return (end() != find(key));
+    }
+
+    iterator lower_bound(const Key key) const
+    {
+        return iterator(m_p_header, detail::ceiling(m_p_header->p_root, key, false));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator lower_bound(const K &key) const
+    {
+        int32_t narrow;
+        int32_t side = detail::key_range_side(key, &narrow);
+
+        return (0 == side) ? lower_bound(narrow) : ((0 > side) ? begin() : end());
+    }
+
+    iterator upper_bound(const Key key) const
+    {
+        return iterator(m_p_header, detail::ceiling(m_p_header->p_root, key, true));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator upper_bound(const K &key) const
+    {
+        int32_t narrow;
+        int32_t side = detail::key_range_side(key, &narrow);
+
+        return (0 == side) ? upper_bound(narrow) : ((0 > side) ? begin() : end());
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key key) const
+    {
+        return std::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K &key) const
+    {
+        return std::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    key_compare key_comp() const
+    {
+        return key_compare();
+    }
+
+    value_compare value_comp() const
+    {
+        return value_compare();
+    }
+
+    /* The tree itself, for the C functions that only read */
+    const st_tree_node_t *root() const noexcept
+    {
+        return m_p_header->p_root;
+    }
+
+    friend bool operator==(const two_three_set &left, const two_three_set &right)
+    {
+        return (left.size() == right.size()) && std::equal(left.begin(), left.end(), right.begin());
+    }
+
+    friend bool operator!=(const two_three_set &left, const two_three_set &right)
+    {
+        return !(left == right);
+    }
+
+private:
+    static void check_key(const Key key)
+    {
+        if ((-1) == key)
+        {
+            throw std::invalid_argument("two_three_set: -1 marks blank keys in the tree and cannot be stored");
+        }
+    }
+
+    /* The container's own header, allocated on the first change */
+    st_tree_node_t **root_link()
+    {
+        m_p_header = detail::own_header(m_p_header, m_node_allocator);
+
+        return &m_p_header->p_root;
+    }
+
+    /* Sorted keys: one bottom-up build instead of n inserts */
+    void copy_from(const two_three_set &other)
+    {
+        std::unique_ptr<int32_t[]>  p_keys;
+        e_retcode_t                 ret;
+        int32_t                     count = static_cast<int32_t>(other.size());
+
+        if (0 == count)
+        {
+            return;
+        }
+
+        p_keys.reset(new int32_t[count]);
+        count = tree_export_keys(other.root(), p_keys.get(), count);
+
+        {
+            scope bound(m_node_allocator);
+
+            ret = tree_build_from_sorted(root_link(), p_keys.get(), nullptr, count);
+        }
+
+        if (RET_ERRCODE_OK != ret)
+        {
+            clear();
+            throw std::bad_alloc();
+        }
+
+        m_p_header->size = static_cast<size_type>(count);
+    }
+
+    node_allocator_type m_node_allocator;
+    detail::tree_header *m_p_header = detail::empty_header();   /**< Moves and swaps with the nodes */
+};
+
+/*
+    Map of int32_t keys to any T, move-only included. Each std::pair<const Key, T> is
+    built in place in memory from the allocator and the tree keeps its address as the
+    key's value.
+*/
+template <class Key, class T, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<const Key, T>>>
+class two_three_map
+{
+    static_assert(std::is_same<Key, int32_t>::value, "the core tree stores int32_t keys");
+    static_assert(std::is_same<Compare, std::less<Key>>::value || std::is_same<Compare, std::less<>>::value,
+                  "the core tree orders keys with <");
+
+public:
+    using key_type               = Key;
+    using mapped_type            = T;
+    using value_type             = std::pair<const Key, T>;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using key_compare            = Compare;
+    using allocator_type         = Allocator;
+    using reference              = value_type &;
+    using const_reference        = const value_type &;
+
+private:
+    struct deref_value
+    {
+        static value_type &get(const detail::tree_position position)
+        {
+            return *reinterpret_cast<value_type *>(position.p_node->values[position.slot]);
+        }
+    };
+
+    using value_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+    using value_traits         = std::allocator_traits<value_allocator_type>;
+    using node_allocator_type  = typename std::allocator_traits<Allocator>::template rebind_alloc<st_tree_node_t>;
+    using scope                = detail::allocator_scope<node_allocator_type>;
+
+public:
+    using iterator               = detail::tree_iterator<value_type, value_type &, deref_value>;
+    using const_iterator         = detail::tree_iterator<value_type, const value_type &, deref_value>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    class value_compare
+    {
+    public:
+        bool operator()(const value_type &left, const value_type &right) const
+        {
+            return left.first < right.first;
+        }
+    };
+
+    two_three_map() : two_three_map(Allocator())
+    {
+    }
+
+    explicit two_three_map(const Allocator &allocator) : m_value_allocator(allocator), m_node_allocator(allocator)
+    {
+    }
+
+    template <class InputIt>
+    two_three_map(InputIt first, InputIt last, const Allocator &allocator = Allocator())
+        : m_value_allocator(allocator), m_node_allocator(allocator)
+    {
+        insert(first, last);
+    }
+
+    two_three_map(std::initializer_list<value_type> values, const Allocator &allocator = Allocator())
+        : m_value_allocator(allocator), m_node_allocator(allocator)
+    {
+        insert(values.begin(), values.end());
+    }
+
+    two_three_map(const two_three_map &other)
+        : m_value_allocator(value_traits::select_on_container_copy_construction(other.m_value_allocator)),
+          m_node_allocator(std::allocator_traits<node_allocator_type>::select_on_container_copy_construction(other.m_node_allocator))
+    {
+        copy_from(other);
+    }
+
+    two_three_map(const two_three_map &other, const Allocator &allocator) : m_value_allocator(allocator), m_node_allocator(allocator)
+    {
+        copy_from(other);
+    }
+
+    two_three_map(two_three_map &&other) noexcept
+        : m_value_allocator(std::move(other.m_value_allocator)), m_node_allocator(std::move(other.m_node_allocator)),
+          m_p_header(other.m_p_header)
+    {
+        other.m_p_header = detail::empty_header();
+    }
+
+    two_three_map(two_three_map &&other, const Allocator &allocator) : m_value_allocator(allocator), m_node_allocator(allocator)
+    {
+        if (m_value_allocator == other.m_value_allocator)
+        {
+            std::swap(m_p_header, other.m_p_header);
+        }
+        else
+        {
+            move_from(other);
+        }
+    }
+
+    ~two_three_map()
+    {
+        clear();
+        detail::release_header(m_p_header, m_node_allocator);
+    }
+
+    two_three_map &operator=(const two_three_map &other)
+    {
+        if (this != &other)
+        {
+            clear();
+
+            if constexpr (value_traits::propagate_on_container_copy_assignment::value)
+            {
+                m_value_allocator = other.m_value_allocator;
+                m_node_allocator  = other.m_node_allocator;
+            }
+
+            copy_from(other);
+        }
+
+        return *this;
+    }
+
+    two_three_map &operator=(two_three_map &&other) noexcept(value_traits::is_always_equal::value
+                                                             || value_traits::propagate_on_container_move_assignment::value)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+
+        /* The header goes back to the allocator it came from before that is replaced */
+        if constexpr (value_traits::propagate_on_container_move_assignment::value)
+        {
+            detail::release_header(m_p_header, m_node_allocator);
+            m_p_header        = detail::empty_header();
+            m_value_allocator = std::move(other.m_value_allocator);
+            m_node_allocator  = std::move(other.m_node_allocator);
+        }
+
+        if (m_value_allocator == other.m_value_allocator)
+        {
+            std::swap(m_p_header, other.m_p_header);
+        }
+        else
+        {
+            move_from(other);
+        }
+
+        return *this;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(m_value_allocator);
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(m_p_header, first_position());
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(m_p_header, first_position());
+    }
+
+    iterator end() noexcept
+    {
+        return iterator(m_p_header, detail::tree_position{nullptr, 0});
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(m_p_header, detail::tree_position{nullptr, 0});
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    bool empty() const noexcept
+    {
+        return (0 == m_p_header->size);
+    }
+
+    size_type size() const noexcept
+    {
+        return m_p_header->size;
+    }
+
+    size_type max_size() const noexcept
+    {
+        return static_cast<size_type>(std::numeric_limits<int32_t>::max());
+    }
+
+    void clear() noexcept
+    {
+        scope bound(m_node_allocator);
+
+        if (detail::empty_header() != m_p_header)
+        {
+            destroy_values(m_p_header->p_root);
+            tree_destroy(&m_p_header->p_root);
+            m_p_header->size = 0;
+        }
+    }
+
+    /* T is built in place, and only when the key is new */
+    template <class... Args>
+    std::pair<iterator, bool> try_emplace(const Key key, Args &&...args)
+    {
+        uintptr_t   *p_slot;
+        value_type  *p_value;
+        bool_t      inserted = false;
+
+        check_key(key);
+
+        {
+            scope bound(m_node_allocator);
+
+            p_slot = insert_or_get(root_link(), key, 0, &inserted);
+        }
+
+        if (nullptr == p_slot)
+        {
+            throw std::bad_alloc();
+        }
+
+        if (inserted)
+        {
+            try
+            {
+                p_value = make_value(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+            }
+            catch (...)
+            {
+                scope bound(m_node_allocator);
+
+                (void)tree_remove(&m_p_header->p_root, key);
+                throw;
+            }
+
+            *p_slot = reinterpret_cast<uintptr_t>(p_value);
+            m_p_header->size++;
+        }
+
+        return std::pair<iterator, bool>(find(key), inserted);
+    }
+
+    template <class... Args>
+    iterator try_emplace(const_iterator, const Key key, Args &&...args)
+    {
+        return try_emplace(key, std::forward<Args>(args)...).first;
+    }
+
+    /* The pair is built first to learn its key; it is dropped again if the key exists */
+    template <class... Args>
+    std::pair<iterator, bool> emplace(Args &&...args)
+    {
+        value_type  *p_value = make_value(std::forward<Args>(args)...);
+        uintptr_t   *p_slot;
+        bool_t      inserted = false;
+        const Key   key      = p_value->first;
+
+        if ((-1) == key)
+        {
+            drop_value(p_value);
+            check_key(key);
+        }
+
+        {
+            scope bound(m_node_allocator);
+
+            p_slot = insert_or_get(root_link(), key, reinterpret_cast<uintptr_t>(p_value), &inserted);
+        }
+
+        if ((nullptr == p_slot) || (false == inserted))
+        {
+            drop_value(p_value);
+
+            if (nullptr == p_slot)
+            {
+                throw std::bad_alloc();
+            }
+        }
+        else
+        {
+            m_p_header->size++;
+        }
+
+        return std::pair<iterator, bool>(find(key), inserted);
+    }
+
+    template <class... Args>
+    iterator emplace_hint(const_iterator, Args &&...args)
+    {
+        return emplace(std::forward<Args>(args)...).first;
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value)
+    {
+        return try_emplace(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type &&value)
+    {
+        return try_emplace(value.first, std::move(value.second));
+    }
+
+    template <class P, class = std::enable_if_t<std::is_constructible<value_type, P &&>::value>>
+    std::pair<iterator, bool> insert(P &&value)
+    {
+        return emplace(std::forward<P>(value));
+    }
+
+    template <class InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+        {
+            (void)emplace(*first);
+        }
+    }
+
+    void insert(std::initializer_list<value_type> values)
+    {
+        insert(values.begin(), values.end());
+    }
+
+    template <class M>
+    std::pair<iterator, bool> insert_or_assign(const Key key, M &&mapped)
+    {
+        std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(mapped));
+
+        if (false == result.second)
+        {
+            result.first->second = std::forward<M>(mapped);
+        }
+
+        return result;
+    }
+
+    T &operator[](const Key key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    T &at(const Key key)
+    {
+        iterator found = find(key);
+
+        if (end() == found)
+        {
+            throw std::out_of_range("two_three_map::at");
+        }
+
+        return found->second;
+    }
+
+    const T &at(const Key key) const
+    {
+        const_iterator found = find(key);
+
+        if (end() == found)
+        {
+            throw std::out_of_range("two_three_map::at");
+        }
+
+        return found->second;
+    }
+
+    size_type erase(const Key key)
+    {
+        uintptr_t   value = 0;
+        bool        removed;
+
+        {
+            scope bound(m_node_allocator);
+
+            removed = (false == empty()) && tree_remove_value(&m_p_header->p_root, key, &value);
+        }
+
+        if (removed)
+        {
+            drop_value(reinterpret_cast<value_type *>(value));
+            m_p_header->size--;
+        }
+
+        return removed ? 1 : 0;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        const Key key = position->first;
+
+        (void)erase(key);
+
+        return lower_bound(key);
+    }
+
+    iterator erase(iterator position)
+    {
+        return erase(const_iterator(position));
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        Key     low;
+        bool    bounded = (last != cend());
+        Key     high    = bounded ? last->first : 0;
+        iterator next   = iterator(m_p_header, first.position());
+
+        while ((next != end()) && ((false == bounded) || (next->first < high)))
+        {
+            low  = next->first;
+            (void)erase(low);
+            next = lower_bound(low);
+        }
+
+        return next;
+    }
+
+    void swap(two_three_map &other) noexcept
+    {
+        if constexpr (value_traits::propagate_on_container_swap::value)
+        {
+            std::swap(m_value_allocator, other.m_value_allocator);
+            std::swap(m_node_allocator, other.m_node_allocator);
+        }
+
+        std::swap(m_p_header, other.m_p_header);
+    }
+
+    iterator find(const Key key)
+    {
+        return iterator(m_p_header, detail::find_position(m_p_header->p_root, key));
+    }
+
+    const_iterator find(const Key key) const
+    {
+        return const_iterator(m_p_header, detail::find_position(m_p_header->p_root, key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    iterator find(const K &key)
+    {
+        int32_t narrow;
+
+        return (0 == detail::key_range_side(key, &narrow)) ? find(narrow) : end();
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator find(const K &key) const
+    {
+        int32_t narrow;
+
+        return (0 == detail::key_range_side(key, &narrow)) ? find(narrow) : end();
+    }
+
+    size_type count(const Key key) const
+    {
+        return (end() != find(key)) ? 1 : 0;
+    }
+
+    bool contains(const Key key) const
+    {
+        return (end() != find(key));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    bool contains(const K &key) const
+    {
+        return (end() != find(key));
+    }
+
+    iterator lower_bound(const Key key)
+    {
+        return iterator(m_p_header, detail::ceiling(m_p_header->p_root, key, false));
+    }
+
+    const_iterator lower_bound(const Key key) const
+    {
+        return const_iterator(m_p_header, detail::ceiling(m_p_header->p_root, key, false));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator lower_bound(const K &key) const
+    {
+        int32_t narrow;
+        int32_t side = detail::key_range_side(key, &narrow);
+
+        return (0 == side) ? lower_bound(narrow) : ((0 > side) ? begin() : end());
+    }
+
+    iterator upper_bound(const Key key)
+    {
+        return iterator(m_p_header, detail::ceiling(m_p_header->p_root, key, true));
+    }
+
+    const_iterator upper_bound(const Key key) const
+    {
+        return const_iterator(m_p_header, detail::ceiling(m_p_header->p_root, key, true));
+    }
+
+    template <class K, class C = Compare, class = typename C::is_transparent>
+    const_iterator upper_bound(const K &key) const
+    {
+        int32_t narrow;
+        int32_t side = detail::key_range_side(key, &narrow);
+
+        return (0 == side) ? upper_bound(narrow) : ((0 > side) ? begin() : end());
+    }
+
+    std::pair<iterator, iterator> equal_range(const Key key)
+    {
+        return std::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const Key key) const
+    {
+        return std::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    key_compare key_comp() const
+    {
+        return key_compare();
+    }
+
+    value_compare value_comp() const
+    {
+        return value_compare();
+    }
+
+    const st_tree_node_t *root() const noexcept
+    {
+        return m_p_header->p_root;
+    }
+
+private:
+    static void check_key(const Key key)
+    {
+        if ((-1) == key)
+        {
+            throw std::invalid_argument("two_three_map: -1 marks blank keys in the tree and cannot be stored");
+        }
+    }
+
+    detail::tree_position first_position() const noexcept
+    {
+        return (nullptr == m_p_header->p_root) ? detail::tree_position{nullptr, 0} : detail::leftmost(m_p_header->p_root);
+    }
+
+    /* The container's own header, allocated on the first change */
+    st_tree_node_t **root_link()
+    {
+        m_p_header = detail::own_header(m_p_header, m_node_allocator);
+
+        return &m_p_header->p_root;
+    }
+
+    template <class... Args>
+    value_type *make_value(Args &&...args)
+    {
+        value_type *p_value = value_traits::allocate(m_value_allocator, 1);
+
+        try
+        {
+            value_traits::construct(m_value_allocator, p_value, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            value_traits::deallocate(m_value_allocator, p_value, 1);
+            throw;
+        }
+
+        return p_value;
+    }
+
+    void drop_value(value_type *const p_value) noexcept
+    {
+        value_traits::destroy(m_value_allocator, p_value);
+        value_traits::deallocate(m_value_allocator, p_value, 1);
+    }
+
+    void destroy_values(const st_tree_node_t *const p_tree_node) noexcept
+    {
+        int32_t index;
+
+        if (nullptr == p_tree_node)
+        {
+            return;
+        }
+
+        /* 0 while a copy is still filling the values */
+        for (index = 0; index < detail::node_key_count(p_tree_node); index++)
+        {
+            if (0 != p_tree_node->values[index])
+            {
+                drop_value(reinterpret_cast<value_type *>(p_tree_node->values[index]));
+            }
+        }
+
+        destroy_values(p_tree_node->p_left_child);
+        destroy_values(p_tree_node->p_middle_child);
+        destroy_values(p_tree_node->p_right_child);
+    }
+
+    /* Same shape as other: build from the sorted keys, then fill the values in order */
+    template <bool MoveValues, class Source>
+    void fill_from(Source &other)
+    {
+        std::unique_ptr<int32_t[]>  p_keys;
+        e_retcode_t                 ret;
+        int32_t                     count = static_cast<int32_t>(other.size());
+        const_iterator              from;
+        iterator                    to;
+
+        if (0 == count)
+        {
+            return;
+        }
+
+        p_keys.reset(new int32_t[count]);
+        count = tree_export_keys(other.root(), p_keys.get(), count);
+
+        {
+            scope bound(m_node_allocator);
+
+            ret = tree_build_from_sorted(root_link(), p_keys.get(), nullptr, count);
+        }
+
+        if (RET_ERRCODE_OK != ret)
+        {
+            clear();
+            throw std::bad_alloc();
+        }
+
+        /* create_node() leaves every value 0, which clear() skips if a copy throws half way */
+        m_p_header->size = static_cast<size_type>(count);
+
+        for (from = other.cbegin(), to = begin(); to != end(); ++from, ++to)
+        {
+            value_type *p_value;
+
+            try
+            {
+                if constexpr (MoveValues)
+                {
+                    p_value = make_value(from->first, std::move(const_cast<T &>(from->second)));
+                }
+                else
+                {
+                    p_value = make_value(*from);
+                }
+            }
+            catch (...)
+            {
+                clear();
+                throw;
+            }
+
+            const_cast<st_tree_node_t *>(to.position().p_node)->values[to.position().slot] = reinterpret_cast<uintptr_t>(p_value);
+        }
+    }
+
+    void copy_from(const two_three_map &other)
+    {
+        fill_from<false>(other);
+    }
+
+    void move_from(two_three_map &other)
+    {
+        fill_from<true>(other);
+        other.clear();
+    }
+
+    value_allocator_type    m_value_allocator;
+    node_allocator_type     m_node_allocator;
+    detail::tree_header     *m_p_header = detail::empty_header();   /**< Moves and swaps with the nodes */
+};
+
+template <class Key, class Compare, class Allocator>
+void swap(two_three_set<Key, Compare, Allocator> &left, two_three_set<Key, Compare, Allocator> &right) noexcept
+{
+    left.swap(right);
+}
+
+template <class Key, class T, class Compare, class Allocator>
+void swap(two_three_map<Key, T, Compare, Allocator> &left, two_three_map<Key, T, Compare, Allocator> &right) noexcept
+{
+    left.swap(right);
+}
+
+namespace pmr
+{
+
+template <class Key = int32_t, class Compare = std::less<Key>>
+using two_three_set = dsa::two_three_set<Key, Compare, std::pmr::polymorphic_allocator<Key>>;
+
+template <class Key, class T, class Compare = std::less<Key>>
+using two_three_map = dsa::two_three_map<Key, T, Compare, std::pmr::polymorphic_allocator<std::pair<const Key, T>>>;
+
+} /* namespace pmr */
+
+} /* namespace dsa */
+
+#endif
\ No newline at end of file
@@ -7,14 +7,78 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/* C++ cannot declare an enum ahead of its list: there the enum types are int, as in C */
+#ifdef __cplusplus
+typedef int                     e_retcode_t;
+typedef int                     e_key_t;
+typedef int                     e_dir_t;
+typedef int                     e_enable_flag_t;
+typedef int                     e_index_op_t;
+typedef int                     e_tree_violation_t;
+typedef int                     e_leaf_encoding_t;
+#else
 typedef enum e_retcode          e_retcode_t;
 typedef enum e_key              e_key_t;
 typedef enum e_dir              e_dir_t;
 typedef enum e_enable_flag      e_enable_flag_t;
-typedef struct st_update_info   st_update_info_t;
+typedef enum e_index_op         e_index_op_t;
+typedef enum e_tree_violation   e_tree_violation_t;
+typedef enum e_leaf_encoding    e_leaf_encoding_t;
+#endif
+
 typedef struct st_tree_node     st_tree_node_t;
 typedef bool                    bool_t;
 typedef struct st_stack         st_stack_t;
 typedef struct st_stack_node    st_stack_node_t;
+typedef struct st_compact_tree  st_compact_tree_t;
+typedef struct st_frozen_tree   st_frozen_tree_t;
+typedef struct st_key_set       st_key_set_t;
+typedef struct st_lazy_tree     st_lazy_tree_t;
+typedef struct st_tree_path     st_tree_path_t;
+typedef struct st_buffered_tree st_buffered_tree_t;
+typedef struct st_finger_tree   st_finger_tree_t;
+typedef struct st_task          st_task_t;
+typedef struct st_work_deque    st_work_deque_t;
+typedef struct st_thread_pool   st_thread_pool_t;
+typedef struct st_index_op      st_index_op_t;
+typedef struct st_shard_index   st_shard_index_t;
+typedef struct st_reduce_ops    st_reduce_ops_t;
+typedef struct st_key_summary   st_key_summary_t;
+typedef struct st_node_allocator st_node_allocator_t;
+typedef struct st_node_pool     st_node_pool_t;
+typedef struct st_epoch_record  st_epoch_record_t;
+typedef struct st_epoch_domain  st_epoch_domain_t;
+typedef struct st_tree_memory_stats st_tree_memory_stats_t;
+typedef struct st_tree_report   st_tree_report_t;
+typedef struct st_disk_node     st_disk_node_t;
+typedef struct st_disk_header   st_disk_header_t;
+typedef struct st_buffer_frame  st_buffer_frame_t;
+typedef struct st_buffer_pool   st_buffer_pool_t;
+typedef struct st_paged_tree    st_paged_tree_t;
+typedef struct st_hot_cache_entry st_hot_cache_entry_t;
+typedef struct st_hot_cache     st_hot_cache_t;
+typedef struct st_hot_cache_stats st_hot_cache_stats_t;
+typedef struct st_bloom_filter  st_bloom_filter_t;
+typedef struct st_filtered_tree st_filtered_tree_t;
+typedef struct st_packed_block  st_packed_block_t;
+typedef struct st_packed_tree   st_packed_tree_t;
+typedef struct st_spline_point  st_spline_point_t;
+typedef struct st_spline_index  st_spline_index_t;
+typedef struct st_node_arena_region st_node_arena_region_t;
+typedef struct st_node_arena    st_node_arena_t;
+typedef struct st_replicated_tree st_replicated_tree_t;
+typedef struct st_tree_augment  st_tree_augment_t;
+typedef struct st_summary_node  st_summary_node_t;
+typedef struct st_counted_tree  st_counted_tree_t;
+typedef struct st_interval_bucket st_interval_bucket_t;
+typedef struct st_interval_tree st_interval_tree_t;
+typedef struct st_ttl_entry     st_ttl_entry_t;
+typedef struct st_ttl_tree      st_ttl_tree_t;
+
+typedef void (*pf_key_visitor_t)(const int32_t key, void *p_ctx);
+typedef void (*pf_count_visitor_t)(const int32_t key, const uint64_t count, void *p_ctx);
+typedef void (*pf_interval_visitor_t)(const int32_t low, const int32_t high, void *p_ctx);
+typedef bool_t (*pf_remove_filter_t)(const int32_t key, const uintptr_t value, void *p_ctx);
+typedef void (*pf_task_t)(void *p_arg);
 
 #endif
\ No newline at end of file
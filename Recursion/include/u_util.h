@@ -4,6 +4,7 @@
 #include "u_errors.h"
 
 #define ARRAY_SIZE(arr) (int32_t)(sizeof(arr) / sizeof(arr[0]))
+#define TREE_MAX_HEIGHT (48)    /**< 2^32 keys need at most 32 levels */
 
 enum e_key {
     FIRST_KEY   = 0,
@@ -22,28 +23,98 @@ enum e_enable_flag {
     ENABLED
 };
 
-struct st_update_info
-{
-    int32_t             value_up;
-    int32_t             value_split;
-    e_enable_flag_t     update_flag;
-};
-
 struct st_tree_node
 {
     int32_t             keys[MAX_KEY];
-    st_update_info_t    update_info;
+    uintptr_t           values[MAX_KEY];    /**< Value of each key, 0 unless set */
     st_tree_node_t      *p_left_child;
     st_tree_node_t      *p_middle_child;
     st_tree_node_t      *p_right_child;
     bool_t              is_root;
+    uint32_t            version;            /**< Bumped whenever keys move in or out of the node */
+};
+
+/*
+    Node of an augmented tree, allocated through tree_summary_allocator(). The base node
+    comes first, so a pointer to one is a pointer to the other; plain trees keep the
+    smaller st_tree_node_t.
+*/
+struct st_summary_node
+{
+    st_tree_node_t      node;
+    int64_t             summary;            /**< Aggregate of the subtree, kept by the bound augmentation */
+};
+
+/* Root-to-leaf path of the last operation, with the key range each node covers */
+struct st_tree_path
+{
+    st_tree_node_t      *p_nodes[TREE_MAX_HEIGHT];
+    int64_t             low[TREE_MAX_HEIGHT];       /**< Keys under p_nodes[i] are > low[i] */
+    int64_t             high[TREE_MAX_HEIGHT];      /**< Keys under p_nodes[i] are < high[i] */
+    int32_t             depth;                      /**< 0 means the path is empty */
+};
+
+/* Hooks for node memory, see tree_set_node_allocator() */
+struct st_node_allocator
+{
+    st_tree_node_t      *(*pf_alloc)(void *p_ctx);
+    void                (*pf_free)(void *p_ctx, st_tree_node_t *p_tree_node);
+    void                *p_ctx;
+};
+
+/*
+    Recomputes the summary of p_tree_node, an st_summary_node_t, from its keys, values and
+    the summaries of its children, see tree_bind_augment(). Children are always updated
+    before their parent.
+*/
+struct st_tree_augment
+{
+    void                (*pf_update)(st_tree_node_t *p_tree_node, void *p_ctx);
+    void                *p_ctx;
 };
 
 e_retcode_t insert(st_tree_node_t **const pp_root, const int32_t key);
 st_tree_node_t *search(const st_tree_node_t *const p_start_node, const int32_t searched_key);
-e_retcode_t delete(st_tree_node_t **const pp_root, const int32_t key);
+#ifndef __cplusplus
+e_retcode_t delete(st_tree_node_t **const pp_root, const int32_t key);   /**< A C++ keyword: use tree_remove() there */
+#endif
+bool_t tree_remove(st_tree_node_t **const pp_root, const int32_t key);
+bool_t tree_remove_value(st_tree_node_t **const pp_root, const int32_t key, uintptr_t *const p_value);
+uintptr_t *insert_or_get(st_tree_node_t **const pp_root, const int32_t key, const uintptr_t value, bool_t *const p_inserted);
+e_retcode_t upsert(st_tree_node_t **const pp_root, const int32_t key, const uintptr_t value);
+bool_t cas(st_tree_node_t *const p_root, const int32_t key, const uintptr_t expected, const uintptr_t desired);
+bool_t tree_get_value(const st_tree_node_t *const p_root, const int32_t key, uintptr_t *const p_value);
 void inorder_traverse(const st_tree_node_t *const p_tree_node);
 void preorder_traverse(const st_tree_node_t *const p_tree_node);
 void postorder_traverse(const st_tree_node_t *const p_tree_node);
+int32_t tree_key_count(const st_tree_node_t *const p_tree_node);
+int32_t tree_export_keys(const st_tree_node_t *const p_tree_node, int32_t *const p_keys, const int32_t capacity);
+int32_t tree_export_entries(const st_tree_node_t *const p_tree_node, int32_t *const p_keys, uintptr_t *const p_values, const int32_t capacity);
+int32_t tree_range_scan(const st_tree_node_t *const p_tree_node, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx);
+bool_t tree_lower_bound(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key);
+bool_t tree_upper_bound(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key);
+bool_t tree_predecessor(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key);
+bool_t tree_successor(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key);
+void tree_set_node_allocator(const st_node_allocator_t *const p_allocator);
+const st_node_allocator_t *tree_bind_node_allocator(const st_node_allocator_t *const p_allocator);
+const st_node_allocator_t *tree_summary_allocator(void);
+const st_tree_augment_t *tree_bind_augment(const st_tree_augment_t *const p_augment);
+uint64_t *tree_bind_free_generation(uint64_t *const p_generation);
+void tree_track_free_generation(void);
+uint64_t tree_free_generation(void);
+st_tree_node_t *create_node(const int32_t key, const bool_t is_root);
+int32_t tree_height_for_count(const int32_t count);
+int32_t tree_split_plan(const int32_t count, const int32_t height, int32_t *const p_child_counts);
+st_tree_node_t *tree_build_subtree(const int32_t *const p_sorted_keys, const uintptr_t *const p_values, const int32_t count, const int32_t height);
+e_retcode_t tree_build_from_sorted(st_tree_node_t **const pp_root, const int32_t *const p_sorted_keys, const uintptr_t *const p_values, const int32_t count);
+void tree_destroy(st_tree_node_t **const pp_root);
+void tree_path_reset(st_tree_path_t *const p_path);
+st_tree_node_t *tree_path_search(st_tree_node_t *const p_root, st_tree_path_t *const p_path, const int32_t searched_key);
+e_retcode_t tree_path_insert(st_tree_node_t **const pp_root, st_tree_path_t *const p_path, const int32_t key);
+uintptr_t *tree_path_insert_or_get(st_tree_node_t **const pp_root, st_tree_path_t *const p_path, const int32_t key, const uintptr_t value, bool_t *const p_inserted);
+void tree_augment_node(st_tree_node_t *const p_tree_node);
+void tree_path_augment(const st_tree_path_t *const p_path);
+e_retcode_t tree_insert_batch(st_tree_node_t **const pp_root, const int32_t *const p_sorted_keys, const int32_t count, int32_t *const p_inserted, int32_t *const p_done);
+int32_t tree_remove_batch(st_tree_node_t **const pp_root, const int32_t *const p_sorted_keys, const int32_t count, pf_remove_filter_t pf_filter, void *p_ctx);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "u_bloom_filter.h"
+
+#define BLOOM_BLOCK_BITS    (BLOOM_BLOCK_WORDS * 32)
+
+static inline uint64_t key_hash(const int32_t key);
+
+/* Odd multipliers, one per word: each picks 5 well-mixed bits of the same 32-bit hash */
+static const uint32_t word_salts[BLOOM_BLOCK_WORDS] =
+{
+    0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+    0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u
+};
+
+/* MurmurHash3 finalizer: sequential keys must not share blocks */
+static inline uint64_t key_hash(const int32_t key)
+{
+    uint64_t hash = (uint64_t)(uint32_t)key;
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+e_retcode_t bloom_filter_init(st_bloom_filter_t *const p_filter, const uint32_t expected_keys)
+{
+    uint64_t wanted_bits = (uint64_t)expected_keys * BLOOM_BITS_PER_KEY;
+    uint32_t block_count = 1;
+
+    if (NULL == p_filter)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    while (((uint64_t)block_count * BLOOM_BLOCK_BITS) < wanted_bits)
+    {
+        block_count *= 2;
+    }
+
+    p_filter->p_blocks = (uint32_t *)aligned_alloc(64, ((size_t)block_count * BLOOM_BLOCK_WORDS * sizeof(uint32_t) + 63) & ~(size_t)63);
+    if (NULL == p_filter->p_blocks)
+    {
+        p_filter->block_count = 0;
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_filter->block_count = block_count;
+    bloom_filter_clear(p_filter);
+
+    return RET_ERRCODE_OK;
+}
+
+void bloom_filter_add(st_bloom_filter_t *const p_filter, const int32_t key)
+{
+    uint64_t    hash     = key_hash(key);
+    uint32_t    *p_block = &p_filter->p_blocks[((hash >> 32) & (p_filter->block_count - 1)) * BLOOM_BLOCK_WORDS];
+    int32_t     i;
+
+    for (i = 0; i < BLOOM_BLOCK_WORDS; i++)
+    {
+        p_block[i] |= 1u << (((uint32_t)hash * word_salts[i]) >> 27);
+    }
+
+    p_filter->key_count++;
+}
+
+/* false means key was never added */
+bool_t bloom_filter_may_contain(const st_bloom_filter_t *const p_filter, const int32_t key)
+{
+    uint64_t        hash     = key_hash(key);
+    const uint32_t  *p_block = &p_filter->p_blocks[((hash >> 32) & (p_filter->block_count - 1)) * BLOOM_BLOCK_WORDS];
+    uint32_t        missing  = 0;
+    int32_t         i;
+
+    /* No early exit: the 8 tests are independent and vectorize */
+    for (i = 0; i < BLOOM_BLOCK_WORDS; i++)
+    {
+        missing |= ~p_block[i] & (1u << (((uint32_t)hash * word_salts[i]) >> 27));
+    }
+
+    return (0 == missing);
+}
+
+/* Keys the filter was sized for */
+uint32_t bloom_filter_capacity(const st_bloom_filter_t *const p_filter)
+{
+    return (uint32_t)(((uint64_t)p_filter->block_count * BLOOM_BLOCK_BITS) / BLOOM_BITS_PER_KEY);
+}
+
+void bloom_filter_clear(st_bloom_filter_t *const p_filter)
+{
+    if ((NULL == p_filter) || (NULL == p_filter->p_blocks))
+    {
+        return;
+    }
+
+    memset(p_filter->p_blocks, 0, (size_t)p_filter->block_count * BLOOM_BLOCK_WORDS * sizeof(uint32_t));
+    p_filter->key_count = 0;
+}
+
+void bloom_filter_destroy(st_bloom_filter_t *const p_filter)
+{
+    if (NULL == p_filter)
+    {
+        return;
+    }
+
+    free(p_filter->p_blocks);
+    p_filter->p_blocks    = NULL;
+    p_filter->block_count = 0;
+    p_filter->key_count   = 0;
+}
\ No newline at end of file
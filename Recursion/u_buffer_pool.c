@@ -0,0 +1,291 @@
+#define _POSIX_C_SOURCE 200809L
+#include <unistd.h>
+
+#include "u_buffer_pool.h"
+
+static uint32_t page_bucket(const st_buffer_pool_t *const p_pool, const uint32_t page_id);
+static uint32_t find_frame(const st_buffer_pool_t *const p_pool, const uint32_t page_id);
+static void unlink_frame(st_buffer_pool_t *const p_pool, const uint32_t frame);
+static e_retcode_t write_back(st_buffer_pool_t *const p_pool, const uint32_t frame);
+static uint32_t pick_victim(st_buffer_pool_t *const p_pool);
+
+static uint32_t page_bucket(const st_buffer_pool_t *const p_pool, const uint32_t page_id)
+{
+    return ((page_id * 2654435761u) >> 7) & p_pool->bucket_mask;
+}
+
+static uint32_t find_frame(const st_buffer_pool_t *const p_pool, const uint32_t page_id)
+{
+    uint32_t frame;
+
+    for (frame = p_pool->p_buckets[page_bucket(p_pool, page_id)]; BUFFER_POOL_NO_PAGE != frame; frame = p_pool->p_frames[frame].next)
+    {
+        if (page_id == p_pool->p_frames[frame].page_id)
+        {
+            break;
+        }
+    }
+
+    return frame;
+}
+
+static void unlink_frame(st_buffer_pool_t *const p_pool, const uint32_t frame)
+{
+    uint32_t *p_link = &p_pool->p_buckets[page_bucket(p_pool, p_pool->p_frames[frame].page_id)];
+
+    while (frame != *p_link)
+    {
+        p_link = &p_pool->p_frames[*p_link].next;
+    }
+
+    *p_link = p_pool->p_frames[frame].next;
+}
+
+static e_retcode_t write_back(st_buffer_pool_t *const p_pool, const uint32_t frame)
+{
+    st_buffer_frame_t   *p_frame = &p_pool->p_frames[frame];
+    const uint8_t       *p_page  = &p_pool->p_pages[(size_t)frame * DISK_TREE_PAGE_SIZE];
+    size_t              done     = 0;
+    ssize_t             written;
+
+    while (done < DISK_TREE_PAGE_SIZE)
+    {
+        written = pwrite(p_pool->fd, &p_page[done], DISK_TREE_PAGE_SIZE - done, ((off_t)p_frame->page_id * DISK_TREE_PAGE_SIZE) + (off_t)done);
+        if (0 >= written)
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        done += (size_t)written;
+    }
+
+    p_frame->dirty = false;
+    p_pool->write_backs++;
+
+    return RET_ERRCODE_OK;
+}
+
+/* CLOCK: skip pinned frames, give referenced ones a second chance. Two sweeps find any unpinned frame */
+static uint32_t pick_victim(st_buffer_pool_t *const p_pool)
+{
+    st_buffer_frame_t   *p_frame;
+    uint32_t            frame;
+    uint32_t            step;
+
+    for (step = 0; step < (2 * p_pool->frame_count); step++)
+    {
+        frame              = p_pool->clock_hand;
+        p_frame            = &p_pool->p_frames[frame];
+        p_pool->clock_hand = (frame + 1) % p_pool->frame_count;
+
+        if (0 < p_frame->pin_count)
+        {
+            continue;
+        }
+
+        if (true == p_frame->referenced)
+        {
+            p_frame->referenced = false;
+            continue;
+        }
+
+        return frame;
+    }
+
+    return BUFFER_POOL_NO_PAGE;
+}
+
+e_retcode_t buffer_pool_init(st_buffer_pool_t *const p_pool, const int fd, const uint32_t frame_count)
+{
+    uint32_t bucket_count = 1;
+    uint32_t i;
+
+    if (NULL == p_pool)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((BUFFER_POOL_MIN_FRAMES > frame_count) || ((UINT32_MAX / 2) < frame_count))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    while (bucket_count < (2 * frame_count))
+    {
+        bucket_count *= 2;
+    }
+
+    memset(p_pool, 0, sizeof(st_buffer_pool_t));
+    p_pool->fd          = fd;
+    p_pool->frame_count = frame_count;
+    p_pool->bucket_mask = bucket_count - 1;
+    p_pool->p_pages     = (uint8_t *)aligned_alloc(DISK_TREE_PAGE_SIZE, (size_t)frame_count * DISK_TREE_PAGE_SIZE);
+    p_pool->p_frames    = (st_buffer_frame_t *)calloc(frame_count, sizeof(st_buffer_frame_t));
+    p_pool->p_buckets   = (uint32_t *)malloc(bucket_count * sizeof(uint32_t));
+
+    if ((NULL == p_pool->p_pages) || (NULL == p_pool->p_frames) || (NULL == p_pool->p_buckets))
+    {
+        free(p_pool->p_pages);
+        free(p_pool->p_frames);
+        free(p_pool->p_buckets);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    for (i = 0; i < frame_count; i++)
+    {
+        p_pool->p_frames[i].page_id = BUFFER_POOL_NO_PAGE;
+        p_pool->p_frames[i].next    = BUFFER_POOL_NO_PAGE;
+    }
+
+    for (i = 0; i < bucket_count; i++)
+    {
+        p_pool->p_buckets[i] = BUFFER_POOL_NO_PAGE;
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Pin page_id in a frame and return its bytes. A page that is not resident replaces the
+    CLOCK victim, which is written back first when dirty. is_new skips the read and hands
+    out a zeroed page, for pages past the end of the file.
+    Fails with RET_ERRCODE_NG_SYSTEM when every frame is pinned or on I/O errors.
+*/
+e_retcode_t buffer_pool_pin(st_buffer_pool_t *const p_pool, const uint32_t page_id, const bool_t is_new, uint8_t **const pp_page)
+{
+    st_buffer_frame_t   *p_frame;
+    uint8_t             *p_page;
+    uint32_t            frame;
+    uint32_t            bucket;
+    size_t              done = 0;
+    ssize_t             bytes;
+
+    if ((NULL == p_pool) || (NULL == pp_page))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    frame = find_frame(p_pool, page_id);
+
+    if (BUFFER_POOL_NO_PAGE != frame)
+    {
+        p_frame = &p_pool->p_frames[frame];
+        p_frame->pin_count++;
+        p_frame->referenced = true;
+        p_pool->hits++;
+
+        *pp_page = &p_pool->p_pages[(size_t)frame * DISK_TREE_PAGE_SIZE];
+
+        return RET_ERRCODE_OK;
+    }
+
+    frame = pick_victim(p_pool);
+    if (BUFFER_POOL_NO_PAGE == frame)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_frame = &p_pool->p_frames[frame];
+    p_page  = &p_pool->p_pages[(size_t)frame * DISK_TREE_PAGE_SIZE];
+
+    if ((true == p_frame->dirty) && (RET_ERRCODE_OK != write_back(p_pool, frame)))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    if (BUFFER_POOL_NO_PAGE != p_frame->page_id)
+    {
+        unlink_frame(p_pool, frame);
+        p_frame->page_id = BUFFER_POOL_NO_PAGE;
+    }
+
+    if (false == is_new)
+    {
+        do
+        {
+            bytes = pread(p_pool->fd, &p_page[done], DISK_TREE_PAGE_SIZE - done, ((off_t)page_id * DISK_TREE_PAGE_SIZE) + (off_t)done);
+            if (0 > bytes)
+            {
+                return RET_ERRCODE_NG_SYSTEM;
+            }
+
+            done += (size_t)bytes;
+        } while ((0 < bytes) && (done < DISK_TREE_PAGE_SIZE));
+    }
+
+    /* The last page of an image may be short */
+    memset(&p_page[done], 0, DISK_TREE_PAGE_SIZE - done);
+
+    bucket                    = page_bucket(p_pool, page_id);
+    p_frame->page_id          = page_id;
+    p_frame->pin_count        = 1;
+    p_frame->dirty            = is_new;
+    p_frame->referenced       = true;
+    p_frame->next             = p_pool->p_buckets[bucket];
+    p_pool->p_buckets[bucket] = frame;
+    p_pool->misses++;
+
+    *pp_page = p_page;
+
+    return RET_ERRCODE_OK;
+}
+
+/* Every pin is matched by one unpin; dirty marks the page for write-back */
+void buffer_pool_unpin(st_buffer_pool_t *const p_pool, const uint32_t page_id, const bool_t dirty)
+{
+    uint32_t frame;
+
+    if (NULL == p_pool)
+    {
+        return;
+    }
+
+    frame = find_frame(p_pool, page_id);
+
+    if ((BUFFER_POOL_NO_PAGE != frame) && (0 < p_pool->p_frames[frame].pin_count))
+    {
+        p_pool->p_frames[frame].pin_count--;
+        p_pool->p_frames[frame].dirty |= dirty;
+    }
+}
+
+/* Write back every dirty page, pinned or not. Pages stay resident */
+e_retcode_t buffer_pool_flush(st_buffer_pool_t *const p_pool)
+{
+    uint32_t frame;
+
+    if (NULL == p_pool)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    for (frame = 0; frame < p_pool->frame_count; frame++)
+    {
+        if ((true == p_pool->p_frames[frame].dirty) && (RET_ERRCODE_OK != write_back(p_pool, frame)))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/* Flush and release the frames. The file descriptor belongs to the caller */
+e_retcode_t buffer_pool_destroy(st_buffer_pool_t *const p_pool)
+{
+    e_retcode_t ret;
+
+    if (NULL == p_pool)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    ret = buffer_pool_flush(p_pool);
+
+    free(p_pool->p_pages);
+    free(p_pool->p_frames);
+    free(p_pool->p_buckets);
+    memset(p_pool, 0, sizeof(st_buffer_pool_t));
+
+    return ret;
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "u_buffered_tree.h"
+
+static int32_t buffer_position(const st_buffered_tree_t *const p_tree, const int32_t key);
+
+/* Index of the first buffered key >= key */
+static int32_t buffer_position(const st_buffered_tree_t *const p_tree, const int32_t key)
+{
+    int32_t low  = 0;
+    int32_t high = p_tree->count;
+    int32_t middle;
+
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+
+        if (p_tree->p_buffer[middle] < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+e_retcode_t buffered_tree_init(st_buffered_tree_t *const p_tree, const int32_t capacity)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (0 >= capacity)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    p_tree->p_root   = NULL;
+    p_tree->count    = 0;
+    p_tree->capacity = capacity;
+    p_tree->p_buffer = (int32_t *)malloc((size_t)capacity * sizeof(int32_t));
+    if (NULL == p_tree->p_buffer)
+    {
+        p_tree->capacity = 0;
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/* Keys already in the tree are not looked up here, the flush drops them */
+e_retcode_t buffered_tree_insert(st_buffered_tree_t *const p_tree, const int32_t key)
+{
+    e_retcode_t ret;
+    int32_t     position;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    position = buffer_position(p_tree, key);
+    if ((position < p_tree->count) && (key == p_tree->p_buffer[position]))
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    if (p_tree->count == p_tree->capacity)
+    {
+        ret = buffered_tree_flush(p_tree, NULL);
+        if (RET_ERRCODE_OK != ret)
+        {
+            return ret;
+        }
+
+        position = 0;
+    }
+
+    memmove(&p_tree->p_buffer[position + 1], &p_tree->p_buffer[position], (size_t)(p_tree->count - position) * sizeof(int32_t));
+    p_tree->p_buffer[position] = key;
+    p_tree->count++;
+
+    return RET_ERRCODE_OK;
+}
+
+bool_t buffered_tree_search(const st_buffered_tree_t *const p_tree, const int32_t searched_key)
+{
+    int32_t position;
+
+    if (NULL == p_tree)
+    {
+        return false;
+    }
+
+    position = buffer_position(p_tree, searched_key);
+    if ((position < p_tree->count) && (searched_key == p_tree->p_buffer[position]))
+    {
+        return true;
+    }
+
+    return (NULL != search(p_tree->p_root, searched_key));
+}
+
+e_retcode_t buffered_tree_delete(st_buffered_tree_t *const p_tree, const int32_t key)
+{
+    int32_t position;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    position = buffer_position(p_tree, key);
+    if ((position < p_tree->count) && (key == p_tree->p_buffer[position]))
+    {
+        memmove(&p_tree->p_buffer[position], &p_tree->p_buffer[position + 1], (size_t)(p_tree->count - position - 1) * sizeof(int32_t));
+        p_tree->count--;
+
+        /* The key may also have reached the tree in an earlier flush */
+        if (NULL == search(p_tree->p_root, key))
+        {
+            return RET_ERRCODE_OK;
+        }
+    }
+
+    return delete(&p_tree->p_root, key);
+}
+
+/*
+    Apply the buffered run to the tree, *p_inserted (may be NULL) gets the number of keys
+    actually added. Out of memory, the keys not applied yet stay buffered.
+*/
+e_retcode_t buffered_tree_flush(st_buffered_tree_t *const p_tree, int32_t *const p_inserted)
+{
+    e_retcode_t ret;
+    int32_t     done;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    ret = tree_insert_batch(&p_tree->p_root, p_tree->p_buffer, p_tree->count, p_inserted, &done);
+
+    if (done < p_tree->count)
+    {
+        memmove(p_tree->p_buffer, &p_tree->p_buffer[done], (size_t)(p_tree->count - done) * sizeof(int32_t));
+    }
+    p_tree->count -= done;
+
+    return ret;
+}
+
+void buffered_tree_destroy(st_buffered_tree_t *const p_tree)
+{
+    if (NULL != p_tree)
+    {
+        tree_destroy(&p_tree->p_root);
+        free(p_tree->p_buffer);
+        p_tree->p_buffer = NULL;
+        p_tree->count    = 0;
+        p_tree->capacity = 0;
+    }
+}
\ No newline at end of file
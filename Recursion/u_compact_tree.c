@@ -0,0 +1,153 @@
+#include "u_compact_tree.h"
+
+static uint32_t count_nodes(const st_tree_node_t *const p_tree_node);
+
+static uint32_t count_nodes(const st_tree_node_t *const p_tree_node)
+{
+    uint32_t count = 0;
+
+    if (NULL != p_tree_node)
+    {
+        count = 1 + count_nodes(p_tree_node->p_left_child)
+                  + count_nodes(p_tree_node->p_middle_child)
+                  + count_nodes(p_tree_node->p_right_child);
+    }
+
+    return count;
+}
+
+e_retcode_t compact_tree_build(const st_tree_node_t *const p_root, st_compact_tree_t *const p_tree)
+{
+    e_retcode_t             ret = RET_ERRCODE_OK;
+    const st_tree_node_t    **pp_queue;
+    const st_tree_node_t    *p_node;
+    uint32_t                head;
+    uint32_t                tail;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_tree, 0, sizeof(st_compact_tree_t));
+    p_tree->node_count = count_nodes(p_root);
+
+    if (0 == p_tree->node_count)
+    {
+        return ret;
+    }
+
+    pp_queue              = (const st_tree_node_t **)malloc(p_tree->node_count * sizeof(st_tree_node_t *));
+    p_tree->p_keys        = (int32_t *)malloc(p_tree->node_count * MAX_KEY * sizeof(int32_t));
+    p_tree->p_first_child = (uint32_t *)malloc(p_tree->node_count * sizeof(uint32_t));
+
+    if ((NULL == pp_queue) || (NULL == p_tree->p_keys) || (NULL == p_tree->p_first_child))
+    {
+        free(pp_queue);
+        compact_tree_destroy(p_tree);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    /* Breadth-first walk: every leaf is on the last level, so internal nodes come first */
+    pp_queue[0] = p_root;
+    head        = 0;
+    tail        = 1;
+
+    while (head < tail)
+    {
+        p_node = pp_queue[head];
+
+        p_tree->p_keys[(MAX_KEY * head) + FIRST_KEY]  = p_node->keys[FIRST_KEY];
+        p_tree->p_keys[(MAX_KEY * head) + SECOND_KEY] = p_node->keys[SECOND_KEY];
+        p_tree->key_count += ((-1) != p_node->keys[SECOND_KEY]) ? 2 : 1;
+
+        if (NULL != p_node->p_left_child)
+        {
+            p_tree->p_first_child[head] = tail;
+            p_tree->internal_count      = head + 1;
+
+            pp_queue[tail++] = p_node->p_left_child;
+            pp_queue[tail++] = p_node->p_middle_child;
+
+            if ((-1) != p_node->keys[SECOND_KEY])
+            {
+                pp_queue[tail++] = p_node->p_right_child;
+            }
+        }
+
+        head++;
+    }
+
+    free(pp_queue);
+
+    /* Leaves do not need a child index */
+    if (0 == p_tree->internal_count)
+    {
+        free(p_tree->p_first_child);
+        p_tree->p_first_child = NULL;
+    }
+    else
+    {
+        p_tree->p_first_child = (uint32_t *)realloc(p_tree->p_first_child, p_tree->internal_count * sizeof(uint32_t));
+    }
+
+    return ret;
+}
+
+bool_t compact_tree_search(const st_compact_tree_t *const p_tree, const int32_t searched_key)
+{
+    const int32_t   *p_keys;
+    uint32_t        index;
+    uint32_t        slot;
+
+    /* -1 marks a blank slot, it can never be a stored key */
+    if ((NULL == p_tree) || (0 == p_tree->node_count) || ((-1) == searched_key))
+    {
+        return false;
+    }
+
+    index = 0;
+
+    while (true)
+    {
+        p_keys = &p_tree->p_keys[MAX_KEY * index];
+
+        if ((searched_key == p_keys[FIRST_KEY]) || (searched_key == p_keys[SECOND_KEY]))
+        {
+            return true;
+        }
+
+        if (index >= p_tree->internal_count)
+        {
+            return false;
+        }
+
+        /* 0: left, 1: middle, 2: right. A blank second key never sends us right */
+        slot  = (uint32_t)(searched_key > p_keys[FIRST_KEY]);
+        slot += (uint32_t)(((-1) != p_keys[SECOND_KEY]) && (searched_key > p_keys[SECOND_KEY]));
+
+        index = p_tree->p_first_child[index] + slot;
+    }
+}
+
+size_t compact_tree_bytes(const st_compact_tree_t *const p_tree)
+{
+    size_t bytes = 0;
+
+    if (NULL != p_tree)
+    {
+        bytes = (p_tree->node_count * MAX_KEY * sizeof(int32_t)) + (p_tree->internal_count * sizeof(uint32_t));
+    }
+
+    return bytes;
+}
+
+void compact_tree_destroy(st_compact_tree_t *const p_tree)
+{
+    if (NULL != p_tree)
+    {
+        free(p_tree->p_keys);
+        free(p_tree->p_first_child);
+        memset(p_tree, 0, sizeof(st_compact_tree_t));
+    }
+}
\ No newline at end of file
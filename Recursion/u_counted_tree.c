@@ -0,0 +1,356 @@
+#include "u_counted_tree.h"
+
+static inline int64_t *node_total(const st_tree_node_t *const p_tree_node);
+static inline int64_t subtree_total(const st_tree_node_t *const p_tree_node);
+static void update_total(st_tree_node_t *p_tree_node, void *p_ctx);
+static void adjust_path(const st_tree_path_t *const p_path, const int64_t delta);
+static uint64_t occurrences_below(const st_tree_node_t *p_tree_node, const int32_t key, const bool_t inclusive);
+static int32_t scan_counts(const st_tree_node_t *const p_tree_node, const int32_t low, const int32_t high, pf_count_visitor_t pf_visitor, void *p_ctx);
+
+/* Summary of a node: occurrences of all keys in its subtree */
+static const st_tree_augment_t count_augment = { update_total, NULL };
+
+/* Every node of a counted tree is an st_summary_node_t */
+static inline int64_t *node_total(const st_tree_node_t *const p_tree_node)
+{
+    return &((st_summary_node_t *)p_tree_node)->summary;
+}
+
+static inline int64_t subtree_total(const st_tree_node_t *const p_tree_node)
+{
+    return (NULL != p_tree_node) ? *node_total(p_tree_node) : 0;
+}
+
+static void update_total(st_tree_node_t *p_tree_node, void *p_ctx)
+{
+    int64_t total;
+
+    (void)p_ctx;
+
+    total = (int64_t)p_tree_node->values[FIRST_KEY]
+          + subtree_total(p_tree_node->p_left_child)
+          + subtree_total(p_tree_node->p_middle_child)
+          + subtree_total(p_tree_node->p_right_child);
+
+    /* A blank key may keep a stale value */
+    if ((-1) != p_tree_node->keys[SECOND_KEY])
+    {
+        total += (int64_t)p_tree_node->values[SECOND_KEY];
+    }
+
+    *node_total(p_tree_node) = total;
+}
+
+/* The count of the last node of the path changed by delta: no sibling has to be read */
+static void adjust_path(const st_tree_path_t *const p_path, const int64_t delta)
+{
+    int32_t level;
+
+    for (level = 0; level < p_path->depth; level++)
+    {
+        *node_total(p_path->p_nodes[level]) += delta;
+    }
+}
+
+/* Occurrences of the keys below key, or not above it when inclusive, in one descent */
+static uint64_t occurrences_below(const st_tree_node_t *p_tree_node, const int32_t key, const bool_t inclusive)
+{
+    const st_tree_node_t    *p_children[MAX_KEY + 1];
+    uint64_t                below = 0;
+    int32_t                 key_count;
+    int32_t                 i;
+
+    while (NULL != p_tree_node)
+    {
+        p_children[LEFT]   = p_tree_node->p_left_child;
+        p_children[MIDDLE] = p_tree_node->p_middle_child;
+        p_children[RIGHT]  = p_tree_node->p_right_child;
+        key_count          = ((-1) != p_tree_node->keys[SECOND_KEY]) ? 2 : 1;
+
+        for (i = 0; (i < key_count) && (key > p_tree_node->keys[i]); i++)
+        {
+            below += (uint64_t)subtree_total(p_children[i]) + p_tree_node->values[i];
+        }
+
+        if ((i < key_count) && (key == p_tree_node->keys[i]))
+        {
+            below += (uint64_t)subtree_total(p_children[i]);
+            below += (true == inclusive) ? p_tree_node->values[i] : 0;
+            break;
+        }
+
+        p_tree_node = p_children[i];
+    }
+
+    return below;
+}
+
+/* tree_range_scan() that hands each key over with its count */
+static int32_t scan_counts(const st_tree_node_t *const p_tree_node, const int32_t low, const int32_t high, pf_count_visitor_t pf_visitor, void *p_ctx)
+{
+    int32_t visited = 0;
+
+    if (NULL == p_tree_node)
+    {
+        return 0;
+    }
+
+    if (low < p_tree_node->keys[FIRST_KEY])
+    {
+        visited += scan_counts(p_tree_node->p_left_child, low, high, pf_visitor, p_ctx);
+    }
+
+    if ((low <= p_tree_node->keys[FIRST_KEY]) && (p_tree_node->keys[FIRST_KEY] <= high))
+    {
+        pf_visitor(p_tree_node->keys[FIRST_KEY], (uint64_t)p_tree_node->values[FIRST_KEY], p_ctx);
+        visited++;
+    }
+
+    if ((-1) == p_tree_node->keys[SECOND_KEY])
+    {
+        if (high > p_tree_node->keys[FIRST_KEY])
+        {
+            visited += scan_counts(p_tree_node->p_middle_child, low, high, pf_visitor, p_ctx);
+        }
+    }
+    else
+    {
+        if ((high > p_tree_node->keys[FIRST_KEY]) && (low < p_tree_node->keys[SECOND_KEY]))
+        {
+            visited += scan_counts(p_tree_node->p_middle_child, low, high, pf_visitor, p_ctx);
+        }
+
+        if ((low <= p_tree_node->keys[SECOND_KEY]) && (p_tree_node->keys[SECOND_KEY] <= high))
+        {
+            pf_visitor(p_tree_node->keys[SECOND_KEY], (uint64_t)p_tree_node->values[SECOND_KEY], p_ctx);
+            visited++;
+        }
+
+        if (high > p_tree_node->keys[SECOND_KEY])
+        {
+            visited += scan_counts(p_tree_node->p_right_child, low, high, pf_visitor, p_ctx);
+        }
+    }
+
+    return visited;
+}
+
+e_retcode_t counted_tree_init(st_counted_tree_t *const p_tree)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_tree, 0, sizeof(st_counted_tree_t));
+
+    return RET_ERRCODE_OK;
+}
+
+/* Add one occurrence of key. A key already present only has its count raised, in the same descent */
+e_retcode_t counted_tree_insert(st_counted_tree_t *const p_tree, const int32_t key)
+{
+    const st_node_allocator_t   *p_previous_allocator;
+    const st_tree_augment_t     *p_previous;
+    st_tree_path_t              path;
+    uintptr_t                   *p_slot;
+    bool_t                      inserted = false;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    path.depth = 0;
+
+    p_previous_allocator = tree_bind_node_allocator(tree_summary_allocator());
+    p_previous           = tree_bind_augment(&count_augment);
+    p_slot               = tree_path_insert_or_get(&p_tree->p_root, &path, key, 1, &inserted);
+    (void)tree_bind_augment(p_previous);
+    (void)tree_bind_node_allocator(p_previous_allocator);
+
+    if (NULL == p_slot)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    if (true == inserted)
+    {
+        p_tree->key_count++;
+    }
+    else
+    {
+        (*p_slot)++;
+        adjust_path(&path, 1);
+    }
+
+    p_tree->total++;
+
+    return RET_ERRCODE_OK;
+}
+
+/* Remove one occurrence of key. The key leaves the tree with its last occurrence; absent keys are ignored */
+e_retcode_t counted_tree_delete(st_counted_tree_t *const p_tree, const int32_t key)
+{
+    const st_node_allocator_t   *p_previous_allocator;
+    const st_tree_augment_t     *p_previous;
+    st_tree_path_t              path;
+    st_tree_node_t              *p_tree_node;
+    uintptr_t                   *p_slot;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    path.depth = 0;
+
+    p_tree_node = tree_path_search(p_tree->p_root, &path, key);
+    if (NULL == p_tree_node)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    p_slot = (key == p_tree_node->keys[FIRST_KEY]) ? &p_tree_node->values[FIRST_KEY] : &p_tree_node->values[SECOND_KEY];
+
+    if (1 < *p_slot)
+    {
+        (*p_slot)--;
+        adjust_path(&path, -1);
+    }
+    else
+    {
+        p_previous_allocator = tree_bind_node_allocator(tree_summary_allocator());
+        p_previous           = tree_bind_augment(&count_augment);
+        (void)tree_remove(&p_tree->p_root, key);
+        (void)tree_bind_augment(p_previous);
+        (void)tree_bind_node_allocator(p_previous_allocator);
+
+        p_tree->key_count--;
+    }
+
+    p_tree->total--;
+
+    return RET_ERRCODE_OK;
+}
+
+/* Occurrences of key, 0 when absent */
+uint64_t counted_tree_count(const st_counted_tree_t *const p_tree, const int32_t key)
+{
+    uintptr_t count = 0;
+
+    if ((NULL == p_tree) || (false == tree_get_value(p_tree->p_root, key, &count)))
+    {
+        return 0;
+    }
+
+    return (uint64_t)count;
+}
+
+/* Occurrences of all keys below key; key itself need not be present */
+uint64_t counted_tree_rank(const st_counted_tree_t *const p_tree, const int32_t key)
+{
+    if (NULL == p_tree)
+    {
+        return 0;
+    }
+
+    return occurrences_below(p_tree->p_root, key, false);
+}
+
+/* Key of the occurrence at rank (from 0) in ascending order. Returns false when rank >= total */
+bool_t counted_tree_select(const st_counted_tree_t *const p_tree, const uint64_t rank, int32_t *const p_key)
+{
+    const st_tree_node_t    *p_tree_node;
+    const st_tree_node_t    *p_children[MAX_KEY + 1];
+    uint64_t                remaining = rank;
+    uint64_t                left;
+    int32_t                 key_count;
+    int32_t                 i;
+
+    if ((NULL == p_tree) || (NULL == p_key) || (rank >= p_tree->total))
+    {
+        return false;
+    }
+
+    p_tree_node = p_tree->p_root;
+
+    while (NULL != p_tree_node)
+    {
+        p_children[LEFT]   = p_tree_node->p_left_child;
+        p_children[MIDDLE] = p_tree_node->p_middle_child;
+        p_children[RIGHT]  = p_tree_node->p_right_child;
+        key_count          = ((-1) != p_tree_node->keys[SECOND_KEY]) ? 2 : 1;
+
+        for (i = 0; i < key_count; i++)
+        {
+            left = (uint64_t)subtree_total(p_children[i]);
+            if (remaining < left)
+            {
+                break;
+            }
+
+            remaining -= left;
+
+            if (remaining < p_tree_node->values[i])
+            {
+                *p_key = p_tree_node->keys[i];
+                return true;
+            }
+
+            remaining -= p_tree_node->values[i];
+        }
+
+        p_tree_node = p_children[i];
+    }
+
+    return false;
+}
+
+/* Occurrences of the keys in [low, high], in two descents whatever the size of the range */
+uint64_t counted_tree_count_range(const st_counted_tree_t *const p_tree, const int32_t low, const int32_t high)
+{
+    if ((NULL == p_tree) || (low > high))
+    {
+        return 0;
+    }
+
+    return occurrences_below(p_tree->p_root, high, true) - occurrences_below(p_tree->p_root, low, false);
+}
+
+/* Visit every key in [low, high] once, in ascending order, with its count. Returns the keys visited */
+int32_t counted_tree_range_scan(const st_counted_tree_t *const p_tree, const int32_t low, const int32_t high, pf_count_visitor_t pf_visitor, void *p_ctx)
+{
+    if ((NULL == p_tree) || (NULL == pf_visitor) || (low > high))
+    {
+        return 0;
+    }
+
+    return scan_counts(p_tree->p_root, low, high, pf_visitor, p_ctx);
+}
+
+void counted_tree_destroy(st_counted_tree_t *const p_tree)
+{
+    const st_node_allocator_t *p_previous_allocator;
+
+    if (NULL == p_tree)
+    {
+        return;
+    }
+
+    p_previous_allocator = tree_bind_node_allocator(tree_summary_allocator());
+    tree_destroy(&p_tree->p_root);
+    (void)tree_bind_node_allocator(p_previous_allocator);
+    p_tree->key_count = 0;
+    p_tree->total     = 0;
+}
\ No newline at end of file
@@ -0,0 +1,470 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "u_disk_tree.h"
+
+/* Buffered sequential reader of int32 keys */
+typedef struct
+{
+    int         fd;
+    int32_t     *p_keys;
+    size_t      capacity;
+    size_t      count;
+    size_t      position;
+} st_key_reader_t;
+
+/* Buffered sequential writer of int32 keys (a spilled level) */
+typedef struct
+{
+    int         fd;
+    int32_t     *p_keys;
+    size_t      capacity;
+    size_t      count;
+} st_key_writer_t;
+
+/* Buffered writer of consecutive node ids into the image */
+typedef struct
+{
+    int         fd;
+    uint8_t     *p_bytes;
+    size_t      capacity;
+    size_t      used;
+    uint64_t    base_offset;    /**< File offset of p_bytes[0] */
+    uint32_t    next_id;
+} st_node_writer_t;
+
+typedef struct
+{
+    uint64_t    key_count;
+    uint32_t    height;
+    uint64_t    node_count[TREE_MAX_HEIGHT];
+    uint32_t    first_id[TREE_MAX_HEIGHT];
+} st_level_plan_t;
+
+static bool_t write_all(const int fd, const void *const p_data, const size_t size, const uint64_t offset);
+static bool_t read_key(st_key_reader_t *const p_reader, int32_t *const p_key);
+static e_retcode_t flush_keys(st_key_writer_t *const p_writer);
+static e_retcode_t write_key(st_key_writer_t *const p_writer, const int32_t key);
+static e_retcode_t flush_nodes(st_node_writer_t *const p_writer);
+static e_retcode_t write_node(st_node_writer_t *const p_writer, const st_disk_node_t *const p_node);
+static e_retcode_t plan_levels(st_level_plan_t *const p_plan, const uint64_t key_count);
+static uint64_t level_quota(const st_level_plan_t *const p_plan, const uint32_t level, const uint64_t index);
+static e_retcode_t build_level(const st_level_plan_t *const p_plan, const uint32_t level, st_key_reader_t *const p_input, st_key_writer_t *const p_spill, st_node_writer_t *const p_image);
+static e_retcode_t write_header(const int fd, const st_level_plan_t *const p_plan);
+
+/* Page 0 is the header */
+uint64_t disk_tree_node_offset(const uint32_t node_id)
+{
+    return (((uint64_t)(node_id / DISK_NODES_PER_PAGE) + 1) * DISK_TREE_PAGE_SIZE) + ((node_id % DISK_NODES_PER_PAGE) * sizeof(st_disk_node_t));
+}
+
+static bool_t write_all(const int fd, const void *const p_data, const size_t size, const uint64_t offset)
+{
+    const uint8_t   *p_bytes = (const uint8_t *)p_data;
+    size_t          done     = 0;
+    ssize_t         written;
+
+    while (done < size)
+    {
+        written = pwrite(fd, &p_bytes[done], size - done, (off_t)(offset + done));
+        if (0 >= written)
+        {
+            return false;
+        }
+
+        done += (size_t)written;
+    }
+
+    return true;
+}
+
+static bool_t read_key(st_key_reader_t *const p_reader, int32_t *const p_key)
+{
+    uint8_t *p_bytes = (uint8_t *)p_reader->p_keys;
+    size_t  filled   = 0;
+    ssize_t bytes;
+
+    if (p_reader->position == p_reader->count)
+    {
+        /* Refill with whole keys only, a short read may stop inside one */
+        do
+        {
+            bytes = read(p_reader->fd, &p_bytes[filled], (p_reader->capacity * sizeof(int32_t)) - filled);
+            if (0 < bytes)
+            {
+                filled += (size_t)bytes;
+            }
+        } while ((0 < bytes) && (0 != (filled % sizeof(int32_t))));
+
+        p_reader->count    = filled / sizeof(int32_t);
+        p_reader->position = 0;
+
+        if (0 == p_reader->count)
+        {
+            return false;
+        }
+    }
+
+    *p_key = p_reader->p_keys[p_reader->position++];
+
+    return true;
+}
+
+static e_retcode_t flush_keys(st_key_writer_t *const p_writer)
+{
+    const uint8_t   *p_bytes = (const uint8_t *)p_writer->p_keys;
+    size_t          size     = p_writer->count * sizeof(int32_t);
+    size_t          done     = 0;
+    ssize_t         written;
+
+    while (done < size)
+    {
+        written = write(p_writer->fd, &p_bytes[done], size - done);
+        if (0 >= written)
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        done += (size_t)written;
+    }
+
+    p_writer->count = 0;
+
+    return RET_ERRCODE_OK;
+}
+
+static e_retcode_t write_key(st_key_writer_t *const p_writer, const int32_t key)
+{
+    if ((p_writer->count == p_writer->capacity) && (RET_ERRCODE_OK != flush_keys(p_writer)))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_writer->p_keys[p_writer->count++] = key;
+
+    return RET_ERRCODE_OK;
+}
+
+static e_retcode_t flush_nodes(st_node_writer_t *const p_writer)
+{
+    if ((0 < p_writer->used) && (false == write_all(p_writer->fd, p_writer->p_bytes, p_writer->used, p_writer->base_offset)))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    /* Page tails are padding: keep them zeroed */
+    memset(p_writer->p_bytes, 0, p_writer->used);
+    p_writer->used = 0;
+
+    return RET_ERRCODE_OK;
+}
+
+/* Ids of one level are consecutive, so the buffer always maps one contiguous file range */
+static e_retcode_t write_node(st_node_writer_t *const p_writer, const st_disk_node_t *const p_node)
+{
+    uint64_t offset = disk_tree_node_offset(p_writer->next_id);
+
+    if ((0 == p_writer->used) || ((offset + sizeof(st_disk_node_t)) > (p_writer->base_offset + p_writer->capacity)))
+    {
+        if (RET_ERRCODE_OK != flush_nodes(p_writer))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        p_writer->base_offset = offset;
+    }
+
+    memcpy(&p_writer->p_bytes[offset - p_writer->base_offset], p_node, sizeof(st_disk_node_t));
+    p_writer->used = (size_t)(offset - p_writer->base_offset) + sizeof(st_disk_node_t);
+    p_writer->next_id++;
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Fewest nodes per level, as in tree_compact(): count keys need ceil((count + 1) / 3)
+    leaves and n children need ceil(n / 3) parents. Knowing every level size up front
+    gives every node its final id before anything is written.
+*/
+static e_retcode_t plan_levels(st_level_plan_t *const p_plan, const uint64_t key_count)
+{
+    uint64_t    total;
+    uint32_t    level = 0;
+
+    memset(p_plan, 0, sizeof(st_level_plan_t));
+    p_plan->key_count = key_count;
+
+    if (0 == key_count)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    p_plan->node_count[0] = (key_count + 3) / 3;
+
+    while (1 < p_plan->node_count[level])
+    {
+        if ((level + 1) >= TREE_MAX_HEIGHT)
+        {
+            return RET_ERRCODE_NG_PARAM;
+        }
+
+        p_plan->node_count[level + 1] = (p_plan->node_count[level] + 2) / 3;
+        level++;
+    }
+
+    p_plan->height = level + 1;
+
+    total = 0;
+    for (level = 0; level < p_plan->height; level++)
+    {
+        p_plan->first_id[level] = (uint32_t)total;
+        total                  += p_plan->node_count[level];
+    }
+
+    /* Node ids are 32-bit */
+    return (total < DISK_NODE_NONE) ? RET_ERRCODE_OK : RET_ERRCODE_NG_PARAM;
+}
+
+/* Keys of leaf index, or children of inner node index, spread evenly over the level */
+static uint64_t level_quota(const st_level_plan_t *const p_plan, const uint32_t level, const uint64_t index)
+{
+    uint64_t total;
+    uint64_t nodes = p_plan->node_count[level];
+
+    total = (0 == level) ? (p_plan->key_count - (nodes - 1)) : p_plan->node_count[level - 1];
+
+    return ((total / nodes) + ((index < (total % nodes)) ? 1 : 0));
+}
+
+/*
+    Turn one level's key stream into that level's nodes. A node takes its keys, then the
+    next key separates it from the following node and is spilled as input for the level above.
+    Children are simply the next ids of the level below.
+*/
+static e_retcode_t build_level(const st_level_plan_t *const p_plan, const uint32_t level, st_key_reader_t *const p_input, st_key_writer_t *const p_spill, st_node_writer_t *const p_image)
+{
+    st_disk_node_t  node;
+    uint64_t        index;
+    uint64_t        quota;
+    uint64_t        key_count;
+    uint64_t        i;
+    uint32_t        next_child   = (0 == level) ? DISK_NODE_NONE : p_plan->first_id[level - 1];
+    int32_t         separator;
+    int32_t         previous     = (-1);
+    bool_t          has_previous = false;
+
+    p_image->next_id = p_plan->first_id[level];
+
+    for (index = 0; index < p_plan->node_count[level]; index++)
+    {
+        quota     = level_quota(p_plan, level, index);
+        key_count = (0 == level) ? quota : (quota - 1);
+
+        node.keys[FIRST_KEY]  = (-1);
+        node.keys[SECOND_KEY] = (-1);
+
+        for (i = 0; i < key_count; i++)
+        {
+            if (false == read_key(p_input, &node.keys[i]))
+            {
+                return RET_ERRCODE_NG_PARAM;
+            }
+
+            /* Only the key file can be out of order, spilled levels come from it */
+            if ((0 == level) && (((-1) == node.keys[i]) || ((true == has_previous) && (node.keys[i] <= previous))))
+            {
+                return RET_ERRCODE_NG_PARAM;
+            }
+
+            previous     = node.keys[i];
+            has_previous = true;
+        }
+
+        for (i = 0; i <= MAX_KEY; i++)
+        {
+            node.children[i] = ((0 < level) && (i < quota)) ? next_child++ : DISK_NODE_NONE;
+        }
+
+        if (RET_ERRCODE_OK != write_node(p_image, &node))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        if ((index + 1) < p_plan->node_count[level])
+        {
+            if (false == read_key(p_input, &separator))
+            {
+                return RET_ERRCODE_NG_PARAM;
+            }
+
+            if ((0 == level) && (((-1) == separator) || (separator <= previous)))
+            {
+                return RET_ERRCODE_NG_PARAM;
+            }
+
+            previous = separator;
+
+            if (RET_ERRCODE_OK != write_key(p_spill, separator))
+            {
+                return RET_ERRCODE_NG_SYSTEM;
+            }
+        }
+    }
+
+    if ((RET_ERRCODE_OK != flush_keys(p_spill)) || (RET_ERRCODE_OK != flush_nodes(p_image)))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+static e_retcode_t write_header(const int fd, const st_level_plan_t *const p_plan)
+{
+    uint8_t             page[DISK_TREE_PAGE_SIZE];
+    st_disk_header_t    header;
+    uint64_t            node_count = 0;
+    uint32_t            level;
+
+    for (level = 0; level < p_plan->height; level++)
+    {
+        node_count += p_plan->node_count[level];
+    }
+
+    memset(&header, 0, sizeof(st_disk_header_t));
+    header.magic      = DISK_TREE_MAGIC;
+    header.version    = DISK_TREE_VERSION;
+    header.page_size  = DISK_TREE_PAGE_SIZE;
+    header.height     = p_plan->height;
+    header.root       = (0 < p_plan->height) ? p_plan->first_id[p_plan->height - 1] : DISK_NODE_NONE;
+    header.key_count  = p_plan->key_count;
+    header.node_count = node_count;
+
+    memset(page, 0, sizeof(page));
+    memcpy(page, &header, sizeof(st_disk_header_t));
+
+    return (true == write_all(fd, page, sizeof(page), 0)) ? RET_ERRCODE_OK : RET_ERRCODE_NG_SYSTEM;
+}
+
+/*
+    Build the on-disk image of the tree holding the keys of p_key_path, a file of strictly
+    ascending native int32 keys, without ever loading the tree.
+    Level 0 streams the key file once: leaves go straight to the image and the separators
+    between them are spilled to a scratch file, which is the key stream of level 1, and so
+    on up to the root. Each level is a third of the one below, so the total I/O stays within
+    about 1.5 times the key file. Memory is three fixed buffers carved from memory_budget,
+    whatever the key count. Scratch files sit next to the image and are removed at the end.
+*/
+e_retcode_t disk_tree_build(const char *const p_key_path, const char *const p_image_path, const size_t memory_budget)
+{
+    e_retcode_t         ret          = RET_ERRCODE_OK;
+    st_level_plan_t     plan;
+    st_key_reader_t     reader;
+    st_key_writer_t     spill;
+    st_node_writer_t    image;
+    struct stat         key_stat;
+    char                spill_paths[2][1024];
+    int                 spill_fds[2] = { (-1), (-1) };
+    int                 key_fd;
+    size_t              share;
+    uint32_t            level;
+    int32_t             i;
+
+    if ((NULL == p_key_path) || (NULL == p_image_path))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (DISK_TREE_MIN_BUDGET > memory_budget)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    key_fd = open(p_key_path, O_RDONLY);
+    if (0 > key_fd)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    if ((0 != fstat(key_fd, &key_stat)) || (0 != (key_stat.st_size % sizeof(int32_t)))
+     || (RET_ERRCODE_OK != plan_levels(&plan, (uint64_t)key_stat.st_size / sizeof(int32_t))))
+    {
+        close(key_fd);
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    (void)posix_fadvise(key_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    /* Three equal buffers: level input, spilled separators, image pages */
+    share = (memory_budget / 3) & ~(size_t)(DISK_TREE_PAGE_SIZE - 1);
+
+    memset(&reader, 0, sizeof(reader));
+    memset(&spill, 0, sizeof(spill));
+    memset(&image, 0, sizeof(image));
+
+    reader.capacity = share / sizeof(int32_t);
+    reader.p_keys   = (int32_t *)malloc(share);
+    spill.capacity  = share / sizeof(int32_t);
+    spill.p_keys    = (int32_t *)malloc(share);
+    image.capacity  = share;
+    image.p_bytes   = (uint8_t *)calloc(1, share);
+    image.fd        = open(p_image_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    for (i = 0; i < 2; i++)
+    {
+        (void)snprintf(spill_paths[i], sizeof(spill_paths[i]), "%s.spill%d", p_image_path, (int)i);
+        spill_fds[i] = open(spill_paths[i], O_RDWR | O_CREAT | O_TRUNC, 0600);
+    }
+
+    if ((NULL == reader.p_keys) || (NULL == spill.p_keys) || (NULL == image.p_bytes) || (0 > image.fd) || (0 > spill_fds[0]) || (0 > spill_fds[1]))
+    {
+        ret = RET_ERRCODE_NG_SYSTEM;
+    }
+
+    /* Level l reads the separators level l - 1 spilled, the two scratch files alternate */
+    for (level = 0; (RET_ERRCODE_OK == ret) && (level < plan.height); level++)
+    {
+        reader.fd       = (0 == level) ? key_fd : spill_fds[(level - 1) % 2];
+        reader.count    = 0;
+        reader.position = 0;
+        spill.fd        = spill_fds[level % 2];
+        spill.count     = 0;
+
+        if ((0 != lseek(reader.fd, 0, SEEK_SET)) || (0 != ftruncate(spill.fd, 0)) || (0 != lseek(spill.fd, 0, SEEK_SET)))
+        {
+            ret = RET_ERRCODE_NG_SYSTEM;
+        }
+        else
+        {
+            ret = build_level(&plan, level, &reader, &spill, &image);
+        }
+    }
+
+    if (RET_ERRCODE_OK == ret)
+    {
+        ret = write_header(image.fd, &plan);
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        if (0 <= spill_fds[i])
+        {
+            close(spill_fds[i]);
+            (void)unlink(spill_paths[i]);
+        }
+    }
+
+    if (0 <= image.fd)
+    {
+        close(image.fd);
+    }
+
+    close(key_fd);
+    free(reader.p_keys);
+    free(spill.p_keys);
+    free(image.p_bytes);
+
+    return ret;
+}
\ No newline at end of file
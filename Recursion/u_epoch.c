@@ -0,0 +1,208 @@
+#include "u_epoch.h"
+
+static st_tree_node_t *epoch_alloc_node(void *p_ctx);
+static void epoch_free_node(void *p_ctx, st_tree_node_t *p_tree_node);
+static void reclaim_limbo(st_epoch_domain_t *const p_domain, const int32_t list);
+
+static st_tree_node_t *epoch_alloc_node(void *p_ctx)
+{
+    return node_pool_alloc(((st_epoch_domain_t *)p_ctx)->p_pool);
+}
+
+static void epoch_free_node(void *p_ctx, st_tree_node_t *p_tree_node)
+{
+    epoch_retire((st_epoch_domain_t *)p_ctx, p_tree_node);
+}
+
+/* Called with the lock held */
+static void reclaim_limbo(st_epoch_domain_t *const p_domain, const int32_t list)
+{
+    size_t i;
+
+    for (i = 0; i < p_domain->limbo_count[list]; i++)
+    {
+        node_pool_free(p_domain->p_pool, p_domain->pp_limbo[list][i]);
+    }
+
+    p_domain->reclaimed          += p_domain->limbo_count[list];
+    p_domain->limbo_count[list]   = 0;
+}
+
+e_retcode_t epoch_domain_init(st_epoch_domain_t *const p_domain, st_node_pool_t *const p_pool)
+{
+    if ((NULL == p_domain) || (NULL == p_pool))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_domain, 0, sizeof(st_epoch_domain_t));
+    p_domain->p_pool = p_pool;
+    (void)pthread_mutex_init(&p_domain->lock, NULL);
+
+    return RET_ERRCODE_OK;
+}
+
+/* Take a reader slot, (-1) when all are in use */
+int32_t epoch_register(st_epoch_domain_t *const p_domain)
+{
+    uint32_t    expected;
+    int32_t     slot;
+
+    if (NULL == p_domain)
+    {
+        return (-1);
+    }
+
+    for (slot = 0; slot < EPOCH_MAX_THREADS; slot++)
+    {
+        expected = 0;
+
+        if (true == __atomic_compare_exchange_n(&p_domain->records[slot].in_use, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            return slot;
+        }
+    }
+
+    return (-1);
+}
+
+void epoch_unregister(st_epoch_domain_t *const p_domain, const int32_t slot)
+{
+    if ((NULL != p_domain) && (0 <= slot) && (EPOCH_MAX_THREADS > slot))
+    {
+        __atomic_store_n(&p_domain->records[slot].active, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&p_domain->records[slot].in_use, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/* Two stores and a fence, no lock */
+void epoch_enter(st_epoch_domain_t *const p_domain, const int32_t slot)
+{
+    st_epoch_record_t *p_record = &p_domain->records[slot];
+
+    __atomic_store_n(&p_record->epoch, __atomic_load_n(&p_domain->global_epoch, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+    __atomic_store_n(&p_record->active, 1, __ATOMIC_RELAXED);
+
+    /* The tree must not be read before the record is visible to epoch_try_advance() */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void epoch_exit(st_epoch_domain_t *const p_domain, const int32_t slot)
+{
+    __atomic_store_n(&p_domain->records[slot].active, 0, __ATOMIC_RELEASE);
+}
+
+/* The node must already be unlinked from the tree */
+void epoch_retire(st_epoch_domain_t *const p_domain, st_tree_node_t *const p_tree_node)
+{
+    st_tree_node_t  **pp_bigger;
+    size_t          capacity;
+    int32_t         list;
+    bool_t          try_advance;
+
+    if ((NULL == p_domain) || (NULL == p_tree_node))
+    {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&p_domain->lock);
+
+    list = (int32_t)(p_domain->global_epoch % EPOCH_LIMBO_LISTS);
+
+    if (p_domain->limbo_count[list] == p_domain->limbo_capacity[list])
+    {
+        capacity  = (0 == p_domain->limbo_capacity[list]) ? EPOCH_RETIRE_BATCH : (2 * p_domain->limbo_capacity[list]);
+        pp_bigger = (st_tree_node_t **)realloc(p_domain->pp_limbo[list], capacity * sizeof(st_tree_node_t *));
+        if (NULL == pp_bigger)
+        {
+            /* Leaking is the only safe option while readers may still hold the node */
+            (void)pthread_mutex_unlock(&p_domain->lock);
+            return;
+        }
+
+        p_domain->pp_limbo[list]       = pp_bigger;
+        p_domain->limbo_capacity[list] = capacity;
+    }
+
+    p_domain->pp_limbo[list][p_domain->limbo_count[list]++] = p_tree_node;
+    p_domain->retired_since_advance++;
+
+    try_advance = (EPOCH_RETIRE_BATCH <= p_domain->retired_since_advance);
+
+    (void)pthread_mutex_unlock(&p_domain->lock);
+
+    if (true == try_advance)
+    {
+        (void)epoch_try_advance(p_domain);
+    }
+}
+
+/*
+    Move to the next epoch if every active reader has caught up with the current one.
+    Nodes retired two epochs ago can no longer be reached by anyone and go back to the pool.
+*/
+bool_t epoch_try_advance(st_epoch_domain_t *const p_domain)
+{
+    uint64_t    epoch;
+    int32_t     slot;
+
+    if (NULL == p_domain)
+    {
+        return false;
+    }
+
+    (void)pthread_mutex_lock(&p_domain->lock);
+
+    epoch = p_domain->global_epoch;
+
+    for (slot = 0; slot < EPOCH_MAX_THREADS; slot++)
+    {
+        if ((0 != __atomic_load_n(&p_domain->records[slot].active, __ATOMIC_ACQUIRE))
+         && (epoch != __atomic_load_n(&p_domain->records[slot].epoch, __ATOMIC_ACQUIRE)))
+        {
+            (void)pthread_mutex_unlock(&p_domain->lock);
+            return false;
+        }
+    }
+
+    /* Readers are all at epoch: what was retired at epoch - 1 is unreachable */
+    reclaim_limbo(p_domain, (int32_t)((epoch + 2) % EPOCH_LIMBO_LISTS));
+
+    p_domain->retired_since_advance = 0;
+    __atomic_store_n(&p_domain->global_epoch, epoch + 1, __ATOMIC_RELEASE);
+
+    (void)pthread_mutex_unlock(&p_domain->lock);
+
+    return true;
+}
+
+/* Hooks for tree_set_node_allocator(): nodes come from the pool and are retired on free */
+void epoch_node_allocator(st_epoch_domain_t *const p_domain, st_node_allocator_t *const p_allocator)
+{
+    if ((NULL != p_domain) && (NULL != p_allocator))
+    {
+        p_allocator->pf_alloc = epoch_alloc_node;
+        p_allocator->pf_free  = epoch_free_node;
+        p_allocator->p_ctx    = p_domain;
+    }
+}
+
+/* No reader may be active any more */
+void epoch_domain_destroy(st_epoch_domain_t *const p_domain)
+{
+    int32_t list;
+
+    if (NULL == p_domain)
+    {
+        return;
+    }
+
+    for (list = 0; list < EPOCH_LIMBO_LISTS; list++)
+    {
+        reclaim_limbo(p_domain, list);
+        free(p_domain->pp_limbo[list]);
+        p_domain->pp_limbo[list] = NULL;
+    }
+
+    (void)pthread_mutex_destroy(&p_domain->lock);
+}
\ No newline at end of file
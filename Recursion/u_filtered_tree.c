@@ -0,0 +1,161 @@
+#include "u_filtered_tree.h"
+
+#define FILTERED_TREE_MIN_KEYS  (1024)
+
+static void add_to_filter(const int32_t key, void *p_ctx);
+
+static void add_to_filter(const int32_t key, void *p_ctx)
+{
+    bloom_filter_add((st_bloom_filter_t *)p_ctx, key);
+}
+
+e_retcode_t filtered_tree_init(st_filtered_tree_t *const p_tree, const uint32_t expected_keys)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_tree, 0, sizeof(st_filtered_tree_t));
+
+    return bloom_filter_init(&p_tree->filter, (FILTERED_TREE_MIN_KEYS < expected_keys) ? expected_keys : FILTERED_TREE_MIN_KEYS);
+}
+
+/* Keys already present are ignored, like insert() */
+e_retcode_t filtered_tree_insert(st_filtered_tree_t *const p_tree, const int32_t key)
+{
+    st_tree_path_t  path;
+    e_retcode_t     ret;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    path.depth = 0;
+
+    ret = tree_path_insert(&p_tree->p_root, &path, key);
+    if (RET_ERRCODE_NG_DUPLICATE == ret)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    if (RET_ERRCODE_OK != ret)
+    {
+        return ret;
+    }
+
+    p_tree->key_count++;
+    bloom_filter_add(&p_tree->filter, key);
+
+    /*
+        A full filter is rebuilt twice as large. The key is in before that, so a rebuild
+        that fails only leaves more false positives, and the insert stands.
+    */
+    if (p_tree->filter.key_count >= bloom_filter_capacity(&p_tree->filter))
+    {
+        (void)filtered_tree_rebuild(p_tree);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+st_tree_node_t *filtered_tree_search(st_filtered_tree_t *const p_tree, const int32_t searched_key)
+{
+    st_tree_node_t *p_tree_node;
+
+    if (NULL == p_tree)
+    {
+        return NULL;
+    }
+
+    p_tree->lookups++;
+
+    if (false == bloom_filter_may_contain(&p_tree->filter, searched_key))
+    {
+        p_tree->filtered++;
+        return NULL;
+    }
+
+    p_tree_node = search(p_tree->p_root, searched_key);
+    if (NULL == p_tree_node)
+    {
+        p_tree->false_positives++;
+    }
+
+    return p_tree_node;
+}
+
+e_retcode_t filtered_tree_delete(st_filtered_tree_t *const p_tree, const int32_t key)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    if ((false == bloom_filter_may_contain(&p_tree->filter, key)) || (false == tree_remove(&p_tree->p_root, key)))
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    p_tree->key_count--;
+    p_tree->stale_count++;
+
+    /* The old filter is still right, only less selective: a failed rebuild is tried again later */
+    if (((uint32_t)p_tree->stale_count * FILTERED_TREE_STALE_RATIO) >= bloom_filter_capacity(&p_tree->filter))
+    {
+        (void)filtered_tree_rebuild(p_tree);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/* Fresh filter sized for twice the current keys, filled by one in-order scan */
+e_retcode_t filtered_tree_rebuild(st_filtered_tree_t *const p_tree)
+{
+    st_bloom_filter_t   filter;
+    uint32_t            expected_keys;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    expected_keys = (uint32_t)p_tree->key_count * 2;
+    if (FILTERED_TREE_MIN_KEYS > expected_keys)
+    {
+        expected_keys = FILTERED_TREE_MIN_KEYS;
+    }
+
+    if (RET_ERRCODE_OK != bloom_filter_init(&filter, expected_keys))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    (void)tree_range_scan(p_tree->p_root, INT32_MIN, INT32_MAX, add_to_filter, &filter);
+
+    bloom_filter_destroy(&p_tree->filter);
+    p_tree->filter      = filter;
+    p_tree->stale_count = 0;
+    p_tree->rebuilds++;
+
+    return RET_ERRCODE_OK;
+}
+
+void filtered_tree_destroy(st_filtered_tree_t *const p_tree)
+{
+    if (NULL == p_tree)
+    {
+        return;
+    }
+
+    tree_destroy(&p_tree->p_root);
+    bloom_filter_destroy(&p_tree->filter);
+    p_tree->key_count   = 0;
+    p_tree->stale_count = 0;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "u_finger_tree.h"
+
+static void count_start(st_finger_tree_t *const p_tree, const int32_t key);
+
+static void count_start(st_finger_tree_t *const p_tree, const int32_t key)
+{
+    const st_tree_path_t *p_finger = &p_tree->finger;
+
+    p_tree->operations++;
+
+    /* No finger yet, or the key is outside the range of the remembered leaf */
+    if ((0 == p_finger->depth)
+     || (key <= p_finger->low[p_finger->depth - 1])
+     || (key >= p_finger->high[p_finger->depth - 1]))
+    {
+        p_tree->finger_misses++;
+    }
+}
+
+void finger_tree_init(st_finger_tree_t *const p_tree)
+{
+    if (NULL != p_tree)
+    {
+        p_tree->p_root        = NULL;
+        p_tree->operations    = 0;
+        p_tree->finger_misses = 0;
+        tree_path_reset(&p_tree->finger);
+    }
+}
+
+e_retcode_t finger_tree_insert(st_finger_tree_t *const p_tree, const int32_t key)
+{
+    e_retcode_t ret;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    count_start(p_tree, key);
+
+    ret = tree_path_insert(&p_tree->p_root, &p_tree->finger, key);
+    if (RET_ERRCODE_NG_DUPLICATE == ret)
+    {
+        printf("Key %d is already present in the tree!\n", key);
+        ret = RET_ERRCODE_OK;
+    }
+
+    return ret;
+}
+
+st_tree_node_t *finger_tree_search(st_finger_tree_t *const p_tree, const int32_t searched_key)
+{
+    if (NULL == p_tree)
+    {
+        return NULL;
+    }
+
+    count_start(p_tree, searched_key);
+
+    return tree_path_search(p_tree->p_root, &p_tree->finger, searched_key);
+}
+
+e_retcode_t finger_tree_delete(st_finger_tree_t *const p_tree, const int32_t key)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    /* delete() may merge or free nodes on the finger */
+    tree_path_reset(&p_tree->finger);
+
+    return delete(&p_tree->p_root, key);
+}
+
+void finger_tree_destroy(st_finger_tree_t *const p_tree)
+{
+    if (NULL != p_tree)
+    {
+        tree_destroy(&p_tree->p_root);
+        tree_path_reset(&p_tree->finger);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "u_frozen_tree.h"
+
+#define FROZEN_CACHE_LINE       (64)
+#define FROZEN_PREFETCH_STRIDE  (FROZEN_CACHE_LINE / (int64_t)sizeof(int32_t))
+
+static int32_t fill_eytzinger(const int32_t *const p_sorted_keys, int32_t index, const int64_t slot, st_frozen_tree_t *const p_frozen);
+static int64_t lower_bound_slot(const st_frozen_tree_t *const p_frozen, const int32_t key);
+static int64_t next_slot(const st_frozen_tree_t *const p_frozen, int64_t slot);
+
+/* In-order walk of the implicit tree consumes the sorted stream once: O(n) */
+static int32_t fill_eytzinger(const int32_t *const p_sorted_keys, int32_t index, const int64_t slot, st_frozen_tree_t *const p_frozen)
+{
+    if (slot <= p_frozen->key_count)
+    {
+        index = fill_eytzinger(p_sorted_keys, index, 2 * slot, p_frozen);
+
+        p_frozen->p_keys[slot] = p_sorted_keys[index];
+        index++;
+
+        index = fill_eytzinger(p_sorted_keys, index, (2 * slot) + 1, p_frozen);
+    }
+
+    return index;
+}
+
+/* Branch-free descent. Returns the slot of the first key >= key, 0 if there is none */
+static int64_t lower_bound_slot(const st_frozen_tree_t *const p_frozen, const int32_t key)
+{
+    int64_t slot = 1;
+
+    while (slot <= p_frozen->key_count)
+    {
+        /* The 16 great-grandchildren 4 levels down share one cache line */
+        __builtin_prefetch(p_frozen->p_keys + (FROZEN_PREFETCH_STRIDE * slot));
+
+        slot = (2 * slot) + (int64_t)(p_frozen->p_keys[slot] < key);
+    }
+
+    /* Undo the trailing right turns plus the last left turn */
+    slot >>= __builtin_ffsll(~slot);
+
+    return slot;
+}
+
+/* In-order successor of a slot, 0 past the end */
+static int64_t next_slot(const st_frozen_tree_t *const p_frozen, int64_t slot)
+{
+    if (((2 * slot) + 1) <= p_frozen->key_count)
+    {
+        slot = (2 * slot) + 1;
+
+        while ((2 * slot) <= p_frozen->key_count)
+        {
+            slot = 2 * slot;
+        }
+    }
+    else
+    {
+        slot >>= __builtin_ffsll(~slot);
+    }
+
+    return slot;
+}
+
+e_retcode_t frozen_tree_build_sorted(const int32_t *const p_sorted_keys, const int32_t count, st_frozen_tree_t *const p_frozen)
+{
+    size_t bytes;
+
+    if ((NULL == p_frozen) || ((NULL == p_sorted_keys) && (0 < count)))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (0 > count)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    /* aligned_alloc() wants a multiple of the alignment */
+    bytes = ((((size_t)count + 1) * sizeof(int32_t)) + FROZEN_CACHE_LINE - 1) & ~((size_t)FROZEN_CACHE_LINE - 1);
+
+    p_frozen->key_count = count;
+    p_frozen->p_keys    = (int32_t *)aligned_alloc(FROZEN_CACHE_LINE, bytes);
+    if (NULL == p_frozen->p_keys)
+    {
+        p_frozen->key_count = 0;
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_frozen->p_keys[0] = (-1);
+    (void)fill_eytzinger(p_sorted_keys, 0, 1, p_frozen);
+
+    return RET_ERRCODE_OK;
+}
+
+e_retcode_t frozen_tree_build(const st_tree_node_t *const p_root, st_frozen_tree_t *const p_frozen)
+{
+    e_retcode_t ret;
+    int32_t     *p_sorted_keys;
+    int32_t     count;
+
+    if (NULL == p_frozen)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    count         = tree_key_count(p_root);
+    p_sorted_keys = (int32_t *)malloc(((size_t)count + 1) * sizeof(int32_t));
+    if (NULL == p_sorted_keys)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    count = tree_export_keys(p_root, p_sorted_keys, count);
+    ret   = frozen_tree_build_sorted(p_sorted_keys, count, p_frozen);
+
+    free(p_sorted_keys);
+
+    return ret;
+}
+
+bool_t frozen_tree_search(const st_frozen_tree_t *const p_frozen, const int32_t searched_key)
+{
+    int64_t slot;
+
+    if ((NULL == p_frozen) || (NULL == p_frozen->p_keys))
+    {
+        return false;
+    }
+
+    slot = lower_bound_slot(p_frozen, searched_key);
+
+    return ((0 != slot) && (searched_key == p_frozen->p_keys[slot]));
+}
+
+bool_t frozen_tree_lower_bound(const st_frozen_tree_t *const p_frozen, const int32_t key, int32_t *const p_found_key)
+{
+    int64_t slot;
+
+    if ((NULL == p_frozen) || (NULL == p_frozen->p_keys) || (NULL == p_found_key))
+    {
+        return false;
+    }
+
+    slot = lower_bound_slot(p_frozen, key);
+    if (0 == slot)
+    {
+        return false;
+    }
+
+    *p_found_key = p_frozen->p_keys[slot];
+
+    return true;
+}
+
+/* Visit every key in [low, high] in ascending order, return the number visited */
+int32_t frozen_tree_range_scan(const st_frozen_tree_t *const p_frozen, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx)
+{
+    int64_t slot;
+    int32_t visited = 0;
+
+    if ((NULL == p_frozen) || (NULL == p_frozen->p_keys) || (NULL == pf_visitor))
+    {
+        return 0;
+    }
+
+    slot = lower_bound_slot(p_frozen, low);
+
+    while ((0 != slot) && (p_frozen->p_keys[slot] <= high))
+    {
+        pf_visitor(p_frozen->p_keys[slot], p_ctx);
+        visited++;
+
+        slot = next_slot(p_frozen, slot);
+    }
+
+    return visited;
+}
+
+void frozen_tree_destroy(st_frozen_tree_t *const p_frozen)
+{
+    if (NULL != p_frozen)
+    {
+        free(p_frozen->p_keys);
+        p_frozen->p_keys    = NULL;
+        p_frozen->key_count = 0;
+    }
+}
\ No newline at end of file
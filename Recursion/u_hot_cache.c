@@ -0,0 +1,211 @@
+#include "u_hot_cache.h"
+
+static st_hot_cache_entry_t *key_set(const st_hot_cache_t *const p_cache, const int32_t key);
+static void move_to_front(st_hot_cache_entry_t *const p_set, const int32_t way);
+static void drop_way(st_hot_cache_entry_t *const p_set, const int32_t way);
+static uint64_t current_generation(const st_hot_cache_t *const p_cache);
+
+static st_hot_cache_entry_t *key_set(const st_hot_cache_t *const p_cache, const int32_t key)
+{
+    uint32_t set = (((uint32_t)key * 2654435761u) >> 8) & p_cache->set_mask;
+
+    return &p_cache->p_entries[set * HOT_CACHE_WAYS];
+}
+
+static void move_to_front(st_hot_cache_entry_t *const p_set, const int32_t way)
+{
+    st_hot_cache_entry_t    entry = p_set[way];
+    int32_t                 i;
+
+    for (i = way; i > 0; i--)
+    {
+        p_set[i] = p_set[i - 1];
+    }
+
+    p_set[0] = entry;
+}
+
+static void drop_way(st_hot_cache_entry_t *const p_set, const int32_t way)
+{
+    int32_t i;
+
+    for (i = way; i < (HOT_CACHE_WAYS - 1); i++)
+    {
+        p_set[i] = p_set[i + 1];
+    }
+
+    p_set[HOT_CACHE_WAYS - 1].p_node = NULL;
+}
+
+static uint64_t current_generation(const st_hot_cache_t *const p_cache)
+{
+    if (NULL == p_cache->p_generation)
+    {
+        return tree_free_generation();
+    }
+
+    return __atomic_load_n(p_cache->p_generation, __ATOMIC_ACQUIRE);
+}
+
+/*
+    entry_count is rounded up to a power of two of at least HOT_CACHE_WAYS.
+    p_generation is the counter bound with tree_bind_free_generation() around every
+    change of the tree, NULL when its writers do not bind one: the process-wide counter
+    is then tracked from here on, which costs every untracked free in the process.
+*/
+e_retcode_t hot_cache_init(st_hot_cache_t *const p_cache, const uint32_t entry_count, const uint64_t *const p_generation)
+{
+    uint32_t set_count = 1;
+
+    if (NULL == p_cache)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((0 == entry_count) || ((UINT32_MAX / 2) < entry_count))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    while ((set_count * HOT_CACHE_WAYS) < entry_count)
+    {
+        set_count *= 2;
+    }
+
+    memset(p_cache, 0, sizeof(st_hot_cache_t));
+
+    p_cache->p_entries = (st_hot_cache_entry_t *)calloc((size_t)set_count * HOT_CACHE_WAYS, sizeof(st_hot_cache_entry_t));
+    if (NULL == p_cache->p_entries)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    if (NULL == p_generation)
+    {
+        tree_track_free_generation();
+    }
+
+    p_cache->set_mask     = set_count - 1;
+    p_cache->p_generation = p_generation;
+    p_cache->generation   = current_generation(p_cache);
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Same result as search(p_root, key). A hit skips the descent; a miss descends and
+    remembers the node, evicting the least recently used way of the key's set.
+    The cache must always be used with the same tree.
+*/
+st_tree_node_t *hot_cache_search(st_hot_cache_t *const p_cache, const st_tree_node_t *const p_root, const int32_t key)
+{
+    st_hot_cache_entry_t    *p_set;
+    st_tree_node_t          *p_tree_node;
+    uint64_t                generation;
+    int32_t                 way;
+
+    if ((NULL == p_cache) || (NULL == p_cache->p_entries))
+    {
+        return search(p_root, key);
+    }
+
+    /* Some entry may point at freed memory: do not even look at the nodes */
+    generation = current_generation(p_cache);
+    if (generation != p_cache->generation)
+    {
+        hot_cache_clear(p_cache);
+        p_cache->generation = generation;
+        p_cache->flushes++;
+    }
+
+    p_cache->lookups++;
+    p_set = key_set(p_cache, key);
+
+    for (way = 0; (way < HOT_CACHE_WAYS) && (NULL != p_set[way].p_node); way++)
+    {
+        if (key != p_set[way].key)
+        {
+            continue;
+        }
+
+        if (p_set[way].version == p_set[way].p_node->version)
+        {
+            p_cache->hits++;
+            move_to_front(p_set, way);
+
+            return p_set[0].p_node;
+        }
+
+        p_cache->stale++;
+        drop_way(p_set, way);
+        break;
+    }
+
+    p_tree_node = search(p_root, key);
+
+    if (NULL != p_tree_node)
+    {
+        move_to_front(p_set, HOT_CACHE_WAYS - 1);
+        p_set[0].p_node  = p_tree_node;
+        p_set[0].key     = key;
+        p_set[0].version = p_tree_node->version;
+    }
+
+    return p_tree_node;
+}
+
+/* Cached tree_get_value() */
+bool_t hot_cache_get_value(st_hot_cache_t *const p_cache, const st_tree_node_t *const p_root, const int32_t key, uintptr_t *const p_value)
+{
+    st_tree_node_t *p_tree_node;
+
+    if (NULL == p_value)
+    {
+        return false;
+    }
+
+    p_tree_node = hot_cache_search(p_cache, p_root, key);
+    if (NULL == p_tree_node)
+    {
+        return false;
+    }
+
+    *p_value = __atomic_load_n((key == p_tree_node->keys[FIRST_KEY]) ? &p_tree_node->values[FIRST_KEY] : &p_tree_node->values[SECOND_KEY], __ATOMIC_ACQUIRE);
+
+    return true;
+}
+
+void hot_cache_clear(st_hot_cache_t *const p_cache)
+{
+    if ((NULL == p_cache) || (NULL == p_cache->p_entries))
+    {
+        return;
+    }
+
+    memset(p_cache->p_entries, 0, ((size_t)p_cache->set_mask + 1) * HOT_CACHE_WAYS * sizeof(st_hot_cache_entry_t));
+}
+
+void hot_cache_stats(const st_hot_cache_t *const p_cache, st_hot_cache_stats_t *const p_stats)
+{
+    if ((NULL == p_cache) || (NULL == p_stats))
+    {
+        return;
+    }
+
+    p_stats->lookups  = p_cache->lookups;
+    p_stats->hits     = p_cache->hits;
+    p_stats->stale    = p_cache->stale;
+    p_stats->flushes  = p_cache->flushes;
+    p_stats->hit_rate = (0 < p_cache->lookups) ? ((double)p_cache->hits / p_cache->lookups) : 0.0;
+}
+
+void hot_cache_destroy(st_hot_cache_t *const p_cache)
+{
+    if (NULL == p_cache)
+    {
+        return;
+    }
+
+    free(p_cache->p_entries);
+    memset(p_cache, 0, sizeof(st_hot_cache_t));
+}
\ No newline at end of file
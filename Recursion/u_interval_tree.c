@@ -0,0 +1,418 @@
+#include "u_interval_tree.h"
+
+#if (UINTPTR_MAX < UINT64_MAX)
+#error "A value slot holds a high end next to a tag bit: 64-bit pointers only"
+#endif
+
+#define INTERVAL_INLINE_TAG ((uintptr_t)1)  /**< Set on a value holding one high end, clear on a bucket pointer */
+
+static inline bool_t is_inline(const uintptr_t value);
+static inline uintptr_t inline_high(const int32_t high);
+static inline int32_t value_max_high(const uintptr_t value);
+static inline int64_t *node_max(const st_tree_node_t *const p_tree_node);
+static inline int64_t subtree_max(const st_tree_node_t *const p_tree_node);
+static void update_max(st_tree_node_t *p_tree_node, void *p_ctx);
+static void raise_path(const st_tree_path_t *const p_path, const int32_t high);
+static uintptr_t bucket_add(const uintptr_t value, const int32_t high);
+static int32_t report_value(const int32_t low_end, const uintptr_t value, const int32_t low, pf_interval_visitor_t pf_visitor, void *p_ctx);
+static int32_t report_overlaps(const st_tree_node_t *const p_tree_node, const int32_t low, const int32_t high, pf_interval_visitor_t pf_visitor, void *p_ctx);
+static void free_buckets(const st_tree_node_t *const p_tree_node);
+
+/* Summary of a node: the largest high end in its subtree */
+static const st_tree_augment_t max_augment = { update_max, NULL };
+
+static inline bool_t is_inline(const uintptr_t value)
+{
+    return (0 != (value & INTERVAL_INLINE_TAG));
+}
+
+static inline uintptr_t inline_high(const int32_t high)
+{
+    return ((uintptr_t)(uint32_t)high << 32) | INTERVAL_INLINE_TAG;
+}
+
+static inline int32_t value_max_high(const uintptr_t value)
+{
+    return (true == is_inline(value)) ? (int32_t)(uint32_t)(value >> 32) : ((const st_interval_bucket_t *)value)->highs[0];
+}
+
+/* Every node of an interval tree is an st_summary_node_t */
+static inline int64_t *node_max(const st_tree_node_t *const p_tree_node)
+{
+    return &((st_summary_node_t *)p_tree_node)->summary;
+}
+
+static inline int64_t subtree_max(const st_tree_node_t *const p_tree_node)
+{
+    return (NULL != p_tree_node) ? *node_max(p_tree_node) : INT64_MIN;
+}
+
+static void update_max(st_tree_node_t *p_tree_node, void *p_ctx)
+{
+    int64_t max_high = value_max_high(p_tree_node->values[FIRST_KEY]);
+    int64_t child_max;
+
+    (void)p_ctx;
+
+    /* A blank key may keep a stale value */
+    if (((-1) != p_tree_node->keys[SECOND_KEY]) && (max_high < value_max_high(p_tree_node->values[SECOND_KEY])))
+    {
+        max_high = value_max_high(p_tree_node->values[SECOND_KEY]);
+    }
+
+    child_max = subtree_max(p_tree_node->p_left_child);
+    max_high  = (max_high < child_max) ? child_max : max_high;
+    child_max = subtree_max(p_tree_node->p_middle_child);
+    max_high  = (max_high < child_max) ? child_max : max_high;
+    child_max = subtree_max(p_tree_node->p_right_child);
+    max_high  = (max_high < child_max) ? child_max : max_high;
+
+    *node_max(p_tree_node) = max_high;
+}
+
+/* A high end was added to the last node of the path: a maximum can only grow, no sibling is read */
+static void raise_path(const st_tree_path_t *const p_path, const int32_t high)
+{
+    int32_t level;
+
+    for (level = 0; level < p_path->depth; level++)
+    {
+        if (*node_max(p_path->p_nodes[level]) < high)
+        {
+            *node_max(p_path->p_nodes[level]) = high;
+        }
+    }
+}
+
+/* Add high to the bucket of value, creating or growing it. Returns the new value, 0 when out of memory */
+static uintptr_t bucket_add(const uintptr_t value, const int32_t high)
+{
+    st_interval_bucket_t    *p_bucket;
+    st_interval_bucket_t    *p_grown;
+    int32_t                 i;
+
+    if (true == is_inline(value))
+    {
+        p_bucket = (st_interval_bucket_t *)malloc(sizeof(st_interval_bucket_t) + (INTERVAL_BUCKET_MIN * sizeof(int32_t)));
+        if (NULL == p_bucket)
+        {
+            return 0;
+        }
+
+        p_bucket->count    = 1;
+        p_bucket->capacity = INTERVAL_BUCKET_MIN;
+        p_bucket->highs[0] = value_max_high(value);
+    }
+    else
+    {
+        p_bucket = (st_interval_bucket_t *)value;
+
+        if (p_bucket->count == p_bucket->capacity)
+        {
+            p_grown = (st_interval_bucket_t *)realloc(p_bucket, sizeof(st_interval_bucket_t) + ((size_t)p_bucket->capacity * 2 * sizeof(int32_t)));
+            if (NULL == p_grown)
+            {
+                return 0;
+            }
+
+            p_bucket = p_grown;
+            p_bucket->capacity *= 2;
+        }
+    }
+
+    /* Largest first */
+    for (i = p_bucket->count; (0 < i) && (p_bucket->highs[i - 1] < high); i--)
+    {
+        p_bucket->highs[i] = p_bucket->highs[i - 1];
+    }
+
+    p_bucket->highs[i] = high;
+    p_bucket->count++;
+
+    return (uintptr_t)p_bucket;
+}
+
+/* Intervals starting at low_end that reach low. A bucket is sorted, so it stops at the first miss */
+static int32_t report_value(const int32_t low_end, const uintptr_t value, const int32_t low, pf_interval_visitor_t pf_visitor, void *p_ctx)
+{
+    const st_interval_bucket_t  *p_bucket;
+    int32_t                     reported = 0;
+
+    if (true == is_inline(value))
+    {
+        if (value_max_high(value) >= low)
+        {
+            pf_visitor(low_end, value_max_high(value), p_ctx);
+            reported = 1;
+        }
+    }
+    else
+    {
+        p_bucket = (const st_interval_bucket_t *)value;
+
+        while ((reported < p_bucket->count) && (p_bucket->highs[reported] >= low))
+        {
+            pf_visitor(low_end, p_bucket->highs[reported], p_ctx);
+            reported++;
+        }
+    }
+
+    return reported;
+}
+
+static int32_t report_overlaps(const st_tree_node_t *const p_tree_node, const int32_t low, const int32_t high, pf_interval_visitor_t pf_visitor, void *p_ctx)
+{
+    const st_tree_node_t    *p_children[MAX_KEY + 1];
+    int32_t                 reported = 0;
+    int32_t                 key_count;
+    int32_t                 i;
+
+    /* Everything under this node ends before the query */
+    if ((NULL == p_tree_node) || (*node_max(p_tree_node) < low))
+    {
+        return 0;
+    }
+
+    p_children[LEFT]   = p_tree_node->p_left_child;
+    p_children[MIDDLE] = p_tree_node->p_middle_child;
+    p_children[RIGHT]  = p_tree_node->p_right_child;
+    key_count          = ((-1) != p_tree_node->keys[SECOND_KEY]) ? 2 : 1;
+
+    /* Each child's summary decides whether it is entered: fetch them all at once */
+    for (i = 0; i <= key_count; i++)
+    {
+        __builtin_prefetch(p_children[i]);
+    }
+
+    for (i = 0; i < key_count; i++)
+    {
+        reported += report_overlaps(p_children[i], low, high, pf_visitor, p_ctx);
+
+        /* Everything from here on starts after the query */
+        if (p_tree_node->keys[i] > high)
+        {
+            return reported;
+        }
+
+        reported += report_value(p_tree_node->keys[i], p_tree_node->values[i], low, pf_visitor, p_ctx);
+    }
+
+    reported += report_overlaps(p_children[key_count], low, high, pf_visitor, p_ctx);
+
+    return reported;
+}
+
+static void free_buckets(const st_tree_node_t *const p_tree_node)
+{
+    if (NULL == p_tree_node)
+    {
+        return;
+    }
+
+    if (false == is_inline(p_tree_node->values[FIRST_KEY]))
+    {
+        free((void *)p_tree_node->values[FIRST_KEY]);
+    }
+
+    if (((-1) != p_tree_node->keys[SECOND_KEY]) && (false == is_inline(p_tree_node->values[SECOND_KEY])))
+    {
+        free((void *)p_tree_node->values[SECOND_KEY]);
+    }
+
+    free_buckets(p_tree_node->p_left_child);
+    free_buckets(p_tree_node->p_middle_child);
+    free_buckets(p_tree_node->p_right_child);
+}
+
+e_retcode_t interval_tree_init(st_interval_tree_t *const p_tree)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_tree, 0, sizeof(st_interval_tree_t));
+
+    return RET_ERRCODE_OK;
+}
+
+/* Add [low, high]. The same interval may be added more than once; low cannot be -1 */
+e_retcode_t interval_tree_insert(st_interval_tree_t *const p_tree, const int32_t low, const int32_t high)
+{
+    const st_node_allocator_t   *p_previous_allocator;
+    const st_tree_augment_t     *p_previous;
+    st_tree_path_t              path;
+    uintptr_t                   *p_slot;
+    uintptr_t                   value;
+    bool_t                      inserted = false;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (((-1) == low) || (low > high))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    path.depth = 0;
+
+    p_previous_allocator = tree_bind_node_allocator(tree_summary_allocator());
+    p_previous           = tree_bind_augment(&max_augment);
+    p_slot               = tree_path_insert_or_get(&p_tree->p_root, &path, low, inline_high(high), &inserted);
+    (void)tree_bind_augment(p_previous);
+    (void)tree_bind_node_allocator(p_previous_allocator);
+
+    if (NULL == p_slot)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    if (true == inserted)
+    {
+        p_tree->key_count++;
+    }
+    else
+    {
+        value = bucket_add(*p_slot, high);
+        if (0 == value)
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        *p_slot = value;
+        raise_path(&path, high);
+    }
+
+    p_tree->interval_count++;
+
+    return RET_ERRCODE_OK;
+}
+
+/* Remove one copy of [low, high]. Absent intervals are ignored */
+e_retcode_t interval_tree_delete(st_interval_tree_t *const p_tree, const int32_t low, const int32_t high)
+{
+    const st_node_allocator_t   *p_previous_allocator;
+    const st_tree_augment_t     *p_previous;
+    st_tree_path_t              path;
+    st_tree_node_t              *p_tree_node;
+    st_interval_bucket_t        *p_bucket;
+    uintptr_t                   *p_slot;
+    int32_t                     i;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (((-1) == low) || (low > high))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    path.depth = 0;
+
+    p_tree_node = tree_path_search(p_tree->p_root, &path, low);
+    if (NULL == p_tree_node)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    p_slot = (low == p_tree_node->keys[FIRST_KEY]) ? &p_tree_node->values[FIRST_KEY] : &p_tree_node->values[SECOND_KEY];
+
+    if (true == is_inline(*p_slot))
+    {
+        if (high != value_max_high(*p_slot))
+        {
+            return RET_ERRCODE_OK;
+        }
+
+        p_previous_allocator = tree_bind_node_allocator(tree_summary_allocator());
+        p_previous           = tree_bind_augment(&max_augment);
+        (void)tree_remove(&p_tree->p_root, low);
+        (void)tree_bind_augment(p_previous);
+        (void)tree_bind_node_allocator(p_previous_allocator);
+
+        p_tree->key_count--;
+    }
+    else
+    {
+        p_bucket = (st_interval_bucket_t *)*p_slot;
+
+        i = 0;
+        while ((i < p_bucket->count) && (p_bucket->highs[i] > high))
+        {
+            i++;
+        }
+
+        if ((i == p_bucket->count) || (p_bucket->highs[i] != high))
+        {
+            return RET_ERRCODE_OK;
+        }
+
+        p_bucket->count--;
+        while (i < p_bucket->count)
+        {
+            p_bucket->highs[i] = p_bucket->highs[i + 1];
+            i++;
+        }
+
+        /* Back to a single high end: no bucket needed */
+        if (1 == p_bucket->count)
+        {
+            *p_slot = inline_high(p_bucket->highs[0]);
+            free(p_bucket);
+        }
+
+        /* The largest high end of this key left: the maxima above may shrink */
+        if (high > value_max_high(*p_slot))
+        {
+            p_previous = tree_bind_augment(&max_augment);
+            tree_path_augment(&path);
+            (void)tree_bind_augment(p_previous);
+        }
+    }
+
+    p_tree->interval_count--;
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Visit every interval overlapping [low, high], by ascending low end, largest high end
+    first among equal ones. Subtrees ending before low and keys starting after high are
+    never entered. Returns the intervals visited.
+*/
+int32_t interval_tree_overlaps(const st_interval_tree_t *const p_tree, const int32_t low, const int32_t high, pf_interval_visitor_t pf_visitor, void *p_ctx)
+{
+    if ((NULL == p_tree) || (NULL == pf_visitor) || (low > high))
+    {
+        return 0;
+    }
+
+    return report_overlaps(p_tree->p_root, low, high, pf_visitor, p_ctx);
+}
+
+/* Visit every interval holding point */
+int32_t interval_tree_stab(const st_interval_tree_t *const p_tree, const int32_t point, pf_interval_visitor_t pf_visitor, void *p_ctx)
+{
+    return interval_tree_overlaps(p_tree, point, point, pf_visitor, p_ctx);
+}
+
+void interval_tree_destroy(st_interval_tree_t *const p_tree)
+{
+    const st_node_allocator_t *p_previous_allocator;
+
+    if (NULL == p_tree)
+    {
+        return;
+    }
+
+    free_buckets(p_tree->p_root);
+    p_previous_allocator = tree_bind_node_allocator(tree_summary_allocator());
+    tree_destroy(&p_tree->p_root);
+    (void)tree_bind_node_allocator(p_previous_allocator);
+    p_tree->key_count      = 0;
+    p_tree->interval_count = 0;
+}
\ No newline at end of file
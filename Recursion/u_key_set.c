@@ -0,0 +1,196 @@
+#include "u_key_set.h"
+
+#define KEY_SET_MIN_CAPACITY    (16)
+
+static inline uint32_t key_hash(const int32_t key, const uint32_t capacity);
+static e_retcode_t key_set_grow(st_key_set_t *const p_set);
+
+static inline uint32_t key_hash(const int32_t key, const uint32_t capacity)
+{
+    /* Fibonacci hashing, spreads clustered keys such as timestamps */
+    return (uint32_t)((((uint64_t)(uint32_t)key * 0x9E3779B97F4A7C15ull) >> 32) & (capacity - 1));
+}
+
+static e_retcode_t key_set_grow(st_key_set_t *const p_set)
+{
+    st_key_set_t    bigger;
+    uint32_t        i;
+
+    if (RET_ERRCODE_OK != key_set_init(&bigger, p_set->capacity * 2))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    for (i = 0; i < p_set->capacity; i++)
+    {
+        if ((-1) != p_set->p_slots[i])
+        {
+            (void)key_set_add(&bigger, p_set->p_slots[i]);
+        }
+    }
+
+    key_set_destroy(p_set);
+    *p_set = bigger;
+
+    return RET_ERRCODE_OK;
+}
+
+e_retcode_t key_set_init(st_key_set_t *const p_set, const uint32_t capacity)
+{
+    if (NULL == p_set)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    p_set->capacity = KEY_SET_MIN_CAPACITY;
+    while (p_set->capacity < capacity)
+    {
+        p_set->capacity *= 2;
+    }
+
+    p_set->count   = 0;
+    p_set->p_slots = (int32_t *)malloc(p_set->capacity * sizeof(int32_t));
+    if (NULL == p_set->p_slots)
+    {
+        p_set->capacity = 0;
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    /* Every byte 0xFF gives (-1) in every slot */
+    memset(p_set->p_slots, 0xFF, p_set->capacity * sizeof(int32_t));
+
+    return RET_ERRCODE_OK;
+}
+
+bool_t key_set_contains(const st_key_set_t *const p_set, const int32_t key)
+{
+    uint32_t index;
+
+    if ((NULL == p_set) || (0 == p_set->count) || ((-1) == key))
+    {
+        return false;
+    }
+
+    index = key_hash(key, p_set->capacity);
+
+    while ((-1) != p_set->p_slots[index])
+    {
+        if (key == p_set->p_slots[index])
+        {
+            return true;
+        }
+
+        index = (index + 1) & (p_set->capacity - 1);
+    }
+
+    return false;
+}
+
+e_retcode_t key_set_add(st_key_set_t *const p_set, const int32_t key)
+{
+    uint32_t index;
+
+    if (NULL == p_set)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    /* Keep the load factor under 1/2 so probe runs stay short */
+    if ((2 * (p_set->count + 1)) > p_set->capacity)
+    {
+        if (RET_ERRCODE_OK != key_set_grow(p_set))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+    }
+
+    index = key_hash(key, p_set->capacity);
+
+    while ((-1) != p_set->p_slots[index])
+    {
+        if (key == p_set->p_slots[index])
+        {
+            return RET_ERRCODE_NG_DUPLICATE;
+        }
+
+        index = (index + 1) & (p_set->capacity - 1);
+    }
+
+    p_set->p_slots[index] = key;
+    p_set->count++;
+
+    return RET_ERRCODE_OK;
+}
+
+bool_t key_set_remove(st_key_set_t *const p_set, const int32_t key)
+{
+    uint32_t    index;
+    uint32_t    next;
+    uint32_t    home;
+    uint32_t    mask;
+
+    if ((NULL == p_set) || (0 == p_set->count) || ((-1) == key))
+    {
+        return false;
+    }
+
+    mask  = p_set->capacity - 1;
+    index = key_hash(key, p_set->capacity);
+
+    while (key != p_set->p_slots[index])
+    {
+        if ((-1) == p_set->p_slots[index])
+        {
+            return false;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    /* Backward-shift deletion: pull later members of the probe run into the hole */
+    next = (index + 1) & mask;
+
+    while ((-1) != p_set->p_slots[next])
+    {
+        home = key_hash(p_set->p_slots[next], p_set->capacity);
+
+        /* Move it only if its home slot is not inside (index, next] */
+        if (((next - home) & mask) >= ((next - index) & mask))
+        {
+            p_set->p_slots[index] = p_set->p_slots[next];
+            index = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+
+    p_set->p_slots[index] = (-1);
+    p_set->count--;
+
+    return true;
+}
+
+void key_set_clear(st_key_set_t *const p_set)
+{
+    if ((NULL != p_set) && (NULL != p_set->p_slots))
+    {
+        memset(p_set->p_slots, 0xFF, p_set->capacity * sizeof(int32_t));
+        p_set->count = 0;
+    }
+}
+
+void key_set_destroy(st_key_set_t *const p_set)
+{
+    if (NULL != p_set)
+    {
+        free(p_set->p_slots);
+        p_set->p_slots  = NULL;
+        p_set->capacity = 0;
+        p_set->count    = 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "u_lazy_tree.h"
+
+#define LAZY_COMPACT_BATCH  (256)
+
+typedef struct
+{
+    const st_key_set_t  *p_tombstones;
+    pf_key_visitor_t    pf_visitor;
+    void                *p_ctx;
+    int32_t             visited;
+} st_live_filter_t;
+
+static void visit_live_key(const int32_t key, void *p_ctx);
+static int compare_keys(const void *p_left, const void *p_right);
+
+static void visit_live_key(const int32_t key, void *p_ctx)
+{
+    st_live_filter_t *p_filter = (st_live_filter_t *)p_ctx;
+
+    if (false == key_set_contains(p_filter->p_tombstones, key))
+    {
+        p_filter->pf_visitor(key, p_filter->p_ctx);
+        p_filter->visited++;
+    }
+}
+
+static int compare_keys(const void *p_left, const void *p_right)
+{
+    const int32_t left  = *(const int32_t *)p_left;
+    const int32_t right = *(const int32_t *)p_right;
+
+    return (left > right) - (left < right);
+}
+
+e_retcode_t lazy_tree_init(st_lazy_tree_t *const p_tree, const uint32_t compact_threshold)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    p_tree->p_root            = NULL;
+    p_tree->compact_threshold = compact_threshold;
+    p_tree->compact_cursor    = 0;
+
+    return key_set_init(&p_tree->tombstones, compact_threshold);
+}
+
+e_retcode_t lazy_tree_insert(st_lazy_tree_t *const p_tree, const int32_t key)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    /* A tombstoned key is still physically in the tree: just revive it */
+    if (true == key_set_remove(&p_tree->tombstones, key))
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    return insert(&p_tree->p_root, key);
+}
+
+st_tree_node_t *lazy_tree_search(const st_lazy_tree_t *const p_tree, const int32_t searched_key)
+{
+    st_tree_node_t *found_node = NULL;
+
+    if (NULL != p_tree)
+    {
+        found_node = search(p_tree->p_root, searched_key);
+
+        if ((NULL != found_node) && (true == key_set_contains(&p_tree->tombstones, searched_key)))
+        {
+            found_node = NULL;
+        }
+    }
+
+    return found_node;
+}
+
+e_retcode_t lazy_tree_delete(st_lazy_tree_t *const p_tree, const int32_t key)
+{
+    e_retcode_t ret = RET_ERRCODE_OK;
+
+    if (NULL == p_tree)
+    {
+        ret = RET_ERRCODE_NG_ARGNULL;
+    }
+    else if ((-1) == key)
+    {
+        ret = RET_ERRCODE_NG_PARAM;
+    }
+    else if (NULL == lazy_tree_search(p_tree, key))
+    {
+        printf("Key %d is not in the tree!\n", key);
+    }
+    else
+    {
+        /* O(log n) for the search above, no split, borrow or merge, and never a compaction */
+        ret = key_set_add(&p_tree->tombstones, key);
+    }
+
+    return ret;
+}
+
+int32_t lazy_tree_range_scan(const st_lazy_tree_t *const p_tree, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx)
+{
+    st_live_filter_t filter;
+
+    if ((NULL == p_tree) || (NULL == pf_visitor))
+    {
+        return 0;
+    }
+
+    filter.p_tombstones = &p_tree->tombstones;
+    filter.pf_visitor   = pf_visitor;
+    filter.p_ctx        = p_ctx;
+    filter.visited      = 0;
+
+    (void)tree_range_scan(p_tree->p_root, low, high, visit_live_key, &filter);
+
+    return filter.visited;
+}
+
+/* true once compact_threshold tombstones have piled up: time to schedule some compaction */
+bool_t lazy_tree_compaction_due(const st_lazy_tree_t *const p_tree)
+{
+    return ((NULL != p_tree) && (0 != p_tree->compact_threshold) && (p_tree->tombstones.count >= p_tree->compact_threshold));
+}
+
+/*
+    Physically remove up to budget tombstoned keys, in sorted runs of LAZY_COMPACT_BATCH
+    through tree_remove_batch(), so compaction can be spread over many calls of
+    O(budget log n) each. The tombstone slots are walked from where the last call stopped.
+    Returns the keys removed.
+*/
+int32_t lazy_tree_compact_step(st_lazy_tree_t *const p_tree, const int32_t budget)
+{
+    int32_t     keys[LAZY_COMPACT_BATCH];
+    int32_t     removed = 0;
+    int32_t     batch_count;
+    uint32_t    scanned;
+    uint32_t    slot;
+    uint32_t    mask;
+    int32_t     i;
+
+    if (NULL == p_tree)
+    {
+        return 0;
+    }
+
+    while ((removed < budget) && (0 < p_tree->tombstones.count))
+    {
+        mask        = p_tree->tombstones.capacity - 1;
+        slot        = p_tree->compact_cursor & mask;
+        batch_count = 0;
+
+        for (scanned = 0; (scanned < p_tree->tombstones.capacity) && (batch_count < LAZY_COMPACT_BATCH) && ((removed + batch_count) < budget); scanned++)
+        {
+            if ((-1) != p_tree->tombstones.p_slots[slot])
+            {
+                keys[batch_count] = p_tree->tombstones.p_slots[slot];
+                batch_count++;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        p_tree->compact_cursor = slot;
+
+        qsort(keys, (size_t)batch_count, sizeof(int32_t), compare_keys);
+        (void)tree_remove_batch(&p_tree->p_root, keys, batch_count, NULL, NULL);
+
+        for (i = 0; i < batch_count; i++)
+        {
+            (void)key_set_remove(&p_tree->tombstones, keys[i]);
+        }
+
+        removed += batch_count;
+    }
+
+    return removed;
+}
+
+/*
+    Remove every tombstoned key in one pass: export the live keys and their values in
+    order, then rebuild bottom-up. O(n); the tree is left as it was when this fails.
+*/
+e_retcode_t lazy_tree_compact(st_lazy_tree_t *const p_tree)
+{
+    e_retcode_t ret;
+    int32_t     *p_keys;
+    uintptr_t   *p_values;
+    int32_t     count;
+    int32_t     live = 0;
+    int32_t     i;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (0 == p_tree->tombstones.count)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    count    = tree_key_count(p_tree->p_root);
+    p_keys   = (int32_t *)malloc(((size_t)count + 1) * sizeof(int32_t));
+    p_values = (uintptr_t *)malloc(((size_t)count + 1) * sizeof(uintptr_t));
+    if ((NULL == p_keys) || (NULL == p_values))
+    {
+        free(p_keys);
+        free(p_values);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    count = tree_export_entries(p_tree->p_root, p_keys, p_values, count);
+
+    for (i = 0; i < count; i++)
+    {
+        if (false == key_set_contains(&p_tree->tombstones, p_keys[i]))
+        {
+            p_keys[live]   = p_keys[i];
+            p_values[live] = p_values[i];
+            live++;
+        }
+    }
+
+    ret = tree_build_from_sorted(&p_tree->p_root, p_keys, p_values, live);
+    if (RET_ERRCODE_OK == ret)
+    {
+        key_set_clear(&p_tree->tombstones);
+    }
+
+    free(p_keys);
+    free(p_values);
+
+    return ret;
+}
+
+void lazy_tree_destroy(st_lazy_tree_t *const p_tree)
+{
+    if (NULL != p_tree)
+    {
+        tree_destroy(&p_tree->p_root);
+        key_set_destroy(&p_tree->tombstones);
+    }
+}
\ No newline at end of file
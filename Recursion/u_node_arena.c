@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <sys/mman.h>
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+#include "u_node_arena.h"
+
+#define NODE_ARENA_HEADER_BYTES (64)    /**< Region header, padded so the nodes start on a cache line */
+
+static st_node_arena_region_t *map_region(st_node_arena_t *const p_arena);
+static st_tree_node_t *arena_alloc_node(void *p_ctx);
+static void arena_free_node(void *p_ctx, st_tree_node_t *p_tree_node);
+#ifdef HAVE_LIBNUMA
+static bool_t numa_ready(void);
+#endif
+
+/* Arena used by the allocator hooks on this thread instead of their default one */
+static _Thread_local st_node_arena_t *p_bound_arena = NULL;
+
+#ifdef HAVE_LIBNUMA
+/* Last CPU this thread ran on and its NUMA node: the lookup is only redone after a migration */
+static _Thread_local int32_t last_cpu  = (-1);
+static _Thread_local int32_t last_node = 0;
+
+/* numa_available() is a system call: ask once. 0 unknown, 1 usable, -1 not */
+static int32_t numa_state = 0;
+
+static bool_t numa_ready(void)
+{
+    int32_t state = __atomic_load_n(&numa_state, __ATOMIC_RELAXED);
+
+    if (0 == state)
+    {
+        state = (0 <= numa_available()) ? 1 : (-1);
+        __atomic_store_n(&numa_state, state, __ATOMIC_RELAXED);
+    }
+
+    return (1 == state);
+}
+#endif
+
+/* Called with the lock held */
+static st_node_arena_region_t *map_region(st_node_arena_t *const p_arena)
+{
+    st_node_arena_region_t  *p_region = NULL;
+    uint8_t                 *p_raw;
+    uint8_t                 *p_aligned;
+    void                    *p_map = MAP_FAILED;
+
+    /* A hugetlb mapping is aligned to the huge page size already */
+    if (0 != (p_arena->flags & NODE_ARENA_HUGE_EXPLICIT))
+    {
+        p_map = mmap(NULL, NODE_ARENA_REGION_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (MAP_FAILED != p_map)
+        {
+            p_region = (st_node_arena_region_t *)p_map;
+            p_arena->huge_region_count++;
+        }
+    }
+
+    if (NULL == p_region)
+    {
+        /* Map twice the size and keep the aligned middle */
+        p_map = mmap(NULL, 2 * NODE_ARENA_REGION_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED == p_map)
+        {
+            return NULL;
+        }
+
+        p_raw     = (uint8_t *)p_map;
+        p_aligned = (uint8_t *)(((uintptr_t)p_raw + NODE_ARENA_REGION_BYTES - 1) & ~(uintptr_t)(NODE_ARENA_REGION_BYTES - 1));
+
+        if (p_aligned != p_raw)
+        {
+            (void)munmap(p_raw, (size_t)(p_aligned - p_raw));
+        }
+
+        (void)munmap(p_aligned + NODE_ARENA_REGION_BYTES, (size_t)((p_raw + (2 * NODE_ARENA_REGION_BYTES)) - (p_aligned + NODE_ARENA_REGION_BYTES)));
+
+        /* Both huge page flags fall back here */
+        if (0 != p_arena->flags)
+        {
+            (void)madvise(p_aligned, NODE_ARENA_REGION_BYTES, MADV_HUGEPAGE);
+        }
+
+        p_region = (st_node_arena_region_t *)p_aligned;
+    }
+
+#ifdef HAVE_LIBNUMA
+    /* Before the first touch, or the pages are already placed */
+    if ((NODE_ARENA_ANY_NODE != p_arena->numa_node) && (true == numa_ready()))
+    {
+        numa_tonode_memory(p_region, NODE_ARENA_REGION_BYTES, p_arena->numa_node);
+    }
+#endif
+
+    p_region->p_arena  = p_arena;
+    p_region->p_next   = p_arena->p_regions;
+    p_arena->p_regions = p_region;
+    p_arena->p_next    = (uint8_t *)p_region + NODE_ARENA_HEADER_BYTES;
+    p_arena->p_end     = (uint8_t *)p_region + NODE_ARENA_REGION_BYTES;
+    p_arena->region_count++;
+
+    return p_region;
+}
+
+static st_tree_node_t *arena_alloc_node(void *p_ctx)
+{
+    return node_arena_alloc((NULL != p_bound_arena) ? p_bound_arena : (st_node_arena_t *)p_ctx);
+}
+
+static void arena_free_node(void *p_ctx, st_tree_node_t *p_tree_node)
+{
+    (void)p_ctx;
+
+    node_arena_free(p_tree_node);
+}
+
+/* numa_node is NODE_ARENA_ANY_NODE or a node below node_arena_node_count() */
+e_retcode_t node_arena_init(st_node_arena_t *const p_arena, const int32_t numa_node, const uint32_t flags)
+{
+    if (NULL == p_arena)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((NODE_ARENA_ANY_NODE > numa_node) || (node_arena_node_count() <= numa_node)
+        || (0 != (flags & ~(NODE_ARENA_HUGE_TRANSPARENT | NODE_ARENA_HUGE_EXPLICIT))))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    memset(p_arena, 0, sizeof(st_node_arena_t));
+    (void)pthread_mutex_init(&p_arena->lock, NULL);
+    p_arena->flags     = flags;
+    p_arena->numa_node = numa_node;
+
+    return RET_ERRCODE_OK;
+}
+
+st_tree_node_t *node_arena_alloc(st_node_arena_t *const p_arena)
+{
+    st_tree_node_t *p_tree_node = NULL;
+
+    if (NULL == p_arena)
+    {
+        return NULL;
+    }
+
+    (void)pthread_mutex_lock(&p_arena->lock);
+
+    if (NULL != p_arena->p_free)
+    {
+        p_tree_node     = p_arena->p_free;
+        p_arena->p_free = *(st_tree_node_t **)p_tree_node;
+    }
+    else if ((((size_t)(p_arena->p_end - p_arena->p_next)) >= sizeof(st_tree_node_t)) || (NULL != map_region(p_arena)))
+    {
+        p_tree_node      = (st_tree_node_t *)p_arena->p_next;
+        p_arena->p_next += sizeof(st_tree_node_t);
+    }
+
+    if (NULL != p_tree_node)
+    {
+        p_arena->allocated++;
+    }
+
+    (void)pthread_mutex_unlock(&p_arena->lock);
+
+    return p_tree_node;
+}
+
+/* p_tree_node must come from node_arena_alloc() */
+void node_arena_free(st_tree_node_t *const p_tree_node)
+{
+    st_node_arena_t *p_arena;
+
+    if (NULL == p_tree_node)
+    {
+        return;
+    }
+
+    p_arena = ((st_node_arena_region_t *)((uintptr_t)p_tree_node & ~(uintptr_t)(NODE_ARENA_REGION_BYTES - 1)))->p_arena;
+
+    (void)pthread_mutex_lock(&p_arena->lock);
+
+    *(st_tree_node_t **)p_tree_node = p_arena->p_free;
+    p_arena->p_free                 = p_tree_node;
+    p_arena->allocated--;
+
+    (void)pthread_mutex_unlock(&p_arena->lock);
+}
+
+/* Nodes created by this thread through the hooks come from p_arena, NULL restores the default */
+void node_arena_bind(st_node_arena_t *const p_arena)
+{
+    p_bound_arena = p_arena;
+}
+
+/*
+    Hooks for tree_set_node_allocator(): nodes come from p_arena, or from the arena bound to
+    the calling thread, one per partition. Install them before any tree is built, since
+    every node freed through them must belong to an arena.
+*/
+void node_arena_allocator(st_node_arena_t *const p_arena, st_node_allocator_t *const p_allocator)
+{
+    if ((NULL != p_arena) && (NULL != p_allocator))
+    {
+        p_allocator->pf_alloc = arena_alloc_node;
+        p_allocator->pf_free  = arena_free_node;
+        p_allocator->p_ctx    = p_arena;
+    }
+}
+
+/* 1 without libnuma */
+int32_t node_arena_node_count(void)
+{
+#ifdef HAVE_LIBNUMA
+    if (true == numa_ready())
+    {
+        return numa_max_node() + 1;
+    }
+#endif
+
+    return 1;
+}
+
+/* NUMA node of the CPU running the caller, 0 without libnuma */
+int32_t node_arena_current_node(void)
+{
+#ifdef HAVE_LIBNUMA
+    int32_t cpu = sched_getcpu();
+
+    if ((cpu != last_cpu) && (0 <= cpu) && (true == numa_ready()))
+    {
+        last_node = numa_node_of_cpu(cpu);
+        last_node = (0 > last_node) ? 0 : last_node;
+        last_cpu  = cpu;
+    }
+
+    return last_node;
+#else
+    return 0;
+#endif
+}
+
+/* Every node of the arena must be unused */
+void node_arena_destroy(st_node_arena_t *const p_arena)
+{
+    st_node_arena_region_t *p_region;
+
+    if (NULL == p_arena)
+    {
+        return;
+    }
+
+    if (p_bound_arena == p_arena)
+    {
+        p_bound_arena = NULL;
+    }
+
+    while (NULL != p_arena->p_regions)
+    {
+        p_region           = p_arena->p_regions;
+        p_arena->p_regions = p_region->p_next;
+        (void)munmap(p_region, NODE_ARENA_REGION_BYTES);
+    }
+
+    (void)pthread_mutex_destroy(&p_arena->lock);
+    memset(p_arena, 0, sizeof(st_node_arena_t));
+}
\ No newline at end of file
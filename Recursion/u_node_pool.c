@@ -0,0 +1,115 @@
+#include "u_node_pool.h"
+
+static e_retcode_t node_pool_grow(st_node_pool_t *const p_pool);
+
+/* Called with the lock held */
+static e_retcode_t node_pool_grow(st_node_pool_t *const p_pool)
+{
+    st_tree_node_t  *p_chunk;
+    void            **pp_bigger;
+    size_t          i;
+
+    pp_bigger = (void **)realloc(p_pool->pp_chunks, (p_pool->chunk_count + 1) * sizeof(void *));
+    if (NULL == pp_bigger)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+    p_pool->pp_chunks = pp_bigger;
+
+    /* The free stack must be able to hold every node ever carved */
+    pp_bigger = (void **)realloc(p_pool->pp_free, (p_pool->chunk_count + 1) * NODE_POOL_CHUNK_NODES * sizeof(void *));
+    if (NULL == pp_bigger)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_pool->pp_free       = pp_bigger;
+    p_pool->free_capacity = (p_pool->chunk_count + 1) * NODE_POOL_CHUNK_NODES;
+
+    p_chunk = (st_tree_node_t *)malloc(NODE_POOL_CHUNK_NODES * sizeof(st_tree_node_t));
+    if (NULL == p_chunk)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_pool->pp_chunks[p_pool->chunk_count++] = p_chunk;
+
+    /* Push in reverse so that consecutive allocations walk the chunk forward */
+    for (i = NODE_POOL_CHUNK_NODES; i > 0; i--)
+    {
+        p_pool->pp_free[p_pool->free_count++] = &p_chunk[i - 1];
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+e_retcode_t node_pool_init(st_node_pool_t *const p_pool)
+{
+    if (NULL == p_pool)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_pool, 0, sizeof(st_node_pool_t));
+    (void)pthread_mutex_init(&p_pool->lock, NULL);
+
+    return RET_ERRCODE_OK;
+}
+
+st_tree_node_t *node_pool_alloc(st_node_pool_t *const p_pool)
+{
+    st_tree_node_t *p_tree_node = NULL;
+
+    if (NULL == p_pool)
+    {
+        return NULL;
+    }
+
+    (void)pthread_mutex_lock(&p_pool->lock);
+
+    if ((0 < p_pool->free_count) || (RET_ERRCODE_OK == node_pool_grow(p_pool)))
+    {
+        p_tree_node = (st_tree_node_t *)p_pool->pp_free[--p_pool->free_count];
+        p_pool->allocated++;
+    }
+
+    (void)pthread_mutex_unlock(&p_pool->lock);
+
+    return p_tree_node;
+}
+
+void node_pool_free(st_node_pool_t *const p_pool, st_tree_node_t *const p_tree_node)
+{
+    if ((NULL == p_pool) || (NULL == p_tree_node))
+    {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&p_pool->lock);
+
+    /* Every node came from a chunk, so the free stack always has room for it */
+    p_pool->pp_free[p_pool->free_count++] = p_tree_node;
+    p_pool->allocated--;
+
+    (void)pthread_mutex_unlock(&p_pool->lock);
+}
+
+void node_pool_destroy(st_node_pool_t *const p_pool)
+{
+    size_t i;
+
+    if (NULL == p_pool)
+    {
+        return;
+    }
+
+    for (i = 0; i < p_pool->chunk_count; i++)
+    {
+        free(p_pool->pp_chunks[i]);
+    }
+
+    free(p_pool->pp_chunks);
+    free(p_pool->pp_free);
+    (void)pthread_mutex_destroy(&p_pool->lock);
+    memset(p_pool, 0, sizeof(st_node_pool_t));
+}
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "u_packed_tree.h"
+
+static uint32_t block_width(const st_packed_tree_t *const p_tree, const uint32_t block);
+static int32_t block_key_count(const st_packed_tree_t *const p_tree, const uint32_t block);
+static uint32_t find_block(const st_packed_tree_t *const p_tree, const int32_t key);
+static void pack_block(const int32_t *const p_keys, const int32_t count, const uint32_t width, uint32_t *const p_words);
+static void unpack_block(const uint32_t *const p_words, const uint32_t width, const int32_t base, int32_t *const p_keys);
+static int32_t get_key(const uint32_t *const p_words, const uint32_t width, const int32_t base, const int32_t index);
+
+static uint32_t block_width(const st_packed_tree_t *const p_tree, const uint32_t block)
+{
+    return (p_tree->p_blocks[block + 1].word_offset - p_tree->p_blocks[block].word_offset) / PACKED_LANES;
+}
+
+/* Only the last block may be short */
+static int32_t block_key_count(const st_packed_tree_t *const p_tree, const uint32_t block)
+{
+    int32_t count = p_tree->key_count - (int32_t)(block * PACKED_BLOCK_KEYS);
+
+    return (PACKED_BLOCK_KEYS < count) ? PACKED_BLOCK_KEYS : count;
+}
+
+/* Last block whose base is <= key. The caller checks key against the first base */
+static uint32_t find_block(const st_packed_tree_t *const p_tree, const int32_t key)
+{
+    uint32_t low  = 0;
+    uint32_t size = p_tree->block_count;
+    uint32_t half;
+
+    while (1 < size)
+    {
+        half  = size / 2;
+        low  += (p_tree->p_blocks[low + half].base <= key) ? half : 0;
+        size -= half;
+    }
+
+    return low;
+}
+
+/* p_words is zeroed. Missing keys of a short block repeat the last delta */
+static void pack_block(const int32_t *const p_keys, const int32_t count, const uint32_t width, uint32_t *const p_words)
+{
+    uint32_t    delta = 0;
+    uint32_t    bit;
+    uint32_t    shift;
+    uint32_t    *p_word;
+    int32_t     i;
+
+    if (0 == width)
+    {
+        return;
+    }
+
+    for (i = 0; i < PACKED_BLOCK_KEYS; i++)
+    {
+        if (i < count)
+        {
+            delta = (uint32_t)p_keys[i] - (uint32_t)p_keys[0];
+        }
+
+        bit    = (uint32_t)(i / PACKED_LANES) * width;
+        shift  = bit % 32;
+        p_word = &p_words[((bit / 32) * PACKED_LANES) + (uint32_t)(i % PACKED_LANES)];
+
+        p_word[0] |= delta << shift;
+
+        /* The delta straddles two words of its lane */
+        if (32 < (shift + width))
+        {
+            p_word[PACKED_LANES] |= delta >> (32 - shift);
+        }
+    }
+}
+
+/* Decode a whole block into PACKED_BLOCK_KEYS keys. The lane loops have no dependency and vectorize */
+static void unpack_block(const uint32_t *const p_words, const uint32_t width, const int32_t base, int32_t *const p_keys)
+{
+    const uint32_t  *p_word;
+    uint32_t        mask = (uint32_t)((1ull << width) - 1);
+    uint32_t        bit;
+    uint32_t        shift;
+    int32_t         position;
+    int32_t         lane;
+
+    for (position = 0; position < (PACKED_BLOCK_KEYS / PACKED_LANES); position++)
+    {
+        bit    = (uint32_t)position * width;
+        shift  = bit % 32;
+        p_word = &p_words[(bit / 32) * PACKED_LANES];
+
+        if (0 == width)
+        {
+            for (lane = 0; lane < PACKED_LANES; lane++)
+            {
+                p_keys[(PACKED_LANES * position) + lane] = base;
+            }
+        }
+        else if (32 < (shift + width))
+        {
+            for (lane = 0; lane < PACKED_LANES; lane++)
+            {
+                p_keys[(PACKED_LANES * position) + lane] = (int32_t)((uint32_t)base + (((p_word[lane] >> shift) | (p_word[PACKED_LANES + lane] << (32 - shift))) & mask));
+            }
+        }
+        else
+        {
+            for (lane = 0; lane < PACKED_LANES; lane++)
+            {
+                p_keys[(PACKED_LANES * position) + lane] = (int32_t)((uint32_t)base + ((p_word[lane] >> shift) & mask));
+            }
+        }
+    }
+}
+
+/* Decode one key, for the binary search inside a block */
+static int32_t get_key(const uint32_t *const p_words, const uint32_t width, const int32_t base, const int32_t index)
+{
+    const uint32_t  *p_word;
+    uint32_t        bit   = (uint32_t)(index / PACKED_LANES) * width;
+    uint32_t        shift = bit % 32;
+    uint32_t        delta;
+
+    if (0 == width)
+    {
+        return base;
+    }
+
+    p_word = &p_words[((bit / 32) * PACKED_LANES) + (uint32_t)(index % PACKED_LANES)];
+    delta  = p_word[0] >> shift;
+
+    if (32 < (shift + width))
+    {
+        delta |= p_word[PACKED_LANES] << (32 - shift);
+    }
+
+    return (int32_t)((uint32_t)base + (delta & (uint32_t)((1ull << width) - 1)));
+}
+
+e_retcode_t packed_tree_build_sorted(const int32_t *const p_sorted_keys, const int32_t count, const e_leaf_encoding_t encoding, st_packed_tree_t *const p_tree)
+{
+    const int32_t   *p_keys;
+    uint32_t        deltas;
+    uint32_t        width;
+    uint32_t        block;
+    int32_t         block_keys;
+    int32_t         i;
+
+    if ((NULL == p_tree) || ((NULL == p_sorted_keys) && (0 < count)))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((0 > count) || ((LEAF_ENCODING_PLAIN != encoding) && (LEAF_ENCODING_FOR != encoding)))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    memset(p_tree, 0, sizeof(st_packed_tree_t));
+    p_tree->encoding    = encoding;
+    p_tree->block_count = (uint32_t)((count + PACKED_BLOCK_KEYS - 1) / PACKED_BLOCK_KEYS);
+    p_tree->p_blocks    = (st_packed_block_t *)malloc(((size_t)p_tree->block_count + 1) * sizeof(st_packed_block_t));
+    if (NULL == p_tree->p_blocks)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    /* First pass: bases and widths, so the words are allocated once */
+    p_tree->p_blocks[0].word_offset = 0;
+
+    for (block = 0; block < p_tree->block_count; block++)
+    {
+        p_keys     = &p_sorted_keys[block * PACKED_BLOCK_KEYS];
+        block_keys = ((count - (int32_t)(block * PACKED_BLOCK_KEYS)) < PACKED_BLOCK_KEYS) ? (count - (int32_t)(block * PACKED_BLOCK_KEYS)) : PACKED_BLOCK_KEYS;
+        deltas     = 0;
+
+        for (i = 1; i < block_keys; i++)
+        {
+            deltas |= (uint32_t)p_keys[i] - (uint32_t)p_keys[0];
+        }
+
+        width = (LEAF_ENCODING_PLAIN == encoding) ? 32 : ((0 == deltas) ? 0 : (32 - (uint32_t)__builtin_clz(deltas)));
+
+        p_tree->p_blocks[block].base            = p_keys[0];
+        p_tree->p_blocks[block + 1].word_offset = p_tree->p_blocks[block].word_offset + (width * PACKED_LANES);
+    }
+
+    /* One spare lane row: calloc(0) may return NULL */
+    p_tree->p_words = (uint32_t *)calloc((size_t)p_tree->p_blocks[p_tree->block_count].word_offset + PACKED_LANES, sizeof(uint32_t));
+    if (NULL == p_tree->p_words)
+    {
+        packed_tree_destroy(p_tree);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_tree->key_count = count;
+
+    for (block = 0; block < p_tree->block_count; block++)
+    {
+        pack_block(&p_sorted_keys[block * PACKED_BLOCK_KEYS], block_key_count(p_tree, block), block_width(p_tree, block),
+                   &p_tree->p_words[p_tree->p_blocks[block].word_offset]);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+e_retcode_t packed_tree_build(const st_tree_node_t *const p_root, const e_leaf_encoding_t encoding, st_packed_tree_t *const p_tree)
+{
+    e_retcode_t ret;
+    int32_t     *p_sorted_keys;
+    int32_t     count;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    count         = tree_key_count(p_root);
+    p_sorted_keys = (int32_t *)malloc(((size_t)count + 1) * sizeof(int32_t));
+    if (NULL == p_sorted_keys)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    count = tree_export_keys(p_root, p_sorted_keys, count);
+    ret   = packed_tree_build_sorted(p_sorted_keys, count, encoding, p_tree);
+
+    free(p_sorted_keys);
+
+    return ret;
+}
+
+bool_t packed_tree_search(const st_packed_tree_t *const p_tree, const int32_t searched_key)
+{
+    const uint32_t  *p_words;
+    uint32_t        block;
+    uint32_t        width;
+    int32_t         base;
+    int32_t         low;
+    int32_t         size;
+    int32_t         half;
+
+    if ((NULL == p_tree) || (0 == p_tree->key_count) || (searched_key < p_tree->p_blocks[0].base))
+    {
+        return false;
+    }
+
+    block   = find_block(p_tree, searched_key);
+    width   = block_width(p_tree, block);
+    base    = p_tree->p_blocks[block].base;
+    p_words = &p_tree->p_words[p_tree->p_blocks[block].word_offset];
+    low     = 0;
+    size    = block_key_count(p_tree, block);
+
+    /* Single keys are decoded in place: a probe costs a shift and a mask */
+    while (1 < size)
+    {
+        half  = size / 2;
+        low  += (get_key(p_words, width, base, low + half) <= searched_key) ? half : 0;
+        size -= half;
+    }
+
+    return (searched_key == get_key(p_words, width, base, low));
+}
+
+/* Visit every key in [low, high] in ascending order, return the number visited */
+int32_t packed_tree_range_scan(const st_packed_tree_t *const p_tree, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx)
+{
+    int32_t     keys[PACKED_BLOCK_KEYS];
+    uint32_t    block;
+    int32_t     block_keys;
+    int32_t     visited = 0;
+    int32_t     i;
+
+    if ((NULL == p_tree) || (0 == p_tree->key_count) || (NULL == pf_visitor))
+    {
+        return 0;
+    }
+
+    block = (low < p_tree->p_blocks[0].base) ? 0 : find_block(p_tree, low);
+
+    for (; block < p_tree->block_count; block++)
+    {
+        if (high < p_tree->p_blocks[block].base)
+        {
+            break;
+        }
+
+        unpack_block(&p_tree->p_words[p_tree->p_blocks[block].word_offset], block_width(p_tree, block), p_tree->p_blocks[block].base, keys);
+        block_keys = block_key_count(p_tree, block);
+
+        for (i = 0; (i < block_keys) && (keys[i] <= high); i++)
+        {
+            if (low <= keys[i])
+            {
+                pf_visitor(keys[i], p_ctx);
+                visited++;
+            }
+        }
+    }
+
+    return visited;
+}
+
+size_t packed_tree_bytes(const st_packed_tree_t *const p_tree)
+{
+    size_t bytes = 0;
+
+    if ((NULL != p_tree) && (NULL != p_tree->p_blocks))
+    {
+        bytes = (((size_t)p_tree->block_count + 1) * sizeof(st_packed_block_t)) + ((size_t)p_tree->p_blocks[p_tree->block_count].word_offset * sizeof(uint32_t));
+    }
+
+    return bytes;
+}
+
+void packed_tree_destroy(st_packed_tree_t *const p_tree)
+{
+    if (NULL != p_tree)
+    {
+        free(p_tree->p_blocks);
+        free(p_tree->p_words);
+        memset(p_tree, 0, sizeof(st_packed_tree_t));
+    }
+}
\ No newline at end of file
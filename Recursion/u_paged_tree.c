@@ -0,0 +1,619 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "u_paged_tree.h"
+
+static e_retcode_t node_pin(st_paged_tree_t *const p_tree, const uint32_t node_id, const bool_t is_new, st_disk_node_t **const pp_node);
+static void node_unpin(st_paged_tree_t *const p_tree, const uint32_t node_id, const bool_t dirty);
+static e_retcode_t node_alloc(st_paged_tree_t *const p_tree, uint32_t *const p_node_id, st_disk_node_t **const pp_node);
+static e_retcode_t write_header(st_paged_tree_t *const p_tree);
+static e_retcode_t repair_underflow(st_paged_tree_t *const p_tree, const uint32_t *const p_path, const int32_t *const p_taken, const int32_t depth);
+
+static e_retcode_t node_pin(st_paged_tree_t *const p_tree, const uint32_t node_id, const bool_t is_new, st_disk_node_t **const pp_node)
+{
+    uint8_t *p_page;
+
+    if (RET_ERRCODE_OK != buffer_pool_pin(&p_tree->pool, (uint32_t)(node_id / DISK_NODES_PER_PAGE) + 1, is_new, &p_page))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    *pp_node = (st_disk_node_t *)&p_page[(node_id % DISK_NODES_PER_PAGE) * sizeof(st_disk_node_t)];
+
+    return RET_ERRCODE_OK;
+}
+
+static void node_unpin(st_paged_tree_t *const p_tree, const uint32_t node_id, const bool_t dirty)
+{
+    buffer_pool_unpin(&p_tree->pool, (uint32_t)(node_id / DISK_NODES_PER_PAGE) + 1, dirty);
+}
+
+/* New nodes take the next id, a node opening a fresh page does not read it from the file */
+static e_retcode_t node_alloc(st_paged_tree_t *const p_tree, uint32_t *const p_node_id, st_disk_node_t **const pp_node)
+{
+    uint32_t node_id = (uint32_t)p_tree->header.node_count;
+
+    if ((DISK_NODE_NONE - 1) <= p_tree->header.node_count)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    if (RET_ERRCODE_OK != node_pin(p_tree, node_id, (0 == (node_id % DISK_NODES_PER_PAGE)), pp_node))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_tree->header.node_count++;
+    *p_node_id = node_id;
+
+    return RET_ERRCODE_OK;
+}
+
+static e_retcode_t write_header(st_paged_tree_t *const p_tree)
+{
+    uint8_t page[DISK_TREE_PAGE_SIZE];
+    size_t  done = 0;
+    ssize_t written;
+
+    memset(page, 0, sizeof(page));
+    memcpy(page, &p_tree->header, sizeof(st_disk_header_t));
+
+    while (done < sizeof(page))
+    {
+        written = pwrite(p_tree->fd, &page[done], sizeof(page) - done, (off_t)done);
+        if (0 >= written)
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        done += (size_t)written;
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Open the image built by disk_tree_build(), or start an empty one when the file is
+    missing or empty. frame_count pages of the image are cached; the upper levels are
+    touched by every operation, so CLOCK keeps them resident on its own.
+*/
+e_retcode_t paged_tree_open(st_paged_tree_t *const p_tree, const char *const p_image_path, const uint32_t frame_count)
+{
+    struct stat image_stat;
+    ssize_t     bytes;
+
+    if ((NULL == p_tree) || (NULL == p_image_path))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_tree, 0, sizeof(st_paged_tree_t));
+
+    p_tree->fd = open(p_image_path, O_RDWR | O_CREAT, 0644);
+    if ((0 > p_tree->fd) || (0 != fstat(p_tree->fd, &image_stat)))
+    {
+        if (0 <= p_tree->fd)
+        {
+            close(p_tree->fd);
+        }
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    if (0 == image_stat.st_size)
+    {
+        p_tree->header.magic     = DISK_TREE_MAGIC;
+        p_tree->header.version   = DISK_TREE_VERSION;
+        p_tree->header.page_size = DISK_TREE_PAGE_SIZE;
+        p_tree->header.root      = DISK_NODE_NONE;
+    }
+    else
+    {
+        bytes = pread(p_tree->fd, &p_tree->header, sizeof(st_disk_header_t), 0);
+
+        if (((ssize_t)sizeof(st_disk_header_t) != bytes) || (DISK_TREE_MAGIC != p_tree->header.magic)
+         || (DISK_TREE_VERSION != p_tree->header.version) || (DISK_TREE_PAGE_SIZE != p_tree->header.page_size))
+        {
+            close(p_tree->fd);
+            return RET_ERRCODE_NG_PARAM;
+        }
+    }
+
+    if (RET_ERRCODE_OK != buffer_pool_init(&p_tree->pool, p_tree->fd, frame_count))
+    {
+        close(p_tree->fd);
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/* One node is pinned at a time, for as long as its keys are compared */
+e_retcode_t paged_tree_search(st_paged_tree_t *const p_tree, const int32_t key, bool_t *const p_found)
+{
+    st_disk_node_t  *p_node;
+    uint32_t        node_id;
+    uint32_t        next_id;
+    int32_t         index;
+
+    if ((NULL == p_tree) || (NULL == p_found))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    *p_found = false;
+
+    for (node_id = p_tree->header.root; DISK_NODE_NONE != node_id; node_id = next_id)
+    {
+        if (RET_ERRCODE_OK != node_pin(p_tree, node_id, false, &p_node))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        if ((key == p_node->keys[FIRST_KEY]) || (key == p_node->keys[SECOND_KEY]))
+        {
+            *p_found = true;
+            next_id  = DISK_NODE_NONE;
+        }
+        else
+        {
+            index   = (int32_t)(key > p_node->keys[FIRST_KEY]) + (int32_t)(((-1) != p_node->keys[SECOND_KEY]) && (key > p_node->keys[SECOND_KEY]));
+            next_id = p_node->children[index];
+        }
+
+        node_unpin(p_tree, node_id, false);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Same bottom-up splitting as tree_path_insert(), on node ids: the descent records the
+    path, then each full node keeps its smallest key, gives its largest to a new node and
+    sends the middle one up. At most two nodes are pinned at once.
+    An I/O error in the middle of the splits leaves the image inconsistent.
+*/
+e_retcode_t paged_tree_insert(st_paged_tree_t *const p_tree, const int32_t key)
+{
+    st_disk_node_t  *p_node;
+    st_disk_node_t  *p_split;
+    uint32_t        path[TREE_MAX_HEIGHT];
+    uint32_t        children[MAX_KEY + 2];
+    int32_t         keys[MAX_KEY + 1];
+    uint32_t        new_child = DISK_NODE_NONE;
+    uint32_t        split_id;
+    uint32_t        node_id;
+    uint32_t        next_id;
+    int32_t         up_key = key;
+    int32_t         depth = 0;
+    int32_t         level;
+    int32_t         position;
+    int32_t         i;
+    bool_t          found = false;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    for (node_id = p_tree->header.root; (DISK_NODE_NONE != node_id) && (false == found); depth++)
+    {
+        if (RET_ERRCODE_OK != node_pin(p_tree, node_id, false, &p_node))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        path[depth] = node_id;
+        found       = ((key == p_node->keys[FIRST_KEY]) || (key == p_node->keys[SECOND_KEY]));
+        position    = (int32_t)(key > p_node->keys[FIRST_KEY]) + (int32_t)(((-1) != p_node->keys[SECOND_KEY]) && (key > p_node->keys[SECOND_KEY]));
+        next_id     = p_node->children[position];
+
+        node_unpin(p_tree, node_id, false);
+        node_id = next_id;
+    }
+
+    if (true == found)
+    {
+        return RET_ERRCODE_NG_DUPLICATE;
+    }
+
+    for (level = depth - 1; level >= 0; level--)
+    {
+        if (RET_ERRCODE_OK != node_pin(p_tree, path[level], false, &p_node))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        position = (int32_t)(up_key > p_node->keys[FIRST_KEY]) + (int32_t)(((-1) != p_node->keys[SECOND_KEY]) && (up_key > p_node->keys[SECOND_KEY]));
+
+        /* Node has only one key: absorb the key and the new child, done */
+        if ((-1) == p_node->keys[SECOND_KEY])
+        {
+            if (0 == position)
+            {
+                p_node->keys[SECOND_KEY]  = p_node->keys[FIRST_KEY];
+                p_node->children[RIGHT]   = p_node->children[MIDDLE];
+                p_node->children[MIDDLE]  = new_child;
+            }
+            else
+            {
+                p_node->children[RIGHT] = new_child;
+            }
+
+            p_node->keys[position] = up_key;
+
+            node_unpin(p_tree, path[level], true);
+            p_tree->header.key_count++;
+
+            return RET_ERRCODE_OK;
+        }
+
+        /* Node is full: lay out 3 keys and 4 children in order */
+        for (i = 0; i <= MAX_KEY; i++)
+        {
+            children[i] = p_node->children[i];
+        }
+
+        for (i = MAX_KEY; i > position; i--)
+        {
+            keys[i]         = p_node->keys[i - 1];
+            children[i + 1] = children[i];
+        }
+
+        for (i = 0; i < position; i++)
+        {
+            keys[i] = p_node->keys[i];
+        }
+
+        keys[position]         = up_key;
+        children[position + 1] = new_child;
+
+        if (RET_ERRCODE_OK != node_alloc(p_tree, &split_id, &p_split))
+        {
+            node_unpin(p_tree, path[level], false);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        p_split->keys[FIRST_KEY]  = keys[2];
+        p_split->keys[SECOND_KEY] = (-1);
+        p_split->children[LEFT]   = children[2];
+        p_split->children[MIDDLE] = children[3];
+        p_split->children[RIGHT]  = DISK_NODE_NONE;
+
+        p_node->keys[FIRST_KEY]   = keys[0];
+        p_node->keys[SECOND_KEY]  = (-1);
+        p_node->children[LEFT]    = children[0];
+        p_node->children[MIDDLE]  = children[1];
+        p_node->children[RIGHT]   = DISK_NODE_NONE;
+
+        node_unpin(p_tree, split_id, true);
+        node_unpin(p_tree, path[level], true);
+
+        up_key    = keys[1];
+        new_child = split_id;
+    }
+
+    /* The root itself was split, or the tree was empty: grow a new root */
+    if (RET_ERRCODE_OK != node_alloc(p_tree, &node_id, &p_node))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_node->keys[FIRST_KEY]  = up_key;
+    p_node->keys[SECOND_KEY] = (-1);
+    p_node->children[LEFT]   = p_tree->header.root;
+    p_node->children[MIDDLE] = new_child;
+    p_node->children[RIGHT]  = DISK_NODE_NONE;
+
+    node_unpin(p_tree, node_id, true);
+
+    p_tree->header.root = node_id;
+    p_tree->header.height++;
+    p_tree->header.key_count++;
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    The leaf at the end of the path has no key left: repair it bottom-up like path_delete().
+    A sibling with 2 keys lends one through the parent, or the empty node merges with a
+    sibling and takes the separator, which may empty the parent in turn. At most three
+    nodes are pinned at once. Merged nodes stay in the image unused.
+*/
+static e_retcode_t repair_underflow(st_paged_tree_t *const p_tree, const uint32_t *const p_path, const int32_t *const p_taken, const int32_t depth)
+{
+    st_disk_node_t  *p_node;
+    st_disk_node_t  *p_parent;
+    st_disk_node_t  *p_sibling;
+    uint32_t        orphan = DISK_NODE_NONE;
+    uint32_t        sibling_id;
+    int32_t         separator;
+    int32_t         level;
+    int32_t         index;
+    int32_t         key_count;
+    int32_t         i;
+    bool_t          is_empty;
+
+    for (level = depth - 1; level > 0; level--)
+    {
+        index = p_taken[level - 1];
+
+        if (RET_ERRCODE_OK != node_pin(p_tree, p_path[level - 1], false, &p_parent))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        if (RET_ERRCODE_OK != node_pin(p_tree, p_path[level], false, &p_node))
+        {
+            node_unpin(p_tree, p_path[level - 1], false);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        key_count = ((-1) != p_parent->keys[SECOND_KEY]) ? 2 : 1;
+
+        /* Borrow through the parent from a left sibling with 2 keys, or from a right one */
+        for (i = 0; i < 2; i++)
+        {
+            if (((0 == i) && (0 == index)) || ((1 == i) && (index == key_count)))
+            {
+                continue;
+            }
+
+            sibling_id = p_parent->children[(0 == i) ? (index - 1) : (index + 1)];
+            if (RET_ERRCODE_OK != node_pin(p_tree, sibling_id, false, &p_sibling))
+            {
+                node_unpin(p_tree, p_path[level], false);
+                node_unpin(p_tree, p_path[level - 1], false);
+                return RET_ERRCODE_NG_SYSTEM;
+            }
+
+            if ((-1) == p_sibling->keys[SECOND_KEY])
+            {
+                node_unpin(p_tree, sibling_id, false);
+                continue;
+            }
+
+            if (0 == i)
+            {
+                p_node->keys[FIRST_KEY]      = p_parent->keys[index - 1];
+                p_node->children[LEFT]       = p_sibling->children[RIGHT];
+                p_node->children[MIDDLE]     = orphan;
+                p_parent->keys[index - 1]    = p_sibling->keys[SECOND_KEY];
+            }
+            else
+            {
+                p_node->keys[FIRST_KEY]      = p_parent->keys[index];
+                p_node->children[LEFT]       = orphan;
+                p_node->children[MIDDLE]     = p_sibling->children[LEFT];
+                p_parent->keys[index]        = p_sibling->keys[FIRST_KEY];
+                p_sibling->keys[FIRST_KEY]   = p_sibling->keys[SECOND_KEY];
+                p_sibling->children[LEFT]    = p_sibling->children[MIDDLE];
+                p_sibling->children[MIDDLE]  = p_sibling->children[RIGHT];
+            }
+
+            p_node->children[RIGHT]     = DISK_NODE_NONE;
+            p_sibling->keys[SECOND_KEY] = (-1);
+            p_sibling->children[RIGHT]  = DISK_NODE_NONE;
+
+            node_unpin(p_tree, sibling_id, true);
+            node_unpin(p_tree, p_path[level], true);
+            node_unpin(p_tree, p_path[level - 1], true);
+
+            return RET_ERRCODE_OK;
+        }
+
+        /* Both neighbours hold one key: the separator joins one of them, with orphan */
+        separator  = (0 < index) ? (index - 1) : FIRST_KEY;
+        sibling_id = p_parent->children[(0 < index) ? (index - 1) : MIDDLE];
+        if (RET_ERRCODE_OK != node_pin(p_tree, sibling_id, false, &p_sibling))
+        {
+            node_unpin(p_tree, p_path[level], false);
+            node_unpin(p_tree, p_path[level - 1], false);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        if (0 < index)
+        {
+            p_sibling->keys[SECOND_KEY]  = p_parent->keys[separator];
+            p_sibling->children[RIGHT]   = orphan;
+        }
+        else
+        {
+            p_sibling->keys[SECOND_KEY]  = p_sibling->keys[FIRST_KEY];
+            p_sibling->keys[FIRST_KEY]   = p_parent->keys[FIRST_KEY];
+            p_sibling->children[RIGHT]   = p_sibling->children[MIDDLE];
+            p_sibling->children[MIDDLE]  = p_sibling->children[LEFT];
+            p_sibling->children[LEFT]    = orphan;
+        }
+
+        node_unpin(p_tree, sibling_id, true);
+        node_unpin(p_tree, p_path[level], false);
+
+        /* Close the gap left by the empty child and the separator */
+        for (i = index; i < key_count; i++)
+        {
+            p_parent->children[i] = p_parent->children[i + 1];
+        }
+        p_parent->children[key_count] = DISK_NODE_NONE;
+
+        for (i = separator; i < (key_count - 1); i++)
+        {
+            p_parent->keys[i] = p_parent->keys[i + 1];
+        }
+        p_parent->keys[key_count - 1] = (-1);
+
+        orphan   = p_parent->children[LEFT];
+        is_empty = ((-1) == p_parent->keys[FIRST_KEY]);
+        node_unpin(p_tree, p_path[level - 1], true);
+
+        if (false == is_empty)
+        {
+            return RET_ERRCODE_OK;
+        }
+    }
+
+    /* The root ran out of keys: its only child takes over */
+    p_tree->header.root = orphan;
+    p_tree->header.height--;
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Same single-pass delete as tree_remove(), on node ids: the descent records the path
+    and the child taken at each node, a key in an inner node is swapped with its
+    in-order successor so a key always leaves from a leaf, and an empty leaf is repaired
+    bottom-up. *p_removed tells whether key was there.
+    Nodes emptied by merges are not reused: rebuild the image with disk_tree_build()
+    to reclaim them. An I/O error during the repair leaves the image inconsistent.
+*/
+e_retcode_t paged_tree_delete(st_paged_tree_t *const p_tree, const int32_t key, bool_t *const p_removed)
+{
+    st_disk_node_t  *p_node;
+    st_disk_node_t  *p_found_node;
+    uint32_t        path[TREE_MAX_HEIGHT];
+    int32_t         taken[TREE_MAX_HEIGHT];
+    uint32_t        found_id = DISK_NODE_NONE;
+    uint32_t        node_id;
+    uint32_t        next_id;
+    int32_t         found_position = FIRST_KEY;
+    int32_t         removed;
+    int32_t         depth = 0;
+    int32_t         index;
+    int32_t         key_count;
+    bool_t          is_empty;
+
+    if ((NULL == p_tree) || (NULL == p_removed))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    *p_removed = false;
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    /* Down to the key, then on to the leftmost leaf on its right */
+    for (node_id = p_tree->header.root; DISK_NODE_NONE != node_id; node_id = next_id)
+    {
+        if (RET_ERRCODE_OK != node_pin(p_tree, node_id, false, &p_node))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        key_count = ((-1) != p_node->keys[SECOND_KEY]) ? 2 : 1;
+
+        if (DISK_NODE_NONE != found_id)
+        {
+            index = LEFT;
+        }
+        else if ((key == p_node->keys[FIRST_KEY]) || ((2 == key_count) && (key == p_node->keys[SECOND_KEY])))
+        {
+            found_id       = node_id;
+            found_position = (key == p_node->keys[FIRST_KEY]) ? FIRST_KEY : SECOND_KEY;
+            index          = found_position + 1;
+        }
+        else
+        {
+            index = (int32_t)(key > p_node->keys[FIRST_KEY]) + (int32_t)((2 == key_count) && (key > p_node->keys[SECOND_KEY]));
+        }
+
+        next_id = p_node->children[index];
+        node_unpin(p_tree, node_id, false);
+
+        path[depth]  = node_id;
+        taken[depth] = index;
+        depth++;
+    }
+
+    if (DISK_NODE_NONE == found_id)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    if (RET_ERRCODE_OK != node_pin(p_tree, path[depth - 1], false, &p_node))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    removed = found_position;
+
+    /* Swap with the successor: the first key of the leaf the descent ended on */
+    if (found_id != path[depth - 1])
+    {
+        if (RET_ERRCODE_OK != node_pin(p_tree, found_id, false, &p_found_node))
+        {
+            node_unpin(p_tree, path[depth - 1], false);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        p_found_node->keys[found_position] = p_node->keys[FIRST_KEY];
+        node_unpin(p_tree, found_id, true);
+        removed = FIRST_KEY;
+    }
+
+    if (FIRST_KEY == removed)
+    {
+        p_node->keys[FIRST_KEY] = p_node->keys[SECOND_KEY];
+    }
+    p_node->keys[SECOND_KEY] = (-1);
+    is_empty                 = ((-1) == p_node->keys[FIRST_KEY]);
+
+    node_unpin(p_tree, path[depth - 1], true);
+
+    *p_removed = true;
+    p_tree->header.key_count--;
+
+    if (false == is_empty)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    return repair_underflow(p_tree, path, taken, depth);
+}
+
+/* Write back dirty pages, then the header, and make both durable */
+e_retcode_t paged_tree_sync(st_paged_tree_t *const p_tree)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((RET_ERRCODE_OK != buffer_pool_flush(&p_tree->pool)) || (RET_ERRCODE_OK != write_header(p_tree)) || (0 != fdatasync(p_tree->fd)))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+e_retcode_t paged_tree_close(st_paged_tree_t *const p_tree)
+{
+    e_retcode_t ret;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    ret = paged_tree_sync(p_tree);
+
+    if (RET_ERRCODE_OK != buffer_pool_destroy(&p_tree->pool))
+    {
+        ret = RET_ERRCODE_NG_SYSTEM;
+    }
+
+    close(p_tree->fd);
+    p_tree->fd = (-1);
+
+    return ret;
+}
\ No newline at end of file
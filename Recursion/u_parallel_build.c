@@ -0,0 +1,591 @@
+#include <pthread.h>
+
+#include "u_parallel_build.h"
+
+#define PARALLEL_TASKS_PER_THREAD   (8)
+
+typedef void (*pf_job_t)(void *p_jobs, const int32_t index);
+
+typedef struct
+{
+    pf_job_t    pf_job;
+    void        *p_jobs;
+    int32_t     job_count;
+    int32_t     next_job;
+} st_job_queue_t;
+
+typedef struct
+{
+    int32_t     *p_keys;
+    int32_t     count;
+} st_sort_job_t;
+
+typedef struct
+{
+    const int32_t   *p_left;
+    int32_t         left_count;
+    const int32_t   *p_right;
+    int32_t         right_count;
+    int32_t         *p_out;
+} st_merge_job_t;
+
+typedef struct
+{
+    const int32_t   *p_sorted_keys;
+    const uintptr_t *p_values;      /**< NULL for all 0 */
+    int32_t         count;
+    int32_t         height;
+    st_tree_node_t  **pp_slot;
+
+    /* Bindings of the calling thread, for the workers */
+    const st_node_allocator_t   *p_allocator;
+    const st_tree_augment_t     *p_augment;
+    uint64_t                    *p_generation;
+} st_build_job_t;
+
+static void *job_worker(void *p_arg);
+static void run_jobs(st_job_queue_t *const p_queue, const int32_t thread_count);
+static int compare_keys(const void *p_left, const void *p_right);
+static void sort_job(void *p_jobs, const int32_t index);
+static void merge_job(void *p_jobs, const int32_t index);
+static void build_job(void *p_jobs, const int32_t index);
+static e_retcode_t parallel_sort(int32_t *const p_keys, const int32_t count, const int32_t thread_count);
+static int32_t unique_keys(int32_t *const p_keys, const int32_t count);
+static int32_t merge_entries(int32_t *const p_keys, uintptr_t *const p_values, const int32_t existing, const int32_t *const p_added_keys, const int32_t added);
+static void augment_top(st_tree_node_t *const p_tree_node, const int32_t levels);
+static e_retcode_t parallel_build_sorted(st_tree_node_t **const pp_root, const int32_t *const p_sorted_keys, const uintptr_t *const p_values, const int32_t count, const int32_t thread_count);
+
+/* Workers pull job indices from a shared counter until the queue is drained */
+static void *job_worker(void *p_arg)
+{
+    st_job_queue_t  *p_queue = (st_job_queue_t *)p_arg;
+    int32_t         index;
+
+    while (true)
+    {
+        index = __atomic_fetch_add(&p_queue->next_job, 1, __ATOMIC_RELAXED);
+        if (index >= p_queue->job_count)
+        {
+            break;
+        }
+
+        p_queue->pf_job(p_queue->p_jobs, index);
+    }
+
+    return NULL;
+}
+
+/* The calling thread is one of the workers */
+static void run_jobs(st_job_queue_t *const p_queue, const int32_t thread_count)
+{
+    pthread_t   threads[PARALLEL_MAX_THREADS];
+    int32_t     started = 0;
+    int32_t     i;
+
+    p_queue->next_job = 0;
+
+    for (i = 1; (i < thread_count) && (i < p_queue->job_count); i++)
+    {
+        if (0 == pthread_create(&threads[started], NULL, job_worker, p_queue))
+        {
+            started++;
+        }
+    }
+
+    (void)job_worker(p_queue);
+
+    for (i = 0; i < started; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+}
+
+static int compare_keys(const void *p_left, const void *p_right)
+{
+    const int32_t left  = *(const int32_t *)p_left;
+    const int32_t right = *(const int32_t *)p_right;
+
+    return (left > right) - (left < right);
+}
+
+static void sort_job(void *p_jobs, const int32_t index)
+{
+    st_sort_job_t *p_job = &((st_sort_job_t *)p_jobs)[index];
+
+    qsort(p_job->p_keys, (size_t)p_job->count, sizeof(int32_t), compare_keys);
+}
+
+static void merge_job(void *p_jobs, const int32_t index)
+{
+    st_merge_job_t  *p_job = &((st_merge_job_t *)p_jobs)[index];
+    int32_t         left   = 0;
+    int32_t         right  = 0;
+    int32_t         out    = 0;
+
+    while ((left < p_job->left_count) && (right < p_job->right_count))
+    {
+        if (p_job->p_left[left] <= p_job->p_right[right])
+        {
+            p_job->p_out[out++] = p_job->p_left[left++];
+        }
+        else
+        {
+            p_job->p_out[out++] = p_job->p_right[right++];
+        }
+    }
+
+    memcpy(&p_job->p_out[out], &p_job->p_left[left], (size_t)(p_job->left_count - left) * sizeof(int32_t));
+    out += p_job->left_count - left;
+    memcpy(&p_job->p_out[out], &p_job->p_right[right], (size_t)(p_job->right_count - right) * sizeof(int32_t));
+}
+
+static void build_job(void *p_jobs, const int32_t index)
+{
+    st_build_job_t              *p_job = &((st_build_job_t *)p_jobs)[index];
+    const st_node_allocator_t   *p_previous_allocator;
+    const st_tree_augment_t     *p_previous_augment;
+    uint64_t                    *p_previous_generation;
+
+    p_previous_allocator  = tree_bind_node_allocator(p_job->p_allocator);
+    p_previous_augment    = tree_bind_augment(p_job->p_augment);
+    p_previous_generation = tree_bind_free_generation(p_job->p_generation);
+
+    *p_job->pp_slot = tree_build_subtree(p_job->p_sorted_keys, p_job->p_values, p_job->count, p_job->height);
+
+    (void)tree_bind_free_generation(p_previous_generation);
+    (void)tree_bind_augment(p_previous_augment);
+    (void)tree_bind_node_allocator(p_previous_allocator);
+}
+
+/* Sort one chunk per thread, then merge neighbouring runs pairwise, one round per level */
+static e_retcode_t parallel_sort(int32_t *const p_keys, const int32_t count, const int32_t thread_count)
+{
+    st_job_queue_t  queue;
+    st_sort_job_t   sort_jobs[PARALLEL_MAX_THREADS];
+    st_merge_job_t  merge_jobs[PARALLEL_MAX_THREADS];
+    int32_t         run_offsets[PARALLEL_MAX_THREADS + 1];
+    int32_t         *p_source = p_keys;
+    int32_t         *p_target;
+    int32_t         *p_buffer;
+    int32_t         run_count;
+    int32_t         i;
+
+    run_count = (count < thread_count) ? 1 : thread_count;
+
+    for (i = 0; i <= run_count; i++)
+    {
+        run_offsets[i] = (int32_t)(((int64_t)count * i) / run_count);
+    }
+
+    for (i = 0; i < run_count; i++)
+    {
+        sort_jobs[i].p_keys = &p_keys[run_offsets[i]];
+        sort_jobs[i].count  = run_offsets[i + 1] - run_offsets[i];
+    }
+
+    queue.pf_job    = sort_job;
+    queue.p_jobs    = sort_jobs;
+    queue.job_count = run_count;
+    run_jobs(&queue, thread_count);
+
+    if (1 == run_count)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    p_buffer = (int32_t *)malloc((size_t)count * sizeof(int32_t));
+    if (NULL == p_buffer)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_target = p_buffer;
+
+    while (1 < run_count)
+    {
+        /* An odd run at the end is merged with an empty one, i.e. copied */
+        for (i = 0; i < run_count; i += 2)
+        {
+            merge_jobs[i / 2].p_left      = &p_source[run_offsets[i]];
+            merge_jobs[i / 2].left_count  = run_offsets[i + 1] - run_offsets[i];
+            merge_jobs[i / 2].p_right     = &p_source[run_offsets[i + 1]];
+            merge_jobs[i / 2].right_count = ((i + 1) < run_count) ? (run_offsets[i + 2] - run_offsets[i + 1]) : 0;
+            merge_jobs[i / 2].p_out       = &p_target[run_offsets[i]];
+        }
+
+        queue.pf_job    = merge_job;
+        queue.p_jobs    = merge_jobs;
+        queue.job_count = (run_count + 1) / 2;
+        run_jobs(&queue, thread_count);
+
+        for (i = 0; i < run_count; i += 2)
+        {
+            run_offsets[i / 2] = run_offsets[i];
+        }
+
+        run_offsets[(run_count + 1) / 2] = count;
+        run_count = (run_count + 1) / 2;
+
+        p_target = p_source;
+        p_source = (p_source == p_keys) ? p_buffer : p_keys;
+    }
+
+    if (p_source != p_keys)
+    {
+        memcpy(p_keys, p_source, (size_t)count * sizeof(int32_t));
+    }
+
+    free(p_buffer);
+
+    return RET_ERRCODE_OK;
+}
+
+/* Drop duplicates and blank keys from a sorted array, return the new count */
+static int32_t unique_keys(int32_t *const p_keys, const int32_t count)
+{
+    int32_t unique = 0;
+    int32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (((-1) != p_keys[i]) && ((0 == unique) || (p_keys[i] != p_keys[unique - 1])))
+        {
+            p_keys[unique++] = p_keys[i];
+        }
+    }
+
+    return unique;
+}
+
+/*
+    p_keys holds existing sorted keys, with their values, and room for added more after them.
+    Merge the sorted added keys in from the back, values 0, skipping those already there.
+    Returns the index where the merged run starts; it ends at existing + added.
+*/
+static int32_t merge_entries(int32_t *const p_keys, uintptr_t *const p_values, const int32_t existing, const int32_t *const p_added_keys, const int32_t added)
+{
+    int32_t old_index = existing - 1;
+    int32_t new_index = added - 1;
+    int32_t out       = existing + added;
+
+    while (0 <= new_index)
+    {
+        out--;
+
+        if ((0 <= old_index) && (p_keys[old_index] >= p_added_keys[new_index]))
+        {
+            if (p_keys[old_index] == p_added_keys[new_index])
+            {
+                new_index--;
+            }
+
+            p_keys[out]   = p_keys[old_index];
+            p_values[out] = p_values[old_index];
+            old_index--;
+        }
+        else
+        {
+            p_keys[out]   = p_added_keys[new_index];
+            p_values[out] = 0;
+            new_index--;
+        }
+    }
+
+    /* The existing keys still below out close the gap left by the duplicates */
+    out -= old_index + 1;
+    memmove(&p_keys[out], p_keys, (size_t)(old_index + 1) * sizeof(int32_t));
+    memmove(&p_values[out], p_values, (size_t)(old_index + 1) * sizeof(uintptr_t));
+
+    return out;
+}
+
+/* Augment the nodes of the top levels, laid out on this thread, once the subtrees below them are built */
+static void augment_top(st_tree_node_t *const p_tree_node, const int32_t levels)
+{
+    if ((0 == levels) || (NULL == p_tree_node))
+    {
+        return;
+    }
+
+    augment_top(p_tree_node->p_left_child, levels - 1);
+    augment_top(p_tree_node->p_middle_child, levels - 1);
+    augment_top(p_tree_node->p_right_child, levels - 1);
+    tree_augment_node(p_tree_node);
+}
+
+/*
+    Expand the top of the tree level by level on this thread until there are enough
+    independent subtrees to keep every thread busy, then build those concurrently.
+*/
+static e_retcode_t parallel_build_sorted(st_tree_node_t **const pp_root, const int32_t *const p_sorted_keys, const uintptr_t *const p_values, const int32_t count, const int32_t thread_count)
+{
+    st_job_queue_t  queue;
+    e_retcode_t     ret = RET_ERRCODE_OK;
+    st_build_job_t  *p_level;
+    st_build_job_t  *p_next_level;
+    st_build_job_t  *p_swap;
+    st_tree_node_t  *p_node;
+    st_tree_node_t  **pp_slots[MAX_KEY + 1];
+    int32_t         child_counts[MAX_KEY + 1];
+    const st_node_allocator_t   *p_allocator;
+    const st_tree_augment_t     *p_augment;
+    uint64_t                    *p_generation;
+    int32_t         target;
+    int32_t         top_levels = 0;
+    int32_t         level_count;
+    int32_t         next_count;
+    int32_t         child_count;
+    int32_t         offset;
+    int32_t         i;
+    int32_t         j;
+
+    target       = PARALLEL_TASKS_PER_THREAD * thread_count;
+    p_level      = (st_build_job_t *)malloc(((3 * (size_t)target) + 3) * sizeof(st_build_job_t));
+    p_next_level = (st_build_job_t *)malloc(((3 * (size_t)target) + 3) * sizeof(st_build_job_t));
+    if ((NULL == p_level) || (NULL == p_next_level))
+    {
+        free(p_level);
+        free(p_next_level);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    /* Bindings are per thread: the workers get the caller's through the jobs */
+    p_allocator  = tree_bind_node_allocator(NULL);
+    p_augment    = tree_bind_augment(NULL);
+    p_generation = tree_bind_free_generation(NULL);
+    (void)tree_bind_node_allocator(p_allocator);
+    (void)tree_bind_augment(p_augment);
+    (void)tree_bind_free_generation(p_generation);
+
+    p_level[0].p_sorted_keys = p_sorted_keys;
+    p_level[0].p_values      = p_values;
+    p_level[0].count         = count;
+    p_level[0].height        = tree_height_for_count(count);
+    p_level[0].pp_slot       = pp_root;
+    p_level[0].p_allocator   = p_allocator;
+    p_level[0].p_augment     = p_augment;
+    p_level[0].p_generation  = p_generation;
+    level_count              = 1;
+
+    /* Every job on a level has the same height, so one test covers them all */
+    while ((RET_ERRCODE_OK == ret) && (level_count < target) && (2 < p_level[0].height))
+    {
+        next_count = 0;
+
+        for (i = 0; i < level_count; i++)
+        {
+            p_node = create_node((-1), false);
+            *p_level[i].pp_slot = p_node;
+            if (NULL == p_node)
+            {
+                ret = RET_ERRCODE_NG_SYSTEM;
+                break;
+            }
+
+            pp_slots[LEFT]   = &p_node->p_left_child;
+            pp_slots[MIDDLE] = &p_node->p_middle_child;
+            pp_slots[RIGHT]  = &p_node->p_right_child;
+
+            child_count = tree_split_plan(p_level[i].count, p_level[i].height, child_counts);
+            offset      = 0;
+
+            for (j = 0; j < child_count; j++)
+            {
+                p_next_level[next_count].p_sorted_keys = &p_level[i].p_sorted_keys[offset];
+                p_next_level[next_count].p_values      = (NULL != p_level[i].p_values) ? &p_level[i].p_values[offset] : NULL;
+                p_next_level[next_count].count         = child_counts[j];
+                p_next_level[next_count].height        = p_level[i].height - 1;
+                p_next_level[next_count].pp_slot       = pp_slots[j];
+                p_next_level[next_count].p_allocator   = p_allocator;
+                p_next_level[next_count].p_augment     = p_augment;
+                p_next_level[next_count].p_generation  = p_generation;
+                next_count++;
+
+                offset += child_counts[j];
+
+                if (j < (child_count - 1))
+                {
+                    p_node->keys[j]   = p_level[i].p_sorted_keys[offset];
+                    p_node->values[j] = (NULL != p_level[i].p_values) ? p_level[i].p_values[offset] : 0;
+                    offset++;
+                }
+            }
+        }
+
+        p_swap       = p_level;
+        p_level      = p_next_level;
+        p_next_level = p_swap;
+        level_count  = next_count;
+        top_levels++;
+    }
+
+    if (RET_ERRCODE_OK == ret)
+    {
+        queue.pf_job    = build_job;
+        queue.p_jobs    = p_level;
+        queue.job_count = level_count;
+        run_jobs(&queue, thread_count);
+
+        for (i = 0; i < level_count; i++)
+        {
+            if (NULL == *p_level[i].pp_slot)
+            {
+                ret = RET_ERRCODE_NG_SYSTEM;
+            }
+        }
+    }
+
+    /* Links not filled in yet are still NULL, so a partial tree can be freed as it is */
+    if (RET_ERRCODE_OK == ret)
+    {
+        augment_top(*pp_root, top_levels);
+        (*pp_root)->is_root = true;
+    }
+    else
+    {
+        tree_destroy(pp_root);
+    }
+
+    free(p_level);
+    free(p_next_level);
+
+    return ret;
+}
+
+/* Replace the tree with one holding the given keys, in any order, duplicates ignored. All values are 0 */
+e_retcode_t parallel_build(st_tree_node_t **const pp_root, const int32_t *const p_keys, const int32_t count, const int32_t thread_count)
+{
+    e_retcode_t     ret;
+    st_tree_node_t  *p_new_root = NULL;
+    int32_t         *p_sorted_keys;
+    int32_t         unique;
+    int32_t         threads;
+
+    if ((NULL == pp_root) || ((NULL == p_keys) && (0 < count)))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((0 > count) || (0 >= thread_count))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    threads = (thread_count > PARALLEL_MAX_THREADS) ? PARALLEL_MAX_THREADS : thread_count;
+
+    if (0 == count)
+    {
+        tree_destroy(pp_root);
+        return RET_ERRCODE_OK;
+    }
+
+    p_sorted_keys = (int32_t *)malloc((size_t)count * sizeof(int32_t));
+    if (NULL == p_sorted_keys)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    memcpy(p_sorted_keys, p_keys, (size_t)count * sizeof(int32_t));
+
+    ret = parallel_sort(p_sorted_keys, count, threads);
+    if (RET_ERRCODE_OK == ret)
+    {
+        unique = unique_keys(p_sorted_keys, count);
+
+        if (0 < unique)
+        {
+            ret = parallel_build_sorted(&p_new_root, p_sorted_keys, NULL, unique, threads);
+        }
+    }
+
+    free(p_sorted_keys);
+
+    /* The old tree goes only once the new one is complete */
+    if (RET_ERRCODE_OK == ret)
+    {
+        tree_destroy(pp_root);
+        *pp_root = p_new_root;
+    }
+
+    return ret;
+}
+
+/*
+    Add many keys at once: the current keys, with their values, and the new ones, with
+    value 0, are rebuilt together. Keys already there keep their value. On failure the
+    tree is left as it was.
+*/
+e_retcode_t parallel_insert_bulk(st_tree_node_t **const pp_root, const int32_t *const p_keys, const int32_t count, const int32_t thread_count)
+{
+    e_retcode_t     ret;
+    st_tree_node_t  *p_new_root = NULL;
+    int32_t         *p_added_keys;
+    int32_t         *p_all_keys;
+    uintptr_t       *p_all_values;
+    int32_t         existing;
+    int32_t         added;
+    int32_t         start;
+    int32_t         threads;
+
+    if ((NULL == pp_root) || ((NULL == p_keys) && (0 < count)))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((0 > count) || (0 >= thread_count))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    if (0 == count)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    threads      = (thread_count > PARALLEL_MAX_THREADS) ? PARALLEL_MAX_THREADS : thread_count;
+    p_added_keys = (int32_t *)malloc((size_t)count * sizeof(int32_t));
+    if (NULL == p_added_keys)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    memcpy(p_added_keys, p_keys, (size_t)count * sizeof(int32_t));
+
+    ret = parallel_sort(p_added_keys, count, threads);
+    if (RET_ERRCODE_OK != ret)
+    {
+        free(p_added_keys);
+        return ret;
+    }
+
+    added        = unique_keys(p_added_keys, count);
+    existing     = tree_key_count(*pp_root);
+    p_all_keys   = (int32_t *)malloc(((size_t)existing + (size_t)added + 1) * sizeof(int32_t));
+    p_all_values = (uintptr_t *)malloc(((size_t)existing + (size_t)added + 1) * sizeof(uintptr_t));
+    if ((NULL == p_all_keys) || (NULL == p_all_values))
+    {
+        ret = RET_ERRCODE_NG_SYSTEM;
+    }
+    else
+    {
+        existing = tree_export_entries(*pp_root, p_all_keys, p_all_values, existing);
+        start    = merge_entries(p_all_keys, p_all_values, existing, p_added_keys, added);
+
+        if (start < (existing + added))
+        {
+            ret = parallel_build_sorted(&p_new_root, &p_all_keys[start], &p_all_values[start], (existing + added) - start, threads);
+        }
+    }
+
+    free(p_added_keys);
+    free(p_all_keys);
+    free(p_all_values);
+
+    if ((RET_ERRCODE_OK == ret) && (NULL != p_new_root))
+    {
+        tree_destroy(pp_root);
+        *pp_root = p_new_root;
+    }
+
+    return ret;
+}
\ No newline at end of file
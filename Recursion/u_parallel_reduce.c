@@ -0,0 +1,318 @@
+#include "u_parallel_reduce.h"
+
+#define REDUCE_TASKS_PER_WORKER (4)
+#define REDUCE_CACHE_LINE       (64)
+
+/* One slice of the key order: a whole subtree, or a single separator key above the split level */
+typedef struct
+{
+    const st_tree_node_t    *p_subtree;     /**< NULL for a separator key */
+    int32_t                 key;
+    int32_t                 low;
+    int32_t                 high;
+    const st_reduce_ops_t   *p_ops;
+    void                    *p_acc;
+} st_reduce_piece_t;
+
+typedef struct
+{
+    st_reduce_piece_t   *p_pieces;
+    int32_t             count;
+    int32_t             capacity;
+} st_piece_list_t;
+
+typedef struct
+{
+    pf_key_visitor_t    pf_visitor;
+    void                *p_ctx;
+} st_for_each_ctx_t;
+
+static e_retcode_t add_piece(st_piece_list_t *const p_list, const st_tree_node_t *const p_subtree, const int32_t key);
+static e_retcode_t split_tree(st_piece_list_t *const p_list, const st_tree_node_t *const p_tree_node, const int32_t depth, const int32_t low, const int32_t high);
+static void accumulate_key(const int32_t key, void *p_ctx);
+static void reduce_piece(void *p_arg);
+static void for_each_init(void *p_acc, void *p_ctx);
+static void for_each_accumulate(void *p_acc, const int32_t key, void *p_ctx);
+static void for_each_combine(void *p_acc, const void *p_right_acc, void *p_ctx);
+static void summary_init(void *p_acc, void *p_ctx);
+static void summary_accumulate(void *p_acc, const int32_t key, void *p_ctx);
+static void summary_combine(void *p_acc, const void *p_right_acc, void *p_ctx);
+
+static e_retcode_t add_piece(st_piece_list_t *const p_list, const st_tree_node_t *const p_subtree, const int32_t key)
+{
+    st_reduce_piece_t *p_bigger;
+
+    if (p_list->count == p_list->capacity)
+    {
+        p_bigger = (st_reduce_piece_t *)realloc(p_list->p_pieces, 2 * (size_t)p_list->capacity * sizeof(st_reduce_piece_t));
+        if (NULL == p_bigger)
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        p_list->p_pieces  = p_bigger;
+        p_list->capacity *= 2;
+    }
+
+    p_list->p_pieces[p_list->count].p_subtree = p_subtree;
+    p_list->p_pieces[p_list->count].key       = key;
+    p_list->count++;
+
+    return RET_ERRCODE_OK;
+}
+
+/* Cut the top depth levels into pieces, in key order, skipping children outside [low, high] */
+static e_retcode_t split_tree(st_piece_list_t *const p_list, const st_tree_node_t *const p_tree_node, const int32_t depth, const int32_t low, const int32_t high)
+{
+    e_retcode_t ret = RET_ERRCODE_OK;
+    bool_t      is_full;
+
+    if (NULL == p_tree_node)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    if ((0 == depth) || (NULL == p_tree_node->p_left_child))
+    {
+        return add_piece(p_list, p_tree_node, 0);
+    }
+
+    is_full = ((-1) != p_tree_node->keys[SECOND_KEY]);
+
+    if (low < p_tree_node->keys[FIRST_KEY])
+    {
+        ret = split_tree(p_list, p_tree_node->p_left_child, depth - 1, low, high);
+    }
+
+    if ((RET_ERRCODE_OK == ret) && (low <= p_tree_node->keys[FIRST_KEY]) && (p_tree_node->keys[FIRST_KEY] <= high))
+    {
+        ret = add_piece(p_list, NULL, p_tree_node->keys[FIRST_KEY]);
+    }
+
+    if ((RET_ERRCODE_OK == ret) && (high > p_tree_node->keys[FIRST_KEY]) && ((false == is_full) || (low < p_tree_node->keys[SECOND_KEY])))
+    {
+        ret = split_tree(p_list, p_tree_node->p_middle_child, depth - 1, low, high);
+    }
+
+    if ((RET_ERRCODE_OK == ret) && (true == is_full))
+    {
+        if ((low <= p_tree_node->keys[SECOND_KEY]) && (p_tree_node->keys[SECOND_KEY] <= high))
+        {
+            ret = add_piece(p_list, NULL, p_tree_node->keys[SECOND_KEY]);
+        }
+
+        if ((RET_ERRCODE_OK == ret) && (high > p_tree_node->keys[SECOND_KEY]))
+        {
+            ret = split_tree(p_list, p_tree_node->p_right_child, depth - 1, low, high);
+        }
+    }
+
+    return ret;
+}
+
+static void accumulate_key(const int32_t key, void *p_ctx)
+{
+    st_reduce_piece_t *p_piece = (st_reduce_piece_t *)p_ctx;
+
+    p_piece->p_ops->pf_accumulate(p_piece->p_acc, key, p_piece->p_ops->p_ctx);
+}
+
+static void reduce_piece(void *p_arg)
+{
+    st_reduce_piece_t *p_piece = (st_reduce_piece_t *)p_arg;
+
+    p_piece->p_ops->pf_init(p_piece->p_acc, p_piece->p_ops->p_ctx);
+
+    if (NULL == p_piece->p_subtree)
+    {
+        p_piece->p_ops->pf_accumulate(p_piece->p_acc, p_piece->key, p_piece->p_ops->p_ctx);
+    }
+    else
+    {
+        (void)tree_range_scan(p_piece->p_subtree, p_piece->low, p_piece->high, accumulate_key, p_piece);
+    }
+}
+
+/*
+    Reduce the keys in [low, high]. The top levels are split into independent subtree
+    tasks (about REDUCE_TASKS_PER_WORKER per worker) that run on the pool; separator keys
+    above the split become tiny pieces of their own. The result is written to p_result.
+    The tree must not be modified while this runs.
+*/
+e_retcode_t parallel_reduce(const st_tree_node_t *const p_root, const int32_t low, const int32_t high, const st_reduce_ops_t *const p_ops, st_thread_pool_t *const p_pool, void *const p_result)
+{
+    e_retcode_t     ret;
+    st_piece_list_t list;
+    uint8_t         *p_accs;
+    size_t          stride;
+    int32_t         depth;
+    int32_t         i;
+
+    if ((NULL == p_ops) || (NULL == p_pool) || (NULL == p_result))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((NULL == p_ops->pf_init) || (NULL == p_ops->pf_accumulate) || (NULL == p_ops->pf_combine) || (0 == p_ops->acc_size))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    p_ops->pf_init(p_result, p_ops->p_ctx);
+
+    if ((NULL == p_root) || (low > high))
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    /* Each level at least doubles the number of pieces */
+    depth = 0;
+    while ((1 << depth) < (REDUCE_TASKS_PER_WORKER * p_pool->worker_count))
+    {
+        depth++;
+    }
+
+    list.count    = 0;
+    list.capacity = 64;
+    list.p_pieces = (st_reduce_piece_t *)malloc((size_t)list.capacity * sizeof(st_reduce_piece_t));
+    if (NULL == list.p_pieces)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    ret = split_tree(&list, p_root, depth, low, high);
+
+    /* Each accumulator on cache lines of its own, so that workers never write to the same line */
+    stride = (p_ops->acc_size + REDUCE_CACHE_LINE - 1) & ~((size_t)REDUCE_CACHE_LINE - 1);
+    p_accs = (uint8_t *)aligned_alloc(REDUCE_CACHE_LINE, ((size_t)list.count + 1) * stride);
+    if ((RET_ERRCODE_OK != ret) || (NULL == p_accs))
+    {
+        free(p_accs);
+        free(list.p_pieces);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    for (i = 0; i < list.count; i++)
+    {
+        list.p_pieces[i].low   = low;
+        list.p_pieces[i].high  = high;
+        list.p_pieces[i].p_ops = p_ops;
+        list.p_pieces[i].p_acc = &p_accs[(size_t)i * stride];
+
+        if (NULL == list.p_pieces[i].p_subtree)
+        {
+            /* A single key is cheaper to fold here than to schedule */
+            reduce_piece(&list.p_pieces[i]);
+        }
+        else if (RET_ERRCODE_OK != thread_pool_submit(p_pool, reduce_piece, &list.p_pieces[i]))
+        {
+            reduce_piece(&list.p_pieces[i]);
+        }
+    }
+
+    thread_pool_wait(p_pool);
+
+    /* Fold left to right to keep key order */
+    for (i = 0; i < list.count; i++)
+    {
+        p_ops->pf_combine(p_result, list.p_pieces[i].p_acc, p_ops->p_ctx);
+    }
+
+    free(p_accs);
+    free(list.p_pieces);
+
+    return RET_ERRCODE_OK;
+}
+
+static void for_each_init(void *p_acc, void *p_ctx)
+{
+    (void)p_acc;
+    (void)p_ctx;
+}
+
+static void for_each_accumulate(void *p_acc, const int32_t key, void *p_ctx)
+{
+    st_for_each_ctx_t *p_for_each = (st_for_each_ctx_t *)p_ctx;
+
+    (void)p_acc;
+    p_for_each->pf_visitor(key, p_for_each->p_ctx);
+}
+
+static void for_each_combine(void *p_acc, const void *p_right_acc, void *p_ctx)
+{
+    (void)p_acc;
+    (void)p_right_acc;
+    (void)p_ctx;
+}
+
+/* Visit every key in [low, high] from the pool threads. No ordering, the visitor must be thread-safe */
+e_retcode_t parallel_for_each(const st_tree_node_t *const p_root, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx, st_thread_pool_t *const p_pool)
+{
+    st_for_each_ctx_t   for_each;
+    st_reduce_ops_t     ops;
+    uint8_t             unused;
+
+    if (NULL == pf_visitor)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    for_each.pf_visitor = pf_visitor;
+    for_each.p_ctx      = p_ctx;
+
+    ops.acc_size      = sizeof(uint8_t);
+    ops.pf_init       = for_each_init;
+    ops.pf_accumulate = for_each_accumulate;
+    ops.pf_combine    = for_each_combine;
+    ops.p_ctx         = &for_each;
+
+    return parallel_reduce(p_root, low, high, &ops, p_pool, &unused);
+}
+
+static void summary_init(void *p_acc, void *p_ctx)
+{
+    st_key_summary_t *p_summary = (st_key_summary_t *)p_acc;
+
+    (void)p_ctx;
+    p_summary->count = 0;
+    p_summary->sum   = 0;
+    p_summary->min   = INT32_MAX;
+    p_summary->max   = INT32_MIN;
+}
+
+static void summary_accumulate(void *p_acc, const int32_t key, void *p_ctx)
+{
+    st_key_summary_t *p_summary = (st_key_summary_t *)p_acc;
+
+    (void)p_ctx;
+    p_summary->count++;
+    p_summary->sum += key;
+    p_summary->min  = (key < p_summary->min) ? key : p_summary->min;
+    p_summary->max  = (key > p_summary->max) ? key : p_summary->max;
+}
+
+static void summary_combine(void *p_acc, const void *p_right_acc, void *p_ctx)
+{
+    st_key_summary_t        *p_summary = (st_key_summary_t *)p_acc;
+    const st_key_summary_t  *p_right   = (const st_key_summary_t *)p_right_acc;
+
+    (void)p_ctx;
+    p_summary->count += p_right->count;
+    p_summary->sum   += p_right->sum;
+    p_summary->min    = (p_right->min < p_summary->min) ? p_right->min : p_summary->min;
+    p_summary->max    = (p_right->max > p_summary->max) ? p_right->max : p_summary->max;
+}
+
+/* Count, sum, min and max of the keys in [low, high] */
+e_retcode_t parallel_summarize(const st_tree_node_t *const p_root, const int32_t low, const int32_t high, st_thread_pool_t *const p_pool, st_key_summary_t *const p_summary)
+{
+    st_reduce_ops_t ops;
+
+    ops.acc_size      = sizeof(st_key_summary_t);
+    ops.pf_init       = summary_init;
+    ops.pf_accumulate = summary_accumulate;
+    ops.pf_combine    = summary_combine;
+    ops.p_ctx         = NULL;
+
+    return parallel_reduce(p_root, low, high, &ops, p_pool, p_summary);
+}
\ No newline at end of file
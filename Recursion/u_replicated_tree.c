@@ -0,0 +1,290 @@
+#include "u_replicated_tree.h"
+
+static uint32_t child_slot(const st_tree_node_t *const p_tree_node, const int32_t key);
+static st_tree_node_t *child_at(const st_tree_node_t *const p_tree_node, const uint32_t slot);
+static bool_t copy_levels(st_node_arena_t *const p_arena, const st_tree_node_t *const p_original, const int32_t levels, st_tree_node_t **const pp_copy);
+static void free_levels(st_tree_node_t *const p_copy, const int32_t levels);
+static void free_replicas(st_replicated_tree_t *const p_tree);
+static bool_t replicas_current(const st_replicated_tree_t *const p_tree, const int32_t key);
+
+/* 0: left, 1: middle, 2: right. A blank second key never sends us right */
+static uint32_t child_slot(const st_tree_node_t *const p_tree_node, const int32_t key)
+{
+    uint32_t slot;
+
+    slot  = (uint32_t)(key > p_tree_node->keys[FIRST_KEY]);
+    slot += (uint32_t)(((-1) != p_tree_node->keys[SECOND_KEY]) && (key > p_tree_node->keys[SECOND_KEY]));
+
+    return slot;
+}
+
+static st_tree_node_t *child_at(const st_tree_node_t *const p_tree_node, const uint32_t slot)
+{
+    return (0 == slot) ? p_tree_node->p_left_child : ((1 == slot) ? p_tree_node->p_middle_child : p_tree_node->p_right_child);
+}
+
+/* Copy levels levels of the subtree; on failure *pp_copy holds what was copied */
+static bool_t copy_levels(st_node_arena_t *const p_arena, const st_tree_node_t *const p_original, const int32_t levels, st_tree_node_t **const pp_copy)
+{
+    st_tree_node_t *p_copy;
+
+    p_copy   = node_arena_alloc(p_arena);
+    *pp_copy = p_copy;
+
+    if (NULL == p_copy)
+    {
+        return false;
+    }
+
+    *p_copy                    = *p_original;
+    p_copy->values[FIRST_KEY]  = (uintptr_t)p_original;
+    p_copy->values[SECOND_KEY] = 0;
+
+    if ((1 == levels) || (NULL == p_original->p_left_child))
+    {
+        return true;
+    }
+
+    p_copy->p_left_child   = NULL;
+    p_copy->p_middle_child = NULL;
+    p_copy->p_right_child  = NULL;
+
+    if ((false == copy_levels(p_arena, p_original->p_left_child, levels - 1, &p_copy->p_left_child))
+        || (false == copy_levels(p_arena, p_original->p_middle_child, levels - 1, &p_copy->p_middle_child)))
+    {
+        return false;
+    }
+
+    return ((NULL == p_original->p_right_child) || (true == copy_levels(p_arena, p_original->p_right_child, levels - 1, &p_copy->p_right_child)));
+}
+
+/* Children of the last copied level are shared nodes and stay */
+static void free_levels(st_tree_node_t *const p_copy, const int32_t levels)
+{
+    if (NULL == p_copy)
+    {
+        return;
+    }
+
+    if (1 < levels)
+    {
+        free_levels(p_copy->p_left_child, levels - 1);
+        free_levels(p_copy->p_middle_child, levels - 1);
+        free_levels(p_copy->p_right_child, levels - 1);
+    }
+
+    node_arena_free(p_copy);
+}
+
+static void free_replicas(st_replicated_tree_t *const p_tree)
+{
+    int32_t replica;
+
+    for (replica = 0; replica < p_tree->replica_count; replica++)
+    {
+        free_levels(p_tree->p_replicas[replica], p_tree->levels);
+        p_tree->p_replicas[replica] = NULL;
+    }
+
+    p_tree->p_replicated_root = NULL;
+}
+
+/*
+    After a write of key: every node a write touches is on the path of key or a child of a
+    node on it, and gets a new version. Comparing versions down the copied path therefore
+    finds any change in the copied levels, and stops before reaching a node that was freed.
+*/
+static bool_t replicas_current(const st_replicated_tree_t *const p_tree, const int32_t key)
+{
+    const st_tree_node_t    *p_copy = p_tree->p_replicas[0];
+    const st_tree_node_t    *p_original;
+    int32_t                 depth;
+
+    if (p_tree->p_root != p_tree->p_replicated_root)
+    {
+        return false;
+    }
+
+    for (depth = 0; (depth < p_tree->levels) && (NULL != p_copy); depth++)
+    {
+        p_original = (const st_tree_node_t *)p_copy->values[FIRST_KEY];
+
+        if (p_original->version != p_copy->version)
+        {
+            return false;
+        }
+
+        p_copy = (depth < (p_tree->levels - 1)) ? child_at(p_copy, child_slot(p_copy, key)) : NULL;
+    }
+
+    return true;
+}
+
+/* levels copied levels, arena_flags as in node_arena_init() */
+e_retcode_t replicated_tree_init(st_replicated_tree_t *const p_tree, const int32_t levels, const uint32_t arena_flags)
+{
+    e_retcode_t ret;
+    int32_t     replica;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((1 > levels) || (REPLICATED_TREE_MAX_LEVELS < levels))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    memset(p_tree, 0, sizeof(st_replicated_tree_t));
+    p_tree->levels        = levels;
+    p_tree->replica_count = node_arena_node_count();
+
+    if (NODE_ARENA_MAX_NODES < p_tree->replica_count)
+    {
+        p_tree->replica_count = NODE_ARENA_MAX_NODES;
+    }
+
+    for (replica = 0; replica < p_tree->replica_count; replica++)
+    {
+        ret = node_arena_init(&p_tree->arenas[replica], (1 < p_tree->replica_count) ? replica : NODE_ARENA_ANY_NODE, arena_flags);
+        if (RET_ERRCODE_OK != ret)
+        {
+            while (0 < replica)
+            {
+                node_arena_destroy(&p_tree->arenas[--replica]);
+            }
+
+            return ret;
+        }
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/* Recopy the top levels of p_root into every arena */
+e_retcode_t replicated_tree_refresh(st_replicated_tree_t *const p_tree)
+{
+    int32_t replica;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    free_replicas(p_tree);
+
+    if (NULL == p_tree->p_root)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    for (replica = 0; replica < p_tree->replica_count; replica++)
+    {
+        if (false == copy_levels(&p_tree->arenas[replica], p_tree->p_root, p_tree->levels, &p_tree->p_replicas[replica]))
+        {
+            free_replicas(p_tree);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+    }
+
+    p_tree->p_replicated_root = p_tree->p_root;
+    p_tree->refreshes++;
+
+    return RET_ERRCODE_OK;
+}
+
+/* Same result as search(p_root, key), starting in the copy local to the caller's NUMA node */
+st_tree_node_t *replicated_tree_search(const st_replicated_tree_t *const p_tree, const int32_t searched_key)
+{
+    const st_tree_node_t    *p_tree_node;
+    int32_t                 depth;
+
+    if (NULL == p_tree)
+    {
+        return NULL;
+    }
+
+    p_tree_node = p_tree->p_replicas[node_arena_current_node() % p_tree->replica_count];
+
+    /* No copies (yet), or -1 which would match a blank key */
+    if ((NULL == p_tree_node) || ((-1) == searched_key))
+    {
+        return search(p_tree->p_root, searched_key);
+    }
+
+    for (depth = 0; (depth < p_tree->levels) && (NULL != p_tree_node); depth++)
+    {
+        if ((searched_key == p_tree_node->keys[FIRST_KEY]) || (searched_key == p_tree_node->keys[SECOND_KEY]))
+        {
+            return (st_tree_node_t *)p_tree_node->values[FIRST_KEY];
+        }
+
+        p_tree_node = child_at(p_tree_node, child_slot(p_tree_node, searched_key));
+    }
+
+    /* Shared nodes from here on */
+    return search(p_tree_node, searched_key);
+}
+
+/* Keys already present are ignored, like insert() */
+e_retcode_t replicated_tree_insert(st_replicated_tree_t *const p_tree, const int32_t key)
+{
+    st_tree_path_t  path;
+    e_retcode_t     ret;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    path.depth = 0;
+
+    ret = tree_path_insert(&p_tree->p_root, &path, key);
+    if (RET_ERRCODE_NG_DUPLICATE == ret)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    if ((RET_ERRCODE_OK == ret) && (false == replicas_current(p_tree, key)))
+    {
+        ret = replicated_tree_refresh(p_tree);
+    }
+
+    return ret;
+}
+
+e_retcode_t replicated_tree_delete(st_replicated_tree_t *const p_tree, const int32_t key)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((true == tree_remove(&p_tree->p_root, key)) && (false == replicas_current(p_tree, key)))
+    {
+        return replicated_tree_refresh(p_tree);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+void replicated_tree_destroy(st_replicated_tree_t *const p_tree)
+{
+    int32_t replica;
+
+    if (NULL == p_tree)
+    {
+        return;
+    }
+
+    free_replicas(p_tree);
+    tree_destroy(&p_tree->p_root);
+
+    for (replica = 0; replica < p_tree->replica_count; replica++)
+    {
+        node_arena_destroy(&p_tree->arenas[replica]);
+    }
+
+    p_tree->replica_count = 0;
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "u_shard_index.h"
+
+typedef struct
+{
+    st_tree_node_t  **pp_root;
+    st_index_op_t   *p_ops;
+    const int32_t   *p_order;       /**< Indices into p_ops, in batch order */
+    int32_t         count;
+} st_shard_batch_t;
+
+static void run_shard_batch(void *p_arg);
+
+/* No printf() and no lock: the results go back through the ops */
+static void run_shard_batch(void *p_arg)
+{
+    st_shard_batch_t    *p_batch = (st_shard_batch_t *)p_arg;
+    st_index_op_t       *p_op;
+    st_tree_path_t      path;
+    int32_t             i;
+
+    path.depth = 0;
+
+    for (i = 0; i < p_batch->count; i++)
+    {
+        p_op = &p_batch->p_ops[p_batch->p_order[i]];
+
+        if (INDEX_OP_INSERT == p_op->type)
+        {
+            p_op->ret   = tree_path_insert(p_batch->pp_root, &path, p_op->key);
+            p_op->found = (RET_ERRCODE_NG_DUPLICATE == p_op->ret);
+        }
+        else if (INDEX_OP_DELETE == p_op->type)
+        {
+            p_op->found = tree_remove(p_batch->pp_root, p_op->key);
+            p_op->ret   = ((-1) == p_op->key) ? RET_ERRCODE_NG_PARAM : RET_ERRCODE_OK;
+
+            /* The path only follows inserts */
+            tree_path_reset(&path);
+        }
+        else
+        {
+            p_op->found = (NULL != search(*p_batch->pp_root, p_op->key));
+            p_op->ret   = RET_ERRCODE_OK;
+        }
+    }
+}
+
+e_retcode_t shard_index_init(st_shard_index_t *const p_index, const int32_t *const p_lower_bounds, const int32_t shard_count)
+{
+    int32_t i;
+
+    if ((NULL == p_index) || (NULL == p_lower_bounds))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (0 >= shard_count)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    for (i = 2; i < shard_count; i++)
+    {
+        if (p_lower_bounds[i - 1] >= p_lower_bounds[i])
+        {
+            return RET_ERRCODE_NG_PARAM;
+        }
+    }
+
+    p_index->shard_count    = shard_count;
+    p_index->pp_roots       = (st_tree_node_t **)calloc((size_t)shard_count, sizeof(st_tree_node_t *));
+    p_index->p_lower_bounds = (int32_t *)malloc((size_t)shard_count * sizeof(int32_t));
+    if ((NULL == p_index->pp_roots) || (NULL == p_index->p_lower_bounds))
+    {
+        shard_index_destroy(p_index);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    memcpy(p_index->p_lower_bounds, p_lower_bounds, (size_t)shard_count * sizeof(int32_t));
+    p_index->p_lower_bounds[0] = INT32_MIN;
+
+    return RET_ERRCODE_OK;
+}
+
+/* Last shard whose lower bound is <= key */
+int32_t shard_index_route(const st_shard_index_t *const p_index, const int32_t key)
+{
+    int32_t low  = 0;
+    int32_t high = p_index->shard_count - 1;
+    int32_t middle;
+
+    while (low < high)
+    {
+        middle = low + ((high - low + 1) / 2);
+
+        if (p_index->p_lower_bounds[middle] <= key)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    return low;
+}
+
+/*
+    Run a mixed batch. Operations are grouped by shard with a stable counting sort,
+    so each shard sees its operations in batch order, then one task per shard is
+    submitted. Hot shards keep their worker busy while idle workers steal the rest.
+*/
+e_retcode_t shard_index_execute(st_shard_index_t *const p_index, st_index_op_t *const p_ops, const int32_t op_count, st_thread_pool_t *const p_pool)
+{
+    e_retcode_t         ret = RET_ERRCODE_OK;
+    st_shard_batch_t    *p_batches;
+    int32_t             *p_shard_of;
+    int32_t             *p_order;
+    int32_t             *p_offsets;
+    int32_t             i;
+
+    if ((NULL == p_index) || (NULL == p_pool) || ((NULL == p_ops) && (0 < op_count)))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (0 >= op_count)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    p_batches  = (st_shard_batch_t *)calloc((size_t)p_index->shard_count, sizeof(st_shard_batch_t));
+    p_offsets  = (int32_t *)calloc((size_t)p_index->shard_count + 1, sizeof(int32_t));
+    p_shard_of = (int32_t *)malloc((size_t)op_count * sizeof(int32_t));
+    p_order    = (int32_t *)malloc((size_t)op_count * sizeof(int32_t));
+    if ((NULL == p_batches) || (NULL == p_offsets) || (NULL == p_shard_of) || (NULL == p_order))
+    {
+        free(p_batches);
+        free(p_offsets);
+        free(p_shard_of);
+        free(p_order);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    for (i = 0; i < op_count; i++)
+    {
+        p_shard_of[i] = shard_index_route(p_index, p_ops[i].key);
+        p_offsets[p_shard_of[i] + 1]++;
+    }
+
+    for (i = 0; i < p_index->shard_count; i++)
+    {
+        p_batches[i].pp_root = &p_index->pp_roots[i];
+        p_batches[i].p_ops   = p_ops;
+        p_batches[i].p_order = &p_order[p_offsets[i]];
+        p_offsets[i + 1]    += p_offsets[i];
+    }
+
+    for (i = 0; i < op_count; i++)
+    {
+        p_order[p_offsets[p_shard_of[i]] + p_batches[p_shard_of[i]].count] = i;
+        p_batches[p_shard_of[i]].count++;
+    }
+
+    for (i = 0; i < p_index->shard_count; i++)
+    {
+        if (0 < p_batches[i].count)
+        {
+            if (RET_ERRCODE_OK != thread_pool_submit(p_pool, run_shard_batch, &p_batches[i]))
+            {
+                /* Keep going in order on this thread rather than dropping the shard */
+                run_shard_batch(&p_batches[i]);
+            }
+        }
+    }
+
+    thread_pool_wait(p_pool);
+
+    free(p_batches);
+    free(p_offsets);
+    free(p_shard_of);
+    free(p_order);
+
+    return ret;
+}
+
+void shard_index_destroy(st_shard_index_t *const p_index)
+{
+    int32_t i;
+
+    if (NULL == p_index)
+    {
+        return;
+    }
+
+    if (NULL != p_index->pp_roots)
+    {
+        for (i = 0; i < p_index->shard_count; i++)
+        {
+            tree_destroy(&p_index->pp_roots[i]);
+        }
+    }
+
+    free(p_index->pp_roots);
+    free(p_index->p_lower_bounds);
+    p_index->pp_roots       = NULL;
+    p_index->p_lower_bounds = NULL;
+    p_index->shard_count    = 0;
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+#include "u_spline_index.h"
+
+#define SPLINE_CACHE_LINE   (64)
+
+static e_retcode_t fit_spline(st_spline_index_t *const p_index);
+static e_retcode_t build_radix(st_spline_index_t *const p_index);
+static int32_t lower_bound_rank(const st_spline_index_t *const p_index, const int32_t key);
+
+/*
+    Greedy spline corridor: keep the range of slopes from the last spline point that
+    pass within max_error of every key seen since. A key outside that range ends the
+    segment at the previous key, which becomes the next spline point. One pass, O(n).
+*/
+static e_retcode_t fit_spline(st_spline_index_t *const p_index)
+{
+    const int32_t   *p_keys = p_index->p_keys;
+    double          upper_slope;
+    double          lower_slope;
+    double          dx;
+    double          dy;
+    int32_t         base;
+    int32_t         i;
+
+    p_index->p_points = (st_spline_point_t *)malloc((size_t)p_index->key_count * sizeof(st_spline_point_t));
+    if (NULL == p_index->p_points)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_index->p_points[0].key      = p_keys[0];
+    p_index->p_points[0].position = 0;
+    p_index->point_count          = 1;
+
+    if (1 == p_index->key_count)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    base        = 0;
+    dx          = (double)((int64_t)p_keys[1] - p_keys[0]);
+    upper_slope = (1.0 + p_index->max_error) / dx;
+    lower_slope = (1.0 - p_index->max_error) / dx;
+
+    for (i = 2; i < p_index->key_count; i++)
+    {
+        dx = (double)((int64_t)p_keys[i] - p_keys[base]);
+        dy = (double)(i - base);
+
+        if (((dy / dx) > upper_slope) || ((dy / dx) < lower_slope))
+        {
+            base = i - 1;
+
+            p_index->p_points[p_index->point_count].key      = p_keys[base];
+            p_index->p_points[p_index->point_count].position = base;
+            p_index->point_count++;
+
+            dx          = (double)((int64_t)p_keys[i] - p_keys[base]);
+            upper_slope = (1.0 + p_index->max_error) / dx;
+            lower_slope = (1.0 - p_index->max_error) / dx;
+        }
+        else
+        {
+            if (((dy + p_index->max_error) / dx) < upper_slope)
+            {
+                upper_slope = (dy + p_index->max_error) / dx;
+            }
+
+            if (((dy - p_index->max_error) / dx) > lower_slope)
+            {
+                lower_slope = (dy - p_index->max_error) / dx;
+            }
+        }
+    }
+
+    p_index->p_points[p_index->point_count].key      = p_keys[p_index->key_count - 1];
+    p_index->p_points[p_index->point_count].position = p_index->key_count - 1;
+    p_index->point_count++;
+
+    /* Usually a tiny fraction of the keys */
+    p_index->p_points = (st_spline_point_t *)realloc(p_index->p_points, (size_t)p_index->point_count * sizeof(st_spline_point_t));
+
+    return RET_ERRCODE_OK;
+}
+
+/* About one spline point per radix bucket, on the significant bits of the key range */
+static e_retcode_t build_radix(st_spline_index_t *const p_index)
+{
+    uint32_t    range = (uint32_t)p_index->p_keys[p_index->key_count - 1] - (uint32_t)p_index->min_key;
+    uint32_t    significant_bits = (0 == range) ? 0 : (32 - (uint32_t)__builtin_clz(range));
+    uint32_t    prefix;
+    uint32_t    bucket = 0;
+    int32_t     i;
+
+    p_index->radix_bits = 1;
+    while ((SPLINE_MAX_RADIX_BITS > p_index->radix_bits) && ((1u << p_index->radix_bits) < (uint32_t)p_index->point_count))
+    {
+        p_index->radix_bits++;
+    }
+
+    p_index->radix_shift = (significant_bits > p_index->radix_bits) ? (significant_bits - p_index->radix_bits) : 0;
+
+    p_index->p_radix = (uint32_t *)malloc(((size_t)1 << p_index->radix_bits) * sizeof(uint32_t) + sizeof(uint32_t));
+    if (NULL == p_index->p_radix)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_index->p_radix[0] = 0;
+
+    for (i = 0; i < p_index->point_count; i++)
+    {
+        prefix = ((uint32_t)p_index->p_points[i].key - (uint32_t)p_index->min_key) >> p_index->radix_shift;
+
+        while (bucket < prefix)
+        {
+            p_index->p_radix[++bucket] = (uint32_t)i;
+        }
+    }
+
+    while (bucket < (1u << p_index->radix_bits))
+    {
+        p_index->p_radix[++bucket] = (uint32_t)p_index->point_count;
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/* Rank of the first key >= key, key_count if there is none */
+static int32_t lower_bound_rank(const st_spline_index_t *const p_index, const int32_t key)
+{
+    const st_spline_point_t *p_left;
+    const st_spline_point_t *p_right;
+    uint32_t                prefix;
+    int64_t                 predicted;
+    int64_t                 low;
+    int64_t                 high;
+    int64_t                 half;
+    int32_t                 point;
+    int32_t                 size;
+
+    if (key <= p_index->min_key)
+    {
+        return 0;
+    }
+
+    if (key > p_index->p_keys[p_index->key_count - 1])
+    {
+        return p_index->key_count;
+    }
+
+    /* First spline point >= key: it is in the key's radix bucket or starts the next one */
+    prefix = ((uint32_t)key - (uint32_t)p_index->min_key) >> p_index->radix_shift;
+    point  = (int32_t)p_index->p_radix[prefix];
+    size   = (int32_t)p_index->p_radix[prefix + 1] - point;
+
+    if ((point + size) >= p_index->point_count)
+    {
+        size = p_index->point_count - 1 - point;
+    }
+
+    while (0 < size)
+    {
+        half = size / 2;
+
+        if (p_index->p_points[point + half].key < key)
+        {
+            point += (int32_t)half + 1;
+            size  -= (int32_t)half + 1;
+        }
+        else
+        {
+            size = (int32_t)half;
+        }
+    }
+
+    /* key > min_key, so point >= 1 */
+    p_left    = &p_index->p_points[point - 1];
+    p_right   = &p_index->p_points[point];
+    predicted = p_left->position + (int64_t)(((double)((int64_t)key - p_left->key) * (p_right->position - p_left->position))
+                                              / (double)((int64_t)p_right->key - p_left->key));
+
+    /* One extra slot on each side absorbs the rounding of the corridor slopes */
+    low  = predicted - p_index->max_error - 1;
+    high = predicted + p_index->max_error + 2;
+    low  = (0 > low) ? 0 : low;
+    high = (p_index->key_count < high) ? p_index->key_count : high;
+
+    /* The window spans a few cache lines: fetch them together instead of one per probe */
+    for (half = low; half < high; half += SPLINE_CACHE_LINE / (int64_t)sizeof(int32_t))
+    {
+        __builtin_prefetch(&p_index->p_keys[half]);
+    }
+
+    while (low < high)
+    {
+        half = low + ((high - low) / 2);
+
+        if (p_index->p_keys[half] < key)
+        {
+            low = half + 1;
+        }
+        else
+        {
+            high = half;
+        }
+    }
+
+    return (int32_t)low;
+}
+
+/* Copies the keys; p_sorted_keys must be strictly ascending */
+e_retcode_t spline_index_build_sorted(const int32_t *const p_sorted_keys, const int32_t count, const int32_t max_error, st_spline_index_t *const p_index)
+{
+    e_retcode_t ret;
+
+    if ((NULL == p_index) || ((NULL == p_sorted_keys) && (0 < count)))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((0 > count) || (0 > max_error))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    memset(p_index, 0, sizeof(st_spline_index_t));
+    p_index->max_error = max_error;
+
+    if (0 == count)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    p_index->p_keys = (int32_t *)malloc((size_t)count * sizeof(int32_t));
+    if (NULL == p_index->p_keys)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    memcpy(p_index->p_keys, p_sorted_keys, (size_t)count * sizeof(int32_t));
+    p_index->key_count = count;
+    p_index->min_key   = p_sorted_keys[0];
+
+    ret = fit_spline(p_index);
+    if (RET_ERRCODE_OK == ret)
+    {
+        ret = build_radix(p_index);
+    }
+
+    if (RET_ERRCODE_OK != ret)
+    {
+        spline_index_destroy(p_index);
+    }
+
+    return ret;
+}
+
+e_retcode_t spline_index_build(const st_tree_node_t *const p_root, const int32_t max_error, st_spline_index_t *const p_index)
+{
+    e_retcode_t ret;
+    int32_t     *p_sorted_keys;
+    int32_t     count;
+
+    if (NULL == p_index)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    count         = tree_key_count(p_root);
+    p_sorted_keys = (int32_t *)malloc(((size_t)count + 1) * sizeof(int32_t));
+    if (NULL == p_sorted_keys)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    count = tree_export_keys(p_root, p_sorted_keys, count);
+    ret   = spline_index_build_sorted(p_sorted_keys, count, max_error, p_index);
+
+    free(p_sorted_keys);
+
+    return ret;
+}
+
+bool_t spline_index_search(const st_spline_index_t *const p_index, const int32_t searched_key)
+{
+    int32_t rank;
+
+    if ((NULL == p_index) || (0 == p_index->key_count))
+    {
+        return false;
+    }
+
+    rank = lower_bound_rank(p_index, searched_key);
+
+    return ((rank < p_index->key_count) && (searched_key == p_index->p_keys[rank]));
+}
+
+bool_t spline_index_lower_bound(const st_spline_index_t *const p_index, const int32_t key, int32_t *const p_found_key)
+{
+    int32_t rank;
+
+    if ((NULL == p_index) || (0 == p_index->key_count) || (NULL == p_found_key))
+    {
+        return false;
+    }
+
+    rank = lower_bound_rank(p_index, key);
+    if (rank == p_index->key_count)
+    {
+        return false;
+    }
+
+    *p_found_key = p_index->p_keys[rank];
+
+    return true;
+}
+
+size_t spline_index_bytes(const st_spline_index_t *const p_index)
+{
+    size_t bytes = 0;
+
+    if ((NULL != p_index) && (0 < p_index->key_count))
+    {
+        bytes = ((size_t)p_index->key_count * sizeof(int32_t))
+              + ((size_t)p_index->point_count * sizeof(st_spline_point_t))
+              + ((((size_t)1 << p_index->radix_bits) + 1) * sizeof(uint32_t));
+    }
+
+    return bytes;
+}
+
+void spline_index_destroy(st_spline_index_t *const p_index)
+{
+    if (NULL != p_index)
+    {
+        free(p_index->p_keys);
+        free(p_index->p_points);
+        free(p_index->p_radix);
+        memset(p_index, 0, sizeof(st_spline_index_t));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include "u_thread_pool.h"
+
+#define WORK_DEQUE_MIN_CAPACITY (64)
+
+static e_retcode_t deque_init(st_work_deque_t *const p_deque);
+static e_retcode_t deque_push(st_work_deque_t *const p_deque, const st_task_t *const p_task);
+static bool_t deque_pop(st_work_deque_t *const p_deque, st_task_t *const p_task);
+static bool_t deque_steal(st_work_deque_t *const p_deque, st_task_t *const p_task);
+static void deque_destroy(st_work_deque_t *const p_deque);
+static bool_t take_task(st_thread_pool_t *const p_pool, const int32_t worker_id, st_task_t *const p_task);
+static void *worker_main(void *p_arg);
+
+/* Lets thread_pool_submit() called from a running task push onto the caller's own deque */
+static _Thread_local st_thread_pool_t *p_current_pool = NULL;
+static _Thread_local int32_t current_worker = (-1);
+
+static e_retcode_t deque_init(st_work_deque_t *const p_deque)
+{
+    p_deque->head     = 0;
+    p_deque->tail     = 0;
+    p_deque->capacity = WORK_DEQUE_MIN_CAPACITY;
+    p_deque->p_tasks  = (st_task_t *)malloc((size_t)p_deque->capacity * sizeof(st_task_t));
+    if (NULL == p_deque->p_tasks)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    (void)pthread_mutex_init(&p_deque->lock, NULL);
+
+    return RET_ERRCODE_OK;
+}
+
+static e_retcode_t deque_push(st_work_deque_t *const p_deque, const st_task_t *const p_task)
+{
+    st_task_t   *p_bigger;
+    int32_t     count;
+    int32_t     i;
+
+    (void)pthread_mutex_lock(&p_deque->lock);
+
+    count = p_deque->tail - p_deque->head;
+    if (count == p_deque->capacity)
+    {
+        p_bigger = (st_task_t *)malloc(2 * (size_t)p_deque->capacity * sizeof(st_task_t));
+        if (NULL == p_bigger)
+        {
+            (void)pthread_mutex_unlock(&p_deque->lock);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        for (i = 0; i < count; i++)
+        {
+            p_bigger[i] = p_deque->p_tasks[(p_deque->head + i) & (p_deque->capacity - 1)];
+        }
+
+        free(p_deque->p_tasks);
+        p_deque->p_tasks   = p_bigger;
+        p_deque->capacity *= 2;
+        p_deque->head      = 0;
+        p_deque->tail      = count;
+    }
+
+    p_deque->p_tasks[p_deque->tail & (p_deque->capacity - 1)] = *p_task;
+    p_deque->tail++;
+
+    (void)pthread_mutex_unlock(&p_deque->lock);
+
+    return RET_ERRCODE_OK;
+}
+
+/* Owner side: newest task first, it is the one most likely still in cache */
+static bool_t deque_pop(st_work_deque_t *const p_deque, st_task_t *const p_task)
+{
+    bool_t taken = false;
+
+    (void)pthread_mutex_lock(&p_deque->lock);
+
+    if (p_deque->tail != p_deque->head)
+    {
+        p_deque->tail--;
+        *p_task = p_deque->p_tasks[p_deque->tail & (p_deque->capacity - 1)];
+        taken   = true;
+    }
+
+    (void)pthread_mutex_unlock(&p_deque->lock);
+
+    return taken;
+}
+
+/* Thief side: oldest task first */
+static bool_t deque_steal(st_work_deque_t *const p_deque, st_task_t *const p_task)
+{
+    bool_t taken = false;
+
+    (void)pthread_mutex_lock(&p_deque->lock);
+
+    if (p_deque->tail != p_deque->head)
+    {
+        *p_task = p_deque->p_tasks[p_deque->head & (p_deque->capacity - 1)];
+        p_deque->head++;
+        taken   = true;
+    }
+
+    (void)pthread_mutex_unlock(&p_deque->lock);
+
+    return taken;
+}
+
+static void deque_destroy(st_work_deque_t *const p_deque)
+{
+    free(p_deque->p_tasks);
+    p_deque->p_tasks = NULL;
+    (void)pthread_mutex_destroy(&p_deque->lock);
+}
+
+static bool_t take_task(st_thread_pool_t *const p_pool, const int32_t worker_id, st_task_t *const p_task)
+{
+    int32_t i;
+    int32_t victim;
+
+    if (true == deque_pop(&p_pool->deques[worker_id], p_task))
+    {
+        return true;
+    }
+
+    for (i = 1; i < p_pool->worker_count; i++)
+    {
+        victim = (worker_id + i) % p_pool->worker_count;
+
+        if (true == deque_steal(&p_pool->deques[victim], p_task))
+        {
+            __atomic_fetch_add(&p_pool->steals, 1, __ATOMIC_RELAXED);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void *worker_main(void *p_arg)
+{
+    st_thread_pool_t    *p_pool = (st_thread_pool_t *)p_arg;
+    st_task_t           task;
+    int32_t             worker_id;
+
+    worker_id      = __atomic_fetch_add(&p_pool->started, 1, __ATOMIC_RELAXED);
+    p_current_pool = p_pool;
+    current_worker = worker_id;
+
+    while (true)
+    {
+        if (true == take_task(p_pool, worker_id, &task))
+        {
+            __atomic_fetch_sub(&p_pool->queued, 1, __ATOMIC_ACQ_REL);
+
+            task.pf_task(task.p_arg);
+
+            (void)pthread_mutex_lock(&p_pool->lock);
+            p_pool->pending--;
+            if (0 == p_pool->pending)
+            {
+                (void)pthread_cond_broadcast(&p_pool->all_done);
+            }
+            (void)pthread_mutex_unlock(&p_pool->lock);
+
+            continue;
+        }
+
+        /* Nothing to run or steal: sleep until something is submitted */
+        (void)pthread_mutex_lock(&p_pool->lock);
+
+        while ((0 >= __atomic_load_n(&p_pool->queued, __ATOMIC_ACQUIRE)) && (false == p_pool->stopping))
+        {
+            (void)pthread_cond_wait(&p_pool->work_ready, &p_pool->lock);
+        }
+
+        if ((true == p_pool->stopping) && (0 >= __atomic_load_n(&p_pool->queued, __ATOMIC_ACQUIRE)))
+        {
+            (void)pthread_mutex_unlock(&p_pool->lock);
+            break;
+        }
+
+        (void)pthread_mutex_unlock(&p_pool->lock);
+    }
+
+    return NULL;
+}
+
+e_retcode_t thread_pool_init(st_thread_pool_t *const p_pool, const int32_t worker_count)
+{
+    int32_t i;
+
+    if (NULL == p_pool)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((0 >= worker_count) || (THREAD_POOL_MAX_WORKERS < worker_count))
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    memset(p_pool, 0, sizeof(st_thread_pool_t));
+    (void)pthread_mutex_init(&p_pool->lock, NULL);
+    (void)pthread_cond_init(&p_pool->work_ready, NULL);
+    (void)pthread_cond_init(&p_pool->all_done, NULL);
+
+    for (i = 0; i < worker_count; i++)
+    {
+        if (RET_ERRCODE_OK != deque_init(&p_pool->deques[i]))
+        {
+            /* No thread started yet, nothing to join */
+            p_pool->worker_count = 0;
+            thread_pool_destroy(p_pool);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+    }
+
+    p_pool->worker_count = worker_count;
+
+    for (i = 0; i < worker_count; i++)
+    {
+        if (0 != pthread_create(&p_pool->threads[i], NULL, worker_main, p_pool))
+        {
+            /* Only the threads already started get joined */
+            p_pool->worker_count = i;
+            thread_pool_destroy(p_pool);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+e_retcode_t thread_pool_submit(st_thread_pool_t *const p_pool, pf_task_t pf_task, void *p_arg)
+{
+    st_task_t   task;
+    int32_t     target;
+    e_retcode_t ret;
+
+    if ((NULL == p_pool) || (NULL == pf_task))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    task.pf_task = pf_task;
+    task.p_arg   = p_arg;
+
+    /* Count the task first, so that pending can never drop to 0 while it is still queued */
+    (void)pthread_mutex_lock(&p_pool->lock);
+    p_pool->pending++;
+    __atomic_fetch_add(&p_pool->queued, 1, __ATOMIC_ACQ_REL);
+
+    if (p_pool == p_current_pool)
+    {
+        target = current_worker;
+    }
+    else
+    {
+        target = (int32_t)(p_pool->next_deque % (uint32_t)p_pool->worker_count);
+        p_pool->next_deque++;
+    }
+    (void)pthread_mutex_unlock(&p_pool->lock);
+
+    ret = deque_push(&p_pool->deques[target], &task);
+
+    (void)pthread_mutex_lock(&p_pool->lock);
+    if (RET_ERRCODE_OK != ret)
+    {
+        p_pool->pending--;
+        __atomic_fetch_sub(&p_pool->queued, 1, __ATOMIC_ACQ_REL);
+        if (0 == p_pool->pending)
+        {
+            (void)pthread_cond_broadcast(&p_pool->all_done);
+        }
+    }
+    else
+    {
+        (void)pthread_cond_signal(&p_pool->work_ready);
+    }
+    (void)pthread_mutex_unlock(&p_pool->lock);
+
+    return ret;
+}
+
+/* Block until every submitted task has finished. Must not be called from a task */
+void thread_pool_wait(st_thread_pool_t *const p_pool)
+{
+    if (NULL != p_pool)
+    {
+        (void)pthread_mutex_lock(&p_pool->lock);
+
+        while (0 != p_pool->pending)
+        {
+            (void)pthread_cond_wait(&p_pool->all_done, &p_pool->lock);
+        }
+
+        (void)pthread_mutex_unlock(&p_pool->lock);
+    }
+}
+
+void thread_pool_destroy(st_thread_pool_t *const p_pool)
+{
+    int32_t i;
+
+    if (NULL == p_pool)
+    {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&p_pool->lock);
+    p_pool->stopping = true;
+    (void)pthread_cond_broadcast(&p_pool->work_ready);
+    (void)pthread_mutex_unlock(&p_pool->lock);
+
+    for (i = 0; i < p_pool->worker_count; i++)
+    {
+        (void)pthread_join(p_pool->threads[i], NULL);
+    }
+
+    for (i = 0; i < THREAD_POOL_MAX_WORKERS; i++)
+    {
+        if (NULL != p_pool->deques[i].p_tasks)
+        {
+            deque_destroy(&p_pool->deques[i]);
+        }
+    }
+
+    (void)pthread_cond_destroy(&p_pool->all_done);
+    (void)pthread_cond_destroy(&p_pool->work_ready);
+    (void)pthread_mutex_destroy(&p_pool->lock);
+}
\ No newline at end of file
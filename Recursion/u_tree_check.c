@@ -0,0 +1,191 @@
+#include "u_tree_check.h"
+
+typedef struct
+{
+    st_tree_report_t    *p_report;
+    const int32_t       *p_expected;
+    bool_t              compare_keys;   /**< false: only the shape is checked */
+    int32_t             expected_count;
+    int32_t             leaf_depth;     /**< (-1) until the first leaf */
+} st_check_ctx_t;
+
+static bool_t fail(st_check_ctx_t *const p_ctx, const e_tree_violation_t violation, const st_tree_node_t *const p_tree_node, const int32_t depth);
+static bool_t check_key(st_check_ctx_t *const p_ctx, const int32_t key);
+static bool_t check_node(st_check_ctx_t *const p_ctx, const st_tree_node_t *const p_tree_node, const int32_t depth, const int64_t low, const int64_t high);
+static bool_t validate(const st_tree_node_t *const p_root, const int32_t *const p_sorted_keys, const int32_t count, const bool_t compare_keys, st_tree_report_t *const p_report);
+
+static bool_t fail(st_check_ctx_t *const p_ctx, const e_tree_violation_t violation, const st_tree_node_t *const p_tree_node, const int32_t depth)
+{
+    p_ctx->p_report->violation = violation;
+    p_ctx->p_report->p_node    = p_tree_node;
+    p_ctx->p_report->depth     = depth;
+
+    return false;
+}
+
+/* Keys are checked in order, so the cursor is simply the number seen so far */
+static bool_t check_key(st_check_ctx_t *const p_ctx, const int32_t key)
+{
+    int32_t index = p_ctx->p_report->key_count++;
+
+    if (false == p_ctx->compare_keys)
+    {
+        return true;
+    }
+
+    return ((index < p_ctx->expected_count) && (key == p_ctx->p_expected[index]));
+}
+
+/* Every key under p_tree_node must lie in (low, high) */
+static bool_t check_node(st_check_ctx_t *const p_ctx, const st_tree_node_t *const p_tree_node, const int32_t depth, const int64_t low, const int64_t high)
+{
+    const int32_t   *p_keys = p_tree_node->keys;
+    bool_t          is_full;
+
+    if (((-1) == p_keys[FIRST_KEY]) || (depth >= TREE_MAX_HEIGHT))
+    {
+        return fail(p_ctx, TREE_VIOLATION_OCCUPANCY, p_tree_node, depth);
+    }
+
+    if (p_tree_node->is_root != (0 == depth))
+    {
+        return fail(p_ctx, TREE_VIOLATION_ROOT_FLAG, p_tree_node, depth);
+    }
+
+    is_full = ((-1) != p_keys[SECOND_KEY]);
+
+    if ((p_keys[FIRST_KEY] <= low) || (p_keys[FIRST_KEY] >= high)
+     || ((true == is_full) && ((p_keys[SECOND_KEY] <= p_keys[FIRST_KEY]) || (p_keys[SECOND_KEY] >= high))))
+    {
+        return fail(p_ctx, TREE_VIOLATION_ORDER, p_tree_node, depth);
+    }
+
+    if (NULL == p_tree_node->p_left_child)
+    {
+        if ((NULL != p_tree_node->p_middle_child) || (NULL != p_tree_node->p_right_child))
+        {
+            return fail(p_ctx, TREE_VIOLATION_CHILDREN, p_tree_node, depth);
+        }
+
+        if ((-1) == p_ctx->leaf_depth)
+        {
+            p_ctx->leaf_depth         = depth;
+            p_ctx->p_report->height   = depth + 1;
+        }
+        else if (depth != p_ctx->leaf_depth)
+        {
+            return fail(p_ctx, TREE_VIOLATION_DEPTH, p_tree_node, depth);
+        }
+
+        if ((false == check_key(p_ctx, p_keys[FIRST_KEY])) || ((true == is_full) && (false == check_key(p_ctx, p_keys[SECOND_KEY]))))
+        {
+            return fail(p_ctx, TREE_VIOLATION_KEYS, NULL, depth);
+        }
+
+        return true;
+    }
+
+    if ((NULL == p_tree_node->p_middle_child) || (is_full != (NULL != p_tree_node->p_right_child)))
+    {
+        return fail(p_ctx, TREE_VIOLATION_CHILDREN, p_tree_node, depth);
+    }
+
+    if (false == check_node(p_ctx, p_tree_node->p_left_child, depth + 1, low, p_keys[FIRST_KEY]))
+    {
+        return false;
+    }
+
+    if (false == check_key(p_ctx, p_keys[FIRST_KEY]))
+    {
+        return fail(p_ctx, TREE_VIOLATION_KEYS, NULL, depth);
+    }
+
+    if (false == check_node(p_ctx, p_tree_node->p_middle_child, depth + 1, p_keys[FIRST_KEY], (true == is_full) ? p_keys[SECOND_KEY] : high))
+    {
+        return false;
+    }
+
+    if (true == is_full)
+    {
+        if (false == check_key(p_ctx, p_keys[SECOND_KEY]))
+        {
+            return fail(p_ctx, TREE_VIOLATION_KEYS, NULL, depth);
+        }
+
+        return check_node(p_ctx, p_tree_node->p_right_child, depth + 1, p_keys[SECOND_KEY], high);
+    }
+
+    return true;
+}
+
+static bool_t validate(const st_tree_node_t *const p_root, const int32_t *const p_sorted_keys, const int32_t count, const bool_t compare_keys, st_tree_report_t *const p_report)
+{
+    st_tree_report_t    local_report;
+    st_check_ctx_t      ctx;
+
+    ctx.p_report       = (NULL != p_report) ? p_report : &local_report;
+    ctx.p_expected     = p_sorted_keys;
+    ctx.expected_count = count;
+    ctx.compare_keys   = compare_keys;
+    ctx.leaf_depth     = (-1);
+
+    memset(ctx.p_report, 0, sizeof(st_tree_report_t));
+
+    if ((NULL != p_root) && (false == check_node(&ctx, p_root, 0, INT64_MIN, INT64_MAX)))
+    {
+        return false;
+    }
+
+    /* The tree ran out before the expected keys did */
+    if ((true == compare_keys) && (ctx.p_report->key_count != count))
+    {
+        return fail(&ctx, TREE_VIOLATION_KEYS, NULL, 0);
+    }
+
+    return true;
+}
+
+/*
+    Check the 2-3 tree invariants in one pass: 1 or 2 sorted keys per node, every key
+    inside the range its ancestors allow, k + 1 children for k keys on inner nodes,
+    all leaves at the same depth and is_root only on the root. Stops at the first
+    violation, which is described in p_report (may be NULL).
+*/
+bool_t tree_validate(const st_tree_node_t *const p_root, st_tree_report_t *const p_report)
+{
+    return validate(p_root, NULL, 0, false, p_report);
+}
+
+/* Same checks, and the in-order keys must be exactly p_sorted_keys[0 .. count - 1] */
+bool_t tree_validate_keys(const st_tree_node_t *const p_root, const int32_t *const p_sorted_keys, const int32_t count, st_tree_report_t *const p_report)
+{
+    if ((NULL == p_sorted_keys) && (0 < count))
+    {
+        return false;
+    }
+
+    return validate(p_root, p_sorted_keys, count, true, p_report);
+}
+
+const char *tree_violation_name(const e_tree_violation_t violation)
+{
+    switch (violation)
+    {
+        case TREE_VIOLATION_NONE:
+            return "none";
+        case TREE_VIOLATION_OCCUPANCY:
+            return "occupancy";
+        case TREE_VIOLATION_ORDER:
+            return "order";
+        case TREE_VIOLATION_CHILDREN:
+            return "children";
+        case TREE_VIOLATION_DEPTH:
+            return "depth";
+        case TREE_VIOLATION_ROOT_FLAG:
+            return "root flag";
+        case TREE_VIOLATION_KEYS:
+            return "keys";
+        default:
+            return "unknown";
+    }
+}
\ No newline at end of file
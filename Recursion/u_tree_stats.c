@@ -0,0 +1,322 @@
+#include "u_tree_stats.h"
+
+/* Bottom-up builder state: one node under construction per level, leaves are level 0 */
+typedef struct
+{
+    st_tree_node_t  *p_nodes[TREE_MAX_HEIGHT];
+    int32_t         node_count[TREE_MAX_HEIGHT];    /**< Nodes on the level */
+    int32_t         node_index[TREE_MAX_HEIGHT];    /**< Index of p_nodes[l] on its level */
+    int32_t         filled[TREE_MAX_HEIGHT];        /**< Keys (leaf) or children (internal) in p_nodes[l] */
+    int32_t         leaf_keys;                      /**< Keys held by the leaf level */
+    int32_t         height;
+} st_packer_t;
+
+static void count_nodes(const st_tree_node_t *const p_tree_node, st_tree_memory_stats_t *const p_stats);
+static void packer_init(st_packer_t *const p_packer, const int32_t count);
+static int32_t packer_quota(const st_packer_t *const p_packer, const int32_t level);
+static e_retcode_t packer_attach(st_packer_t *const p_packer, const int32_t level, st_tree_node_t *p_child);
+static e_retcode_t packer_push(st_packer_t *const p_packer, const int32_t key, const uintptr_t value);
+static st_tree_node_t *packer_finish(st_packer_t *const p_packer);
+static void packer_abort(st_packer_t *const p_packer);
+static e_retcode_t pack_subtree(st_packer_t *const p_packer, const st_tree_node_t *const p_tree_node);
+
+static void count_nodes(const st_tree_node_t *const p_tree_node, st_tree_memory_stats_t *const p_stats)
+{
+    int32_t key_count;
+
+    if (NULL == p_tree_node)
+    {
+        return;
+    }
+
+    key_count = ((-1) != p_tree_node->keys[FIRST_KEY]) + ((-1) != p_tree_node->keys[SECOND_KEY]);
+
+    p_stats->fill_histogram[key_count]++;
+    p_stats->key_count  += key_count;
+    p_stats->node_count++;
+
+    count_nodes(p_tree_node->p_left_child, p_stats);
+    count_nodes(p_tree_node->p_middle_child, p_stats);
+    count_nodes(p_tree_node->p_right_child, p_stats);
+}
+
+/*
+    Fewest nodes per level: count keys need ceil((count + 1) / 3) leaves of up to 2 keys
+    (one key between two leaves goes up), and n children need ceil(n / 3) parents.
+*/
+static void packer_init(st_packer_t *const p_packer, const int32_t count)
+{
+    int32_t level = 0;
+
+    memset(p_packer, 0, sizeof(st_packer_t));
+
+    p_packer->node_count[0] = (count + 3) / 3;
+    p_packer->leaf_keys     = count - (p_packer->node_count[0] - 1);
+
+    while (1 < p_packer->node_count[level])
+    {
+        p_packer->node_count[level + 1] = (p_packer->node_count[level] + 2) / 3;
+        level++;
+    }
+
+    p_packer->height = level + 1;
+}
+
+/* Keys a leaf, or children an internal node, gets so that its level is spread evenly */
+static int32_t packer_quota(const st_packer_t *const p_packer, const int32_t level)
+{
+    int32_t total;
+    int32_t nodes = p_packer->node_count[level];
+
+    total = (0 == level) ? p_packer->leaf_keys : p_packer->node_count[level - 1];
+
+    return ((total / nodes) + ((p_packer->node_index[level] < (total % nodes)) ? 1 : 0));
+}
+
+/* Hang a finished node under the node being built one level up */
+static e_retcode_t packer_attach(st_packer_t *const p_packer, const int32_t level, st_tree_node_t *p_child)
+{
+    st_tree_node_t *p_parent;
+
+    if (NULL == p_packer->p_nodes[level])
+    {
+        p_packer->p_nodes[level] = create_node((-1), false);
+        p_packer->filled[level]  = 0;
+        if (NULL == p_packer->p_nodes[level])
+        {
+            tree_destroy(&p_child);
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+    }
+
+    p_parent = p_packer->p_nodes[level];
+
+    if (0 == p_packer->filled[level])
+    {
+        p_parent->p_left_child = p_child;
+    }
+    else if (1 == p_packer->filled[level])
+    {
+        p_parent->p_middle_child = p_child;
+    }
+    else
+    {
+        p_parent->p_right_child = p_child;
+    }
+
+    p_packer->filled[level]++;
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Feed the next key and its value in order. The key fills the current leaf up to the leaf's
+    quota, otherwise it is the separator after that leaf: the leaf is hung under its parent and
+    the key becomes the parent's next key, or moves further up when the parent has all its children.
+*/
+static e_retcode_t packer_push(st_packer_t *const p_packer, const int32_t key, const uintptr_t value)
+{
+    st_tree_node_t  *p_child;
+    int32_t         level;
+
+    if (NULL == p_packer->p_nodes[0])
+    {
+        p_packer->p_nodes[0] = create_node(key, false);
+        if (NULL == p_packer->p_nodes[0])
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        p_packer->p_nodes[0]->values[FIRST_KEY] = value;
+        p_packer->filled[0]                     = 1;
+
+        return RET_ERRCODE_OK;
+    }
+
+    if (p_packer->filled[0] < packer_quota(p_packer, 0))
+    {
+        p_packer->p_nodes[0]->keys[p_packer->filled[0]]   = key;
+        p_packer->p_nodes[0]->values[p_packer->filled[0]] = value;
+        p_packer->filled[0]++;
+
+        return RET_ERRCODE_OK;
+    }
+
+    /* A node is augmented once it is complete, after all its children */
+    p_child              = p_packer->p_nodes[0];
+    p_packer->p_nodes[0] = NULL;
+    p_packer->node_index[0]++;
+    tree_augment_node(p_child);
+
+    /* The level sizes guarantee that some ancestor still has room for the separator */
+    for (level = 1; level < p_packer->height; level++)
+    {
+        if (RET_ERRCODE_OK != packer_attach(p_packer, level, p_child))
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
+
+        if (p_packer->filled[level] < packer_quota(p_packer, level))
+        {
+            p_packer->p_nodes[level]->keys[p_packer->filled[level] - 1]   = key;
+            p_packer->p_nodes[level]->values[p_packer->filled[level] - 1] = value;
+            break;
+        }
+
+        p_child                  = p_packer->p_nodes[level];
+        p_packer->p_nodes[level] = NULL;
+        p_packer->node_index[level]++;
+        tree_augment_node(p_child);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/* Close the right spine: the last node of each level goes under the last node above it */
+static st_tree_node_t *packer_finish(st_packer_t *const p_packer)
+{
+    st_tree_node_t  *p_child = p_packer->p_nodes[0];
+    int32_t         level;
+
+    p_packer->p_nodes[0] = NULL;
+    tree_augment_node(p_child);
+
+    for (level = 1; level < p_packer->height; level++)
+    {
+        if (RET_ERRCODE_OK != packer_attach(p_packer, level, p_child))
+        {
+            packer_abort(p_packer);
+            return NULL;
+        }
+
+        p_child                  = p_packer->p_nodes[level];
+        p_packer->p_nodes[level] = NULL;
+        tree_augment_node(p_child);
+    }
+
+    if (NULL != p_child)
+    {
+        p_child->is_root = true;
+    }
+
+    return p_child;
+}
+
+static void packer_abort(st_packer_t *const p_packer)
+{
+    int32_t level;
+
+    for (level = 0; level < p_packer->height; level++)
+    {
+        tree_destroy(&p_packer->p_nodes[level]);
+    }
+}
+
+/* Push the keys of the old tree in order, straight into the packer */
+static e_retcode_t pack_subtree(st_packer_t *const p_packer, const st_tree_node_t *const p_tree_node)
+{
+    e_retcode_t ret = RET_ERRCODE_OK;
+
+    if (NULL == p_tree_node)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    ret = pack_subtree(p_packer, p_tree_node->p_left_child);
+
+    if (RET_ERRCODE_OK == ret)
+    {
+        ret = packer_push(p_packer, p_tree_node->keys[FIRST_KEY], p_tree_node->values[FIRST_KEY]);
+    }
+
+    if (RET_ERRCODE_OK == ret)
+    {
+        ret = pack_subtree(p_packer, p_tree_node->p_middle_child);
+    }
+
+    if ((RET_ERRCODE_OK == ret) && ((-1) != p_tree_node->keys[SECOND_KEY]))
+    {
+        ret = packer_push(p_packer, p_tree_node->keys[SECOND_KEY], p_tree_node->values[SECOND_KEY]);
+
+        if (RET_ERRCODE_OK == ret)
+        {
+            ret = pack_subtree(p_packer, p_tree_node->p_right_child);
+        }
+    }
+
+    return ret;
+}
+
+e_retcode_t tree_memory_stats(const st_tree_node_t *const p_root, st_tree_memory_stats_t *const p_stats)
+{
+    const st_tree_node_t *p_tree_node;
+
+    if (NULL == p_stats)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_stats, 0, sizeof(st_tree_memory_stats_t));
+
+    /* All leaves are at the same depth */
+    for (p_tree_node = p_root; NULL != p_tree_node; p_tree_node = p_tree_node->p_left_child)
+    {
+        p_stats->height++;
+    }
+
+    count_nodes(p_root, p_stats);
+
+    p_stats->node_bytes = (size_t)p_stats->node_count * sizeof(st_tree_node_t);
+
+    if (0 < p_stats->key_count)
+    {
+        p_stats->bytes_per_key = (double)p_stats->node_bytes / p_stats->key_count;
+        p_stats->fill_factor   = (double)p_stats->key_count / (MAX_KEY * p_stats->node_count);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Rebuild the tree with the fewest nodes: almost every node holds 2 keys, and nodes are
+    allocated in key order. Values move with their keys, and every node gets its summary
+    from the bound augmentation (tree_bind_augment()). The new tree is built next to the
+    old one and published with a single atomic store of the root, so readers never see a half-built tree. The old nodes
+    then go through the node allocator: with epoch_node_allocator() installed they are only
+    retired, and readers still walking them are not disturbed. Writers must be excluded.
+*/
+e_retcode_t tree_compact(st_tree_node_t **const pp_root)
+{
+    st_packer_t     packer;
+    st_tree_node_t  *p_old_root;
+    st_tree_node_t  *p_new_root;
+
+    if (NULL == pp_root)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if (NULL == *pp_root)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    packer_init(&packer, tree_key_count(*pp_root));
+
+    if (RET_ERRCODE_OK != pack_subtree(&packer, *pp_root))
+    {
+        packer_abort(&packer);
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_new_root = packer_finish(&packer);
+    if (NULL == p_new_root)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_old_root = __atomic_exchange_n(pp_root, p_new_root, __ATOMIC_ACQ_REL);
+    tree_destroy(&p_old_root);
+
+    return RET_ERRCODE_OK;
+}
\ No newline at end of file
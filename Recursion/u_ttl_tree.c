@@ -0,0 +1,376 @@
+#include "u_ttl_tree.h"
+
+#if (UINTPTR_MAX < UINT64_MAX)
+#error "A value slot holds a 64-bit deadline: 64-bit pointers only"
+#endif
+
+typedef struct
+{
+    st_ttl_tree_t   *p_tree;
+    uint64_t        now;
+} st_ttl_sweep_t;
+
+static e_retcode_t heap_reserve(st_ttl_tree_t *const p_tree);
+static void heap_push(st_ttl_tree_t *const p_tree, const uint64_t deadline, const int32_t key);
+static st_ttl_entry_t heap_pop(st_ttl_tree_t *const p_tree);
+static int compare_entries(const void *p_left, const void *p_right);
+static int compare_deadlines(const void *p_left, const void *p_right);
+static void heap_trim(st_ttl_tree_t *const p_tree);
+static bool_t remove_if_due(const int32_t key, const uintptr_t value, void *p_ctx);
+
+/* Room for one more entry */
+static e_retcode_t heap_reserve(st_ttl_tree_t *const p_tree)
+{
+    st_ttl_entry_t  *p_grown;
+    int32_t         capacity;
+
+    if (p_tree->heap_count < p_tree->heap_capacity)
+    {
+        return RET_ERRCODE_OK;
+    }
+
+    capacity = (0 < p_tree->heap_capacity) ? (p_tree->heap_capacity * 2) : TTL_HEAP_MIN;
+    p_grown  = (st_ttl_entry_t *)realloc(p_tree->p_heap, (size_t)capacity * sizeof(st_ttl_entry_t));
+    if (NULL == p_grown)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_tree->p_heap        = p_grown;
+    p_tree->heap_capacity = capacity;
+
+    return RET_ERRCODE_OK;
+}
+
+/* The heap must have room, see heap_reserve() */
+static void heap_push(st_ttl_tree_t *const p_tree, const uint64_t deadline, const int32_t key)
+{
+    int32_t child = p_tree->heap_count;
+    int32_t parent;
+
+    while (0 < child)
+    {
+        parent = (child - 1) / 2;
+        if (p_tree->p_heap[parent].deadline <= deadline)
+        {
+            break;
+        }
+
+        p_tree->p_heap[child] = p_tree->p_heap[parent];
+        child                 = parent;
+    }
+
+    p_tree->p_heap[child].deadline = deadline;
+    p_tree->p_heap[child].key      = key;
+    p_tree->heap_count++;
+}
+
+/* The heap must not be empty */
+static st_ttl_entry_t heap_pop(st_ttl_tree_t *const p_tree)
+{
+    st_ttl_entry_t  top  = p_tree->p_heap[0];
+    st_ttl_entry_t  last = p_tree->p_heap[p_tree->heap_count - 1];
+    int32_t         parent = 0;
+    int32_t         child;
+
+    p_tree->heap_count--;
+
+    while (true)
+    {
+        child = (2 * parent) + 1;
+        if (child >= p_tree->heap_count)
+        {
+            break;
+        }
+
+        if (((child + 1) < p_tree->heap_count) && (p_tree->p_heap[child + 1].deadline < p_tree->p_heap[child].deadline))
+        {
+            child++;
+        }
+
+        if (last.deadline <= p_tree->p_heap[child].deadline)
+        {
+            break;
+        }
+
+        p_tree->p_heap[parent] = p_tree->p_heap[child];
+        parent                 = child;
+    }
+
+    p_tree->p_heap[parent] = last;
+
+    return top;
+}
+
+static int compare_entries(const void *p_left, const void *p_right)
+{
+    const int32_t left  = ((const st_ttl_entry_t *)p_left)->key;
+    const int32_t right = ((const st_ttl_entry_t *)p_right)->key;
+
+    return (left > right) - (left < right);
+}
+
+static int compare_deadlines(const void *p_left, const void *p_right)
+{
+    const uint64_t left  = ((const st_ttl_entry_t *)p_left)->deadline;
+    const uint64_t right = ((const st_ttl_entry_t *)p_right)->deadline;
+
+    return (left > right) - (left < right);
+}
+
+/*
+    Once stale entries (deleted keys, deadlines moved) outnumber the live keys, rebuild the
+    heap from the tree with one entry per key, at its deadline; an array sorted by deadline
+    is a heap. Keeps the heap, and the work of later sweeps, in proportion to the keys
+    rather than to the operations. Out of memory, the heap stays as it is: it is still right.
+*/
+static void heap_trim(st_ttl_tree_t *const p_tree)
+{
+    st_ttl_entry_t  *p_smaller;
+    int32_t         *p_keys;
+    uintptr_t       *p_deadlines;
+    int32_t         count;
+    int32_t         capacity;
+    int32_t         i;
+
+    if (p_tree->heap_count <= ((2 * p_tree->key_count) + TTL_HEAP_MIN))
+    {
+        return;
+    }
+
+    p_keys      = (int32_t *)malloc(((size_t)p_tree->key_count + 1) * sizeof(int32_t));
+    p_deadlines = (uintptr_t *)malloc(((size_t)p_tree->key_count + 1) * sizeof(uintptr_t));
+    if ((NULL == p_keys) || (NULL == p_deadlines))
+    {
+        free(p_keys);
+        free(p_deadlines);
+        return;
+    }
+
+    count = tree_export_entries(p_tree->p_root, p_keys, p_deadlines, p_tree->key_count);
+
+    /* key_count < heap_count: the heap has room for them all */
+    for (i = 0; i < count; i++)
+    {
+        p_tree->p_heap[i].deadline = (uint64_t)p_deadlines[i];
+        p_tree->p_heap[i].key      = p_keys[i];
+    }
+
+    qsort(p_tree->p_heap, (size_t)count, sizeof(st_ttl_entry_t), compare_deadlines);
+    p_tree->heap_count = count;
+
+    free(p_keys);
+    free(p_deadlines);
+
+    /* Give back what the stale entries took, keeping room to grow */
+    capacity = (2 * count) + TTL_HEAP_MIN;
+    if (capacity < p_tree->heap_capacity)
+    {
+        p_smaller = (st_ttl_entry_t *)realloc(p_tree->p_heap, (size_t)capacity * sizeof(st_ttl_entry_t));
+        if (NULL != p_smaller)
+        {
+            p_tree->p_heap        = p_smaller;
+            p_tree->heap_capacity = capacity;
+        }
+    }
+}
+
+/* A key given a later deadline since it was queued stays, and is queued again */
+static bool_t remove_if_due(const int32_t key, const uintptr_t value, void *p_ctx)
+{
+    st_ttl_sweep_t *p_sweep = (st_ttl_sweep_t *)p_ctx;
+
+    if ((uint64_t)value <= p_sweep->now)
+    {
+        return true;
+    }
+
+    /* The pops of this sweep left room for it */
+    heap_push(p_sweep->p_tree, (uint64_t)value, key);
+
+    return false;
+}
+
+e_retcode_t ttl_tree_init(st_ttl_tree_t *const p_tree)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    memset(p_tree, 0, sizeof(st_ttl_tree_t));
+
+    return RET_ERRCODE_OK;
+}
+
+/* Add key to expire at deadline, or move the deadline of a key already there */
+e_retcode_t ttl_tree_insert(st_ttl_tree_t *const p_tree, const int32_t key, const uint64_t deadline)
+{
+    uintptr_t   *p_slot;
+    bool_t      inserted = false;
+
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    /* Before the tree changes, so that a full heap cannot leave a key without an entry */
+    if (RET_ERRCODE_OK != heap_reserve(p_tree))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    p_slot = insert_or_get(&p_tree->p_root, key, (uintptr_t)deadline, &inserted);
+    if (NULL == p_slot)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    if (true == inserted)
+    {
+        heap_push(p_tree, deadline, key);
+        p_tree->key_count++;
+    }
+    else
+    {
+        /*
+            The key has an entry no later than its current deadline: a later or equal
+            deadline is picked up when that entry comes due, only an earlier one is queued.
+        */
+        if (deadline < (uint64_t)*p_slot)
+        {
+            heap_push(p_tree, deadline, key);
+        }
+
+        *p_slot = (uintptr_t)deadline;
+    }
+
+    heap_trim(p_tree);
+
+    return RET_ERRCODE_OK;
+}
+
+/* true when key is there and its deadline is after now */
+bool_t ttl_tree_search(const st_ttl_tree_t *const p_tree, const int32_t searched_key, const uint64_t now)
+{
+    uintptr_t deadline;
+
+    if ((NULL == p_tree) || (false == tree_get_value(p_tree->p_root, searched_key, &deadline)))
+    {
+        return false;
+    }
+
+    return ((uint64_t)deadline > now);
+}
+
+/* Remove key before its deadline. Its heap entry is dropped when it comes due */
+e_retcode_t ttl_tree_delete(st_ttl_tree_t *const p_tree, const int32_t key)
+{
+    if (NULL == p_tree)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    if (true == tree_remove(&p_tree->p_root, key))
+    {
+        p_tree->key_count--;
+        heap_trim(p_tree);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Remove keys whose deadline is not after now, taking at most budget entries off the
+    heap, so one call does bounded work however many keys are due. Due entries go in runs
+    of TTL_SWEEP_BATCH, sorted by key, to tree_remove_batch(), which checks each deadline
+    on the node it is about to remove from. An entry whose key was deleted is dropped,
+    one whose key got a later deadline is queued again. Returns the keys removed; call
+    again while ttl_tree_next_deadline() is not after now to finish the sweep.
+*/
+int32_t ttl_tree_expire_until(st_ttl_tree_t *const p_tree, const uint64_t now, const int32_t budget)
+{
+    st_ttl_entry_t  batch[TTL_SWEEP_BATCH];
+    int32_t         keys[TTL_SWEEP_BATCH];
+    st_ttl_sweep_t  sweep;
+    int32_t         examined = 0;
+    int32_t         removed = 0;
+    int32_t         batch_count;
+    int32_t         key_count;
+    int32_t         i;
+
+    if (NULL == p_tree)
+    {
+        return 0;
+    }
+
+    sweep.p_tree = p_tree;
+    sweep.now    = now;
+
+    while ((examined < budget) && (0 < p_tree->heap_count) && (p_tree->p_heap[0].deadline <= now))
+    {
+        batch_count = 0;
+        while ((batch_count < TTL_SWEEP_BATCH) && (examined < budget)
+            && (0 < p_tree->heap_count) && (p_tree->p_heap[0].deadline <= now))
+        {
+            batch[batch_count] = heap_pop(p_tree);
+            batch_count++;
+            examined++;
+        }
+
+        qsort(batch, (size_t)batch_count, sizeof(st_ttl_entry_t), compare_entries);
+
+        /* A key queued twice is handled once */
+        key_count = 0;
+        for (i = 0; i < batch_count; i++)
+        {
+            if ((0 == i) || (batch[i].key != batch[i - 1].key))
+            {
+                keys[key_count] = batch[i].key;
+                key_count++;
+            }
+        }
+
+        removed += tree_remove_batch(&p_tree->p_root, keys, key_count, remove_if_due, &sweep);
+    }
+
+    p_tree->key_count -= removed;
+    p_tree->expired   += (uint64_t)removed;
+
+    return removed;
+}
+
+/* Earliest deadline still queued. It may belong to a key deleted or extended since */
+bool_t ttl_tree_next_deadline(const st_ttl_tree_t *const p_tree, uint64_t *const p_deadline)
+{
+    if ((NULL == p_tree) || (NULL == p_deadline) || (0 == p_tree->heap_count))
+    {
+        return false;
+    }
+
+    *p_deadline = p_tree->p_heap[0].deadline;
+
+    return true;
+}
+
+void ttl_tree_destroy(st_ttl_tree_t *const p_tree)
+{
+    if (NULL == p_tree)
+    {
+        return;
+    }
+
+    tree_destroy(&p_tree->p_root);
+    free(p_tree->p_heap);
+    memset(p_tree, 0, sizeof(st_ttl_tree_t));
+}
\ No newline at end of file
@@ -1,1174 +1,1304 @@
-#include "u_stack_ctrl.h"
 #include "u_util.h"
 
-static st_tree_node_t *create_node(const int32_t key, const bool_t is_root);
 static bool_t node_is_full(const st_tree_node_t *const p_tree_node);
-static bool_t node_is_vacant(const st_tree_node_t *const p_tree_node);
-static bool_t node_is_leaf(const st_tree_node_t *const p_tree_node);
 static inline bool_t key_on_the_left(const int32_t key, const st_tree_node_t *const p_tree_node);
 static inline bool_t key_in_the_middle(const int32_t key, const st_tree_node_t *const p_tree_node);
-static inline bool_t key_on_the_right(const int32_t key, const st_tree_node_t *const p_tree_node);
-static void split(st_tree_node_t **const pp_root, st_tree_node_t *const p_current, const e_dir_t dir);
-static void merge(st_tree_node_t **pp_root, st_tree_node_t *p_parent, e_dir_t target_dir, e_dir_t merged_dir, st_tree_node_t *p_target_delete);
-static void insert_to_tree(st_tree_node_t **const pp_root, st_tree_node_t *const candidate, const int32_t key, e_dir_t dir);
-static void delete_from_node(st_tree_node_t **const pp_root, st_tree_node_t *const p_current, const int32_t key);
-static void delete_key(st_tree_node_t *const p_tree_node, const e_key_t position);
-static void node_shift(st_tree_node_t *const p_tree_node, e_dir_t dir);
-static void delete_one_key_leaf_node(st_tree_node_t **pp_root, st_tree_node_t *p_current);
-static st_tree_node_t *get_leftmost(st_tree_node_t *p_tree_node);
-static st_tree_node_t *inorder_successor(st_tree_node_t *p_tree_node, const e_key_t key_position);
-static void process_inorder_successor(st_tree_node_t **pp_root, st_tree_node_t *p_current, const e_key_t key_position);
-static void delete_internal_node(st_tree_node_t **pp_root, st_tree_node_t *p_current, int32_t key_to_delete);
-
-static st_stack_t stack           = { NULL };
-static st_stack_t stack_for_split = { NULL };
-static e_enable_flag_t delete_flag = DISABLED;
-static bool_t root_change = false;
-
-static st_tree_node_t *create_node(const int32_t key, const bool_t is_root)
+static void destroy_node(st_tree_node_t *const p_tree_node);
+static int32_t export_keys(const st_tree_node_t *const p_tree_node, int32_t *const p_keys, uintptr_t *const p_values, const int32_t capacity, int32_t count);
+static bool_t ceiling_key(const st_tree_node_t *p_tree_node, const int32_t key, const bool_t strict, int32_t *const p_found_key);
+static bool_t floor_key(const st_tree_node_t *p_tree_node, const int32_t key, const bool_t strict, int32_t *const p_found_key);
+static int64_t max_keys_for_height(const int32_t height);
+static void destroy_subtree(st_tree_node_t *const p_tree_node);
+static st_tree_node_t **child_link(st_tree_node_t *const p_tree_node, const int32_t index);
+static void path_reset(st_tree_path_t *const p_path, st_tree_node_t *const p_root);
+static void path_rewind(st_tree_path_t *const p_path, st_tree_node_t *const p_root, const int32_t key);
+static st_tree_node_t *path_descend(st_tree_path_t *const p_path, const int32_t key);
+static uintptr_t *path_insert(st_tree_node_t **const pp_root, st_tree_path_t *const p_path, const int32_t key, const uintptr_t value);
+static bool_t path_delete(st_tree_node_t **const pp_root, const int32_t key, pf_remove_filter_t pf_filter, void *p_ctx);
+static bool_t take_value(const int32_t key, const uintptr_t value, void *p_ctx);
+static uintptr_t *value_slot(st_tree_node_t *const p_tree_node, const int32_t key);
+static uintptr_t *find_value_slot(st_tree_node_t *const p_root, const int32_t key);
+static inline void augment_node(st_tree_node_t *const p_tree_node);
+static void augment_upward(st_tree_node_t *const *const p_nodes, const int32_t depth);
+static st_tree_node_t *alloc_summary_node(void *p_ctx);
+static void free_summary_node(void *p_ctx, st_tree_node_t *p_tree_node);
+
+/* Where nodes come from and go to. All NULL means plain malloc() and free() */
+static st_node_allocator_t node_allocator = { NULL, NULL, NULL };
+
+/* Takes precedence over node_allocator on the thread that bound it */
+static _Thread_local const st_node_allocator_t *p_bound_allocator = NULL;
+
+/* Nodes with room for a summary, see tree_summary_allocator() */
+static const st_node_allocator_t summary_allocator = { alloc_summary_node, free_summary_node, NULL };
+
+/* Keeps the node summaries of the trees this thread changes, NULL leaves them alone */
+static _Thread_local const st_tree_augment_t *p_bound_augment = NULL;
+
+/* Number of nodes destroyed by trees without a counter of their own, once tracked */
+static uint64_t free_generation = 0;
+
+/* Set by tree_track_free_generation(), never cleared */
+static bool_t free_generation_tracked = false;
+
+/* Counts the nodes this thread frees instead of free_generation */
+static _Thread_local uint64_t *p_bound_generation = NULL;
+
+void tree_set_node_allocator(const st_node_allocator_t *const p_allocator)
 {
-    st_tree_node_t *node;
+    if (NULL == p_allocator)
+    {
+        node_allocator.pf_alloc = NULL;
+        node_allocator.pf_free  = NULL;
+        node_allocator.p_ctx    = NULL;
+    }
+    else
+    {
+        node_allocator = *p_allocator;
+    }
+}
 
-    node = (st_tree_node_t *)malloc(sizeof(st_tree_node_t));
-    if (NULL != node)
+/*
+    Send this thread's node allocations and frees to p_allocator, NULL goes back to the
+    process-wide hooks. Returns the previous binding so that bindings nest.
+    *p_allocator must stay valid while it is bound.
+*/
+const st_node_allocator_t *tree_bind_node_allocator(const st_node_allocator_t *const p_allocator)
+{
+    const st_node_allocator_t *p_previous = p_bound_allocator;
+
+    p_bound_allocator = p_allocator;
+
+    return p_previous;
+}
+
+static st_tree_node_t *alloc_summary_node(void *p_ctx)
+{
+    st_summary_node_t *p_summary_node = (st_summary_node_t *)malloc(sizeof(st_summary_node_t));
+
+    (void)p_ctx;
+
+    if (NULL == p_summary_node)
     {
-        node->keys[FIRST_KEY]           = key;
-        node->keys[SECOND_KEY]          = (-1);   /**< -1 means blank space */
-        node->p_left_child              = NULL;
-        node->p_middle_child            = NULL;
-        node->p_right_child             = NULL;
-        node->is_root                   = is_root;
-        node->update_info.update_flag   = DISABLED;
-        node->update_info.value_up      = 0;
-        node->update_info.value_split   = 0;
+        return NULL;
     }
 
-    return node;
+    p_summary_node->summary = 0;
+
+    return &p_summary_node->node;
 }
 
-static bool_t node_is_full(const st_tree_node_t *const p_tree_node)
+static void free_summary_node(void *p_ctx, st_tree_node_t *p_tree_node)
 {
-    return (((-1) != p_tree_node->keys[FIRST_KEY]) && ((-1) != p_tree_node->keys[SECOND_KEY]));
+    (void)p_ctx;
+
+    free(p_tree_node);
+}
+
+/*
+    Hooks that hand out st_summary_node_t, for trees that bind an augmentation. Bind them
+    with tree_bind_node_allocator() around every change of such a tree, its destruction
+    included.
+*/
+const st_node_allocator_t *tree_summary_allocator(void)
+{
+    return &summary_allocator;
 }
 
-static bool_t node_is_vacant(const st_tree_node_t *const p_tree_node)
+/*
+    Have every insert, delete and build of this thread recompute the summary of each node
+    it changes and of all their ancestors, NULL stops it. Returns the previous binding.
+    Bind the same augmentation for every change of a given tree, or its summaries go stale,
+    and allocate its nodes with tree_summary_allocator().
+*/
+const st_tree_augment_t *tree_bind_augment(const st_tree_augment_t *const p_augment)
 {
-    return (((-1) == p_tree_node->keys[FIRST_KEY]) && ((-1) == p_tree_node->keys[SECOND_KEY]));
+    const st_tree_augment_t *p_previous = p_bound_augment;
+
+    p_bound_augment = p_augment;
+
+    return p_previous;
 }
 
-static bool_t node_is_leaf(const st_tree_node_t *const p_tree_node)
+/*
+    Count the nodes this thread frees in *p_generation instead of the process-wide
+    tree_free_generation(), NULL goes back to it (counting only when tracked). Returns the previous binding.
+    Bind the same counter for every change of a given tree, so that a hot cache
+    watching it is flushed by frees in that tree only.
+*/
+uint64_t *tree_bind_free_generation(uint64_t *const p_generation)
 {
-    bool_t checked = false;
+    uint64_t *p_previous = p_bound_generation;
+
+    p_bound_generation = p_generation;
+
+    return p_previous;
+}
 
-    if (true == node_is_full(p_tree_node))
+static inline void augment_node(st_tree_node_t *const p_tree_node)
+{
+    if (NULL != p_bound_augment)
     {
-        checked = ((NULL == p_tree_node->p_left_child) && (NULL == p_tree_node->p_middle_child) && (NULL == p_tree_node->p_right_child));
+        p_bound_augment->pf_update(p_tree_node, p_bound_augment->p_ctx);
     }
-    else
+}
+
+/* Update p_nodes[depth - 1] up to p_nodes[0], a root-to-node path */
+static void augment_upward(st_tree_node_t *const *const p_nodes, const int32_t depth)
+{
+    int32_t level;
+
+    if (NULL != p_bound_augment)
     {
-        checked = ((NULL == p_tree_node->p_left_child) && (NULL == p_tree_node->p_right_child));
+        for (level = depth - 1; level >= 0; level--)
+        {
+            p_bound_augment->pf_update(p_nodes[level], p_bound_augment->p_ctx);
+        }
     }
-
-    return checked;
 }
 
-static inline bool_t key_on_the_left(const int32_t key, const st_tree_node_t *const p_tree_node)
+static void destroy_node(st_tree_node_t *const p_tree_node)
 {
-    return (key < p_tree_node->keys[FIRST_KEY]);
+    const st_node_allocator_t *p_allocator = (NULL != p_bound_allocator) ? p_bound_allocator : &node_allocator;
+
+    /* No shared cache line is written per free unless a cache asked for the process-wide count */
+    if (NULL != p_bound_generation)
+    {
+        __atomic_add_fetch(p_bound_generation, 1, __ATOMIC_RELEASE);
+    }
+    else if (true == __atomic_load_n(&free_generation_tracked, __ATOMIC_RELAXED))
+    {
+        __atomic_add_fetch(&free_generation, 1, __ATOMIC_RELEASE);
+    }
+
+    if (NULL == p_allocator->pf_free)
+    {
+        free(p_tree_node);
+    }
+    else
+    {
+        p_allocator->pf_free(p_allocator->p_ctx, p_tree_node);
+    }
 }
 
-static inline bool_t key_in_the_middle(const int32_t key, const st_tree_node_t *const p_tree_node)
+/*
+    Start counting the frees outside tree_bind_free_generation() in tree_free_generation().
+    Off by default, so that untracked frees touch no shared counter; once on it stays on.
+    Call it before remembering any node, with the writers of the tree excluded.
+*/
+void tree_track_free_generation(void)
 {
-    return ((key > p_tree_node->keys[FIRST_KEY]) && (key < p_tree_node->keys[SECOND_KEY]));
+    __atomic_store_n(&free_generation_tracked, true, __ATOMIC_RELEASE);
 }
 
-static inline bool_t key_on_the_right(const int32_t key, const st_tree_node_t *const p_tree_node)
+/*
+    Changes whenever a node is freed, except under tree_bind_free_generation(), once
+    tree_track_free_generation() was called. A pointer to a node remembered under an older
+    generation may dangle; one remembered under the current generation is still a node,
+    and its version tells whether its keys moved since.
+*/
+uint64_t tree_free_generation(void)
 {
-    return (key > p_tree_node->keys[SECOND_KEY]);
+    return __atomic_load_n(&free_generation, __ATOMIC_ACQUIRE);
 }
 
-static void split(st_tree_node_t **const pp_root, st_tree_node_t *const p_current, const e_dir_t dir)
+st_tree_node_t *create_node(const int32_t key, const bool_t is_root)
 {
-    st_tree_node_t  *new_root = NULL;
-    st_tree_node_t  *split_node = NULL;
-    st_tree_node_t  *parent = NULL;
-    st_tree_node_t  *popped_node = NULL;
+    const st_node_allocator_t   *p_allocator = (NULL != p_bound_allocator) ? p_bound_allocator : &node_allocator;
+    st_tree_node_t              *node;
 
-    if (ENABLED == p_current->update_info.update_flag)
+    if (NULL == p_allocator->pf_alloc)
     {
-        /* If p_current is the root */
-        if (true == p_current->is_root)
-        {
-            /* Node is always full in this case as it has to be split up. So there's no need to check whether it's full or not */
-            /* p_current is no longer the root */
-            p_current->is_root = false;
+        node = (st_tree_node_t *)malloc(sizeof(st_tree_node_t));
+    }
+    else
+    {
+        node = p_allocator->pf_alloc(p_allocator->p_ctx);
+    }
 
-            /* Create new root and new split_node */
-            new_root   = create_node(p_current->update_info.value_up, true);
-            split_node = create_node(p_current->update_info.value_split, false);
+    if (NULL != node)
+    {
+        node->keys[FIRST_KEY]    = key;
+        node->keys[SECOND_KEY]   = (-1);   /**< -1 means blank space */
+        node->values[FIRST_KEY]  = 0;
+        node->values[SECOND_KEY] = 0;
+        node->p_left_child       = NULL;
+        node->p_middle_child     = NULL;
+        node->p_right_child      = NULL;
+        node->is_root            = is_root;
+        node->version            = 0;
+    }
 
-            /* Finish splitting and promoting */
-            p_current->update_info.update_flag = DISABLED;
+    return node;
+}
 
-            /* Determine the side that the node in the stack_for_split is on */
-            popped_node = stack_pop(&stack_for_split);
+static bool_t node_is_full(const st_tree_node_t *const p_tree_node)
+{
+    return (((-1) != p_tree_node->keys[FIRST_KEY]) && ((-1) != p_tree_node->keys[SECOND_KEY]));
+}
 
-            if (LEFT == dir)
-            {
-                /* Assign split_node */
-                split_node->p_left_child   = p_current->p_middle_child;
-                split_node->p_middle_child = p_current->p_right_child;
-            }
-            else if (MIDDLE == dir)
-            {
-                /* Assign split_node */
-                split_node->p_left_child   = popped_node;
-                split_node->p_middle_child = p_current->p_right_child;
-            }
-            else
-            {
-                /* Assign split_node */
-                split_node->p_left_child   = p_current->p_right_child;
-                split_node->p_middle_child = popped_node;
-            }
+static inline bool_t key_on_the_left(const int32_t key, const st_tree_node_t *const p_tree_node)
+{
+    return (key < p_tree_node->keys[FIRST_KEY]);
+}
 
-            /* Remove 2nd key in p_current */
-            p_current->keys[SECOND_KEY] = (-1);
+static inline bool_t key_in_the_middle(const int32_t key, const st_tree_node_t *const p_tree_node)
+{
+    return ((key > p_tree_node->keys[FIRST_KEY]) && (key < p_tree_node->keys[SECOND_KEY]));
+}
 
-            /* Assign new root */
-            new_root->p_left_child   = p_current;
-            new_root->p_middle_child = split_node;
+void inorder_traverse(const st_tree_node_t *const p_tree_node)
+{
+    if (NULL != p_tree_node)
+    {
+        inorder_traverse(p_tree_node->p_left_child);
 
-            /* Promote new root */
-            *pp_root = new_root;
-        }
-        else
-        {
-            split_node = create_node(p_current->update_info.value_split, false);
-            p_current->update_info.update_flag = DISABLED;
+        printf("%d ", p_tree_node->keys[FIRST_KEY]);
 
-            /* Popped from stack */
-            parent = stack_pop(&stack);
+        inorder_traverse(p_tree_node->p_middle_child);
 
-            if (NULL != parent)
-            {
-                /* Parent node is full */
-                if (true == node_is_full(parent))
-                {
-                    /* Push the split_node to the stack */
-                    stack_push(&stack_for_split, (uintptr_t)split_node);
-
-                    /* Enable splitting and promoting */
-                    parent->update_info.update_flag = ENABLED;
-
-                    if (true == key_on_the_left(p_current->update_info.value_up, parent))
-                    {
-                        /* Prepare for splitting and promoting */
-                        parent->update_info.value_up    = parent->keys[FIRST_KEY];
-                        parent->update_info.value_split = parent->keys[SECOND_KEY];
-
-                        /* Move up the key from p_current to parent */
-                        parent->keys[FIRST_KEY] = p_current->update_info.value_up;
-
-                        /* Split up the parent */
-                        split(pp_root, parent, LEFT);
-
-                        /* Pop the stack to assign nodes if needed */
-                        popped_node = stack_pop(&stack_for_split);
-
-                        /* Assign parent */
-                        parent->p_left_child   = p_current;
-                        parent->p_middle_child = split_node;
-                        parent->p_right_child  = NULL;
-                    }
-                    else if (true == key_in_the_middle(p_current->update_info.value_up, parent))
-                    {
-                        /* Prepare for splitting and promoting */
-                        parent->update_info.value_up    = p_current->update_info.value_up;
-                        parent->update_info.value_split = parent->keys[SECOND_KEY];
-
-                        /* Split up the parent */
-                        split(pp_root, parent, MIDDLE);
-
-                        /* Pop the stack to assign nodes if needed */
-                        popped_node = stack_pop(&stack_for_split);
-
-                        /* Assign parent */
-                        parent->p_middle_child = p_current;
-                        parent->p_right_child  = NULL;
-                    }
-                    else
-                    {
-                        /* Prepare for splitting and promoting */
-                        parent->update_info.value_up    = parent->keys[SECOND_KEY];
-                        parent->update_info.value_split = p_current->update_info.value_up;
-
-                        /* Split up the parent */
-                        split(pp_root, parent, RIGHT);
-
-                        /* Pop the stack to assign nodes if needed */
-                        popped_node = stack_pop(&stack_for_split);
-
-                        /* Assign parent */
-                        parent->p_right_child  = NULL;
-                    }
-
-                    /* Assign split_node if needed */
-                    if (false == node_is_leaf(p_current))
-                    {
-                        if (popped_node == split_node)
-                        {
-                            /* Get the child */
-                            popped_node = stack_pop(&stack_for_split);
-                        }
-
-                        if (LEFT == dir)
-                        {
-                            split_node->p_left_child   = p_current->p_middle_child;
-                            split_node->p_middle_child = p_current->p_right_child;
-                        }
-                        else if (MIDDLE == dir)
-                        {
-                            split_node->p_left_child   = popped_node;
-                            split_node->p_middle_child = p_current->p_right_child;
-                        }
-                        else
-                        {
-                            split_node->p_left_child   = p_current->p_right_child;
-                            split_node->p_middle_child = popped_node;
-                        }
-                    }
-                }
-                /* Parent node has only one key */
-                else
-                {
-                    if (true == key_on_the_left(p_current->update_info.value_up, parent))
-                    {
-                        parent->keys[SECOND_KEY] = parent->keys[FIRST_KEY];
-                        parent->keys[FIRST_KEY]  = p_current->update_info.value_up;
-
-                        /* Assign parent */
-                        parent->p_right_child  = parent->p_middle_child;
-                        parent->p_middle_child = split_node;
-                    }
-                    else
-                    {
-                        parent->keys[SECOND_KEY] = p_current->update_info.value_up;
-
-                        /* Assign parent's middle */
-                        parent->p_right_child  = split_node;
-                    }
-
-                    /* Assign split_node */
-                    if (false == node_is_leaf(p_current))
-                    {
-                        split_node->p_middle_child = NULL;
-
-                        if (LEFT == dir)
-                        {
-                            split_node->p_left_child   = p_current->p_middle_child;
-                            split_node->p_middle_child = p_current->p_right_child;
-                        }
-                        else if (MIDDLE == dir)
-                        {
-                            popped_node = stack_pop(&stack_for_split);
-
-                            if (NULL != popped_node)
-                            {
-                                split_node->p_left_child   = popped_node;
-                                split_node->p_middle_child = p_current->p_right_child;
-                            }
-                        }
-                        else
-                        {
-                            popped_node = stack_pop(&stack_for_split);
-
-                            if (NULL != popped_node)
-                            {
-                                split_node->p_left_child   = p_current->p_right_child;
-                                split_node->p_middle_child = popped_node;
-                            }
-                        }
-                    }
-                }
+        if ((-1) != p_tree_node->keys[SECOND_KEY])
+        {
+            printf("%d ", p_tree_node->keys[SECOND_KEY]);
+        }
 
-                /* Adjust p_current */
-                p_current->keys[SECOND_KEY] = (-1);
+        inorder_traverse(p_tree_node->p_right_child);
+    }
+}
 
-                /* Finish splitting and promoting */
-                p_current->update_info.update_flag = DISABLED;
+void preorder_traverse(const st_tree_node_t *const p_tree_node)
+{
+    int32_t i;
 
-                /* Clear stack */
-                if (DISABLED == parent->update_info.update_flag)
-                {
-                    while (false == stack_is_empty(&stack))
-                    {
-                        (void)stack_pop(&stack);
-                    }
-                }
+    if (NULL != p_tree_node)
+    {
+        for (i = 0; i < MAX_KEY; i++)
+        {
+            if ((-1) != p_tree_node->keys[i])
+            {
+                printf("%d ", p_tree_node->keys[i]);
             }
         }
+
+        preorder_traverse(p_tree_node->p_left_child);
+        preorder_traverse(p_tree_node->p_middle_child);
+        preorder_traverse(p_tree_node->p_right_child);
     }
 }
 
-static void insert_to_tree(st_tree_node_t **const pp_root, st_tree_node_t *const candidate, const int32_t key, e_dir_t dir)
+void postorder_traverse(const st_tree_node_t *const p_tree_node)
 {
-    if (NULL == candidate)
-    {
-        *pp_root = create_node(key, true);
-    }
-    else
+    int32_t i;
+
+    if (NULL != p_tree_node)
     {
-        /* When candidate is a leaf */
-        if (true == node_is_leaf(candidate))
+        postorder_traverse(p_tree_node->p_left_child);
+        postorder_traverse(p_tree_node->p_middle_child);
+        postorder_traverse(p_tree_node->p_right_child);
+
+        for (i = 0; i < MAX_KEY; i++)
         {
-            if (true == node_is_full(candidate))
+            if ((-1) != p_tree_node->keys[i])
             {
-                /* Enable splitting and promoting */
-                candidate->update_info.update_flag = ENABLED;
-
-                if (true == key_on_the_left(key, candidate))
-                {
-                    /* Prepare for splitting and promoting */
-                    candidate->update_info.value_up    = candidate->keys[FIRST_KEY];
-                    candidate->update_info.value_split = candidate->keys[SECOND_KEY];
-
-                    /* Assign key to the candidate */
-                    candidate->keys[FIRST_KEY] = key;
-                }
-                else if (true == key_in_the_middle(key, candidate))
-                {
-                    /* Prepare for splitting and promoting */
-                    candidate->update_info.value_up    = key;
-                    candidate->update_info.value_split = candidate->keys[SECOND_KEY];
-                }
-                else
-                {
-                    /* Prepare for splitting and promoting */
-                    candidate->update_info.value_up    = candidate->keys[SECOND_KEY];
-                    candidate->update_info.value_split = key;
-                }
+                printf("%d ", p_tree_node->keys[i]);
             }
-            else
-            {
-                if (true == key_on_the_left(key, candidate))
-                {
-                    candidate->keys[SECOND_KEY] = candidate->keys[FIRST_KEY];
-                    candidate->keys[FIRST_KEY]  = key;
-                }
-                else
-                {
-                    candidate->keys[SECOND_KEY] = key;
-                }
+        }
+    }
+}
 
-                /* Disable splitting and promoting */
-                candidate->update_info.update_flag = DISABLED;
+/* p_values may be NULL when only the keys are wanted */
+static int32_t export_keys(const st_tree_node_t *const p_tree_node, int32_t *const p_keys, uintptr_t *const p_values, const int32_t capacity, int32_t count)
+{
+    if ((NULL != p_tree_node) && (count < capacity))
+    {
+        count = export_keys(p_tree_node->p_left_child, p_keys, p_values, capacity, count);
 
-                while (false == stack_is_empty(&stack))
-                {
-                    (void)stack_pop(&stack);
-                }
-            }
-        }
-        else
+        if (count < capacity)
         {
-            stack_push(&stack, (uintptr_t)candidate);
-
-            if (true == node_is_full(candidate))
+            if (NULL != p_values)
             {
-                if (true == key_on_the_left(key, candidate))
-                {
-                    dir = LEFT;
-                    insert_to_tree(pp_root, candidate->p_left_child, key, dir);
-                }
-                else if (true == key_in_the_middle(key, candidate))
-                {
-                    dir = MIDDLE;
-                    insert_to_tree(pp_root, candidate->p_middle_child, key, dir);
-                }
-                else
-                {
-                    dir = RIGHT;
-                    insert_to_tree(pp_root, candidate->p_right_child, key, dir);
-                }
+                p_values[count] = p_tree_node->values[FIRST_KEY];
             }
-            else
+
+            p_keys[count++] = p_tree_node->keys[FIRST_KEY];
+        }
+
+        count = export_keys(p_tree_node->p_middle_child, p_keys, p_values, capacity, count);
+
+        if (((-1) != p_tree_node->keys[SECOND_KEY]) && (count < capacity))
+        {
+            if (NULL != p_values)
             {
-                if (true == key_on_the_left(key, candidate))
-                {
-                    dir = LEFT;
-                    insert_to_tree(pp_root, candidate->p_left_child, key, dir);
-                }
-                else
-                {
-                    dir = MIDDLE;
-                    insert_to_tree(pp_root, candidate->p_middle_child, key, dir);
-                }
+                p_values[count] = p_tree_node->values[SECOND_KEY];
             }
+
+            p_keys[count++] = p_tree_node->keys[SECOND_KEY];
         }
 
-        /* Self-balance */
-        split(pp_root, candidate, dir);
+        count = export_keys(p_tree_node->p_right_child, p_keys, p_values, capacity, count);
     }
+
+    return count;
 }
 
-static void node_shift(st_tree_node_t *const p_tree_node, e_dir_t dir)
+int32_t tree_key_count(const st_tree_node_t *const p_tree_node)
 {
-    if (LEFT == dir)
+    int32_t count = 0;
+
+    if (NULL != p_tree_node)
     {
-        p_tree_node->keys[FIRST_KEY]  = p_tree_node->keys[SECOND_KEY];
-        p_tree_node->keys[SECOND_KEY] = (-1);
+        count = (((-1) != p_tree_node->keys[SECOND_KEY]) ? 2 : 1)
+              + tree_key_count(p_tree_node->p_left_child)
+              + tree_key_count(p_tree_node->p_middle_child)
+              + tree_key_count(p_tree_node->p_right_child);
     }
-    else if (RIGHT == dir)
+
+    return count;
+}
+
+/* Write up to capacity keys in ascending order, return the number written */
+int32_t tree_export_keys(const st_tree_node_t *const p_tree_node, int32_t *const p_keys, const int32_t capacity)
+{
+    int32_t count = 0;
+
+    if (NULL != p_keys)
     {
-        p_tree_node->keys[SECOND_KEY] = p_tree_node->keys[FIRST_KEY];
-        p_tree_node->keys[FIRST_KEY]  = (-1);
+        count = export_keys(p_tree_node, p_keys, NULL, capacity, 0);
     }
-    else
+
+    return count;
+}
+
+/* tree_export_keys() that also writes the value of each key at the same index of p_values */
+int32_t tree_export_entries(const st_tree_node_t *const p_tree_node, int32_t *const p_keys, uintptr_t *const p_values, const int32_t capacity)
+{
+    int32_t count = 0;
+
+    if ((NULL != p_keys) && (NULL != p_values))
     {
-        /* Do nothing */
+        count = export_keys(p_tree_node, p_keys, p_values, capacity, 0);
     }
+
+    return count;
 }
 
-static void merge(st_tree_node_t **pp_root, st_tree_node_t *p_parent, e_dir_t target_dir, e_dir_t merged_dir, st_tree_node_t *p_target_delete)
+/* Visit every key in [low, high] in ascending order, return the number visited */
+int32_t tree_range_scan(const st_tree_node_t *const p_tree_node, const int32_t low, const int32_t high, pf_key_visitor_t pf_visitor, void *p_ctx)
 {
-    st_tree_node_t *p_target_node;
+    int32_t visited = 0;
 
-    if (NULL == p_parent)
+    if ((NULL == p_tree_node) || (NULL == pf_visitor) || (low > high))
     {
-        return;
+        return 0;
     }
 
-    if ((LEFT == target_dir) && (MIDDLE == merged_dir))
+    /* Only descend into children whose key range overlaps [low, high] */
+    if (low < p_tree_node->keys[FIRST_KEY])
     {
-        if ((true == node_is_full(p_parent->p_left_child)) || (true == node_is_full(p_parent->p_middle_child)))
-        {
-            return;
-        }
+        visited += tree_range_scan(p_tree_node->p_left_child, low, high, pf_visitor, p_ctx);
+    }
+
+    if ((low <= p_tree_node->keys[FIRST_KEY]) && (p_tree_node->keys[FIRST_KEY] <= high))
+    {
+        pf_visitor(p_tree_node->keys[FIRST_KEY], p_ctx);
+        visited++;
     }
 
-    if ((MIDDLE == target_dir) && (RIGHT == merged_dir))
+    if ((-1) == p_tree_node->keys[SECOND_KEY])
     {
-        if ((true == node_is_full(p_parent->p_middle_child)) || (true == node_is_full(p_parent->p_right_child)))
+        if (high > p_tree_node->keys[FIRST_KEY])
         {
-            return;
+            visited += tree_range_scan(p_tree_node->p_middle_child, low, high, pf_visitor, p_ctx);
         }
     }
-
-    /* When parent is full (contains 2 keys) (has 3 children) */
-    if (true == node_is_full(p_parent))
+    else
     {
-        /* Merge middle sibling to left sibling */
-        if ((LEFT == target_dir) && (MIDDLE == merged_dir))
+        if ((high > p_tree_node->keys[FIRST_KEY]) && (low < p_tree_node->keys[SECOND_KEY]))
         {
-            /* When target_delete is the left child */
-            if (p_target_delete == p_parent->p_left_child)
-            {
-                /* Merge 2 nodes */
-                p_parent->p_left_child->keys[FIRST_KEY]  = p_parent->keys[FIRST_KEY];
-                p_parent->p_left_child->keys[SECOND_KEY] = p_parent->p_middle_child->keys[FIRST_KEY];
-                delete_key(p_parent, FIRST_KEY);
-
-                /* Assign left child's children */
-                /* When middle child of the left child is missing as left child is a non-leaf node */
-                if (false == node_is_leaf(p_parent->p_left_child))
-                {
-                    if (NULL == p_parent->p_left_child->p_middle_child)
-                    {
-                        p_parent->p_left_child->p_middle_child = p_parent->p_middle_child->p_left_child;
-                        p_parent->p_left_child->p_right_child  = p_parent->p_middle_child->p_middle_child;
-                    }
-                    else
-                    {
-                        /* Do nothing */
-                    }
-                }
-                /* When left child is a leaf node */
-                else
-                {
-                    /* Do nothing */
-                }
-
-                /* Destroy the middle node */
-                free(p_parent->p_middle_child);
-
-                /* Arrange parent's children */
-                p_parent->p_middle_child = p_parent->p_right_child;
-                p_parent->p_right_child  = NULL;
-            }
-            /* When target_delete is the middle child */
-            else
-            {
-                /* Merge 2 nodes */
-                p_parent->p_left_child->keys[SECOND_KEY] = p_parent->keys[FIRST_KEY];
-                delete_key(p_parent, FIRST_KEY);
-
-                /* When parent's children are leaf nodes */
-                if (true == node_is_leaf(p_parent->p_left_child))
-                {
-                    /* Destroy the middle child */
-                    free(p_parent->p_middle_child);
+            visited += tree_range_scan(p_tree_node->p_middle_child, low, high, pf_visitor, p_ctx);
+        }
 
-                    /* Adjust parent's children */
-                    p_parent->p_middle_child = p_parent->p_right_child;
-                    p_parent->p_right_child  = NULL;
-                }
-                /* When parent's children are non leaf nodes */
-                else
-                {
-                    /* Do nothing *//* Confirmed! */
-                }                
-            }
+        if ((low <= p_tree_node->keys[SECOND_KEY]) && (p_tree_node->keys[SECOND_KEY] <= high))
+        {
+            pf_visitor(p_tree_node->keys[SECOND_KEY], p_ctx);
+            visited++;
         }
-        /* Merge right sibling to middle sibling */
-        else if ((MIDDLE == target_dir) && (RIGHT == merged_dir))
+
+        if (high > p_tree_node->keys[SECOND_KEY])
         {
-            p_target_node = p_parent->p_middle_child;
+            visited += tree_range_scan(p_tree_node->p_right_child, low, high, pf_visitor, p_ctx);
+        }
+    }
 
-            /* When target_delete is the middle child */
-            if (p_target_delete == p_parent->p_middle_child)
-            {
-                /* Change target_delete to right child (merged node) */
-                p_target_delete = p_parent->p_right_child;
-
-                /* Merge 2 nodes */
-                p_target_node->keys[FIRST_KEY]  = p_parent->keys[SECOND_KEY];
-                p_target_node->keys[SECOND_KEY] = p_target_delete->keys[FIRST_KEY];
-                delete_key(p_parent, SECOND_KEY);
-                delete_key(p_target_delete, FIRST_KEY);
-
-                /* Adjust children: Shift from right sibling */
-                p_target_node->p_middle_child = p_target_delete->p_left_child;
-                p_target_node->p_right_child  = p_target_delete->p_middle_child;
-            }
-            /* When target_delete is the right child */
-            else
-            {
-                /* Merge 2 nodes */
-                p_target_node->keys[SECOND_KEY] = p_parent->keys[SECOND_KEY];
-                delete_key(p_parent, SECOND_KEY);
+    return visited;
+}
 
-                /* Adjust children: Shift from right sibling */
-                p_target_node->p_right_child = p_target_delete->p_left_child;
-            }
+/*
+    Smallest key above key (strict) or not below it, in one descent. Each node offers at
+    most one candidate: it is better than any seen higher up, and only the child left of
+    it can hold a closer one.
+*/
+static bool_t ceiling_key(const st_tree_node_t *p_tree_node, const int32_t key, const bool_t strict, int32_t *const p_found_key)
+{
+    bool_t found = false;
+
+    while (NULL != p_tree_node)
+    {
+        if ((false == strict) && ((key == p_tree_node->keys[FIRST_KEY]) || (((-1) != p_tree_node->keys[SECOND_KEY]) && (key == p_tree_node->keys[SECOND_KEY]))))
+        {
+            *p_found_key = key;
+            return true;
+        }
 
-            /* Destroy p_target_delete */
-            free(p_target_delete);
-            p_target_delete         = NULL;
-            p_parent->p_right_child = NULL;
+        if (key < p_tree_node->keys[FIRST_KEY])
+        {
+            *p_found_key = p_tree_node->keys[FIRST_KEY];
+            found        = true;
+            p_tree_node  = p_tree_node->p_left_child;
+        }
+        else if (((-1) != p_tree_node->keys[SECOND_KEY]) && (key < p_tree_node->keys[SECOND_KEY]))
+        {
+            *p_found_key = p_tree_node->keys[SECOND_KEY];
+            found        = true;
+            p_tree_node  = p_tree_node->p_middle_child;
         }
         else
         {
-            /* Do nothing (confirmed) */
+            p_tree_node = ((-1) != p_tree_node->keys[SECOND_KEY]) ? p_tree_node->p_right_child : p_tree_node->p_middle_child;
         }
     }
-    /* When parent has only one key (has 2 children) */
-    else
-    {
-        /* When target delete is middle child */
-        if (p_target_delete == p_parent->p_middle_child)
-        {
-            /* Move parent's key to the left child */
-            p_parent->p_left_child->keys[SECOND_KEY] = p_parent->keys[FIRST_KEY];
-            delete_key(p_parent, FIRST_KEY);
 
-            /* In case children are non-leaf nodes */
-            if (false == node_is_leaf(p_parent->p_left_child))
-            {
-                /* When 2 children of target_delete is not yet merged */
-                if (NULL != p_target_delete->p_middle_child)
-                {
-                    merge(pp_root, p_target_delete, LEFT, MIDDLE, p_target_delete->p_middle_child);
-                }
+    return found;
+}
 
-                p_parent->p_left_child->p_right_child = p_target_delete->p_left_child;
-                p_target_delete->p_left_child         = NULL;
-            }
-            /* In case children are leaf nodes */
-            else
-            {
-                /* Do nothing */
-            }
+/* Largest key below key (strict) or not above it, mirror of ceiling_key() */
+static bool_t floor_key(const st_tree_node_t *p_tree_node, const int32_t key, const bool_t strict, int32_t *const p_found_key)
+{
+    bool_t found = false;
+
+    while (NULL != p_tree_node)
+    {
+        if ((false == strict) && ((key == p_tree_node->keys[FIRST_KEY]) || (((-1) != p_tree_node->keys[SECOND_KEY]) && (key == p_tree_node->keys[SECOND_KEY]))))
+        {
+            *p_found_key = key;
+            return true;
+        }
 
-            /* Destroy the middle node */
-            free(p_target_delete);
-            p_parent->p_middle_child = NULL;
+        if (((-1) != p_tree_node->keys[SECOND_KEY]) && (key > p_tree_node->keys[SECOND_KEY]))
+        {
+            *p_found_key = p_tree_node->keys[SECOND_KEY];
+            found        = true;
+            p_tree_node  = p_tree_node->p_right_child;
+        }
+        else if (key > p_tree_node->keys[FIRST_KEY])
+        {
+            *p_found_key = p_tree_node->keys[FIRST_KEY];
+            found        = true;
+            p_tree_node  = p_tree_node->p_middle_child;
         }
-        /* When target delete is left child */
         else
         {
-            /* Change target_delete to middle child because we merge into left child */
-            p_target_delete = p_parent->p_middle_child;
+            p_tree_node = p_tree_node->p_left_child;
+        }
+    }
 
-            /* Merge middle sibling to left sibling */
-            p_parent->p_left_child->keys[FIRST_KEY]  = p_parent->keys[FIRST_KEY];
-            p_parent->p_left_child->keys[SECOND_KEY] = p_target_delete->keys[FIRST_KEY];
-            delete_key(p_parent, FIRST_KEY);
+    return found;
+}
 
-            /* Assign children of the left child */
-            if (NULL != p_parent->p_left_child->p_middle_child)
-            {
-                merge(pp_root, p_parent->p_left_child, LEFT, MIDDLE, p_parent->p_left_child->p_middle_child);
-            }
+/* Smallest key >= key. Returns false when there is none */
+bool_t tree_lower_bound(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key)
+{
+    return (NULL != p_found_key) && ceiling_key(p_root, key, false, p_found_key);
+}
 
-            /* Adjust children: Shift from middle sibling */
-            p_parent->p_left_child->p_middle_child = p_target_delete->p_left_child;
-            p_parent->p_left_child->p_right_child  = p_target_delete->p_middle_child;
+/* Smallest key > key */
+bool_t tree_upper_bound(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key)
+{
+    return (NULL != p_found_key) && ceiling_key(p_root, key, true, p_found_key);
+}
 
-            /* Destroy the middle node */
-            free(p_target_delete);
-            p_parent->p_middle_child = NULL;
-        }
-    }
+/* Largest key < key. key itself does not have to be in the tree */
+bool_t tree_predecessor(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key)
+{
+    return (NULL != p_found_key) && floor_key(p_root, key, true, p_found_key);
+}
+
+/* Smallest key > key. key itself does not have to be in the tree */
+bool_t tree_successor(const st_tree_node_t *const p_root, const int32_t key, int32_t *const p_found_key)
+{
+    return tree_upper_bound(p_root, key, p_found_key);
+}
 
-    /* Update root if needed */
-    if ((true == p_parent->is_root) && (true == node_is_vacant(p_parent)))
+/* A tree of height h holds at most 3^h - 1 keys (every node full) */
+static int64_t max_keys_for_height(const int32_t height)
+{
+    int64_t max_keys = 1;
+    int32_t i;
+
+    for (i = 0; i < height; i++)
     {
-        p_parent->p_left_child->is_root = true;
-        *pp_root = p_parent->p_left_child;
-        free(p_parent);
-        root_change = true;
+        max_keys *= 3;
     }
+
+    return (max_keys - 1);
 }
 
-static void delete_key(st_tree_node_t *const p_tree_node, const e_key_t position)
+/* Lowest height that fits count keys, it gives the fullest nodes */
+int32_t tree_height_for_count(const int32_t count)
 {
-    if (FIRST_KEY == position)
+    int32_t height = 1;
+
+    while (max_keys_for_height(height) < count)
     {
-        node_shift(p_tree_node, LEFT);
+        height++;
     }
-    else
+
+    return height;
+}
+
+/*
+    How a subtree of the given height splits count sorted keys: 2 or 3 children
+    (returned), with p_child_counts[i] keys each and one separator key between them.
+    The keys are spread evenly, so every child stays within [2^(h-1) - 1, 3^(h-1) - 1]
+    keys and all leaves end up at the same depth.
+*/
+int32_t tree_split_plan(const int32_t count, const int32_t height, int32_t *const p_child_counts)
+{
+    int32_t child_count;
+    int32_t child_keys;
+    int32_t extra;
+    int32_t i;
+
+    child_count = ((int64_t)(count - 1) <= (2 * max_keys_for_height(height - 1))) ? 2 : 3;
+    child_keys  = (count - (child_count - 1)) / child_count;
+    extra       = (count - (child_count - 1)) % child_count;
+
+    for (i = 0; i < child_count; i++)
     {
-        p_tree_node->keys[SECOND_KEY] = (-1);
+        p_child_counts[i] = child_keys + ((i < extra) ? 1 : 0);
     }
+
+    return child_count;
 }
 
-static void delete_one_key_leaf_node(st_tree_node_t **pp_root, st_tree_node_t *p_current)
+/*
+    Build a subtree of exactly the given height from count sorted keys. p_values holds the
+    value of each key, NULL leaves them all 0. NULL when out of memory.
+*/
+st_tree_node_t *tree_build_subtree(const int32_t *const p_sorted_keys, const uintptr_t *const p_values, const int32_t count, const int32_t height)
 {
-    st_tree_node_t  *p_parent;
+    st_tree_node_t  *p_node;
+    int32_t         child_counts[MAX_KEY + 1];
+    int32_t         child_count;
+    int32_t         offset;
+    int32_t         i;
 
-    /* Delete the key */
-    delete_key(p_current, FIRST_KEY);
+    if (1 == height)
+    {
+        p_node = create_node(p_sorted_keys[FIRST_KEY], false);
+        if (NULL == p_node)
+        {
+            return NULL;
+        }
 
-    p_parent = stack_pop(&stack);
+        if (2 == count)
+        {
+            p_node->keys[SECOND_KEY] = p_sorted_keys[SECOND_KEY];
+        }
 
-    /* When current is not a root */
-    if (NULL != p_parent)
-    {
-        /* When parent is full (contains 2 keys) */
-        if (true == node_is_full(p_parent))
+        if (NULL != p_values)
         {
-            /* When current is the left child */
-            if (p_current == p_parent->p_left_child)
-            {
-                /* When middle sibling is full (contains 2 keys) */
-                if (true == node_is_full(p_parent->p_middle_child))
-                {
-                    /* Borrow from middle child */
-                    p_current->keys[FIRST_KEY] = p_parent->keys[FIRST_KEY];
-                    p_parent->keys[FIRST_KEY]  = p_parent->p_middle_child->keys[FIRST_KEY];
+            p_node->values[FIRST_KEY]  = p_values[FIRST_KEY];
+            p_node->values[SECOND_KEY] = (2 == count) ? p_values[SECOND_KEY] : 0;
+        }
 
-                    /* Delete borrowed key from borrowed node */
-                    delete_from_node(pp_root, p_parent->p_middle_child, p_parent->p_middle_child->keys[FIRST_KEY]);
-                }
-                /* When middle sibling has only one key */
-                else
-                {
-                    /* Merge with the middle */
-                    merge(pp_root, p_parent, LEFT, MIDDLE, p_current);
-                }
-            }
-            /* When current is the middle child */
-            else if (p_current == p_parent->p_middle_child)
-            {
-                /* When the right child is full (contains 2 keys) */
-                if (true == node_is_full(p_parent->p_right_child))
-                {
-                    /* Borrow from the right sibling */
-                    p_current->keys[FIRST_KEY] = p_parent->keys[SECOND_KEY];
-                    p_parent->keys[SECOND_KEY] = p_parent->p_right_child->keys[FIRST_KEY];
+        augment_node(p_node);
 
-                    /* Delete borrowed key in the borrowed node (right sibling) */
-                    delete_from_node(pp_root, p_parent->p_right_child, p_parent->p_right_child->keys[FIRST_KEY]);
-                }
-                /* When the left child is full (contains 2 keys) */
-                else if (true == node_is_full(p_parent->p_left_child))
-                {
-                    /* Borrow from the left sibling */
-                    node_shift(p_current, RIGHT);
-                    p_current->keys[FIRST_KEY] = p_parent->keys[FIRST_KEY];
-                    p_parent->keys[FIRST_KEY]  = p_parent->p_left_child->keys[SECOND_KEY];
+        return p_node;
+    }
 
-                    /* Delete borrowed key in the borrowed node (left sibling) */
-                    delete_from_node(pp_root, p_parent->p_left_child, p_parent->p_left_child->keys[SECOND_KEY]);
-                }
-                /* When the left sibling and the right sibling both have only one key */
-                else
-                {
-                    /* Merge with the right sibling */
-                    merge(pp_root, p_parent, MIDDLE, RIGHT, p_current);
-                }
-            }
-            /* When current is the right child */
-            else
-            {
-                /* When middle sibling is full (contains 2 keys) */
-                if (true == node_is_full(p_parent->p_middle_child))
-                {
-                    /* Borrow from middle child */
-                    p_current->keys[FIRST_KEY] = p_parent->keys[SECOND_KEY];
-                    p_parent->keys[SECOND_KEY] = p_parent->p_middle_child->keys[SECOND_KEY];
+    p_node = create_node((-1), false);
+    if (NULL == p_node)
+    {
+        return NULL;
+    }
 
-                    /* Delete borrowed key from borrowed node */
-                    delete_key(p_parent->p_middle_child, SECOND_KEY);
-                }
-                /* When middle sibling has only one key */
-                else
-                {
-                    merge(pp_root, p_parent, MIDDLE, RIGHT, p_current);
-                }
-            }
-        }
-        /* When parent has only one key */
-        else
+    child_count = tree_split_plan(count, height, child_counts);
+    offset      = 0;
+
+    for (i = 0; i < child_count; i++)
+    {
+        *child_link(p_node, i) = tree_build_subtree(&p_sorted_keys[offset], (NULL != p_values) ? &p_values[offset] : NULL, child_counts[i], height - 1);
+        if (NULL == *child_link(p_node, i))
         {
-            /* When current is the left child */
-            if (p_current == p_parent->p_left_child)
-            {
-                /* When middle sibling is full (contains 2 keys) */
-                if (true == node_is_full(p_parent->p_middle_child))
-                {
-                    /* Borrow key from middle sibling */
-                    p_current->keys[FIRST_KEY] = p_parent->keys[FIRST_KEY];
-                    p_parent->keys[FIRST_KEY]  = p_parent->p_middle_child->keys[FIRST_KEY];
+            destroy_subtree(p_node);
+            return NULL;
+        }
 
-                    /* Delete borrowed key in the borrowed node (middle sibling) */
-                    delete_from_node(pp_root, p_parent->p_middle_child, p_parent->p_middle_child->keys[FIRST_KEY]);
-                }
-                /* When middle sibling has only one key */
-                else
-                {
-                    if (ENABLED == delete_flag)
-                    {
-                        merge(pp_root, p_parent, LEFT, MIDDLE, p_current);
-
-                        delete_flag = DISABLED;
-                    }
-
-                    /* Delete key in parent */
-                    if (false == root_change)
-                    {
-                        delete_from_node(pp_root, p_parent, p_parent->keys[FIRST_KEY]);
-                    }
-                    else
-                    {
-                        root_change = false;
-                    }
-                }
-            }
-            /* When current is the middle child */
-            else
-            {
-                /* When left sibling is full (contains 2 keys) */
-                if (true == node_is_full(p_parent->p_left_child))
-                {
-                    /* Borrow a key from left sibling */
-                    p_current->keys[FIRST_KEY] = p_parent->keys[FIRST_KEY];
-                    p_parent->keys[FIRST_KEY]  = p_parent->p_left_child->keys[SECOND_KEY];
+        offset += child_counts[i];
 
-                    /* Delete borrowed key in the borrowed node (middle sibling) */
-                    delete_from_node(pp_root, p_parent->p_left_child, p_parent->p_left_child->keys[SECOND_KEY]);
-                }
-                /* When left sibling has only one key */
-                else
-                {
-                    if (ENABLED == delete_flag)
-                    {
-                        merge(pp_root, p_parent, LEFT, MIDDLE, p_current);
-
-                        delete_flag = DISABLED;
-                    }
-
-                    /* Delete key in parent */
-                    if (false == root_change)
-                    {
-                        delete_from_node(pp_root, p_parent, p_parent->keys[FIRST_KEY]);
-                    }
-                    else
-                    {
-                        root_change = false;
-                    }
-                }
-            }
+        /* Separator between this child and the next one */
+        if (i < (child_count - 1))
+        {
+            p_node->keys[i]   = p_sorted_keys[offset];
+            p_node->values[i] = (NULL != p_values) ? p_values[offset] : 0;
+            offset++;
         }
     }
-    /* When current is the root */
-    else
-    {
-        /* Simply remove it and destroy the node */
-        free(p_current);
-        p_current = NULL;
-        *pp_root  = NULL;
-    }
+
+    augment_node(p_node);
+
+    return p_node;
 }
 
-static st_tree_node_t *get_leftmost(st_tree_node_t *p_tree_node)
+/*
+    Replace the tree with one built bottom-up from strictly ascending keys and their values,
+    p_values NULL for all 0. The new tree is complete before the old one is freed, so on
+    failure the tree is left as it was.
+*/
+e_retcode_t tree_build_from_sorted(st_tree_node_t **const pp_root, const int32_t *const p_sorted_keys, const uintptr_t *const p_values, const int32_t count)
 {
-    st_tree_node_t *p_leftmost_node;
+    st_tree_node_t  *p_new_root = NULL;
+    int32_t         height;
 
-    p_leftmost_node = p_tree_node;
+    if ((NULL == pp_root) || ((NULL == p_sorted_keys) && (0 < count)))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
 
-    if (false == node_is_leaf(p_leftmost_node))
+    if (0 > count)
     {
-        stack_push(&stack, (uintptr_t)p_leftmost_node);
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    if (0 < count)
+    {
+        height     = tree_height_for_count(count);
+        p_new_root = tree_build_subtree(p_sorted_keys, p_values, count, height);
+        if (NULL == p_new_root)
+        {
+            return RET_ERRCODE_NG_SYSTEM;
+        }
 
-        p_leftmost_node = get_leftmost(p_leftmost_node->p_left_child);
+        p_new_root->is_root = true;
     }
 
-    return p_leftmost_node;
+    tree_destroy(pp_root);
+    *pp_root = p_new_root;
+
+    return RET_ERRCODE_OK;
 }
 
-static st_tree_node_t *inorder_successor(st_tree_node_t *p_tree_node, const e_key_t key_position)
+static void destroy_subtree(st_tree_node_t *const p_tree_node)
 {
-    st_tree_node_t *p_inorder_successor;
+    if (NULL != p_tree_node)
+    {
+        destroy_subtree(p_tree_node->p_left_child);
+        destroy_subtree(p_tree_node->p_middle_child);
+        destroy_subtree(p_tree_node->p_right_child);
 
-    if (true == node_is_full(p_tree_node))
+        destroy_node(p_tree_node);
+    }
+}
+
+void tree_destroy(st_tree_node_t **const pp_root)
+{
+    if (NULL != pp_root)
     {
-        if (FIRST_KEY == key_position)
-        {
-            p_inorder_successor = get_leftmost(p_tree_node->p_middle_child);
-        }
-        else
-        {
-            p_inorder_successor = get_leftmost(p_tree_node->p_right_child);
-        }
+        destroy_subtree(*pp_root);
+        *pp_root = NULL;
+    }
+}
+
+static st_tree_node_t **child_link(st_tree_node_t *const p_tree_node, const int32_t index)
+{
+    st_tree_node_t **pp_child;
+
+    if (LEFT == index)
+    {
+        pp_child = &p_tree_node->p_left_child;
+    }
+    else if (MIDDLE == index)
+    {
+        pp_child = &p_tree_node->p_middle_child;
     }
     else
     {
-        p_inorder_successor = get_leftmost(p_tree_node->p_middle_child);
+        pp_child = &p_tree_node->p_right_child;
     }
 
-    return p_inorder_successor;
+    return pp_child;
 }
 
-static void process_inorder_successor(st_tree_node_t **pp_root, st_tree_node_t *p_current, const e_key_t key_position)
+static void path_reset(st_tree_path_t *const p_path, st_tree_node_t *const p_root)
 {
-    st_tree_node_t  *p_inorder_successor;
-    int32_t         key_tmp;
+    p_path->depth = 0;
 
-    p_inorder_successor = inorder_successor(p_current, key_position);
+    if (NULL != p_root)
+    {
+        p_path->p_nodes[0] = p_root;
+        p_path->low[0]     = INT64_MIN;
+        p_path->high[0]    = INT64_MAX;
+        p_path->depth      = 1;
+    }
+}
 
-    /* Swap the key to delete with inorder successor's lowest key */
-    key_tmp                              = p_inorder_successor->keys[FIRST_KEY];
-    p_inorder_successor->keys[FIRST_KEY] = p_current->keys[key_position];
-    p_current->keys[key_position]        = key_tmp;
+/* Drop the deepest levels whose key range does not cover key. The root covers everything */
+static void path_rewind(st_tree_path_t *const p_path, st_tree_node_t *const p_root, const int32_t key)
+{
+    /* A new root (grown or shrunk elsewhere) invalidates the whole path */
+    if ((0 < p_path->depth) && (p_root != p_path->p_nodes[0]))
+    {
+        p_path->depth = 0;
+    }
 
-    delete_from_node(pp_root, p_inorder_successor, p_inorder_successor->keys[FIRST_KEY]);
+    while ((0 < p_path->depth)
+        && ((key <= p_path->low[p_path->depth - 1]) || (key >= p_path->high[p_path->depth - 1])))
+    {
+        p_path->depth--;
+    }
+
+    if (0 == p_path->depth)
+    {
+        path_reset(p_path, p_root);
+    }
 }
 
-static void delete_internal_node(st_tree_node_t **pp_root, st_tree_node_t *p_current, int32_t key_to_delete)
+/* Walk down from the deepest node of the path. Return the node holding key, or NULL at the leaf */
+static st_tree_node_t *path_descend(st_tree_path_t *const p_path, const int32_t key)
 {
-    st_tree_node_t  *p_parent;
+    st_tree_node_t  *p_node;
+    int32_t         level;
+    int32_t         index;
+    int32_t         key_count;
 
-    if (ENABLED == delete_flag)
+    while (true)
     {
-        /* When current is full (contains 2 keys) */
-        if (true == node_is_full(p_current))
-        {
-            /* We will take inorder predecessor or inorder successor */
-            stack_push(&stack, (uintptr_t)p_current);
+        level  = p_path->depth - 1;
+        p_node = p_path->p_nodes[level];
 
-            /* When delete the first key */
-            if (key_to_delete == p_current->keys[FIRST_KEY])
-            {
-                process_inorder_successor(pp_root, p_current, FIRST_KEY);
-            }
-            /* When delete the second key */
-            else
-            {
-                process_inorder_successor(pp_root, p_current, SECOND_KEY);
-            }
-        }
-        /* When current has only one key */
-        else
+        if ((key == p_node->keys[FIRST_KEY]) || (key == p_node->keys[SECOND_KEY]))
         {
-            /* We will take inorder predecessor or inorder successor */
-            stack_push(&stack, (uintptr_t)p_current);
+            return p_node;
+        }
 
-            process_inorder_successor(pp_root, p_current, FIRST_KEY);
+        if (NULL == p_node->p_left_child)
+        {
+            return NULL;
         }
 
-        delete_flag = DISABLED;
+        key_count = ((-1) != p_node->keys[SECOND_KEY]) ? 2 : 1;
+        index     = (int32_t)(key > p_node->keys[FIRST_KEY]) + (int32_t)((2 == key_count) && (key > p_node->keys[SECOND_KEY]));
+
+        p_path->p_nodes[level + 1] = *child_link(p_node, index);
+        p_path->low[level + 1]     = (LEFT == index) ? p_path->low[level] : p_node->keys[index - 1];
+        p_path->high[level + 1]    = (key_count == index) ? p_path->high[level] : p_node->keys[index];
+        p_path->depth++;
     }
-    /* When delete_flag = DISABLED */
-    else
+}
+
+/*
+    Add key and its value to the leaf at the end of the path, splitting full nodes bottom-up.
+    Afterwards the path keeps only the levels whose key range did not change.
+    Every node changed and all its ancestors are augmented bottom-up.
+    Returns the value slot where the new key ended up, or NULL with the tree untouched
+    when a node cannot be allocated.
+*/
+static uintptr_t *path_insert(st_tree_node_t **const pp_root, st_tree_path_t *const p_path, const int32_t key, const uintptr_t value)
+{
+    st_tree_node_t  *p_node;
+    st_tree_node_t  *p_new_child = NULL;
+    st_tree_node_t  *p_split;
+    st_tree_node_t  *p_spares[TREE_MAX_HEIGHT + 1];
+    st_tree_node_t  *p_children[MAX_KEY + 2];
+    int32_t         keys[MAX_KEY + 1];
+    uintptr_t       values[MAX_KEY + 1];
+    uintptr_t       *p_slot = NULL;
+    int32_t         up_key = key;
+    uintptr_t       up_value = value;
+    int32_t         spare_count = 0;
+    int32_t         level;
+    int32_t         position;
+    int32_t         i;
+
+    /* One node per full node on the way up, and a new root when they all are, before anything moves */
+    for (level = p_path->depth - 1; (level >= 0) && (true == node_is_full(p_path->p_nodes[level])); level--)
     {
-        p_parent = stack_pop(&stack);
+        spare_count++;
+    }
 
-        /* When current is left child */
-        if (p_current == p_parent->p_left_child)
+    if (0 > level)
+    {
+        spare_count++;
+    }
+
+    for (i = 0; i < spare_count; i++)
+    {
+        p_spares[i] = create_node((-1), false);
+        if (NULL == p_spares[i])
         {
-            /* Currently, in this implementation, current has only one key, never be full (contains 2 keys) */
-            /* When middle sibling is full (contains 2 keys) */
-            if (true == node_is_full(p_parent->p_middle_child))
-            {
-                /* Borrow from middle sibling */
-                p_current->keys[FIRST_KEY] = p_parent->keys[FIRST_KEY];
-                p_parent->keys[FIRST_KEY]  = p_parent->p_middle_child->keys[FIRST_KEY];
-                node_shift(p_parent->p_middle_child, LEFT);
-
-                /* Assign children: Shift children from middle sibling to current */
-                p_current->p_middle_child                = p_parent->p_middle_child->p_left_child;
-                p_parent->p_middle_child->p_left_child   = p_parent->p_middle_child->p_middle_child;
-                p_parent->p_middle_child->p_middle_child = p_parent->p_middle_child->p_right_child;
-                p_parent->p_middle_child->p_right_child  = NULL;
-            }
-            /* When middle sibling has only one key */
-            else
+            while (0 < i)
             {
-                merge(pp_root, p_parent, LEFT, MIDDLE, p_current);
+                i--;
+                destroy_node(p_spares[i]);
             }
+
+            return NULL;
         }
-        /* When current is middle child */
-        else if (p_current == p_parent->p_middle_child)
+    }
+
+    spare_count = 0;
+
+    for (level = p_path->depth - 1; level >= 0; level--)
+    {
+        p_node   = p_path->p_nodes[level];
+        position = (int32_t)(up_key > p_node->keys[FIRST_KEY]) + (int32_t)(((-1) != p_node->keys[SECOND_KEY]) && (up_key > p_node->keys[SECOND_KEY]));
+
+        /* Node has only one key: absorb the key and the new child, done */
+        if ((-1) == p_node->keys[SECOND_KEY])
         {
-            /* Currently, in this implementation, current has only one key, never be full (contains 2 keys) */
-            /* When parent is full */
-            if (true == node_is_full(p_parent))
+            if (0 == position)
             {
-                /* When right sibling is full (contains 2 keys) */
-                if ( true == node_is_full(p_parent->p_right_child))
-                {
-                    /* Borrow from right sibling */
-                    p_current->keys[FIRST_KEY] = p_parent->keys[SECOND_KEY];
-                    p_parent->keys[SECOND_KEY] = p_parent->p_right_child->keys[FIRST_KEY];
-                    delete_key(p_parent->p_right_child, FIRST_KEY);
-
-                    /* Assign children: Shift children from right sibling to current  */
-                    p_current->p_middle_child               = p_parent->p_right_child->p_left_child;
-                    p_parent->p_right_child->p_left_child   = p_parent->p_right_child->p_middle_child;
-                    p_parent->p_right_child->p_middle_child = p_parent->p_right_child->p_right_child;
-                    p_parent->p_right_child->p_right_child  = NULL;
-                }
-                /* When left sibling is full (contains 2 keys) */
-                else if (true == node_is_full(p_parent->p_left_child))
-                {
-                    /* Borrow from left sibling */
-                    p_current->keys[FIRST_KEY] = p_parent->keys[FIRST_KEY];
-                    p_parent->keys[FIRST_KEY]  = p_parent->p_left_child->keys[SECOND_KEY];
-                    delete_key(p_parent->p_left_child, SECOND_KEY);
-
-                    /* Assign children: Shift children from left sibling to current */
-                    p_current->p_middle_child             = p_current->p_left_child;
-                    p_current->p_left_child               = p_parent->p_left_child->p_right_child;
-                    p_parent->p_left_child->p_right_child = NULL;
-                }
-                else
-                {
-                    merge(pp_root, p_parent, MIDDLE, RIGHT, p_current);
-                }
+                p_node->keys[SECOND_KEY]   = p_node->keys[FIRST_KEY];
+                p_node->values[SECOND_KEY] = p_node->values[FIRST_KEY];
+                p_node->p_right_child      = p_node->p_middle_child;
+                p_node->p_middle_child     = p_new_child;
             }
-            /* When parent has only one key */
             else
             {
-                /* When left sibling is full (contains 2 keys) */
-                if (true == node_is_full(p_parent->p_left_child))
-                {
-                    /* Borrow from left sibling */
-                    p_current->keys[FIRST_KEY] = p_parent->keys[FIRST_KEY];
-                    p_parent->keys[FIRST_KEY]  = p_parent->p_left_child->keys[SECOND_KEY];
-                    delete_key(p_parent->p_left_child, SECOND_KEY);
-
-                    /* Assign children: Shift children from left sibling to current */
-                    p_current->p_middle_child             = p_current->p_left_child;
-                    p_current->p_left_child               = p_parent->p_left_child->p_right_child;
-                    p_parent->p_left_child->p_right_child = NULL;
-                }
-                /* When left sibling has only one key */
-                else
-                {
-                    merge(pp_root, p_parent, LEFT, MIDDLE, p_current);
-                }
+                p_node->p_right_child = p_new_child;
             }
+
+            p_node->keys[position]   = up_key;
+            p_node->values[position] = up_value;
+            p_node->version++;
+
+            augment_node(p_node);
+            augment_upward(p_path->p_nodes, level);
+
+            p_path->depth = level + 1;
+
+            return (key == up_key) ? &p_node->values[position] : p_slot;
+        }
+
+        /* Node is full: lay out 3 keys and 4 children in order */
+        p_children[0] = p_node->p_left_child;
+        p_children[1] = p_node->p_middle_child;
+        p_children[2] = p_node->p_right_child;
+
+        for (i = MAX_KEY; i > position; i--)
+        {
+            keys[i]           = p_node->keys[i - 1];
+            values[i]         = p_node->values[i - 1];
+            p_children[i + 1] = p_children[i];
         }
-        /* When current is the right child */
-        else
+
+        for (i = 0; i < position; i++)
         {
-            /* Currently, in this implementation, current has only one key, never be full (contains 2 keys) */
-            /* When middle sibling is full (contains 2 keys) */
-            if (true == node_is_full(p_parent->p_middle_child))
-            {
-                /* Borrow from middle sibling */
-                node_shift(p_current, RIGHT);
-                p_current->keys[FIRST_KEY] = p_parent->keys[SECOND_KEY];
-                p_parent->keys[SECOND_KEY] = p_parent->p_middle_child->keys[SECOND_KEY];
-                delete_key(p_parent->p_middle_child, SECOND_KEY);
-
-                /* Assign children: Shift children from middle sibling to current */
-                p_current->p_middle_child               = p_current->p_left_child;
-                p_current->p_left_child                 = p_parent->p_middle_child->p_right_child;
-                p_parent->p_middle_child->p_right_child = NULL;
-            }
-            /* When middle sibling has only one key */
-            else
-            {
-                merge(pp_root, p_parent, MIDDLE, RIGHT, p_current);
-            }
+            keys[i]   = p_node->keys[i];
+            values[i] = p_node->values[i];
         }
 
-        if (true == node_is_vacant(p_parent))
+        keys[position]           = up_key;
+        values[position]         = up_value;
+        p_children[position + 1] = p_new_child;
+
+        /* Keep the smallest key, move the largest to a new sibling, promote the middle one */
+        p_split = p_spares[spare_count++];
+        p_split->keys[FIRST_KEY]   = keys[2];
+        p_split->values[FIRST_KEY] = values[2];
+        p_split->p_left_child      = p_children[2];
+        p_split->p_middle_child    = p_children[3];
+
+        p_node->keys[FIRST_KEY]   = keys[0];
+        p_node->values[FIRST_KEY] = values[0];
+        p_node->keys[SECOND_KEY]  = (-1);
+        p_node->p_left_child      = p_children[0];
+        p_node->p_middle_child    = p_children[1];
+        p_node->p_right_child     = NULL;
+        p_node->version++;
+
+        augment_node(p_split);
+        augment_node(p_node);
+
+        if (key == keys[0])
+        {
+            p_slot = &p_node->values[FIRST_KEY];
+        }
+        else if (key == keys[2])
         {
-            delete_internal_node(pp_root, p_parent, key_to_delete);
+            p_slot = &p_split->values[FIRST_KEY];
         }
+
+        up_key      = keys[1];
+        up_value    = values[1];
+        p_new_child = p_split;
     }
 
-    return;
+    /* The root itself was split: grow a new root */
+    p_node = p_spares[spare_count];
+    p_node->keys[FIRST_KEY]   = up_key;
+    p_node->values[FIRST_KEY] = up_value;
+    p_node->is_root           = true;
+    p_node->p_left_child      = *pp_root;
+    p_node->p_middle_child    = p_new_child;
+    (*pp_root)->is_root       = false;
+    *pp_root                  = p_node;
+
+    augment_node(p_node);
+
+    p_path->depth = 0;
+
+    return (key == up_key) ? &p_node->values[FIRST_KEY] : p_slot;
 }
 
-static void delete_from_node(st_tree_node_t **const pp_root, st_tree_node_t *const p_current, const int32_t key)
+/*
+    Remove key without recursion. The descent records every node and the child taken
+    below it; a key found in an inner node is replaced by its in-order successor, found
+    by following the same descent to the leftmost leaf on its right, so a key always
+    leaves from a leaf. A leaf left empty is repaired in one bottom-up loop: a sibling
+    holding 2 keys lends one through the parent and the loop ends, otherwise the empty
+    node merges with a sibling and takes the separator from the parent, which may leave
+    the parent empty in turn. An empty root is replaced by its only child.
+    Values move with their keys, and every node left changed is augmented bottom-up.
+    pf_filter, when set, sees the value once the key is found and may keep the key.
+    Returns false when key is not in the tree or was kept.
+*/
+static bool_t path_delete(st_tree_node_t **const pp_root, const int32_t key, pf_remove_filter_t pf_filter, void *p_ctx)
 {
-    if ((key == p_current->keys[FIRST_KEY]) || (key == p_current->keys[SECOND_KEY]))
+    st_tree_node_t  *p_nodes[TREE_MAX_HEIGHT];
+    int32_t         taken[TREE_MAX_HEIGHT];
+    st_tree_node_t  *p_node;
+    st_tree_node_t  *p_leaf;
+    st_tree_node_t  *p_parent;
+    st_tree_node_t  *p_sibling;
+    st_tree_node_t  *p_found = NULL;
+    st_tree_node_t  *p_orphan = NULL;
+    int32_t         found_position = FIRST_KEY;
+    int32_t         removed;
+    int32_t         separator;
+    int32_t         depth = 0;
+    int32_t         level;
+    int32_t         index;
+    int32_t         key_count;
+    int32_t         i;
+
+    for (p_node = *pp_root; NULL != p_node; p_node = *child_link(p_node, index))
     {
-        /* When p_current is a leaf node */
-        if (true == node_is_leaf(p_current))
+        key_count = ((-1) != p_node->keys[SECOND_KEY]) ? 2 : 1;
+
+        if (NULL != p_found)
         {
-            /* When p_current is full (contains 2 keys), simply delete it */
-            if (true == node_is_full(p_current))
-            {
-                if (key == p_current->keys[FIRST_KEY])
-                {
-                    delete_key(p_current, FIRST_KEY);
-                }
-                else
-                {
-                    delete_key(p_current, SECOND_KEY);
-                }
-            }
-            /* When node has only one key, simply delete it then borrow or merge */
-            else
-            {
-                delete_one_key_leaf_node(pp_root, p_current);
-            }
+            index = LEFT;
+        }
+        else if ((key == p_node->keys[FIRST_KEY]) || ((2 == key_count) && (key == p_node->keys[SECOND_KEY])))
+        {
+            p_found        = p_node;
+            found_position = (key == p_node->keys[FIRST_KEY]) ? FIRST_KEY : SECOND_KEY;
+            index          = found_position + 1;
         }
-        /* When current is not a leaf */
         else
         {
-            /* When current is full (contains 2 keys) */
-            if (true == node_is_full(p_current))
-            {
-                if (key == p_current->keys[FIRST_KEY])
-                {
-                    /* When current's left child is vacant */
-                    if (NULL == p_current->p_left_child)
-                    {
-                        delete_key(p_current, FIRST_KEY);
-
-                        /* Shift all children leftward */
-                        p_current->p_left_child   = p_current->p_middle_child;
-                        p_current->p_middle_child = p_current->p_right_child;
-                        p_current->p_right_child  = NULL;
-                    }
-                    else
-                    {
-                        delete_internal_node(pp_root, p_current, key);
-                    }
-                }
-                else
-                {
-                    delete_internal_node(pp_root, p_current, key);
-                }
-            }
-            /* When current has only one key */
-            else
-            {
-                delete_internal_node(pp_root, p_current, key);
-            }
+            index = (int32_t)(key > p_node->keys[FIRST_KEY]) + (int32_t)((2 == key_count) && (key > p_node->keys[SECOND_KEY]));
         }
+
+        p_nodes[depth] = p_node;
+        taken[depth]   = index;
+        depth++;
     }
-    else
+
+    if ((NULL == p_found) || ((NULL != pf_filter) && (false == pf_filter(key, p_found->values[found_position], p_ctx))))
+    {
+        return false;
+    }
+
+    /* Swap with the successor: the first key of the leaf the descent ended on */
+    p_leaf  = p_nodes[depth - 1];
+    removed = found_position;
+
+    if (p_found != p_leaf)
+    {
+        p_found->keys[found_position]   = p_leaf->keys[FIRST_KEY];
+        p_found->values[found_position] = p_leaf->values[FIRST_KEY];
+        removed                         = FIRST_KEY;
+        p_found->version++;
+    }
+
+    if (FIRST_KEY == removed)
+    {
+        p_leaf->keys[FIRST_KEY]   = p_leaf->keys[SECOND_KEY];
+        p_leaf->values[FIRST_KEY] = p_leaf->values[SECOND_KEY];
+    }
+    p_leaf->keys[SECOND_KEY] = (-1);
+    p_leaf->version++;
+
+    if ((-1) != p_leaf->keys[FIRST_KEY])
     {
-        /* Push the parent into the stack */
-        stack_push(&stack, (uintptr_t)p_current);
+        augment_upward(p_nodes, depth);
+        return true;
+    }
 
-        if (true == key_on_the_left(key, p_current))
+    /* p_nodes[level] has no key left and p_orphan is its only child (none for a leaf) */
+    for (level = depth - 1; level > 0; level--)
+    {
+        p_node    = p_nodes[level];
+        p_parent  = p_nodes[level - 1];
+        index     = taken[level - 1];
+        key_count = ((-1) != p_parent->keys[SECOND_KEY]) ? 2 : 1;
+
+        /* Borrow through the parent from a left sibling with 2 keys */
+        p_sibling = (0 < index) ? *child_link(p_parent, index - 1) : NULL;
+        if ((NULL != p_sibling) && ((-1) != p_sibling->keys[SECOND_KEY]))
         {
-            delete_from_node(pp_root, p_current->p_left_child, key);
+            p_node->keys[FIRST_KEY]     = p_parent->keys[index - 1];
+            p_node->values[FIRST_KEY]   = p_parent->values[index - 1];
+            p_node->p_left_child        = p_sibling->p_right_child;
+            p_node->p_middle_child      = p_orphan;
+            p_parent->keys[index - 1]   = p_sibling->keys[SECOND_KEY];
+            p_parent->values[index - 1] = p_sibling->values[SECOND_KEY];
+            p_sibling->keys[SECOND_KEY] = (-1);
+            p_sibling->p_right_child    = NULL;
+            p_node->version++;
+            p_parent->version++;
+            p_sibling->version++;
+
+            augment_node(p_sibling);
+            augment_upward(p_nodes, level + 1);
+
+            return true;
         }
-        else if (true == node_is_full(p_current))
+
+        /* Or from a right sibling with 2 keys */
+        p_sibling = (index < key_count) ? *child_link(p_parent, index + 1) : NULL;
+        if ((NULL != p_sibling) && ((-1) != p_sibling->keys[SECOND_KEY]))
         {
-            if (true == key_in_the_middle(key, p_current))
-            {
-                delete_from_node(pp_root, p_current->p_middle_child, key);
-            }
-            else
-            {
-                delete_from_node(pp_root, p_current->p_right_child, key);
-            }
+            p_node->keys[FIRST_KEY]      = p_parent->keys[index];
+            p_node->values[FIRST_KEY]    = p_parent->values[index];
+            p_node->p_left_child         = p_orphan;
+            p_node->p_middle_child       = p_sibling->p_left_child;
+            p_parent->keys[index]        = p_sibling->keys[FIRST_KEY];
+            p_parent->values[index]      = p_sibling->values[FIRST_KEY];
+            p_sibling->keys[FIRST_KEY]   = p_sibling->keys[SECOND_KEY];
+            p_sibling->values[FIRST_KEY] = p_sibling->values[SECOND_KEY];
+            p_sibling->keys[SECOND_KEY]  = (-1);
+            p_sibling->p_left_child      = p_sibling->p_middle_child;
+            p_sibling->p_middle_child    = p_sibling->p_right_child;
+            p_sibling->p_right_child     = NULL;
+            p_node->version++;
+            p_parent->version++;
+            p_sibling->version++;
+
+            augment_node(p_sibling);
+            augment_upward(p_nodes, level + 1);
+
+            return true;
+        }
+
+        /* Both neighbours hold one key: the separator joins one of them, with p_orphan */
+        if (0 < index)
+        {
+            separator = index - 1;
+            p_sibling = *child_link(p_parent, separator);
+
+            p_sibling->keys[SECOND_KEY]   = p_parent->keys[separator];
+            p_sibling->values[SECOND_KEY] = p_parent->values[separator];
+            p_sibling->p_right_child      = p_orphan;
         }
         else
         {
-            delete_from_node(pp_root, p_current->p_middle_child, key);
+            separator = FIRST_KEY;
+            p_sibling = p_parent->p_middle_child;
+
+            p_sibling->keys[SECOND_KEY]   = p_sibling->keys[FIRST_KEY];
+            p_sibling->values[SECOND_KEY] = p_sibling->values[FIRST_KEY];
+            p_sibling->keys[FIRST_KEY]    = p_parent->keys[FIRST_KEY];
+            p_sibling->values[FIRST_KEY]  = p_parent->values[FIRST_KEY];
+            p_sibling->p_right_child      = p_sibling->p_middle_child;
+            p_sibling->p_middle_child     = p_sibling->p_left_child;
+            p_sibling->p_left_child       = p_orphan;
+        }
+
+        p_sibling->version++;
+        augment_node(p_sibling);
+        destroy_node(p_node);
+
+        /* Close the gap left by the empty child and the separator */
+        for (i = index; i < key_count; i++)
+        {
+            *child_link(p_parent, i) = *child_link(p_parent, i + 1);
+        }
+        *child_link(p_parent, key_count) = NULL;
+
+        for (i = separator; i < (key_count - 1); i++)
+        {
+            p_parent->keys[i]   = p_parent->keys[i + 1];
+            p_parent->values[i] = p_parent->values[i + 1];
+        }
+        p_parent->keys[key_count - 1] = (-1);
+        p_parent->version++;
+
+        if ((-1) != p_parent->keys[FIRST_KEY])
+        {
+            augment_upward(p_nodes, level);
+            return true;
         }
+
+        p_orphan = p_parent->p_left_child;
+    }
+
+    /* The root ran out of keys: its only child takes over */
+    p_node   = p_nodes[0];
+    *pp_root = p_orphan;
+
+    if (NULL != p_orphan)
+    {
+        p_orphan->is_root = true;
     }
+
+    destroy_node(p_node);
+
+    return true;
 }
 
-void inorder_traverse(const st_tree_node_t *const p_tree_node)
+void tree_path_reset(st_tree_path_t *const p_path)
 {
-    if (NULL != p_tree_node)
+    if (NULL != p_path)
     {
-        inorder_traverse(p_tree_node->p_left_child);
+        p_path->depth = 0;
+    }
+}
 
-        printf("%d ", p_tree_node->keys[FIRST_KEY]);
+/*
+    Search that starts from the deepest node of p_path still covering the key instead of the root.
+    On return the path ends at the node holding the key, or at the leaf where it would go.
+    The path must be reset after the tree is changed by anything but tree_path_insert().
+*/
+st_tree_node_t *tree_path_search(st_tree_node_t *const p_root, st_tree_path_t *const p_path, const int32_t searched_key)
+{
+    if ((NULL == p_root) || (NULL == p_path) || ((-1) == searched_key))
+    {
+        return NULL;
+    }
 
-        inorder_traverse(p_tree_node->p_middle_child);
+    path_rewind(p_path, p_root, searched_key);
 
-        if ((-1) != p_tree_node->keys[SECOND_KEY])
+    return path_descend(p_path, searched_key);
+}
+
+/* Insert along p_path, see tree_path_search(). Only one descent, even for duplicates */
+e_retcode_t tree_path_insert(st_tree_node_t **const pp_root, st_tree_path_t *const p_path, const int32_t key)
+{
+    if ((NULL == pp_root) || (NULL == p_path))
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    if (NULL == *pp_root)
+    {
+        *pp_root = create_node(key, true);
+        if (NULL == *pp_root)
         {
-            printf("%d ", p_tree_node->keys[SECOND_KEY]);
+            return RET_ERRCODE_NG_SYSTEM;
         }
 
-        inorder_traverse(p_tree_node->p_right_child);
+        augment_node(*pp_root);
+        path_reset(p_path, *pp_root);
+        return RET_ERRCODE_OK;
+    }
+
+    if (NULL != tree_path_search(*pp_root, p_path, key))
+    {
+        return RET_ERRCODE_NG_DUPLICATE;
+    }
+
+    if (NULL == path_insert(pp_root, p_path, key, 0))
+    {
+        return RET_ERRCODE_NG_SYSTEM;
     }
+
+    return RET_ERRCODE_OK;
 }
 
-void preorder_traverse(const st_tree_node_t *const p_tree_node)
+/*
+    Insert many keys in one call. Each descent resumes from the deepest node of the
+    previous path that still covers the key, so ascending runs share most of the walk.
+    Duplicates are skipped. Stops at the first key that cannot be inserted (no memory,
+    or the blank key) and returns why; *p_done is then its index, and the keys before it
+    are in the tree. *p_inserted counts the keys added. Either pointer may be NULL.
+*/
+e_retcode_t tree_insert_batch(st_tree_node_t **const pp_root, const int32_t *const p_sorted_keys, const int32_t count, int32_t *const p_inserted, int32_t *const p_done)
 {
-    int32_t i;
+    st_tree_path_t  path;
+    e_retcode_t     ret = RET_ERRCODE_OK;
+    int32_t         inserted = 0;
+    int32_t         i;
 
-    if (NULL != p_tree_node)
+    if ((NULL == pp_root) || ((NULL == p_sorted_keys) && (0 < count)))
     {
-        for (i = 0; i < MAX_KEY; i++)
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    path.depth = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        ret = tree_path_insert(pp_root, &path, p_sorted_keys[i]);
+        if (RET_ERRCODE_OK == ret)
         {
-            if ((-1) != p_tree_node->keys[i])
-            {
-                printf("%d ", p_tree_node->keys[i]);
-            }
+            inserted++;
+        }
+        else if (RET_ERRCODE_NG_DUPLICATE != ret)
+        {
+            break;
         }
 
-        preorder_traverse(p_tree_node->p_left_child);
-        preorder_traverse(p_tree_node->p_middle_child);
-        preorder_traverse(p_tree_node->p_right_child);
+        ret = RET_ERRCODE_OK;
+    }
+
+    if (NULL != p_inserted)
+    {
+        *p_inserted = inserted;
+    }
+
+    if (NULL != p_done)
+    {
+        *p_done = i;
     }
+
+    return ret;
 }
 
-void postorder_traverse(const st_tree_node_t *const p_tree_node)
+/*
+    Remove many keys in one call. In ascending order each descent follows the previous
+    one, so the upper levels and the leaves just merged stay in cache. pf_filter, when
+    set, is handed each key found with its value and removes it only by returning true,
+    so a condition on the value costs no descent of its own.
+    Absent keys are skipped. Returns the number of keys removed.
+*/
+int32_t tree_remove_batch(st_tree_node_t **const pp_root, const int32_t *const p_sorted_keys, const int32_t count, pf_remove_filter_t pf_filter, void *p_ctx)
 {
+    int32_t removed = 0;
     int32_t i;
 
-    if (NULL != p_tree_node)
+    if ((NULL == pp_root) || (NULL == p_sorted_keys))
     {
-        postorder_traverse(p_tree_node->p_left_child);
-        postorder_traverse(p_tree_node->p_middle_child);
-        postorder_traverse(p_tree_node->p_right_child);
+        return 0;
+    }
 
-        for (i = 0; i < MAX_KEY; i++)
+    for (i = 0; (i < count) && (NULL != *pp_root); i++)
+    {
+        if (((-1) != p_sorted_keys[i]) && (true == path_delete(pp_root, p_sorted_keys[i], pf_filter, p_ctx)))
         {
-            if ((-1) != p_tree_node->keys[i])
-            {
-                printf("%d ", p_tree_node->keys[i]);
-            }
+            removed++;
         }
     }
+
+    return removed;
 }
 
 st_tree_node_t *search(const st_tree_node_t *const p_start_node, const int32_t searched_key)
@@ -1224,28 +1354,191 @@ st_tree_node_t *search(const st_tree_node_t *const p_start_node, const int32_t s
     return found_node;
 }
 
+/* One descent: the duplicate check and the insert share the same path */
 e_retcode_t insert(st_tree_node_t **const pp_root, const int32_t key)
 {
-    e_retcode_t ret = RET_ERRCODE_OK;
+    e_retcode_t     ret;
+    st_tree_path_t  path;
 
-    if (NULL == pp_root)
+    path.depth = 0;
+
+    ret = tree_path_insert(pp_root, &path, key);
+    if (RET_ERRCODE_NG_DUPLICATE == ret)
     {
-        ret = RET_ERRCODE_NG_ARGNULL;
+        printf("Key %d is already present in the tree!\n", key);
+        ret = RET_ERRCODE_OK;
     }
-    else if ((-1) == key)
+
+    return ret;
+}
+
+static uintptr_t *value_slot(st_tree_node_t *const p_tree_node, const int32_t key)
+{
+    return (key == p_tree_node->keys[FIRST_KEY]) ? &p_tree_node->values[FIRST_KEY] : &p_tree_node->values[SECOND_KEY];
+}
+
+static uintptr_t *find_value_slot(st_tree_node_t *const p_root, const int32_t key)
+{
+    st_tree_node_t *p_tree_node;
+
+    if ((NULL == p_root) || ((-1) == key))
     {
-        ret = RET_ERRCODE_NG_PARAM;
+        return NULL;
     }
-    else if (NULL != search(*pp_root, key))
+
+    p_tree_node = search(p_root, key);
+
+    return (NULL != p_tree_node) ? value_slot(p_tree_node, key) : NULL;
+}
+
+/*
+    Return the value slot of key, inserting key with value first when it is absent.
+    Only one descent; the split path runs only when a key is really added.
+    The slot stays valid until the next insert or delete on the tree.
+*/
+uintptr_t *insert_or_get(st_tree_node_t **const pp_root, const int32_t key, const uintptr_t value, bool_t *const p_inserted)
+{
+    st_tree_path_t path;
+
+    path.depth = 0;
+
+    return tree_path_insert_or_get(pp_root, &path, key, value, p_inserted);
+}
+
+/*
+    insert_or_get() along p_path, see tree_path_search(). When key was already there the
+    path ends at its node, so a value changed through the slot can be folded into the
+    summaries with tree_path_augment().
+*/
+uintptr_t *tree_path_insert_or_get(st_tree_node_t **const pp_root, st_tree_path_t *const p_path, const int32_t key, const uintptr_t value, bool_t *const p_inserted)
+{
+    st_tree_node_t  *p_found;
+    uintptr_t       *p_slot;
+    bool_t          inserted = false;
+
+    if ((NULL == pp_root) || (NULL == p_path) || ((-1) == key))
     {
-        printf("Key %d is already present in the tree!\n", key);
+        return NULL;
+    }
+
+    if (NULL == *pp_root)
+    {
+        *pp_root = create_node(key, true);
+        if (NULL == *pp_root)
+        {
+            return NULL;
+        }
+
+        (*pp_root)->values[FIRST_KEY] = value;
+        p_slot                        = &(*pp_root)->values[FIRST_KEY];
+        inserted                      = true;
+
+        augment_node(*pp_root);
+        path_reset(p_path, *pp_root);
     }
     else
     {
-        insert_to_tree(pp_root, *pp_root, key, LEFT);
+        path_rewind(p_path, *pp_root, key);
+
+        p_found = path_descend(p_path, key);
+        if (NULL != p_found)
+        {
+            p_slot = value_slot(p_found, key);
+        }
+        else
+        {
+            p_slot   = path_insert(pp_root, p_path, key, value);
+            inserted = (NULL != p_slot);
+        }
     }
 
-    return ret;
+    if (NULL != p_inserted)
+    {
+        *p_inserted = inserted;
+    }
+
+    return p_slot;
+}
+
+/* Augment one node built outside this file, once its children have been */
+void tree_augment_node(st_tree_node_t *const p_tree_node)
+{
+    if (NULL != p_tree_node)
+    {
+        augment_node(p_tree_node);
+    }
+}
+
+/* Augment the nodes of p_path bottom-up, after a value of its last node was changed in place */
+void tree_path_augment(const st_tree_path_t *const p_path)
+{
+    if (NULL != p_path)
+    {
+        augment_upward(p_path->p_nodes, p_path->depth);
+    }
+}
+
+/* Insert key with value, or overwrite the value when key is already there */
+e_retcode_t upsert(st_tree_node_t **const pp_root, const int32_t key, const uintptr_t value)
+{
+    uintptr_t   *p_slot;
+    bool_t      inserted;
+
+    if (NULL == pp_root)
+    {
+        return RET_ERRCODE_NG_ARGNULL;
+    }
+
+    if ((-1) == key)
+    {
+        return RET_ERRCODE_NG_PARAM;
+    }
+
+    p_slot = insert_or_get(pp_root, key, value, &inserted);
+    if (NULL == p_slot)
+    {
+        return RET_ERRCODE_NG_SYSTEM;
+    }
+
+    if (false == inserted)
+    {
+        __atomic_store_n(p_slot, value, __ATOMIC_RELEASE);
+    }
+
+    return RET_ERRCODE_OK;
+}
+
+/*
+    Replace the value of key with desired only if it is still expected. The swap is atomic,
+    so it can race with other cas() calls on the same key; the tree shape is not changed.
+    Returns false when key is absent or holds another value.
+*/
+bool_t cas(st_tree_node_t *const p_root, const int32_t key, const uintptr_t expected, const uintptr_t desired)
+{
+    uintptr_t   *p_slot = find_value_slot(p_root, key);
+    uintptr_t   current = expected;
+
+    if (NULL == p_slot)
+    {
+        return false;
+    }
+
+    return __atomic_compare_exchange_n(p_slot, &current, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/* Copy the value of key to p_value. Returns false when key is absent */
+bool_t tree_get_value(const st_tree_node_t *const p_root, const int32_t key, uintptr_t *const p_value)
+{
+    uintptr_t *p_slot = find_value_slot((st_tree_node_t *)p_root, key);
+
+    if ((NULL == p_slot) || (NULL == p_value))
+    {
+        return false;
+    }
+
+    *p_value = __atomic_load_n(p_slot, __ATOMIC_ACQUIRE);
+
+    return true;
 }
 
 e_retcode_t delete(st_tree_node_t **const pp_root, const int32_t key)
@@ -1260,21 +1553,42 @@ e_retcode_t delete(st_tree_node_t **const pp_root, const int32_t key)
     {
         ret = RET_ERRCODE_NG_PARAM;
     }
-    else if (NULL == search(*pp_root, key))
+    else if (false == path_delete(pp_root, key, NULL, NULL))
     {
         printf("Key %d is not in the tree!\n", key);
     }
-    else
+
+    return ret;
+}
+
+/* delete() without the message: tells whether key was in the tree */
+bool_t tree_remove(st_tree_node_t **const pp_root, const int32_t key)
+{
+    if ((NULL == pp_root) || ((-1) == key))
     {
-        delete_flag = ENABLED;
-        delete_from_node(pp_root, *pp_root, key);
+        return false;
+    }
 
-        /* Clear the stack */
-        while (false == stack_is_empty(&stack))
-        {
-            (void)stack_pop(&stack);
-        }
+    return path_delete(pp_root, key, NULL, NULL);
+}
+
+/* Hands the value of the key found to tree_remove_value(), and lets it go */
+static bool_t take_value(const int32_t key, const uintptr_t value, void *p_ctx)
+{
+    (void)key;
+
+    *(uintptr_t *)p_ctx = value;
+
+    return true;
+}
+
+/* tree_remove() that also gives the value the key had, in the same descent */
+bool_t tree_remove_value(st_tree_node_t **const pp_root, const int32_t key, uintptr_t *const p_value)
+{
+    if ((NULL == pp_root) || (NULL == p_value) || ((-1) == key))
+    {
+        return false;
     }
 
-    return ret;
+    return path_delete(pp_root, key, take_value, p_value);
 }
\ No newline at end of file